@@ -0,0 +1,169 @@
+/** @file AttributeChannel.cpp
+ *
+ * @brief Defines extra per vertex or per corner data stored with a mesh
+ *
+ * Copyright 2013, Stewart Hall
+ *
+ * Licensed under The MIT License
+ * Redistributions of files must retain the above copyright notice.
+ *
+ * @author		Stewart Hall (www.stewartghall.com)
+ * @date		10/18/2026
+ * @copyright	Copyright 2013, Stewart Hall
+ * @license		MIT License (http://www.opensource.org/licenses/mit-license.php)
+ */
+
+#include <sstream>
+#include <iomanip>
+
+#include "AttributeChannel.h"
+#include "CommonDefs.h"
+
+//Constructor
+AttributeChannel::AttributeChannel(const char *iname, attribute_semantic isemantic, attribute_binding ibinding, int inum_components, MemoryArena *iarena)
+:name(iname), values(ArenaAllocator<float>(iarena))
+{
+	semantic = isemantic;
+	binding = ibinding;
+	num_components = inum_components;
+}
+
+//Destructor
+AttributeChannel::~AttributeChannel()
+{
+
+}
+
+//Get the name
+const char *AttributeChannel::getName()
+{
+	return name.c_str();
+}
+
+//Get the semantic
+attribute_semantic AttributeChannel::getSemantic()
+{
+	return semantic;
+}
+
+//Get the binding
+attribute_binding AttributeChannel::getBinding()
+{
+	return binding;
+}
+
+//Get the number of components
+int AttributeChannel::getNumComponents()
+{
+	return num_components;
+}
+
+//Get the number of elements
+int AttributeChannel::getNumElements()
+{
+	return values.size() / num_components;
+}
+
+//Get an element
+float *AttributeChannel::getValue(int index)
+{
+	return &values[index * num_components];
+}
+
+//Change the number of elements
+void AttributeChannel::resize(int count)
+{
+	values.resize(count * num_components, 0.0f);
+}
+
+//Average elements into one
+void AttributeChannel::average(int index, const int *sources, int count)
+{
+	float sum[ATTRIBUTE_MAX_COMPONENTS] = {0.0f, 0.0f, 0.0f, 0.0f};
+	float scale = 1.0f / (float)count;
+
+	for(int i = 0; i < count; i++) {
+		const float *source = &values[sources[i] * num_components];
+		for(int j = 0; j < num_components; j++)
+			sum[j] += source[j];
+	}
+
+	float *dest = &values[index * num_components];
+	for(int j = 0; j < num_components; j++)
+		dest[j] = sum[j] * scale;
+}
+
+//Remove elements
+void AttributeChannel::compact(const int *remap)
+{
+	int num_elements = getNumElements();
+	int kept = 0;
+
+	for(int i = 0; i < num_elements; i++) {
+		if(remap[i] == -1)
+			continue;
+
+		for(int j = 0; j < num_components; j++)
+			values[remap[i] * num_components + j] = values[i * num_components + j];
+		kept++;
+	}
+
+	values.resize(kept * num_components);
+}
+
+//Save to a source node
+void AttributeChannel::save(pugi::xml_node root, const std::string &id)
+{
+	static const char *param_names[3][ATTRIBUTE_MAX_COMPONENTS] = {
+		{"X", "Y", "Z", "W"},
+		{"R", "G", "B", "A"},
+		{"S", "T", "P", "Q"}
+	};
+
+	int count = getNumElements();
+
+	pugi::xml_node source_node = root.append_child("source");
+	source_node.append_attribute("id") = id.c_str();
+
+	std::string array_id = id + "-array";
+	pugi::xml_node array_node = source_node.append_child("float_array");
+	array_node.append_attribute("id") = array_id.c_str();
+	array_node.append_attribute("count") = count * num_components;
+
+	//Create indentation for newlines
+	char indent[20];
+	int depth = array_node.depth() - 2;
+	int idx;
+	for(idx = 0; idx < depth; idx++)
+		indent[idx] = '\t';
+	indent[idx] = '\0';
+
+	//One element per line
+	std::ostringstream value_stream;
+	value_stream << std::setiosflags(std::ios::showpoint) << std::endl << indent;
+	for(int i = 0; i < count; i++) {
+		for(int j = 0; j < num_components; j++) {
+			value_stream << DEC_FORMAT << values[i * num_components + j];
+			if(j != num_components - 1)
+				value_stream << " ";
+		}
+
+		value_stream << std::endl << indent;
+	}
+
+	std::string value_string = value_stream.str();
+	array_node.text() = value_string.c_str();
+
+	//Add the technique node
+	pugi::xml_node technique_node = source_node.append_child("technique_common");
+	pugi::xml_node accessor_node = technique_node.append_child("accessor");
+	accessor_node.append_attribute("source") = (std::string("#") + array_id).c_str();
+	accessor_node.append_attribute("count") = count;
+	accessor_node.append_attribute("stride") = num_components;
+
+	for(int j = 0; j < num_components; j++) {
+		pugi::xml_node param = accessor_node.append_child("param");
+		param.append_attribute("name") = param_names[semantic][j];
+		param.append_attribute("type") = "float";
+	}
+}
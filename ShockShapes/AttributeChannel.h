@@ -0,0 +1,147 @@
+/** @file AttributeChannel.h
+ *
+ * @brief Defines extra per vertex or per corner data stored with a mesh
+ *
+ * Copyright 2013, Stewart Hall
+ *
+ * Licensed under The MIT License
+ * Redistributions of files must retain the above copyright notice.
+ *
+ * @author		Stewart Hall (www.stewartghall.com)
+ * @date		10/18/2026
+ * @copyright	Copyright 2013, Stewart Hall
+ * @license		MIT License (http://www.opensource.org/licenses/mit-license.php)
+ */
+
+#ifndef _ATTRIBUTECHANNEL_
+#define _ATTRIBUTECHANNEL_
+
+#include <string>
+#include <vector>
+
+#include "pugixml.hpp"
+#include "MemoryArena.h"
+
+/**
+ * Most floats a single element of a channel can hold
+ */
+#define ATTRIBUTE_MAX_COMPONENTS 4
+
+/**
+ * @brief Meaning of the data in a channel, used to name it when saving
+ */
+enum attribute_semantic {
+	AS_TANGENT,		/**< Tangent xyz and the sign of the bitangent in w, saved as TEXTANGENT. */
+	AS_COLOR,		/**< Vertex color, saved as COLOR. */
+	AS_TEXCOORD		/**< Extra texture coordinate set, saved as TEXCOORD after the mesh's own set. */
+};
+
+/**
+ * @brief What each element of a channel belongs to
+ */
+enum attribute_binding {
+	AB_VERTEX,		/**< One element per vertex, indexed like the vertex buffer. */
+	AB_CORNER		/**< One element per triangle corner, corner k of triangle t at 3 * t + k. */
+};
+
+/**
+ * @brief Float storage for channels. Allocated from the owning scene's arena if there is one.
+ */
+typedef std::vector<float, ArenaAllocator<float> > FloatBuffer;
+
+/**
+ * @brief A named array of fixed size float elements stored with a mesh
+ * @details Elements are stored contiguously, num_components floats each.
+ * The owning geometry keeps the channel sized to its vertices or triangle
+ * corners, zero filling elements for vertices and triangles added after the
+ * channel, and carries the channel through subdivision, combining, clean up
+ * and saving.
+ */
+class AttributeChannel {
+private:
+	std::string name;				/**< Name of the channel, unique within a mesh. */
+	attribute_semantic semantic;	/**< Meaning of the data. */
+	attribute_binding binding;		/**< What each element belongs to. */
+	int num_components;				/**< Floats in each element. */
+	FloatBuffer values;				/**< Elements stored one after another. */
+
+public:
+	/**
+	 * Constructs an empty channel
+	 * @param iname Name of the channel
+	 * @param isemantic Meaning of the data
+	 * @param ibinding What each element belongs to
+	 * @param inum_components Floats in each element, from 1 to ATTRIBUTE_MAX_COMPONENTS
+	 * @param iarena Arena to allocate from or NULL for the heap
+	 */
+	AttributeChannel(const char *iname, attribute_semantic isemantic, attribute_binding ibinding, int inum_components, MemoryArena *iarena);
+
+	~AttributeChannel();	/**< Destructor. */
+
+	/**
+	 * Gets the name of the channel
+	 * @return The name
+	 */
+	const char *getName();
+
+	/**
+	 * Gets the meaning of the data
+	 * @return The semantic
+	 */
+	attribute_semantic getSemantic();
+
+	/**
+	 * Gets what each element belongs to
+	 * @return The binding
+	 */
+	attribute_binding getBinding();
+
+	/**
+	 * Gets the number of floats in each element
+	 * @return The number of components
+	 */
+	int getNumComponents();
+
+	/**
+	 * Gets the number of elements
+	 * @return The number of elements
+	 */
+	int getNumElements();
+
+	/**
+	 * Gets an element
+	 * @param index Index of the element
+	 * @return Pointer to the element's first component
+	 */
+	float *getValue(int index);
+
+	/**
+	 * Changes the number of elements, zero filling new ones
+	 * @param count New number of elements
+	 */
+	void resize(int count);
+
+	/**
+	 * Sets an element to the average of other elements
+	 * @param index Index of the element to set. May be one of the sources
+	 * @param sources Indices of the elements to average
+	 * @param count Number of sources
+	 */
+	void average(int index, const int *sources, int count);
+
+	/**
+	 * Removes elements, moving the rest down
+	 * @param remap New index of each element, or -1 to remove it. Kept
+	 * elements must keep their order
+	 */
+	void compact(const int *remap);
+
+	/**
+	 * Saves the elements to a COLLADA source node
+	 * @param root Mesh node to add the source node to
+	 * @param id Id of the source node
+	 */
+	void save(pugi::xml_node root, const std::string &id);
+};
+
+#endif
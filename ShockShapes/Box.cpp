@@ -0,0 +1,151 @@
+/** @file Box.cpp
+ *
+ * @brief Generates rectangular prisms with evenly divided faces
+ *
+ * Copyright 2013, Stewart Hall
+ *
+ * Licensed under The MIT License
+ * Redistributions of files must retain the above copyright notice.
+ *
+ * @author		Stewart Hall (www.stewartghall.com)
+ * @date		10/18/2026
+ * @copyright	Copyright 2013, Stewart Hall
+ * @license		MIT License (http://www.opensource.org/licenses/mit-license.php)
+ */
+
+#include "Box.h"
+
+/**
+ * For each face, the outward axis and its sign, then the axes that columns
+ * and rows run along with their signs. Right crossed with up points out.
+ */
+static const int box_faces[6][6] = {
+	{0, 1, 2, -1, 1, 1},		//+X: right is -Z, up is +Y
+	{0, -1, 2, 1, 1, 1},		//-X: right is +Z, up is +Y
+	{1, 1, 0, 1, 2, -1},		//+Y: right is +X, up is -Z
+	{1, -1, 0, 1, 2, 1},		//-Y: right is +X, up is +Z
+	{2, 1, 0, 1, 1, 1},			//+Z: right is +X, up is +Y
+	{2, -1, 0, -1, 1, 1}		//-Z: right is -X, up is +Y
+};
+
+//Default constructor
+Box::Box()
+:Primitive("Box")
+{
+	for(int i = 0; i < 3; i++) {
+		size[i] = 1.0f;
+		segments[i] = 1;
+	}
+}
+
+//Sized constructor
+Box::Box(float x, float y, float z, int x_segs, int y_segs, int z_segs)
+:Primitive("Box")
+{
+	size[0] = x;
+	size[1] = y;
+	size[2] = z;
+	segments[0] = x_segs < 1 ? 1 : x_segs;
+	segments[1] = y_segs < 1 ? 1 : y_segs;
+	segments[2] = z_segs < 1 ? 1 : z_segs;
+}
+
+//Destructor
+Box::~Box()
+{
+
+}
+
+//A box has a patch per face
+int Box::getNumPatches()
+{
+	return 6;
+}
+
+//Describe a face
+void Box::getPatch(int patch, PrimitivePatch *desc)
+{
+	desc->columns = segments[box_faces[patch][2]];
+	desc->rows = segments[box_faces[patch][4]];
+	desc->flags = PF_FLAT;
+}
+
+//Count the lattice points on the surface
+int Box::getNumPositions()
+{
+	int cap = (segments[0] + 1) * (segments[2] + 1);
+	int ring = 2 * (segments[0] + segments[2]);
+
+	return 2 * cap + (segments[1] - 1) * ring;
+}
+
+//Vertices are stored by layer along Y. The bottom and top layers are full
+//grids and the layers between are rings around the sides.
+int Box::getLatticeIndex(int i, int j, int k)
+{
+	int xs = segments[0];
+	int ys = segments[1];
+	int zs = segments[2];
+	int cap = (xs + 1) * (zs + 1);
+	int ring = 2 * (xs + zs);
+
+	if(j == 0)
+		return i + k * (xs + 1);
+	if(j == ys)
+		return cap + (ys - 1) * ring + i + k * (xs + 1);
+
+	//Walk the ring counterclockwise from the corner at the smallest X and Z
+	int base = cap + (j - 1) * ring;
+	if(k == 0 && i < xs)
+		return base + i;
+	if(i == xs && k < zs)
+		return base + xs + k;
+	if(k == zs && i > 0)
+		return base + xs + zs + (xs - i);
+	return base + 2 * xs + zs + (zs - k);
+}
+
+//Find where a grid point of a face is on the lattice
+void Box::getLatticePoint(int patch, int row, int column, int *lattice)
+{
+	const int *face = box_faces[patch];
+
+	lattice[face[0]] = face[1] > 0 ? segments[face[0]] : 0;
+	lattice[face[2]] = face[3] > 0 ? column : segments[face[2]] - column;
+	lattice[face[4]] = face[5] > 0 ? row : segments[face[4]] - row;
+}
+
+//Find the vertex of a grid point
+int Box::getVertexIndex(int patch, int row, int column)
+{
+	int lattice[3];
+	getLatticePoint(patch, row, column, lattice);
+
+	return getLatticeIndex(lattice[0], lattice[1], lattice[2]);
+}
+
+//Evaluate a grid point. Positions only depend on the lattice point, so faces
+//meeting at an edge agree exactly.
+void Box::evaluate(int patch, int row, int column, Vector3D *position, Vector3D *normal, Vector2D *uv)
+{
+	const int *face = box_faces[patch];
+	int lattice[3];
+	float p[3];
+	float n[3] = {0.0f, 0.0f, 0.0f};
+
+	getLatticePoint(patch, row, column, lattice);
+	for(int i = 0; i < 3; i++)
+		p[i] = ((float)lattice[i] / (float)segments[i] - 0.5f) * size[i];
+	n[face[0]] = (float)face[1];
+
+	position->x = p[0];
+	position->y = p[1];
+	position->z = p[2];
+
+	normal->x = n[0];
+	normal->y = n[1];
+	normal->z = n[2];
+
+	uv->u = (float)column / (float)segments[face[2]];
+	uv->v = (float)row / (float)segments[face[4]];
+}
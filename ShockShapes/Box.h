@@ -0,0 +1,109 @@
+/** @file Box.h
+ *
+ * @brief Generates rectangular prisms with evenly divided faces
+ *
+ * Copyright 2013, Stewart Hall
+ *
+ * Licensed under The MIT License
+ * Redistributions of files must retain the above copyright notice.
+ *
+ * @author		Stewart Hall (www.stewartghall.com)
+ * @date		10/18/2026
+ * @copyright	Copyright 2013, Stewart Hall
+ * @license		MIT License (http://www.opensource.org/licenses/mit-license.php)
+ */
+
+#ifndef _BOX_
+#define _BOX_
+
+#include "Primitive.h"
+
+/**
+ * @brief Generates a rectangular prism centered at the origin with a grid on
+ * each face
+ * @details Faces share the vertices along their edges, so the box is closed,
+ * while each face has its own flat normal. Unlike a subdivided Cube, each
+ * axis can have its own number of segments.
+ */
+class Box : public Primitive {
+private:
+	float size[3];					/**< Dimensions along X, Y and Z. */
+	int segments[3];				/**< Number of cells along X, Y and Z. */
+
+	/**
+	 * Finds the vertex at a point of the surface lattice
+	 * @param i Lattice coordinate along X, from 0 to the X segments
+	 * @param j Lattice coordinate along Y, from 0 to the Y segments
+	 * @param k Lattice coordinate along Z, from 0 to the Z segments
+	 * @return Index of the vertex
+	 */
+	int getLatticeIndex(int i, int j, int k);
+
+	/**
+	 * Finds the lattice point of a grid point on a face
+	 * @param patch Index of the face
+	 * @param row Row of the grid point
+	 * @param column Column of the grid point
+	 * @param lattice Receives the lattice coordinates
+	 */
+	void getLatticePoint(int patch, int row, int column, int *lattice);
+
+protected:
+	/**
+	 * Gets the number of patches
+	 * @return 6, one for each face
+	 */
+	virtual int getNumPatches();
+
+	/**
+	 * Describes a face, with columns running right and rows running up as
+	 * seen from outside
+	 * @param patch Index of the face
+	 * @param desc Receives the size of the face
+	 */
+	virtual void getPatch(int patch, PrimitivePatch *desc);
+
+	/**
+	 * Gets the number of vertices
+	 * @return One per point of the lattice on the surface
+	 */
+	virtual int getNumPositions();
+
+	/**
+	 * Finds the vertex of a grid point
+	 * @param patch Index of the face
+	 * @param row Row of the grid point
+	 * @param column Column of the grid point
+	 * @return Index of the vertex
+	 */
+	virtual int getVertexIndex(int patch, int row, int column);
+
+	/**
+	 * Evaluates a face at a grid point
+	 * @param patch Index of the face
+	 * @param row Row of the grid point
+	 * @param column Column of the grid point
+	 * @param position Receives the position
+	 * @param normal Receives the unit normal
+	 * @param uv Receives the texture coordinate
+	 */
+	virtual void evaluate(int patch, int row, int column, Vector3D *position, Vector3D *normal, Vector2D *uv);
+
+public:
+	Box();							/**< Default constructor makes a unit cube of one cell per face. */
+
+	/**
+	 * Makes a box with the specified size and resolution
+	 * @param x Size along the X axis
+	 * @param y Size along the Y axis
+	 * @param z Size along the Z axis
+	 * @param x_segs Number of cells along the X axis
+	 * @param y_segs Number of cells along the Y axis
+	 * @param z_segs Number of cells along the Z axis
+	 */
+	Box(float x, float y, float z, int x_segs, int y_segs, int z_segs);
+
+	~Box();							/**< Destructor. */
+};
+
+#endif
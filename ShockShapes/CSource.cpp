@@ -19,18 +19,36 @@
 #include <string>
 
 #include "CSource.h"
+#include "NumberParse.h"
+#include "Quantize.h"
 
 CSource::CSource()
 {
+	type = ST_FLOAT;
 	params = NULL;
 	data_buffer = NULL;
+	buffer_size = 0;
+	stride = 0;
+	count = 0;
+	offset = 0;
+
+	for(int i = 0; i < PT_INVALID; i++)
+		param_offsets[i] = -1;
 }
 
 //Construct from COLLADA
 CSource::CSource(pugi::xml_node root)
 {
+	type = ST_FLOAT;
 	params = NULL;
 	data_buffer = NULL;
+	buffer_size = 0;
+	stride = 0;
+	count = 0;
+	offset = 0;
+
+	for(int i = 0; i < PT_INVALID; i++)
+		param_offsets[i] = -1;
 
 	//Read the id attribute
 	id = root.attribute("id").value();
@@ -51,14 +69,18 @@ CSource::CSource(pugi::xml_node root)
 		if(technique_node.child("accessor")) {
 			pugi::xml_node accessor_node = technique_node.child("accessor");
 
-			//Get count and stride
+			//Get count, stride and offset
 			count = atoi(accessor_node.attribute("count").value());
-			stride = atoi(accessor_node.attribute("stride").value());
+			stride = accessor_node.attribute("stride") ? atoi(accessor_node.attribute("stride").value()) : 1;
+			offset = atoi(accessor_node.attribute("offset").value());
 
-			//Read each parameter
+			//Read each parameter. Unnamed parameters are skipped.
 			params = new param_type[stride];
-			int index = 0;
-			for(pugi::xml_node param = accessor_node.first_child(); param; param = param.next_sibling()) {
+			for(unsigned int i = 0; i < stride; i++)
+				params[i] = PT_INVALID;
+
+			unsigned int index = 0;
+			for(pugi::xml_node param = accessor_node.child("param"); param && index < stride; param = param.next_sibling("param")) {
 				const char *param_name = param.attribute("name").value();
 
 				if(!strcmp(param_name, "A")) {
@@ -97,10 +119,35 @@ CSource::CSource(pugi::xml_node root)
 					params[index] = PT_Z;
 				}
 
+				//Resolve the offset of each parameter once
+				if(params[index] != PT_INVALID && param_offsets[params[index]] < 0)
+					param_offsets[params[index]] = index;
+
 				index++;
 			}
 		}
 	}
+
+	//Integer data written by a quantized export is decoded to floats
+	if(type == ST_INT) {
+		for(pugi::xml_node technique_node = root.child("technique"); technique_node; technique_node = technique_node.next_sibling("technique")) {
+			if(!strcmp(technique_node.attribute("profile").value(), "ShockShapes") && technique_node.child("quantization")) {
+				decodeQuantized(technique_node.child("quantization"));
+				break;
+			}
+		}
+	}
+}
+
+//Destructor
+CSource::~CSource()
+{
+	if(type == ST_INT)
+		delete[] (int*)data_buffer;
+	else
+		delete[] (float*)data_buffer;
+
+	delete[] params;
 }
 
 //Read a float array
@@ -112,12 +159,8 @@ void CSource::readFloatArray(pugi::xml_node root)
 	buffer_size = atoi(root.attribute("count").value());
 	buffer = new float[buffer_size];
 
-	//Read each float from the array
-	std::string text = root.text().get();
-	std::istringstream iss(text);
-	for(unsigned int i = 0; i < buffer_size; i++) {
-		iss >> buffer[i];
-	}
+	//Read each float straight from the document text
+	parseFloatArray(root.text().get(), buffer, buffer_size);
 
 	data_buffer = (void*)buffer;
 
@@ -133,18 +176,87 @@ void CSource::readIntArray(pugi::xml_node root)
 	buffer_size = atoi(root.attribute("count").value());
 	buffer = new int[buffer_size];
 
-	//Read each float from the array
-	std::string text = root.text().get();
-	std::istringstream iss(text);
-	for(unsigned int i = 0; i < buffer_size; i++) {
-		iss >> buffer[i];
-	}
+	//Read each integer straight from the document text
+	parseIntArray(root.text().get(), buffer, buffer_size);
 
 	data_buffer = (void*)buffer;
 
 	return;
 }
 
+//Decode quantized integers
+void CSource::decodeQuantized(pugi::xml_node quant_node)
+{
+	const char *encoding = quant_node.attribute("encoding").value();
+	const int *values = (const int*)data_buffer;
+	if(!values || !params || stride == 0)
+		return;
+
+	//Only decode elements that are completely present
+	unsigned int elements = buffer_size > offset ? (buffer_size - offset) / stride : 0;
+	if(elements > count)
+		elements = count;
+
+	float *decoded;
+	unsigned int decoded_stride;
+	if(!strcmp(encoding, "octahedral_snorm16")) {
+		int x = param_offsets[PT_X];
+		int y = param_offsets[PT_Y];
+		if(x < 0 || y < 0)
+			return;
+
+		decoded_stride = 3;
+		decoded = new float[elements * decoded_stride];
+		for(unsigned int i = 0; i < elements; i++) {
+			const int *element = values + offset + i * stride;
+			Vector3D n = octDecode((short)element[x], (short)element[y]);
+			decoded[i * 3] = n.x;
+			decoded[i * 3 + 1] = n.y;
+			decoded[i * 3 + 2] = n.z;
+		}
+
+		//The two stored components become a full vector
+		delete[] params;
+		params = new param_type[decoded_stride];
+		params[0] = PT_X;
+		params[1] = PT_Y;
+		params[2] = PT_Z;
+		for(int i = 0; i < PT_INVALID; i++)
+			param_offsets[i] = -1;
+		param_offsets[PT_X] = 0;
+		param_offsets[PT_Y] = 1;
+		param_offsets[PT_Z] = 2;
+	} else if(!strcmp(encoding, "unorm16")) {
+		//Each component is offset + value * scale
+		float *offsets = new float[stride];
+		float *scales = new float[stride];
+		parseFloatArray(quant_node.attribute("offset").value(), offsets, stride);
+		parseFloatArray(quant_node.attribute("scale").value(), scales, stride);
+
+		decoded_stride = stride;
+		decoded = new float[elements * decoded_stride];
+		for(unsigned int i = 0; i < elements; i++) {
+			const int *element = values + offset + i * stride;
+			for(unsigned int c = 0; c < stride; c++)
+				decoded[i * stride + c] = offsets[c] + (float)element[c] * scales[c];
+		}
+
+		delete[] offsets;
+		delete[] scales;
+	} else {
+		return;
+	}
+
+	//Continue as a tightly packed float source
+	delete[] (int*)data_buffer;
+	data_buffer = (void*)decoded;
+	buffer_size = elements * decoded_stride;
+	type = ST_FLOAT;
+	stride = decoded_stride;
+	count = elements;
+	offset = 0;
+}
+
 //Returns the id
 const char* CSource::getId()
 {
@@ -178,21 +290,39 @@ int CSource::getInt(unsigned int index)
 //Getter for a param
 float CSource::accessFloatParameter(unsigned int element, param_type param_id)
 {
-	if(type == ST_FLOAT) {
-		//Can only be used if a technique_common node was processed
-		if(params) {
-			if(element < count) {
-				for(unsigned int i = 0; i < stride; i++) {
-					if(params[i] == param_id)
-						return ((float*)data_buffer)[element * stride + i];
-				}
-			}
-		}
-	}
+	FloatView view = getFloatView(param_id);
+
+	if(view.data && element < view.count)
+		return view.data[element * view.stride];
 
 	return 0.0f;
 }
 
+//Get a view of a parameter
+FloatView CSource::getFloatView(param_type param_id)
+{
+	FloatView view;
+	view.data = NULL;
+	view.stride = stride;
+	view.count = 0;
+
+	//Can only be used if a technique_common node was processed
+	if(type != ST_FLOAT || !data_buffer || param_id >= PT_INVALID || param_offsets[param_id] < 0)
+		return view;
+
+	unsigned int first = offset + param_offsets[param_id];
+	if(first >= buffer_size)
+		return view;
+
+	//Clamp the count to the elements actually present in the array
+	view.data = (float*)data_buffer + first;
+	view.count = count;
+	if(stride > 0 && (buffer_size - first + stride - 1) / stride < count)
+		view.count = (buffer_size - first + stride - 1) / stride;
+
+	return view;
+}
+
 //Return the number of parameters
 int CSource::getNumParameters()
 {
@@ -202,7 +332,7 @@ int CSource::getNumParameters()
 //Return the type of parameter
 param_type CSource::getParamType(unsigned int index)
 {
-	if(index < stride)
+	if(params && index < stride)
 		return params[index];
 
 	return PT_INVALID;
@@ -54,6 +54,17 @@ enum param_type {
 	PT_INVALID
 };
 
+/**
+ * @brief Strided read only view of one parameter of every element in a float source
+ * @details Element i is data[i * stride]. The view points into the source's
+ * buffer and is valid as long as the source is.
+ */
+typedef struct {
+	const float *data;		/**< Value of the parameter in the first element or NULL if the source has no such parameter. */
+	unsigned int stride;	/**< Distance in floats between the values of consecutive elements. */
+	unsigned int count;		/**< Number of elements in the view. */
+} FloatView;
+
 /**
  * @brief Loads and stores data from COLLADA source nodes
  * @details Stores an array of the data and provides accessors
@@ -83,6 +94,13 @@ private:
 	param_type *params;
 	unsigned int stride;
 	unsigned int count;
+	unsigned int offset;
+
+	/**
+	 * Offset of each parameter type within an element or -1 if not present.
+	 * Resolved once when the accessor is read.
+	 */
+	int param_offsets[PT_INVALID];
 
 	/**
 	 * Reads a float array
@@ -96,10 +114,23 @@ private:
 	 */
 	void readIntArray(pugi::xml_node root);
 
+	/**
+	 * Replaces integer data saved by a quantized export with the decoded
+	 * floats. Octahedral normals are expanded to X, Y and Z. Unknown
+	 * encodings leave the source as integers
+	 * @param quant_node The quantization node of the ShockShapes technique
+	 */
+	void decodeQuantized(pugi::xml_node quant_node);
+
+	CSource(const CSource &c);				/**< Sources own their buffers and cannot be copied. */
+	CSource &operator=(const CSource &c);	/**< Sources own their buffers and cannot be copied. */
+
 public:
 	CSource();								/**< Constructs an empty source. */
 	CSource(pugi::xml_node root);			/**< Constructs a source from COLLADA data. */
 
+	~CSource();								/**< Destructor. Frees the data buffer and params. */
+
 	const char* getId();					/**< Returns the id attribute in C string format. */
 
 	source_type getType();					/**< Returns the type of source. */
@@ -115,6 +146,13 @@ public:
 	 */
 	float accessFloatParameter(unsigned int element, param_type param_id);
 
+	/**
+	 * Returns a view of one parameter across all elements
+	 * @param param_id The parameter to view
+	 * @return View of the parameter. The data pointer is NULL if the source is not a float source or lacks the parameter
+	 */
+	FloatView getFloatView(param_type param_id);
+
 	/**
 	 * Returns the number of parameters per element
 	 * @return Number of parameters
@@ -34,21 +34,14 @@ CSourceLib::~CSourceLib()
 //Add a new source to the collection
 void CSourceLib::addSource(pugi::xml_node root)
 {
-	sources.push_back(new CSource(root));
+	CSource *source = new CSource(root);
+
+	sources.push_back(source);
+	index.add(source->getId(), source);
 }
 
 //Get a source by name
 CSource* CSourceLib::getSource(const char *name)
 {
-	//Remove # if present
-	if(name[0] == '#')
-		name = &(name[1]);
-
-	for(unsigned int i = 0; i < sources.size(); i++)
-	{
-		if(!strcmp(sources[i]->getId(), name))
-			return sources[i];
-	}
-
-	return NULL;
+	return index.find(name);
 }
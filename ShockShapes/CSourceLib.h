@@ -22,6 +22,7 @@
 
 #include "pugixml.hpp"
 #include "CSource.h"
+#include "IdIndex.h"
 
 /**
  * @brief Holds multiple CSource objects
@@ -33,6 +34,11 @@ private:
 	 */
 	std::vector<CSource*> sources;
 
+	/**
+	 * Sources keyed by id for constant time lookup
+	 */
+	IdIndex<CSource> index;
+
 public:
 	CSourceLib();
 	~CSourceLib();
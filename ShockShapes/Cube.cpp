@@ -38,6 +38,12 @@ Cube::Cube(float x, float y, float z)
 	h = y;
 }
 
+//Destructor
+Cube::~Cube()
+{
+
+}
+
 //Generates the object's mesh
 void Cube::generate(int seed, Scene *scene)
 {
@@ -72,6 +78,20 @@ void Cube::generate(int seed, Scene *scene)
 	v.x = hl;
 	addVertex(v);
 
+	//Create a texture coordinate for each corner of a face
+	Vector2D uv;
+	uv.u = 0.0f; uv.v = 0.0f;
+	addUV(uv);
+
+	uv.u = 1.0f;
+	addUV(uv);
+
+	uv.v = 1.0f;
+	addUV(uv);
+
+	uv.u = 0.0f;
+	addUV(uv);
+
 	//Create a two triangles for each face
 	//Top
 	v.x = 0.0f; v.y = 1.0f; v.z = 0.0f;
@@ -79,10 +99,8 @@ void Cube::generate(int seed, Scene *scene)
 	t1.normals[0] = t1.normals[1] = t1.normals[2] = 0;
 	t2.normals[0] = t2.normals[1] = t2.normals[2] = 0;
 
-	t1.uvs[0].u = t1.uvs[0].v = t1.uvs[1].v = 1.0f;
-	t1.uvs[1].u = t1.uvs[2].u = t1.uvs[2].v = 0.0f;
-	t2.uvs[0].u = t2.uvs[0].v = t2.uvs[1].v = 0.0f;
-	t2.uvs[1].u = t2.uvs[2].u = t2.uvs[2].v = 1.0f;
+	t1.uvs[0] = 2; t1.uvs[1] = 3; t1.uvs[2] = 0;
+	t2.uvs[0] = 0; t2.uvs[1] = 1; t2.uvs[2] = 2;
 
 	t1.vertices[0] = 2; t1.vertices[1] = 1; t1.vertices[2] = 0;
 	addTriangle(t1);
@@ -0,0 +1,135 @@
+/** @file CullingVolume.cpp
+ *
+ * @brief Defines volumes used to skip objects outside a region when saving or combining
+ *
+ * Copyright 2013, Stewart Hall
+ *
+ * Licensed under The MIT License
+ * Redistributions of files must retain the above copyright notice.
+ *
+ * @author		Stewart Hall (www.stewartghall.com)
+ * @date		10/18/2026
+ * @copyright	Copyright 2013, Stewart Hall
+ * @license		MIT License (http://www.opensource.org/licenses/mit-license.php)
+ */
+
+#include "CullingVolume.h"
+
+//Constructor
+CullingVolume::CullingVolume()
+{
+	num_planes = 0;
+}
+
+//Destructor
+CullingVolume::~CullingVolume()
+{
+
+}
+
+//Set the volume to a box
+void CullingVolume::setBox(Vector3D min, Vector3D max)
+{
+	const float mins[3] = {min.x, min.y, min.z};
+	const float maxs[3] = {max.x, max.y, max.z};
+
+	//One plane facing inwards from each side
+	num_planes = 6;
+	for(int axis = 0; axis < 3; axis++) {
+		float *low = planes[axis * 2];
+		float *high = planes[axis * 2 + 1];
+		for(int i = 0; i < 3; i++) {
+			low[i] = (i == axis) ? 1.0f : 0.0f;
+			high[i] = (i == axis) ? -1.0f : 0.0f;
+		}
+
+		low[3] = -mins[axis];
+		high[3] = maxs[axis];
+	}
+}
+
+//Set the volume to a camera frustum
+void CullingVolume::setFrustum(Matrix *view_projection)
+{
+	const float *rows[3] = {view_projection->r0, view_projection->r1, view_projection->r2};
+	const float *w = view_projection->r3;
+
+	//-w <= x, y, z <= w gives w + row >= 0 and w - row >= 0 for each row
+	num_planes = 6;
+	for(int axis = 0; axis < 3; axis++) {
+		for(int i = 0; i < 4; i++) {
+			planes[axis * 2][i] = w[i] + rows[axis][i];
+			planes[axis * 2 + 1][i] = w[i] - rows[axis][i];
+		}
+	}
+}
+
+//Test a box against the volume
+bool CullingVolume::intersects(const BoundingBox *box)
+{
+	if(box->min.x > box->max.x || box->min.y > box->max.y || box->min.z > box->max.z)
+		return false;
+
+	//The box is outside if its corner furthest along a plane's normal is behind it
+	for(int i = 0; i < num_planes; i++) {
+		const float *p = planes[i];
+		float x = p[0] >= 0.0f ? box->max.x : box->min.x;
+		float y = p[1] >= 0.0f ? box->max.y : box->min.y;
+		float z = p[2] >= 0.0f ? box->max.z : box->min.z;
+		if(p[0] * x + p[1] * y + p[2] * z + p[3] < 0.0f)
+			return false;
+	}
+
+	return true;
+}
+
+//Make an empty box
+void CullingVolume::emptyBounds(BoundingBox *box)
+{
+	box->min.x = box->min.y = box->min.z = 1e30f;
+	box->max.x = box->max.y = box->max.z = -1e30f;
+}
+
+//Grow a box to contain another
+void CullingVolume::expandBounds(BoundingBox *box, const BoundingBox *other)
+{
+	box->min.x = other->min.x < box->min.x ? other->min.x : box->min.x;
+	box->min.y = other->min.y < box->min.y ? other->min.y : box->min.y;
+	box->min.z = other->min.z < box->min.z ? other->min.z : box->min.z;
+	box->max.x = other->max.x > box->max.x ? other->max.x : box->max.x;
+	box->max.y = other->max.y > box->max.y ? other->max.y : box->max.y;
+	box->max.z = other->max.z > box->max.z ? other->max.z : box->max.z;
+}
+
+//Bound a transformed box
+void CullingVolume::transformBounds(Matrix *m, const BoundingBox *in, BoundingBox *out)
+{
+	if(in->min.x > in->max.x || in->min.y > in->max.y || in->min.z > in->max.z) {
+		emptyBounds(out);
+		return;
+	}
+
+	const float mins[3] = {in->min.x, in->min.y, in->min.z};
+	const float maxs[3] = {in->max.x, in->max.y, in->max.z};
+	const float *rows[3] = {m->r0, m->r1, m->r2};
+	float result_min[3];
+	float result_max[3];
+
+	//Each output axis is smallest and largest where each term is
+	for(int i = 0; i < 3; i++) {
+		result_min[i] = result_max[i] = rows[i][3];
+		for(int j = 0; j < 3; j++) {
+			float a = rows[i][j] * mins[j];
+			float b = rows[i][j] * maxs[j];
+			result_min[i] += a < b ? a : b;
+			result_max[i] += a < b ? b : a;
+		}
+	}
+
+	out->min.x = result_min[0];
+	out->min.y = result_min[1];
+	out->min.z = result_min[2];
+	out->max.x = result_max[0];
+	out->max.y = result_max[1];
+	out->max.z = result_max[2];
+}
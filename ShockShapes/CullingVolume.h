@@ -0,0 +1,96 @@
+/** @file CullingVolume.h
+ *
+ * @brief Defines volumes used to skip objects outside a region when saving or combining
+ *
+ * Copyright 2013, Stewart Hall
+ *
+ * Licensed under The MIT License
+ * Redistributions of files must retain the above copyright notice.
+ *
+ * @author		Stewart Hall (www.stewartghall.com)
+ * @date		10/18/2026
+ * @copyright	Copyright 2013, Stewart Hall
+ * @license		MIT License (http://www.opensource.org/licenses/mit-license.php)
+ */
+
+#ifndef _CULLINGVOLUME_
+#define _CULLINGVOLUME_
+
+#include "CommonDefs.h"
+#include "Transform.h"
+
+/**
+ * Most planes a culling volume can have
+ */
+#define CULL_MAX_PLANES 6
+
+/**
+ * @brief Axis aligned bounding box. Empty when min is greater than max on any axis
+ */
+typedef struct {
+	Vector3D min;
+	Vector3D max;
+} BoundingBox;
+
+/**
+ * @brief Convex region bounded by planes, such as a camera frustum or a box
+ * @details Tests are conservative: a box that is outside the volume but
+ * straddles the extensions of two of its planes may still be reported as
+ * intersecting, so culled objects are always outside but not every object
+ * outside is culled.
+ */
+class CullingVolume {
+private:
+	float planes[CULL_MAX_PLANES][4];	/**< Planes (a, b, c, d) with a * x + b * y + c * z + d >= 0 inside. */
+	int num_planes;						/**< Number of planes in use. */
+
+public:
+	CullingVolume();		/**< Constructs a volume containing everything. */
+
+	~CullingVolume();		/**< Destructor. */
+
+	/**
+	 * Sets the volume to an axis aligned box
+	 * @param min Corner of the box with the smallest coordinates
+	 * @param max Corner of the box with the largest coordinates
+	 */
+	void setBox(Vector3D min, Vector3D max);
+
+	/**
+	 * Sets the volume to the view frustum of a camera
+	 * @param view_projection Matrix taking world space points to clip space,
+	 * where points inside have x, y and z between -w and w
+	 */
+	void setFrustum(Matrix *view_projection);
+
+	/**
+	 * Checks whether a box might be inside the volume
+	 * @param box The box to test
+	 * @return False if the box is empty or entirely outside the volume
+	 */
+	bool intersects(const BoundingBox *box);
+
+	/**
+	 * Makes an empty bounding box
+	 * @param box The box to empty
+	 */
+	static void emptyBounds(BoundingBox *box);
+
+	/**
+	 * Grows a bounding box to contain another
+	 * @param box The box to grow
+	 * @param other The box to contain
+	 */
+	static void expandBounds(BoundingBox *box, const BoundingBox *other);
+
+	/**
+	 * Finds the axis aligned box around a transformed box, treating the
+	 * matrix as affine
+	 * @param m The transform
+	 * @param in The box to transform
+	 * @param out Receives the bounds of the transformed box. May be in
+	 */
+	static void transformBounds(Matrix *m, const BoundingBox *in, BoundingBox *out);
+};
+
+#endif
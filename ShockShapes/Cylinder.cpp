@@ -0,0 +1,141 @@
+/** @file Cylinder.cpp
+ *
+ * @brief Generates capped cylinders
+ *
+ * Copyright 2013, Stewart Hall
+ *
+ * Licensed under The MIT License
+ * Redistributions of files must retain the above copyright notice.
+ *
+ * @author		Stewart Hall (www.stewartghall.com)
+ * @date		10/18/2026
+ * @copyright	Copyright 2013, Stewart Hall
+ * @license		MIT License (http://www.opensource.org/licenses/mit-license.php)
+ */
+
+#include <math.h>
+
+#include "Cylinder.h"
+
+//Default constructor
+Cylinder::Cylinder()
+:Primitive("Cylinder")
+{
+	radius = 0.5f;
+	height = 1.0f;
+	segments = 32;
+	height_segments = 1;
+	cap_rings = 1;
+}
+
+//Sized constructor
+Cylinder::Cylinder(float r, float h, int segs, int h_segs, int c_rings)
+:Primitive("Cylinder")
+{
+	radius = r;
+	height = h;
+	segments = segs < 3 ? 3 : segs;
+	height_segments = h_segs < 1 ? 1 : h_segs;
+	cap_rings = c_rings < 1 ? 1 : c_rings;
+}
+
+//Destructor
+Cylinder::~Cylinder()
+{
+
+}
+
+//The side and two caps
+int Cylinder::getNumPatches()
+{
+	return 3;
+}
+
+//Describe a patch
+void Cylinder::getPatch(int patch, PrimitivePatch *desc)
+{
+	desc->columns = segments;
+	if(patch == 0) {
+		desc->rows = height_segments;
+		desc->flags = PF_WRAP_COLUMNS;
+	} else {
+		desc->rows = cap_rings;
+		desc->flags = PF_FLAT | PF_COLLAPSE_FIRST | PF_WRAP_COLUMNS;
+	}
+}
+
+//Count the side rings and the inside of the caps
+int Cylinder::getNumPositions()
+{
+	int cap = 1 + (cap_rings - 1) * segments;
+
+	return (height_segments + 1) * segments + 2 * cap;
+}
+
+//The top cap runs the other way around so it faces up
+int Cylinder::getSideColumn(int patch, int column)
+{
+	column %= segments;
+	if(patch == 1)
+		return (segments - column) % segments;
+
+	return column;
+}
+
+//Side rings come first from bottom to top, then the top and bottom caps
+//from the center out. The outer ring of a cap is a ring of the side.
+int Cylinder::getVertexIndex(int patch, int row, int column)
+{
+	int side_column = getSideColumn(patch, column);
+	if(patch == 0)
+		return row * segments + side_column;
+
+	if(row == cap_rings)
+		return (patch == 1 ? height_segments * segments : 0) + side_column;
+
+	int cap_start = (height_segments + 1) * segments + (patch - 1) * (1 + (cap_rings - 1) * segments);
+	if(row == 0)
+		return cap_start;
+
+	return cap_start + 1 + (row - 1) * segments + side_column;
+}
+
+//Evaluate a grid point
+void Cylinder::evaluate(int patch, int row, int column, Vector3D *position, Vector3D *normal, Vector2D *uv)
+{
+	//Angles come from the side's columns so the rims match the side exactly
+	float angle = 2.0f * PI * (float)getSideColumn(patch, column) / (float)segments;
+	float c = cosf(angle);
+	float s = sinf(angle);
+
+	if(patch == 0) {
+		uv->u = (float)column / (float)segments;
+		uv->v = (float)row / (float)height_segments;
+
+		position->x = radius * c;
+		position->y = (uv->v - 0.5f) * height;
+		position->z = -radius * s;
+
+		normal->x = c;
+		normal->y = 0.0f;
+		normal->z = -s;
+		return;
+	}
+
+	float ring_radius = radius * (float)row / (float)cap_rings;
+	float side = patch == 1 ? 1.0f : -1.0f;
+
+	position->x = ring_radius * c;
+	position->y = 0.5f * side * height;
+	position->z = -ring_radius * s;
+
+	normal->x = 0.0f;
+	normal->y = side;
+	normal->z = 0.0f;
+
+	//Project the cap straight down onto the texture, flipped on the bottom so
+	//neither is mirrored
+	float scale = 0.5f / radius;
+	uv->u = 0.5f + position->x * scale;
+	uv->v = 0.5f - side * position->z * scale;
+}
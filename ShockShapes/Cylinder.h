@@ -0,0 +1,100 @@
+/** @file Cylinder.h
+ *
+ * @brief Generates capped cylinders
+ *
+ * Copyright 2013, Stewart Hall
+ *
+ * Licensed under The MIT License
+ * Redistributions of files must retain the above copyright notice.
+ *
+ * @author		Stewart Hall (www.stewartghall.com)
+ * @date		10/18/2026
+ * @copyright	Copyright 2013, Stewart Hall
+ * @license		MIT License (http://www.opensource.org/licenses/mit-license.php)
+ */
+
+#ifndef _CYLINDER_
+#define _CYLINDER_
+
+#include "Primitive.h"
+
+/**
+ * @brief Generates a cylinder along the Y axis centered at the origin
+ * @details The side has smooth normals and each cap is a flat disc of rings.
+ * The caps share the vertices around their rims with the side.
+ */
+class Cylinder : public Primitive {
+private:
+	float radius;					/**< Radius of the cylinder. */
+	float height;					/**< Length along the Y axis. */
+	int segments;					/**< Number of cells around the cylinder. */
+	int height_segments;			/**< Number of cells along the side. */
+	int cap_rings;					/**< Number of rings of cells from the center of a cap to its rim. */
+
+	/**
+	 * Finds the column of the side that a column of a patch lines up with
+	 * @param patch Index of the patch
+	 * @param column Column of the patch
+	 * @return Column of the side from 0 to segments - 1
+	 */
+	int getSideColumn(int patch, int column);
+
+protected:
+	/**
+	 * Gets the number of patches
+	 * @return 3, for the side, top and bottom
+	 */
+	virtual int getNumPatches();
+
+	/**
+	 * Describes the side, with columns running around and rows running up,
+	 * or a cap, with rows running out from the center
+	 * @param patch Index of the patch
+	 * @param desc Receives the size of the patch
+	 */
+	virtual void getPatch(int patch, PrimitivePatch *desc);
+
+	/**
+	 * Gets the number of vertices
+	 * @return One per ring point on the side, plus each cap's center and
+	 * inner rings
+	 */
+	virtual int getNumPositions();
+
+	/**
+	 * Finds the vertex of a grid point
+	 * @param patch Index of the patch
+	 * @param row Row of the grid point
+	 * @param column Column of the grid point
+	 * @return Index of the vertex
+	 */
+	virtual int getVertexIndex(int patch, int row, int column);
+
+	/**
+	 * Evaluates the side or a cap at a grid point
+	 * @param patch Index of the patch
+	 * @param row Row of the grid point
+	 * @param column Column of the grid point
+	 * @param position Receives the position
+	 * @param normal Receives the unit normal
+	 * @param uv Receives the texture coordinate
+	 */
+	virtual void evaluate(int patch, int row, int column, Vector3D *position, Vector3D *normal, Vector2D *uv);
+
+public:
+	Cylinder();						/**< Default constructor makes a cylinder of radius 0.5 and height 1 with 32 segments. */
+
+	/**
+	 * Makes a cylinder with the specified size and resolution
+	 * @param r Radius of the cylinder
+	 * @param h Length along the Y axis
+	 * @param segs Number of cells around the cylinder. At least 3
+	 * @param h_segs Number of cells along the side
+	 * @param c_rings Number of rings of cells on each cap
+	 */
+	Cylinder(float r, float h, int segs, int h_segs, int c_rings);
+
+	~Cylinder();					/**< Destructor. */
+};
+
+#endif
@@ -0,0 +1,329 @@
+/** @file DetailBaker.cpp
+ *
+ * @brief Bakes the surface detail of a dense mesh into a texture over a coarse mesh
+ *
+ * Copyright 2013, Stewart Hall
+ *
+ * Licensed under The MIT License
+ * Redistributions of files must retain the above copyright notice.
+ *
+ * @author		Stewart Hall (www.stewartghall.com)
+ * @date		10/18/2026
+ * @copyright	Copyright 2013, Stewart Hall
+ * @license		MIT License (http://www.opensource.org/licenses/mit-license.php)
+ */
+
+#include <math.h>
+
+#include "DetailBaker.h"
+
+//Texel centers this far outside a triangle still count as inside, closing gaps between neighbors
+#define BAKE_EDGE_TOLERANCE 1e-5f
+
+//Dot product of two vectors
+static float dotProduct(const Vector3D &a, const Vector3D &b)
+{
+	return a.x * b.x + a.y * b.y + a.z * b.z;
+}
+
+//Scale a vector to unit length, leaving zero vectors alone
+static void normalize(Vector3D *v)
+{
+	float length = sqrtf(dotProduct(*v, *v));
+	if(length > 0.0f) {
+		v->x /= length;
+		v->y /= length;
+		v->z /= length;
+	}
+}
+
+//Map a value from -1 to 1 onto a byte
+static unsigned char encodeSigned(float value)
+{
+	int encoded = (int)((value * 0.5f + 0.5f) * 255.0f + 0.5f);
+	return (unsigned char)(encoded < 0 ? 0 : (encoded > 255 ? 255 : encoded));
+}
+
+//Constructor
+DetailBaker::DetailBaker(Geometry *ilow, Geometry *ihigh, int iwidth, int iheight, float imax_distance)
+{
+	low = ilow;
+	high = ihigh;
+	width = iwidth;
+	height = iheight;
+	max_distance = imax_distance;
+}
+
+//Destructor
+DetailBaker::~DetailBaker()
+{
+
+}
+
+//Fill per triangle data and bin triangles by tile
+void DetailBaker::prepare()
+{
+	int num_triangles = low->getNumTriangles();
+	int tiles_x = (width + BAKE_TILE_SIZE - 1) / BAKE_TILE_SIZE;
+	int tiles_y = (height + BAKE_TILE_SIZE - 1) / BAKE_TILE_SIZE;
+
+	faces.resize(num_triangles);
+	bins.clear();
+	bins.resize(tiles_x * tiles_y);
+
+	for(int i = 0; i < num_triangles; i++) {
+		Triangle *tri = low->getTriangle(i);
+		BakeTriangle *face = &(faces[i]);
+
+		//Texel space has v running down the image
+		for(int k = 0; k < 3; k++) {
+			Vector2D *uv = low->getUV(tri->uvs[k]);
+			face->uv[k][0] = uv->u * (float)width;
+			face->uv[k][1] = (1.0f - uv->v) * (float)height;
+		}
+
+		float du1 = face->uv[1][0] - face->uv[0][0];
+		float dv1 = face->uv[1][1] - face->uv[0][1];
+		float du2 = face->uv[2][0] - face->uv[0][0];
+		float dv2 = face->uv[2][1] - face->uv[0][1];
+		float area = du1 * dv2 - du2 * dv1;
+		face->inv_area = fabsf(area) > 1e-12f ? 1.0f / area : 0.0f;
+		if(face->inv_area == 0.0f)
+			continue;
+
+		//Surface directions of increasing u and v, back in texture space
+		Vector3D *p0 = low->getVertex(tri->vertices[0]);
+		Vector3D *p1 = low->getVertex(tri->vertices[1]);
+		Vector3D *p2 = low->getVertex(tri->vertices[2]);
+		Vector3D e1 = {p1->x - p0->x, p1->y - p0->y, p1->z - p0->z};
+		Vector3D e2 = {p2->x - p0->x, p2->y - p0->y, p2->z - p0->z};
+		float su1 = du1 / (float)width, sv1 = -dv1 / (float)height;
+		float su2 = du2 / (float)width, sv2 = -dv2 / (float)height;
+		float r = 1.0f / (su1 * sv2 - su2 * sv1);
+
+		face->tangent.x = (e1.x * sv2 - e2.x * sv1) * r;
+		face->tangent.y = (e1.y * sv2 - e2.y * sv1) * r;
+		face->tangent.z = (e1.z * sv2 - e2.z * sv1) * r;
+		face->bitangent.x = (e2.x * su1 - e1.x * su2) * r;
+		face->bitangent.y = (e2.y * su1 - e1.y * su2) * r;
+		face->bitangent.z = (e2.z * su1 - e1.z * su2) * r;
+
+		//Add the triangle to every tile its UV bounds overlap
+		float min_u = face->uv[0][0], max_u = face->uv[0][0];
+		float min_v = face->uv[0][1], max_v = face->uv[0][1];
+		for(int k = 1; k < 3; k++) {
+			min_u = face->uv[k][0] < min_u ? face->uv[k][0] : min_u;
+			max_u = face->uv[k][0] > max_u ? face->uv[k][0] : max_u;
+			min_v = face->uv[k][1] < min_v ? face->uv[k][1] : min_v;
+			max_v = face->uv[k][1] > max_v ? face->uv[k][1] : max_v;
+		}
+
+		if(max_u < 0.0f || max_v < 0.0f || min_u > (float)width || min_v > (float)height)
+			continue;
+
+		int first_x = min_u > 0.0f ? (int)min_u / BAKE_TILE_SIZE : 0;
+		int first_y = min_v > 0.0f ? (int)min_v / BAKE_TILE_SIZE : 0;
+		int last_x = max_u < (float)width ? (int)max_u / BAKE_TILE_SIZE : tiles_x - 1;
+		int last_y = max_v < (float)height ? (int)max_v / BAKE_TILE_SIZE : tiles_y - 1;
+		for(int y = first_y; y <= last_y; y++) {
+			for(int x = first_x; x <= last_x; x++)
+				bins[y * tiles_x + x].push_back(i);
+		}
+	}
+}
+
+//Find the value of one texel
+void DetailBaker::bakeTexel(int tri, const float *b, bake_map map, unsigned char *out)
+{
+	Triangle *t = low->getTriangle(tri);
+	BakeTriangle *face = &(faces[tri]);
+
+	//Interpolate the coarse surface
+	Vector3D position = {0.0f, 0.0f, 0.0f};
+	Vector3D normal = {0.0f, 0.0f, 0.0f};
+	for(int k = 0; k < 3; k++) {
+		Vector3D *p = low->getVertex(t->vertices[k]);
+		Vector3D *n = low->getNormal(t->normals[k]);
+		position.x += p->x * b[k];
+		position.y += p->y * b[k];
+		position.z += p->z * b[k];
+		normal.x += n->x * b[k];
+		normal.y += n->y * b[k];
+		normal.z += n->z * b[k];
+	}
+	normalize(&normal);
+
+	BVHHit hit;
+	bool found = bvh.findClosestAlong(position, normal, max_distance, &hit);
+
+	if(map == BK_DISPLACEMENT) {
+		out[0] = encodeSigned(found ? hit.t / max_distance : 0.0f);
+		return;
+	}
+
+	if(!found) {
+		out[0] = out[1] = 128;
+		out[2] = 255;
+		return;
+	}
+
+	//Normal of the dense surface at the hit
+	Triangle *high_tri = high->getTriangle(hit.triangle);
+	float w[3] = {1.0f - hit.u - hit.v, hit.u, hit.v};
+	Vector3D detail = {0.0f, 0.0f, 0.0f};
+	if(high->getNumNormals()) {
+		for(int k = 0; k < 3; k++) {
+			Vector3D *n = high->getNormal(high_tri->normals[k]);
+			detail.x += n->x * w[k];
+			detail.y += n->y * w[k];
+			detail.z += n->z * w[k];
+		}
+	} else {
+		Vector3D *p0 = high->getVertex(high_tri->vertices[0]);
+		Vector3D *p1 = high->getVertex(high_tri->vertices[1]);
+		Vector3D *p2 = high->getVertex(high_tri->vertices[2]);
+		Vector3D e1 = {p1->x - p0->x, p1->y - p0->y, p1->z - p0->z};
+		Vector3D e2 = {p2->x - p0->x, p2->y - p0->y, p2->z - p0->z};
+		detail.x = e1.y * e2.z - e1.z * e2.y;
+		detail.y = e1.z * e2.x - e1.x * e2.z;
+		detail.z = e1.x * e2.y - e1.y * e2.x;
+	}
+	normalize(&detail);
+
+	//Tangent frame orthogonal to the interpolated normal
+	Vector3D tangent = face->tangent;
+	float along = dotProduct(tangent, normal);
+	tangent.x -= normal.x * along;
+	tangent.y -= normal.y * along;
+	tangent.z -= normal.z * along;
+	normalize(&tangent);
+
+	Vector3D bitangent;
+	bitangent.x = normal.y * tangent.z - normal.z * tangent.y;
+	bitangent.y = normal.z * tangent.x - normal.x * tangent.z;
+	bitangent.z = normal.x * tangent.y - normal.y * tangent.x;
+	if(dotProduct(bitangent, face->bitangent) < 0.0f) {
+		bitangent.x = -bitangent.x;
+		bitangent.y = -bitangent.y;
+		bitangent.z = -bitangent.z;
+	}
+
+	out[0] = encodeSigned(dotProduct(detail, tangent));
+	out[1] = encodeSigned(dotProduct(detail, bitangent));
+	out[2] = encodeSigned(dotProduct(detail, normal));
+}
+
+//Bake one tile
+void DetailBaker::bakeTile(int tile_x, int tile_y, bake_map map, unsigned char *pixels)
+{
+	int channels = map == BK_NORMAL ? 3 : 1;
+	int tiles_x = (width + BAKE_TILE_SIZE - 1) / BAKE_TILE_SIZE;
+
+	int first_x = tile_x * BAKE_TILE_SIZE;
+	int first_y = tile_y * BAKE_TILE_SIZE;
+	int end_x = first_x + BAKE_TILE_SIZE < width ? first_x + BAKE_TILE_SIZE : width;
+	int end_y = first_y + BAKE_TILE_SIZE < height ? first_y + BAKE_TILE_SIZE : height;
+
+	//Start flat and track which texels a triangle has claimed
+	bool covered[BAKE_TILE_SIZE * BAKE_TILE_SIZE];
+	for(int y = first_y; y < end_y; y++) {
+		unsigned char *out = pixels + ((size_t)(y - first_y) * width + first_x) * channels;
+		for(int x = first_x; x < end_x; x++) {
+			if(map == BK_NORMAL) {
+				*out++ = 128;
+				*out++ = 128;
+				*out++ = 255;
+			} else {
+				*out++ = 128;
+			}
+			covered[(y - first_y) * BAKE_TILE_SIZE + x - first_x] = false;
+		}
+	}
+
+	std::vector<int> &bin = bins[tile_y * tiles_x + tile_x];
+	for(unsigned int i = 0; i < bin.size(); i++) {
+		BakeTriangle *face = &(faces[bin[i]]);
+
+		//Texels whose centers fall inside the triangle's bounds
+		float min_u = face->uv[0][0], max_u = face->uv[0][0];
+		float min_v = face->uv[0][1], max_v = face->uv[0][1];
+		for(int k = 1; k < 3; k++) {
+			min_u = face->uv[k][0] < min_u ? face->uv[k][0] : min_u;
+			max_u = face->uv[k][0] > max_u ? face->uv[k][0] : max_u;
+			min_v = face->uv[k][1] < min_v ? face->uv[k][1] : min_v;
+			max_v = face->uv[k][1] > max_v ? face->uv[k][1] : max_v;
+		}
+
+		int x0 = (int)floorf(min_u - 0.5f), x1 = (int)ceilf(max_u - 0.5f);
+		int y0 = (int)floorf(min_v - 0.5f), y1 = (int)ceilf(max_v - 0.5f);
+		x0 = x0 > first_x ? x0 : first_x;
+		y0 = y0 > first_y ? y0 : first_y;
+		x1 = x1 < end_x - 1 ? x1 : end_x - 1;
+		y1 = y1 < end_y - 1 ? y1 : end_y - 1;
+
+		for(int y = y0; y <= y1; y++) {
+			float cy = (float)y + 0.5f;
+			for(int x = x0; x <= x1; x++) {
+				int local = (y - first_y) * BAKE_TILE_SIZE + x - first_x;
+				if(covered[local])
+					continue;
+
+				//Barycentric weights from the signed areas opposite each corner
+				float cx = (float)x + 0.5f;
+				float b[3];
+				for(int k = 0; k < 3; k++) {
+					const float *p = face->uv[(k + 1) % 3];
+					const float *q = face->uv[(k + 2) % 3];
+					b[k] = ((q[0] - p[0]) * (cy - p[1]) - (q[1] - p[1]) * (cx - p[0])) * face->inv_area;
+				}
+
+				if(b[0] < -BAKE_EDGE_TOLERANCE || b[1] < -BAKE_EDGE_TOLERANCE || b[2] < -BAKE_EDGE_TOLERANCE)
+					continue;
+
+				covered[local] = true;
+				bakeTexel(bin[i], b, map, pixels + ((size_t)(y - first_y) * width + x) * channels);
+			}
+		}
+	}
+}
+
+//Bake a map to a file
+int DetailBaker::bake(const char *filename, bake_map map, image_format format)
+{
+	if(!low || !high || width <= 0 || height <= 0 || max_distance <= 0.0f)
+		return 1;
+
+	if(low->getNumTriangles() && (!low->getNumNormals() || !low->getNumUVs()))
+		return 1;
+
+	int channels = map == BK_NORMAL ? 3 : 1;
+
+	ImageWriter writer;
+	if(writer.open(filename, format, width, height, channels))
+		return 1;
+
+	bvh.build(high);
+	prepare();
+
+	//Only one row of tiles is held in memory
+	unsigned char *pixels = new unsigned char[(size_t)width * BAKE_TILE_SIZE * channels];
+	int tiles_x = (width + BAKE_TILE_SIZE - 1) / BAKE_TILE_SIZE;
+	int tiles_y = (height + BAKE_TILE_SIZE - 1) / BAKE_TILE_SIZE;
+	int error = 0;
+
+	for(int tile_y = 0; tile_y < tiles_y && !error; tile_y++) {
+		#pragma omp parallel for schedule(dynamic)
+		for(int tile_x = 0; tile_x < tiles_x; tile_x++)
+			bakeTile(tile_x, tile_y, map, pixels);
+
+		int rows = height - tile_y * BAKE_TILE_SIZE;
+		error = writer.writeRows(pixels, rows < BAKE_TILE_SIZE ? rows : BAKE_TILE_SIZE);
+	}
+
+	delete[] pixels;
+
+	if(writer.close())
+		error = 1;
+
+	return error;
+}
@@ -0,0 +1,124 @@
+/** @file DetailBaker.h
+ *
+ * @brief Bakes the surface detail of a dense mesh into a texture over a coarse mesh
+ *
+ * Copyright 2013, Stewart Hall
+ *
+ * Licensed under The MIT License
+ * Redistributions of files must retain the above copyright notice.
+ *
+ * @author		Stewart Hall (www.stewartghall.com)
+ * @date		10/18/2026
+ * @copyright	Copyright 2013, Stewart Hall
+ * @license		MIT License (http://www.opensource.org/licenses/mit-license.php)
+ */
+
+#ifndef _DETAILBAKER_
+#define _DETAILBAKER_
+
+#include <vector>
+
+#include "CommonDefs.h"
+#include "Geometry.h"
+#include "ImageWriter.h"
+#include "TriangleBVH.h"
+
+/**
+ * Width and height in texels of the tiles baked in parallel. Baking holds
+ * one row of tiles in memory at a time.
+ */
+#define BAKE_TILE_SIZE 64
+
+/**
+ * @brief Kinds of map a baker can write
+ */
+enum bake_map {
+	BK_NORMAL,			/**< RGB tangent space normals, with (128, 128, 255) pointing straight out of the surface. */
+	BK_DISPLACEMENT		/**< Gray signed distance along the normal, with 128 meaning no displacement. */
+};
+
+/**
+ * @brief Per triangle data of the coarse mesh used while baking
+ */
+typedef struct {
+	float uv[3][2];			/**< Texture coordinates of the corners. */
+	float inv_area;			/**< Inverse of twice the signed UV area, or 0 if the triangle has no UV area. */
+	Vector3D tangent;		/**< Direction of increasing u on the surface. */
+	Vector3D bitangent;		/**< Direction of increasing v on the surface. */
+} BakeTriangle;
+
+/**
+ * @brief Transfers the detail of a dense mesh to a texture over a coarse one
+ * @details Typically the coarse mesh is a shape with little or no
+ * subdivision and the dense mesh is the same shape with more subdivision and
+ * bump filters applied, so the coarse mesh plus the baked map can stand in
+ * for the dense mesh. Both meshes must be generated and filtered, in the
+ * same local space, and the coarse mesh must have normals and
+ * non-overlapping UVs in [0, 1]; where UVs overlap the lowest numbered
+ * triangle wins. Each texel covered by the coarse mesh's UV layout looks for
+ * the dense surface along the coarse normal, both outwards and inwards,
+ * using a bounding volume hierarchy over the dense mesh. The dense mesh's
+ * normals are used at the hit, so run a NormalFilter on it first for
+ * smooth results. Texels the layout does not cover, or that find no
+ * surface within the search distance, are left flat. The image is baked
+ * one row of tiles at a time with the tiles of a row on multiple threads.
+ */
+class DetailBaker {
+private:
+	Geometry *low;						/**< Coarse mesh whose UV layout is baked. */
+	Geometry *high;						/**< Dense mesh providing the detail. */
+	int width;							/**< Width in texels. */
+	int height;							/**< Height in texels. */
+	float max_distance;					/**< Largest distance from the coarse surface to search. */
+	TriangleBVH bvh;					/**< Hierarchy over the dense mesh. */
+	std::vector<BakeTriangle> faces;	/**< Per triangle data of the coarse mesh. */
+	std::vector<std::vector<int> > bins;	/**< Coarse triangles overlapping each tile, in index order. */
+
+	/**
+	 * Fills the per triangle data and tile bins of the coarse mesh
+	 */
+	void prepare();
+
+	/**
+	 * Bakes one tile into a row of tiles
+	 * @param tile_x Index of the tile within the row
+	 * @param tile_y Index of the tile row
+	 * @param map Kind of map being baked
+	 * @param pixels Samples for the whole tile row
+	 */
+	void bakeTile(int tile_x, int tile_y, bake_map map, unsigned char *pixels);
+
+	/**
+	 * Finds the value of one texel
+	 * @param tri Coarse triangle covering the texel
+	 * @param b Barycentric weights of the texel center in the triangle
+	 * @param map Kind of map being baked
+	 * @param out Samples of the texel
+	 */
+	void bakeTexel(int tri, const float *b, bake_map map, unsigned char *out);
+
+public:
+	/**
+	 * Constructs a baker
+	 * @param ilow Coarse mesh whose UV layout is baked
+	 * @param ihigh Dense mesh providing the detail
+	 * @param iwidth Width in texels
+	 * @param iheight Height in texels
+	 * @param imax_distance Largest distance from the coarse surface to search.
+	 * Displacement maps use the full range of gray for this distance either way
+	 */
+	DetailBaker(Geometry *ilow, Geometry *ihigh, int iwidth, int iheight, float imax_distance);
+
+	~DetailBaker();		/**< Destructor. */
+
+	/**
+	 * Bakes a map and writes it to a file
+	 * @param filename Name of the file
+	 * @param map Kind of map to bake
+	 * @param format Format of the file
+	 * @return Returns 0 if no errors occur
+	 */
+	int bake(const char *filename, bake_map map, image_format format);
+};
+
+#endif
@@ -57,7 +57,7 @@ void GBumpFilter::run(Geometry *g)
 	if(perturb_once) {
 		//Set up list to keep track of which vertices have been perturbed
 		int num_vertices = g->getNumVertices();
-		int *visited = new int[num_vertices];
+		ScratchArray<int> visited(g->getScratchArena(), num_vertices);
 		for(int i = 0; i < num_vertices; i++)
 			visited[i] = 0;
 
@@ -109,8 +109,6 @@ void GBumpFilter::run(Geometry *g)
 				}
 			}
 		}
-
-		delete[] visited;
 	} else {
 		//Iterate through each triangle and perturb vertices
 		int num_triangles = g->getNumTriangles();
@@ -149,3 +147,9 @@ void GBumpFilter::run(Geometry *g)
 
 	return;
 }
+
+//Only reads normals
+int GBumpFilter::getNormalUsage()
+{
+	return FN_READS;
+}
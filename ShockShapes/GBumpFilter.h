@@ -62,6 +62,12 @@ public:
 	 * @param g The object to apply the filter to
 	 */
 	virtual void run(Geometry *g);
+
+	/**
+	 * Describes how the filter uses normals
+	 * @return FN_READS
+	 */
+	virtual int getNormalUsage();
 };
 
 #endif
@@ -13,17 +13,48 @@
  * @license		MIT License (http://www.opensource.org/licenses/mit-license.php)
  */
 
+#include <string.h>
+
 #include "Geometry.h"
 #include "CSourceLib.h"
+#include "NumberParse.h"
+#include "Triangulate.h"
+#include "ProceduralTexture.h"
+#include "HashMap.h"
 
 int current_id = 0; /**< Incrementing number used for unique IDs. */
 
+//Key identifying a texture coordinate by its exact value
+static unsigned long long uvKey(Vector2D uv)
+{
+	//Adding 0 turns -0 into 0 so both merge
+	float u = uv.u + 0.0f;
+	float v = uv.v + 0.0f;
+	unsigned int u_bits, v_bits;
+	memcpy(&u_bits, &u, sizeof(u_bits));
+	memcpy(&v_bits, &v, sizeof(v_bits));
+
+	return ((unsigned long long)u_bits << 32) | v_bits;
+}
+
 //Geometry constructor creates empty mesh
 Geometry::Geometry()
-:vertices(), vbuffer_references(), normals(), nbuffer_references(), triangles(), name("Geometry"), unique_id(""), t(), filters()
+:vertices(), vbuffer_references(), normals(), nbuffer_references(), uvs(), uvbuffer_references(), triangles(), name("Geometry"), unique_id(""), t(), filters()
 {
+	arena = NULL;
 	id = current_id++;
 	visible = true;
+	meshlets = NULL;
+	topology = NULL;
+	texture = NULL;
+	topology_valid = false;
+	references_valid = true;
+	bounds_valid = false;
+	referenced = false;
+	quantized = false;
+	quantization_error.position_error = 0.0f;
+	quantization_error.normal_error = 0.0f;
+	quantization_error.uv_error = 0.0f;
 
 	//Build the unique id for this object
 	std::ostringstream unique_id_stream;
@@ -33,10 +64,50 @@ Geometry::Geometry()
 
 //Geometry constructor with different name
 Geometry::Geometry(const char *iname)
-:vertices(), vbuffer_references(), normals(), nbuffer_references(), triangles(), name(iname), unique_id(""), t(), filters()
+:vertices(), vbuffer_references(), normals(), nbuffer_references(), uvs(), uvbuffer_references(), triangles(), name(iname), unique_id(""), t(), filters()
+{
+	arena = NULL;
+	id = current_id++;
+	visible = true;
+	meshlets = NULL;
+	topology = NULL;
+	texture = NULL;
+	topology_valid = false;
+	references_valid = true;
+	bounds_valid = false;
+	referenced = false;
+	quantized = false;
+	quantization_error.position_error = 0.0f;
+	quantization_error.normal_error = 0.0f;
+	quantization_error.uv_error = 0.0f;
+
+	//Build the unique id for this object
+	std::ostringstream unique_id_stream;
+	unique_id_stream << name << id;
+	unique_id = unique_id_stream.str();
+}
+
+//Geometry constructor allocating from an arena
+Geometry::Geometry(const char *iname, MemoryArena *iarena)
+:vertices(ArenaAllocator<Vector3D>(iarena)), vbuffer_references(ArenaAllocator<int>(iarena)),
+normals(ArenaAllocator<Vector3D>(iarena)), nbuffer_references(ArenaAllocator<int>(iarena)),
+uvs(ArenaAllocator<Vector2D>(iarena)), uvbuffer_references(ArenaAllocator<int>(iarena)),
+triangles(ArenaAllocator<Triangle>(iarena)), name(iname), unique_id(""), t(), filters()
 {
+	arena = iarena;
 	id = current_id++;
 	visible = true;
+	meshlets = NULL;
+	topology = NULL;
+	texture = NULL;
+	topology_valid = false;
+	references_valid = true;
+	bounds_valid = false;
+	referenced = false;
+	quantized = false;
+	quantization_error.position_error = 0.0f;
+	quantization_error.normal_error = 0.0f;
+	quantization_error.uv_error = 0.0f;
 
 	//Build the unique id for this object
 	std::ostringstream unique_id_stream;
@@ -47,7 +118,64 @@ Geometry::Geometry(const char *iname)
 //Destructor
 Geometry::~Geometry()
 {
-	
+	delete meshlets;
+	delete topology;
+
+	for(unsigned int i = 0; i < channels.size(); i++)
+		delete channels[i];
+}
+
+//Heap allocation
+void *Geometry::operator new(size_t size)
+{
+	return ::operator new(size);
+}
+
+//Arena allocation
+void *Geometry::operator new(size_t size, MemoryArena *iarena)
+{
+	if(iarena)
+		return iarena->allocate(size);
+
+	return ::operator new(size);
+}
+
+//Heap deallocation
+void Geometry::operator delete(void *p)
+{
+	::operator delete(p);
+}
+
+//Arena deallocation when a constructor throws
+void Geometry::operator delete(void *p, MemoryArena *iarena)
+{
+	if(!iarena)
+		::operator delete(p);
+}
+
+//Destroy an object from the heap or an arena
+void Geometry::destroy(Geometry *g)
+{
+	if(!g)
+		return;
+
+	//Arena memory is reclaimed when the arena is reset
+	if(g->arena)
+		g->~Geometry();
+	else
+		delete g;
+}
+
+//Get the arena
+MemoryArena *Geometry::getArena()
+{
+	return arena;
+}
+
+//Get the scratch arena
+MemoryArena *Geometry::getScratchArena()
+{
+	return arena ? arena->getScratch() : NULL;
 }
 
 //Get the id
@@ -68,6 +196,10 @@ int Geometry::addVertex(Vector3D v)
 	int index = vertices.size();
 	vertices.push_back(v);
 	vbuffer_references.push_back(0);
+	bounds_valid = false;
+
+	if(!channels.empty())
+		resizeChannels(AB_VERTEX, vertices.size());
 
 	return index;
 }
@@ -82,11 +214,29 @@ int Geometry::addNormal(Vector3D n)
 	return index;
 }
 
+//Adds a texture coordinate to the buffer
+int Geometry::addUV(Vector2D uv)
+{
+	int index = uvs.size();
+	uvs.push_back(uv);
+	uvbuffer_references.push_back(0);
+
+	return index;
+}
+
 //Add a triangle to the buffer
 int Geometry::addTriangle(Triangle t)
 {
 	int index = triangles.size();
 	triangles.push_back(t);
+	topology_valid = false;
+
+	if(!channels.empty())
+		resizeChannels(AB_CORNER, triangles.size() * 3);
+
+	//Counts are rebuilt in one pass while the triangles are being edited
+	if(!references_valid)
+		return index;
 
 	//Update the vertex reference counts
 	vbuffer_references[t.vertices[0]]++;
@@ -98,12 +248,123 @@ int Geometry::addTriangle(Triangle t)
 	nbuffer_references[t.normals[1]]++;
 	nbuffer_references[t.normals[2]]++;
 
+	//Update the texture coordinate reference counts
+	uvbuffer_references[t.uvs[0]]++;
+	uvbuffer_references[t.uvs[1]]++;
+	uvbuffer_references[t.uvs[2]]++;
+
 	return index;
 }
 
+//Get the connectivity of the mesh
+MeshTopology *Geometry::getTopology()
+{
+	if(!topology)
+		topology = new MeshTopology();
+
+	if(!topology_valid) {
+		topology->build(this);
+		topology_valid = true;
+	}
+
+	return topology;
+}
+
+//Calculate the unit normal of each triangle
+void Geometry::getFaceNormals(Vector3D *face_normals)
+{
+	Triangle *current;
+	Vector3D *v1;
+	Vector3D *v2;
+	Vector3D *v3;
+	Vector3D edge1, edge2;
+	Vector3D normal;
+	float magnitude;
+
+	int num_triangles = getNumTriangles();
+	for(int i = 0; i < num_triangles; i++) {
+		current = getTriangle(i);
+		v1 = getVertex(current->vertices[0]);
+		v2 = getVertex(current->vertices[1]);
+		v3 = getVertex(current->vertices[2]);
+
+		//Calculate edge vectors of the triangle
+		edge1.x = v2->x - v1->x;
+		edge1.y = v2->y - v1->y;
+		edge1.z = v2->z - v1->z;
+
+		edge2.x = v3->x - v1->x;
+		edge2.y = v3->y - v1->y;
+		edge2.z = v3->z - v1->z;
+
+		//Calculate normal from cross product
+		normal.x = edge1.y * edge2.z - edge1.z * edge2.y;
+		normal.y = edge1.z * edge2.x - edge1.x * edge2.z;
+		normal.z = edge1.x * edge2.y - edge1.y * edge2.x;
+
+		//Degenerate triangles get a zero normal
+		magnitude = sqrtf(normal.x * normal.x + normal.y * normal.y + normal.z * normal.z);
+		magnitude = magnitude > 0.0f ? 1.0f / magnitude : 0.0f;
+		normal.x *= magnitude;
+		normal.y *= magnitude;
+		normal.z *= magnitude;
+
+		face_normals[i] = normal;
+	}
+}
+
+//Reserve space for more triangles
+void Geometry::reserveTriangles(int count)
+{
+	if(count <= 0)
+		return;
+
+	//Grow geometrically so many small reservations stay linear
+	size_t needed = triangles.size() + count;
+	if(needed > triangles.capacity())
+		triangles.reserve(needed > triangles.capacity() * 2 ? needed : triangles.capacity() * 2);
+}
+
+//Size the buffers for a generator that fills them in place
+void Geometry::resizeBuffers(int num_vertices, int num_normals, int num_uvs, int num_triangles)
+{
+	Vector3D zero = {0.0f, 0.0f, 0.0f};
+	Vector2D zero_uv = {0.0f, 0.0f};
+	Triangle empty = {{0, 0, 0}, {0, 0, 0}, {0, 0, 0}};
+
+	vertices.resize(num_vertices, zero);
+	vbuffer_references.resize(num_vertices, 0);
+	normals.resize(num_normals, zero);
+	nbuffer_references.resize(num_normals, 0);
+	uvs.resize(num_uvs, zero_uv);
+	uvbuffer_references.resize(num_uvs, 0);
+	triangles.resize(num_triangles, empty);
+
+	if(!channels.empty()) {
+		resizeChannels(AB_VERTEX, num_vertices);
+		resizeChannels(AB_CORNER, num_triangles * 3);
+	}
+
+	//The triangles are about to be written directly
+	references_valid = false;
+	topology_valid = false;
+	bounds_valid = false;
+}
+
 //Sets a triangle
 void Geometry::setTriangle(int id, Triangle t)
 {
+	//Connectivity only depends on vertex indices
+	if(t.vertices[0] != triangles[id].vertices[0] || t.vertices[1] != triangles[id].vertices[1] ||
+		t.vertices[2] != triangles[id].vertices[2])
+		topology_valid = false;
+
+	//Counts are rebuilt in one pass while the triangles are being edited
+	if(!references_valid) {
+		triangles[id] = t;
+		return;
+	}
+
 	//Update the vertex reference counts
 	vbuffer_references[triangles[id].vertices[0]]--;
 	vbuffer_references[triangles[id].vertices[1]]--;
@@ -122,9 +383,112 @@ void Geometry::setTriangle(int id, Triangle t)
 	nbuffer_references[t.normals[1]]++;
 	nbuffer_references[t.normals[2]]++;
 
+	//Update the texture coordinate reference counts
+	uvbuffer_references[triangles[id].uvs[0]]--;
+	uvbuffer_references[triangles[id].uvs[1]]--;
+	uvbuffer_references[triangles[id].uvs[2]]--;
+
+	uvbuffer_references[t.uvs[0]]++;
+	uvbuffer_references[t.uvs[1]]++;
+	uvbuffer_references[t.uvs[2]]++;
+
 	triangles[id] = t;
 }
 
+//Gets the triangles for editing in place
+Triangle *Geometry::editTriangles()
+{
+	references_valid = false;
+	topology_valid = false;
+
+	if(triangles.empty())
+		return NULL;
+
+	return &triangles[0];
+}
+
+//Resize the channels with a binding
+void Geometry::resizeChannels(attribute_binding binding, int count)
+{
+	for(unsigned int i = 0; i < channels.size(); i++) {
+		if(channels[i]->getBinding() == binding)
+			channels[i]->resize(count);
+	}
+}
+
+//Add a data channel
+AttributeChannel *Geometry::addChannel(const char *name, attribute_semantic semantic, attribute_binding binding, int num_components)
+{
+	if(num_components < 1 || num_components > ATTRIBUTE_MAX_COMPONENTS)
+		return NULL;
+
+	AttributeChannel *channel = findChannel(name);
+	if(channel) {
+		if(channel->getSemantic() != semantic || channel->getBinding() != binding || channel->getNumComponents() != num_components)
+			return NULL;
+
+		return channel;
+	}
+
+	channel = new AttributeChannel(name, semantic, binding, num_components, arena);
+	channel->resize(binding == AB_VERTEX ? vertices.size() : triangles.size() * 3);
+	channels.push_back(channel);
+
+	return channel;
+}
+
+//Find a data channel by name
+AttributeChannel *Geometry::findChannel(const char *name)
+{
+	for(unsigned int i = 0; i < channels.size(); i++) {
+		if(strcmp(channels[i]->getName(), name) == 0)
+			return channels[i];
+	}
+
+	return NULL;
+}
+
+//Get the number of data channels
+int Geometry::getNumChannels()
+{
+	return channels.size();
+}
+
+//Get a data channel
+AttributeChannel *Geometry::getChannel(int index)
+{
+	return channels[index];
+}
+
+//Average per vertex channel elements
+void Geometry::averageVertexChannels(int index, const int *sources, int count)
+{
+	for(unsigned int i = 0; i < channels.size(); i++) {
+		if(channels[i]->getBinding() == AB_VERTEX)
+			channels[i]->average(index, sources, count);
+	}
+}
+
+//Recount references from scratch
+void Geometry::recountReferences()
+{
+	unsigned int num_triangles = triangles.size();
+
+	vbuffer_references.assign(vertices.size(), 0);
+	nbuffer_references.assign(normals.size(), 0);
+	uvbuffer_references.assign(uvs.size(), 0);
+
+	for(unsigned int i = 0; i < num_triangles; i++) {
+		for(int j = 0; j < 3; j++) {
+			vbuffer_references[triangles[i].vertices[j]]++;
+			nbuffer_references[triangles[i].normals[j]]++;
+			uvbuffer_references[triangles[i].uvs[j]]++;
+		}
+	}
+
+	references_valid = true;
+}
+
 //Gets the number of triangles in the mesh
 int Geometry::getNumTriangles()
 {
@@ -161,118 +525,177 @@ Vector3D *Geometry::getNormal(int index)
 	return &normals[index];
 }
 
+//Gets the number of texture coordinates
+int Geometry::getNumUVs()
+{
+	return uvs.size();
+}
+
+//Gets a texture coordinate from the buffer
+Vector2D *Geometry::getUV(int index)
+{
+	return &uvs[index];
+}
+
+//Removes unreferenced entries from a buffer and records the new index of each entry
+template <class Buffer>
+static void compactBuffer(Buffer &buffer, ReferenceBuffer &references, int *remap)
+{
+	unsigned int num_entries = buffer.size();
+	unsigned int kept = 0;
+
+	for(unsigned int i = 0; i < num_entries; i++) {
+		if(references[i] == 0) {
+			remap[i] = -1;
+		} else {
+			buffer[kept] = buffer[i];
+			references[kept] = references[i];
+			remap[i] = kept;
+			kept++;
+		}
+	}
+
+	buffer.resize(kept);
+	references.resize(kept);
+}
+
 //Clean up the geometric object when done manipulating
 void Geometry::cleanUp()
 {
-	unsigned int num_vertices = vbuffer_references.size();
 	unsigned int num_triangles = triangles.size();
-	unsigned int num_normals = nbuffer_references.size();
-	unsigned int original_num_vertices = num_vertices;
-	unsigned int original_num_normals = num_normals;
-	unsigned int original_index;
 
-	std::vector<Vector3D> new_list;
-	std::vector<int> new_references;
+	MemoryArena *scratch = getScratchArena();
+	ScratchArray<int> vertex_remap(scratch, vertices.size());
+	ScratchArray<int> normal_remap(scratch, normals.size());
+	ScratchArray<int> uv_remap(scratch, uvs.size());
 
-	std::vector<unsigned int> removed_vertices;
-	std::vector<unsigned int> removed_normals;
-	unsigned int *vertex_remap = new unsigned int[num_vertices];
-	unsigned int *normal_remap = new unsigned int[num_normals];
+	if(!references_valid)
+		recountReferences();
 
-	for(unsigned int i = 0; i < num_vertices; i++)
-		vertex_remap[i] = i;
+	//Remove each vertex, normal and texture coordinate with 0 references
+	compactBuffer(vertices, vbuffer_references, vertex_remap.get());
+	compactBuffer(normals, nbuffer_references, normal_remap.get());
+	compactBuffer(uvs, uvbuffer_references, uv_remap.get());
 
-	for(unsigned int i = 0; i < num_normals; i++)
-		normal_remap[i] = i;
-	
-	//Find each vertex with 0 references
-	original_index = 0;
-	for(unsigned int i = 0; i < num_vertices; i++) {
-		if(vbuffer_references[i] == 0) {
-			removed_vertices.push_back(original_index);
-		}
-		else
-		{
-			new_list.push_back(vertices[i]);
-			new_references.push_back(vbuffer_references[i]);
-		}
-
-		original_index++;
+	//Per vertex channels follow the vertices, per corner channels are unchanged
+	for(unsigned int i = 0; i < channels.size(); i++) {
+		if(channels[i]->getBinding() == AB_VERTEX)
+			channels[i]->compact(vertex_remap.get());
 	}
 
-	vertices = new_list;
-	vbuffer_references = new_references;
-	new_list.clear();
-	new_references.clear();
-	
-	//Find each vertex with 0 references
-	original_index = 0;
-	for(unsigned int i = 0; i < num_normals; i++) {
-		if(nbuffer_references[i] == 0) {
-			removed_normals.push_back(original_index);
-		}
-		else
+	//Update indices in each triangle
+	for(unsigned int i = 0; i < num_triangles; i++)
+	{
+		for(int j = 0; j < 3; j++)
 		{
-			new_list.push_back(normals[i]);
-			new_references.push_back(nbuffer_references[i]);
+			triangles[i].vertices[j] = vertex_remap[triangles[i].vertices[j]];
+			triangles[i].normals[j] = normal_remap[triangles[i].normals[j]];
+			triangles[i].uvs[j] = uv_remap[triangles[i].uvs[j]];
 		}
-
-		original_index++;
 	}
 
-	normals = new_list;
-	nbuffer_references = new_references;
-	new_list.clear();
-	new_references.clear();
+	//Vertex indices changed so the meshlets must be rebuilt
+	topology_valid = false;
+	bounds_valid = false;
+	if(meshlets)
+		meshlets->build(this, meshlets->getMaxVertices(), meshlets->getMaxTriangles());
+}
 
-	//Generate remap from list of removed vertices/normals
-	int removed_index = 0;
-	int current_offset = 0;
-	for(unsigned int i = 0; i < original_num_vertices; i++)
-	{
-		vertex_remap[i] = current_offset;
-		if(i < removed_vertices.size() && i == removed_vertices[removed_index])
-		{
-			removed_index++;
-			current_offset++;
-		}
+//Remove unreferenced normals
+void Geometry::compactNormals()
+{
+	unsigned int num_triangles = triangles.size();
+
+	if(!references_valid)
+		recountReferences();
+
+	ScratchArray<int> normal_remap(getScratchArena(), normals.size());
+	compactBuffer(normals, nbuffer_references, normal_remap.get());
+
+	//Topology and meshlets only depend on vertex indices
+	for(unsigned int i = 0; i < num_triangles; i++) {
+		for(int j = 0; j < 3; j++)
+			triangles[i].normals[j] = normal_remap[triangles[i].normals[j]];
 	}
+}
 
-	removed_index = 0;
-	current_offset = 0;
-	for(unsigned int i = 0; i < original_num_normals; i++)
-	{
-		normal_remap[i] = current_offset;
-		if(i < removed_normals.size() && i == removed_normals[removed_index])
-		{
-			removed_index++;
-			current_offset++;
+//Merge equal texture coordinates
+void Geometry::mergeUVs()
+{
+	unsigned int num_uvs = uvs.size();
+	unsigned int num_triangles = triangles.size();
+	if(num_uvs < 2)
+		return;
+
+	ScratchArray<int> uv_remap(getScratchArena(), num_uvs);
+	HASH_MAP<unsigned long long, int> first_uvs;
+	first_uvs.rehash(num_uvs);
+
+	//Keep the first of each value, moving it down over the merged entries
+	unsigned int kept = 0;
+	for(unsigned int i = 0; i < num_uvs; i++) {
+		std::pair<HASH_MAP<unsigned long long, int>::iterator, bool> inserted =
+			first_uvs.insert(std::make_pair(uvKey(uvs[i]), (int)kept));
+
+		if(inserted.second) {
+			uvs[kept] = uvs[i];
+			uvbuffer_references[kept] = uvbuffer_references[i];
+			kept++;
+		} else {
+			uvbuffer_references[inserted.first->second] += uvbuffer_references[i];
 		}
+
+		uv_remap[i] = inserted.first->second;
 	}
 
-	//Update indices in each triangle
-	for(unsigned int i = 0; i < num_triangles; i++)
-	{
-		triangles[i].normals[0] -= normal_remap[triangles[i].normals[0]];
-		triangles[i].normals[1] -= normal_remap[triangles[i].normals[1]];
-		triangles[i].normals[2] -= normal_remap[triangles[i].normals[2]];
+	if(kept == num_uvs)
+		return;
+
+	uvs.resize(kept);
+	uvbuffer_references.resize(kept);
 
-		triangles[i].vertices[0] -= vertex_remap[triangles[i].vertices[0]];
-		triangles[i].vertices[1] -= vertex_remap[triangles[i].vertices[1]];
-		triangles[i].vertices[2] -= vertex_remap[triangles[i].vertices[2]];
+	for(unsigned int i = 0; i < num_triangles; i++) {
+		for(int j = 0; j < 3; j++)
+			triangles[i].uvs[j] = uv_remap[triangles[i].uvs[j]];
 	}
+}
+
+//Replace all normals
+void Geometry::replaceNormals(const Vector3D *new_normals, int count, const int *corner_normals)
+{
+	unsigned int num_triangles = triangles.size();
+
+	//Reuses the buffer's storage when it is already large enough
+	normals.assign(new_normals, new_normals + count);
+	nbuffer_references.assign(count, 0);
 
-	delete vertex_remap;
-	delete normal_remap;
+	for(unsigned int i = 0; i < num_triangles; i++) {
+		for(int j = 0; j < 3; j++) {
+			int n = corner_normals[i * 3 + j];
+			triangles[i].normals[j] = n;
+			nbuffer_references[n]++;
+		}
+	}
 }
 
 //Saves the instance of this object
-int Geometry::saveInstance(pugi::xml_node root, int *id, Transform *parent)
+int Geometry::saveInstance(pugi::xml_node root, int *id, Transform *parent, CullingVolume *volume)
 {
 	//Make sure node pointer is valid
 	if(!root)
 		return 1;
 
+	//Skip objects outside the volume before writing anything
+	Matrix *world = t.getWorldMatrix(parent);
+	if(volume) {
+		BoundingBox bounds;
+		getBounds(world, &bounds);
+		if(!volume->intersects(&bounds))
+			return 0;
+
+		referenced = true;
+	}
+
 	std::ostringstream name_stream;
 	name_stream << name << "-Inst-" << (*id);
 	*id = *id + 1;
@@ -280,21 +703,67 @@ int Geometry::saveInstance(pugi::xml_node root, int *id, Transform *parent)
 	pugi::xml_node node = root.append_child("node");
 	node.append_attribute("name") = name_stream.str().c_str();
 
-	//Compound parent transform into the group's transform
-	Transform total_t(t);
-	if(parent)
-		total_t.combine(parent);
-
-	//Add the transform element
-	total_t.save(node);
+	//Add the world transform element
+	world->save(node);
 
 	//Add the geometry instance element
 	pugi::xml_node instance_node = node.append_child("instance_geometry");
 	instance_node.append_attribute("url") = (std::string("#") + unique_id).c_str();
+	writeMaterialBinding(instance_node, texture);
 
 	return 0;
 }
 
+//Save the geometry if a culled save used it
+int Geometry::saveReferencedGeometry(pugi::xml_node root)
+{
+	if(!referenced)
+		return 0;
+
+	referenced = false;
+	return saveGeometry(root);
+}
+
+//Mark the mesh as used by a culled save
+void Geometry::markReferenced()
+{
+	referenced = true;
+}
+
+//Recompute the bounds when they are next needed
+void Geometry::invalidateBounds()
+{
+	bounds_valid = false;
+}
+
+//Get the bounds of the vertex buffer
+BoundingBox *Geometry::getLocalBounds()
+{
+	if(bounds_valid)
+		return &local_bounds;
+
+	CullingVolume::emptyBounds(&local_bounds);
+	unsigned int num_vertices = vertices.size();
+	for(unsigned int i = 0; i < num_vertices; i++) {
+		const Vector3D &v = vertices[i];
+		local_bounds.min.x = v.x < local_bounds.min.x ? v.x : local_bounds.min.x;
+		local_bounds.min.y = v.y < local_bounds.min.y ? v.y : local_bounds.min.y;
+		local_bounds.min.z = v.z < local_bounds.min.z ? v.z : local_bounds.min.z;
+		local_bounds.max.x = v.x > local_bounds.max.x ? v.x : local_bounds.max.x;
+		local_bounds.max.y = v.y > local_bounds.max.y ? v.y : local_bounds.max.y;
+		local_bounds.max.z = v.z > local_bounds.max.z ? v.z : local_bounds.max.z;
+	}
+
+	bounds_valid = true;
+	return &local_bounds;
+}
+
+//Bound the transformed mesh
+void Geometry::getBounds(Matrix *m, BoundingBox *bounds)
+{
+	CullingVolume::transformBounds(m, getLocalBounds(), bounds);
+}
+
 //Saves this geometric object into the specified COLLADA file
 int Geometry::saveGeometry(pugi::xml_node root)
 {
@@ -310,14 +779,25 @@ int Geometry::saveGeometry(pugi::xml_node root)
 	//Add mesh node to store triangle data
 	pugi::xml_node mesh_node = geom_node.append_child("mesh");
 	
-	//Add the source node containing vertex positions
-	writeVertexData(mesh_node, VDT_POSITION);
+	if(quantized) {
+		//Add the quantized source nodes
+		writeQuantizedVertexData(mesh_node, VDT_POSITION);
+		writeQuantizedVertexData(mesh_node, VDT_NORMAL);
+		writeQuantizedVertexData(mesh_node, VDT_UV);
+	} else {
+		//Add the source node containing vertex positions
+		writeVertexData(mesh_node, VDT_POSITION);
 
-	//Add the source node containing vertex normals
-	writeVertexData(mesh_node, VDT_NORMAL);
+		//Add the source node containing vertex normals
+		writeVertexData(mesh_node, VDT_NORMAL);
 
-	//Add the source node containing vertex uv coordinates
-	writeVertexData(mesh_node, VDT_UV);
+		//Add the source node containing vertex uv coordinates
+		writeVertexData(mesh_node, VDT_UV);
+	}
+
+	//Add a source node for each data channel
+	for(unsigned int i = 0; i < channels.size(); i++)
+		channels[i]->save(mesh_node, unique_id + "-" + channels[i]->getName());
 
 	//Add the vertex node
 	pugi::xml_node vertex_node = mesh_node.append_child("vertices");
@@ -330,6 +810,10 @@ int Geometry::saveGeometry(pugi::xml_node root)
 	//Add the triangles node
 	writeTriangleData(mesh_node);
 
+	//Add the meshlet partitioning if one was built
+	if(meshlets)
+		meshlets->save(mesh_node);
+
 	return 0;
 }
 
@@ -364,7 +848,7 @@ void Geometry::writeVertexData(pugi::xml_node root, vertex_data_type data_type)
 	else if(data_type == VDT_NORMAL)
 		count = normals.size();
 	else
-		count = triangles.size() * 3;
+		count = uvs.size();
 
 	//Create the source node
 	pugi::xml_node source_node = root.append_child("source");
@@ -403,18 +887,11 @@ void Geometry::writeVertexData(pugi::xml_node root, vertex_data_type data_type)
 			va_string_stream << DEC_FORMAT << normals[i].z << std::endl << indent;
 		}
 	} else {
-		//Write out per triangle-vertex information
-		int num_tris = triangles.size();
-		
-		switch(data_type){
-		case VDT_UV:
-			for(int i = 0; i < num_tris; i++) {
-				for(int j = 0; j < 3; j++) {
-					va_string_stream << DEC_FORMAT << triangles[i].uvs[j].u << " ";
-					va_string_stream << DEC_FORMAT << triangles[i].uvs[j].v << std::endl << indent;
-				}
-			}
-			break;
+		//Write out each texture coordinate in the buffer
+		int num_uvs = uvs.size();
+		for(int i = 0; i < num_uvs; i++) {
+			va_string_stream << DEC_FORMAT << uvs[i].u << " ";
+			va_string_stream << DEC_FORMAT << uvs[i].v << std::endl << indent;
 		}
 	}
 
@@ -453,11 +930,203 @@ void Geometry::writeVertexData(pugi::xml_node root, vertex_data_type data_type)
 	return;
 }
 
+//Save a source node with quantized vertex data
+void Geometry::writeQuantizedVertexData(pugi::xml_node root, vertex_data_type data_type)
+{
+	//Gather the values to encode
+	std::vector<float> values;
+	int components;
+	std::string vsn_name;
+	switch(data_type) {
+	case VDT_POSITION:
+		vsn_name = unique_id + "-Pos";
+		components = 3;
+		for(unsigned int i = 0; i < vertices.size(); i++) {
+			values.push_back(vertices[i].x);
+			values.push_back(vertices[i].y);
+			values.push_back(vertices[i].z);
+		}
+		break;
+	case VDT_NORMAL:
+		vsn_name = unique_id + "-Normal";
+		components = 3;
+		for(unsigned int i = 0; i < normals.size(); i++) {
+			values.push_back(normals[i].x);
+			values.push_back(normals[i].y);
+			values.push_back(normals[i].z);
+		}
+		break;
+	case VDT_UV:
+		vsn_name = unique_id + "-Tex";
+		components = 2;
+		for(unsigned int i = 0; i < uvs.size(); i++) {
+			values.push_back(uvs[i].u);
+			values.push_back(uvs[i].v);
+		}
+		break;
+	default:
+		return;
+	}
+
+	int count = values.size() / components;
+
+	//Normals are stored with two octahedral components
+	int stride = (data_type == VDT_NORMAL) ? 2 : components;
+
+	//Find the range of each component for unorm encoding
+	float offset[3] = {0.0f, 0.0f, 0.0f};
+	float scale[3] = {0.0f, 0.0f, 0.0f};
+	if(data_type != VDT_NORMAL && count > 0) {
+		float vmax[3];
+		for(int c = 0; c < components; c++)
+			offset[c] = vmax[c] = values[c];
+
+		for(int i = 1; i < count; i++) {
+			for(int c = 0; c < components; c++) {
+				float v = values[i * components + c];
+				if(v < offset[c])
+					offset[c] = v;
+				if(v > vmax[c])
+					vmax[c] = v;
+			}
+		}
+
+		for(int c = 0; c < components; c++)
+			scale[c] = (vmax[c] - offset[c]) / (float)QUANTIZE_UNORM16_MAX;
+	}
+
+	//Create the source node
+	pugi::xml_node source_node = root.append_child("source");
+	source_node.append_attribute("id") = vsn_name.c_str();
+
+	std::string vsna_name = vsn_name + "-array";
+	pugi::xml_node via_node = source_node.append_child("int_array");
+	via_node.append_attribute("id") = vsna_name.c_str();
+	via_node.append_attribute("count") = stride * count;
+
+	//Create indentation for newlines
+	char indent[20];
+	int depth = via_node.depth() - 2;
+	int idx;
+	for(idx = 0; idx < depth; idx++)
+		indent[idx] = '\t';
+	indent[idx] = '\0';
+
+	//Encode each element and track the largest decoding error
+	float max_error = 0.0f;
+	std::ostringstream va_string_stream;
+	va_string_stream << std::endl << indent;
+	for(int i = 0; i < count; i++) {
+		float *element = &values[i * components];
+
+		if(data_type == VDT_NORMAL) {
+			Vector3D n;
+			n.x = element[0];
+			n.y = element[1];
+			n.z = element[2];
+
+			short ox, oy;
+			octEncode(n, &ox, &oy);
+			va_string_stream << ox << " " << oy;
+
+			//Measure the angle to the decoded normal
+			float length = sqrtf(n.x * n.x + n.y * n.y + n.z * n.z);
+			if(length > 0.0f) {
+				Vector3D d = octDecode(ox, oy);
+				float cos_angle = (n.x * d.x + n.y * d.y + n.z * d.z) / length;
+				if(cos_angle > 1.0f)
+					cos_angle = 1.0f;
+
+				float angle = acosf(cos_angle) * 180.0f / PI;
+				if(angle > max_error)
+					max_error = angle;
+			}
+		} else {
+			for(int c = 0; c < components; c++) {
+				float normalized = scale[c] > 0.0f ? (element[c] - offset[c]) / (scale[c] * (float)QUANTIZE_UNORM16_MAX) : 0.0f;
+				unsigned short q = quantizeUnorm16(normalized);
+				va_string_stream << q;
+				if(c != components - 1)
+					va_string_stream << " ";
+
+				float error = fabsf(offset[c] + (float)q * scale[c] - element[c]);
+				if(error > max_error)
+					max_error = error;
+			}
+		}
+
+		va_string_stream << std::endl << indent;
+	}
+
+	//Build the string from the stream and copy to the node
+	std::string va_string = va_string_stream.str();
+	via_node.text() = va_string.c_str();
+
+	//Add the technique node
+	pugi::xml_node vtechnique_node = source_node.append_child("technique_common");
+	pugi::xml_node vta_node = vtechnique_node.append_child("accessor");
+	vta_node.append_attribute("source") = (std::string("#") + vsna_name).c_str();
+	vta_node.append_attribute("count") = count;
+	vta_node.append_attribute("stride") = stride;
+
+	const char *param_names[3];
+	if(data_type == VDT_UV) {
+		param_names[0] = "S";
+		param_names[1] = "T";
+	} else {
+		param_names[0] = "X";
+		param_names[1] = "Y";
+		param_names[2] = "Z";
+	}
+
+	for(int c = 0; c < stride; c++) {
+		pugi::xml_node param = vta_node.append_child("param");
+		param.append_attribute("name") = param_names[c];
+		param.append_attribute("type") = "int";
+	}
+
+	//Describe how to decode the data
+	pugi::xml_node qtechnique_node = source_node.append_child("technique");
+	qtechnique_node.append_attribute("profile") = "ShockShapes";
+	pugi::xml_node quant_node = qtechnique_node.append_child("quantization");
+
+	if(data_type == VDT_NORMAL) {
+		quant_node.append_attribute("encoding") = "octahedral_snorm16";
+	} else {
+		std::ostringstream offset_stream, scale_stream;
+		for(int c = 0; c < components; c++) {
+			offset_stream << std::setprecision(9) << offset[c];
+			scale_stream << std::setprecision(9) << scale[c];
+			if(c != components - 1) {
+				offset_stream << " ";
+				scale_stream << " ";
+			}
+		}
+
+		quant_node.append_attribute("encoding") = "unorm16";
+		quant_node.append_attribute("offset") = offset_stream.str().c_str();
+		quant_node.append_attribute("scale") = scale_stream.str().c_str();
+	}
+	quant_node.append_attribute("max_error") = max_error;
+
+	//Report the error
+	if(data_type == VDT_POSITION)
+		quantization_error.position_error = max_error;
+	else if(data_type == VDT_NORMAL)
+		quantization_error.normal_error = max_error;
+	else
+		quantization_error.uv_error = max_error;
+
+	return;
+}
+
 //Adds the triangles node to a COLLADA file
 void Geometry::writeTriangleData(pugi::xml_node root)
 {
 	pugi::xml_node triangles_node = root.append_child("triangles");
 	triangles_node.append_attribute("count") = triangles.size();
+	if(texture)
+		triangles_node.append_attribute("material") = texture->getMaterialId().c_str();
 
 	//Specify the format of the data
 	pugi::xml_node input1 = triangles_node.append_child("input");
@@ -475,6 +1144,24 @@ void Geometry::writeTriangleData(pugi::xml_node root)
 	input3.append_attribute("source") = (std::string("#") + unique_id + "-Tex").c_str();
 	input3.append_attribute("offset") = 2;
 
+	//Per vertex channels share the vertex index and per corner channels get their own
+	static const char *channel_semantics[3] = {"TEXTANGENT", "COLOR", "TEXCOORD"};
+	int channel_sets[3] = {0, 0, 1};
+	int num_inputs = 3;
+	for(unsigned int i = 0; i < channels.size(); i++) {
+		attribute_semantic semantic = channels[i]->getSemantic();
+		bool per_corner = (channels[i]->getBinding() == AB_CORNER);
+
+		pugi::xml_node channel_input = triangles_node.append_child("input");
+		channel_input.append_attribute("semantic") = channel_semantics[semantic];
+		channel_input.append_attribute("source") = (std::string("#") + unique_id + "-" + channels[i]->getName()).c_str();
+		channel_input.append_attribute("offset") = per_corner ? num_inputs : 0;
+		channel_input.append_attribute("set") = channel_sets[semantic]++;
+
+		if(per_corner)
+			num_inputs++;
+	}
+
 	//Add the primitive node
 	pugi::xml_node p_node = triangles_node.append_child("p");
 
@@ -491,17 +1178,17 @@ void Geometry::writeTriangleData(pugi::xml_node root)
 	tri_stream << std::endl << indent;
 	int num_tris = triangles.size();
 	int last_tri = num_tris - 1;
-	int index = 0;
 	for(int i = 0; i < num_tris; i++) {
 		for(int j = 0; j < 3; j++) {
 			tri_stream << triangles[i].vertices[j] << " ";
 			tri_stream << triangles[i].normals[j] << " ";
-			tri_stream << index;
+			tri_stream << triangles[i].uvs[j];
+
+			for(int k = 3; k < num_inputs; k++)
+				tri_stream << " " << i * 3 + j;
 
 			if(j != 2)
 				tri_stream << "  ";
-
-			index++;
 		}
 
 		if(i == last_tri)
@@ -517,6 +1204,196 @@ void Geometry::writeTriangleData(pugi::xml_node root)
 	return;
 }
 
+/**
+ * @brief Where each attribute index is found in a corner of a COLLADA primitive
+ */
+typedef struct {
+	unsigned int num_inputs;	/**< Number of indices in each corner. */
+	unsigned int vertex_offset;	/**< Offset of the position index. */
+	int normal_offset;			/**< Offset of the normal index or -1 if every corner uses normal_base. */
+	int normal_base;			/**< Added to every normal index. */
+	int uv_offset;				/**< Offset of the texture coordinate index or -1 if every corner uses uv_base. */
+	int uv_base;				/**< Added to every texture coordinate index. */
+} PrimitiveLayout;
+
+/**
+ * @brief Working buffers reused for every primitive read into a mesh
+ */
+typedef struct {
+	std::vector<int> corners;			/**< Indices of the corners of the current polygon. */
+	std::vector<int> counts;			/**< Corner count of each polygon in a polylist. */
+	std::vector<Vector3D> positions;	/**< Corner positions of the current polygon. */
+	std::vector<int> triangles;			/**< Triangulation of the current polygon. */
+	Triangulator triangulator;
+} PrimitiveBuffers;
+
+//Add a triangle made from three corners of a primitive, skipping it if an index is out of range
+static void addCornerTriangle(Geometry *g, const int *c0, const int *c1, const int *c2, const PrimitiveLayout *layout)
+{
+	const int *corners[3] = {c0, c1, c2};
+	Triangle t;
+
+	for(int i = 0; i < 3; i++) {
+		t.vertices[i] = corners[i][layout->vertex_offset];
+		t.normals[i] = layout->normal_base + (layout->normal_offset >= 0 ? corners[i][layout->normal_offset] : 0);
+		t.uvs[i] = layout->uv_base + (layout->uv_offset >= 0 ? corners[i][layout->uv_offset] : 0);
+
+		if(t.vertices[i] < 0 || t.vertices[i] >= g->getNumVertices() ||
+			t.normals[i] < 0 || t.normals[i] >= g->getNumNormals() ||
+			t.uvs[i] < 0 || t.uvs[i] >= g->getNumUVs())
+			return;
+	}
+
+	g->addTriangle(t);
+}
+
+//Triangulate a polygon and add it to the mesh
+static void addPolygon(Geometry *g, int num_corners, const PrimitiveLayout *layout, PrimitiveBuffers *buffers)
+{
+	const int *corners = &buffers->corners[0];
+	unsigned int stride = layout->num_inputs;
+
+	if(num_corners < 3)
+		return;
+
+	if(num_corners == 3) {
+		addCornerTriangle(g, corners, corners + stride, corners + stride * 2, layout);
+		return;
+	}
+
+	//Gather corner positions for the triangulator
+	buffers->positions.resize(num_corners);
+	for(int i = 0; i < num_corners; i++) {
+		int v = corners[i * stride + layout->vertex_offset];
+		if(v < 0 || v >= g->getNumVertices())
+			return;
+
+		buffers->positions[i] = *(g->getVertex(v));
+	}
+
+	buffers->triangles.resize((num_corners - 2) * 3);
+	int num_triangles = buffers->triangulator.triangulate(&buffers->positions[0], num_corners, &buffers->triangles[0]);
+
+	for(int i = 0; i < num_triangles; i++) {
+		const int *tri = &buffers->triangles[i * 3];
+		addCornerTriangle(g, corners + tri[0] * stride, corners + tri[1] * stride, corners + tri[2] * stride, layout);
+	}
+}
+
+//Read the corners of a single <p> element into the corner buffer
+static int readCorners(const char *text, const PrimitiveLayout *layout, PrimitiveBuffers *buffers)
+{
+	int num_corners = countValues(text) / layout->num_inputs;
+	if(num_corners == 0)
+		return 0;
+
+	buffers->corners.resize(num_corners * layout->num_inputs);
+	parseIntArray(text, &buffers->corners[0], num_corners * layout->num_inputs);
+
+	return num_corners;
+}
+
+//Read a primitive element and add its triangles to the mesh
+static void readPrimitives(Geometry *g, pugi::xml_node prim_node, const PrimitiveLayout *layout, PrimitiveBuffers *buffers)
+{
+	const char *type = prim_node.name();
+	unsigned int stride = layout->num_inputs;
+	int count = atoi(prim_node.attribute("count").value());
+	if(count < 0)
+		count = 0;
+
+	if(!strcmp(type, "triangles")) {
+		//One list of three corners per triangle
+		if(!prim_node.child("p") || count == 0)
+			return;
+
+		g->reserveTriangles(count);
+		buffers->corners.resize(stride * 3);
+
+		const char *text = prim_node.child("p").text().get();
+		for(int i = 0; i < count; i++) {
+			text = parseIntArray(text, &buffers->corners[0], stride * 3);
+			addPolygon(g, 3, layout, buffers);
+		}
+	} else if(!strcmp(type, "polylist")) {
+		//Corner counts in vcount followed by one list of all corners
+		if(!prim_node.child("p") || !prim_node.child("vcount") || count == 0)
+			return;
+
+		buffers->counts.resize(count);
+		parseIntArray(prim_node.child("vcount").text().get(), &buffers->counts[0], count);
+
+		int num_triangles = 0;
+		for(int i = 0; i < count; i++) {
+			if(buffers->counts[i] > 2)
+				num_triangles += buffers->counts[i] - 2;
+		}
+		g->reserveTriangles(num_triangles);
+
+		const char *text = prim_node.child("p").text().get();
+		for(int i = 0; i < count; i++) {
+			int num_corners = buffers->counts[i];
+			if(num_corners <= 0)
+				continue;
+
+			buffers->corners.resize(num_corners * stride);
+			text = parseIntArray(text, &buffers->corners[0], num_corners * stride);
+			addPolygon(g, num_corners, layout, buffers);
+		}
+	} else if(!strcmp(type, "polygons")) {
+		//One <p> per polygon. Holes of <ph> polygons are ignored.
+		g->reserveTriangles(count);
+
+		for(pugi::xml_node p = prim_node.first_child(); p; p = p.next_sibling()) {
+			pugi::xml_node outline = p;
+			if(!strcmp(p.name(), "ph"))
+				outline = p.child("p");
+			else if(strcmp(p.name(), "p"))
+				continue;
+
+			int num_corners = readCorners(outline.text().get(), layout, buffers);
+			addPolygon(g, num_corners, layout, buffers);
+		}
+	} else if(!strcmp(type, "trifans")) {
+		//Each <p> is a fan around its first corner
+		for(pugi::xml_node p = prim_node.child("p"); p; p = p.next_sibling("p")) {
+			int num_corners = readCorners(p.text().get(), layout, buffers);
+			if(num_corners < 3)
+				continue;
+
+			g->reserveTriangles(num_corners - 2);
+			const int *corners = &buffers->corners[0];
+			for(int i = 1; i < num_corners - 1; i++)
+				addCornerTriangle(g, corners, corners + i * stride, corners + (i + 1) * stride, layout);
+		}
+	} else if(!strcmp(type, "tristrips")) {
+		//Each <p> is a strip. Every other triangle is flipped to keep the winding.
+		for(pugi::xml_node p = prim_node.child("p"); p; p = p.next_sibling("p")) {
+			int num_corners = readCorners(p.text().get(), layout, buffers);
+			if(num_corners < 3)
+				continue;
+
+			g->reserveTriangles(num_corners - 2);
+			const int *corners = &buffers->corners[0];
+			for(int i = 0; i < num_corners - 2; i++) {
+				const int *c0 = corners + i * stride;
+				const int *c1 = corners + (i + 1) * stride;
+				const int *c2 = corners + (i + 2) * stride;
+
+				//Skip degenerate triangles used to join strips
+				int v0 = c0[layout->vertex_offset], v1 = c1[layout->vertex_offset], v2 = c2[layout->vertex_offset];
+				if(v0 == v1 || v1 == v2 || v0 == v2)
+					continue;
+
+				if(i % 2 == 0)
+					addCornerTriangle(g, c0, c1, c2, layout);
+				else
+					addCornerTriangle(g, c1, c0, c2, layout);
+			}
+		}
+	}
+}
+
 //Read geometry data from COLLADA node
 int Geometry::readGeometry(pugi::xml_node root)
 {
@@ -542,10 +1419,6 @@ int Geometry::readGeometry(pugi::xml_node root)
 	bool vtxTexCoords = false;
 	bool triTexCoords = false;
 
-	//Offsets in triangle data of each attribute
-	unsigned int vtxOffset, normalOffset, texOffset;
-	unsigned int numInputs;
-
 	//Read name of the geometry
 	if(root.attribute("name"))
 	{
@@ -564,9 +1437,8 @@ int Geometry::readGeometry(pugi::xml_node root)
 	}
 	else
 	{
-		id = current_id++;
-
-		//Build the unique id for this object
+		//Build the unique id from the id assigned by the constructor
+		//so geometries can be read on any thread
 		std::ostringstream unique_id_stream;
 		unique_id_stream << name << id;
 		unique_id = unique_id_stream.str();
@@ -577,9 +1449,21 @@ int Geometry::readGeometry(pugi::xml_node root)
 	if(!mesh_node)
 		return 2;
 
+	//Sources already copied into the buffers and where their data starts
+	CSource *copied_normals = NULL;
+	CSource *copied_uvs = NULL;
+	int normals_base = 0;
+	int uvs_base = 0;
+
+	//Shared attributes for primitives without normals or texture coordinates
+	int default_normal = -1;
+	int default_uv = -1;
+
+	PrimitiveBuffers buffers;
+
 	//Iterate over each child of the mesh and process if supported
 	for(pugi::xml_node child = mesh_node.first_child(); child; child = child.next_sibling()) {
-		//Currently not supported: lines, linestrips, polygons, polylist
+		//Currently not supported: lines, linestrips
 		if(!strcmp(child.name(), "source")) {
 			sources.addSource(child);
 		} else if(!strcmp(child.name(), "vertices")) {
@@ -588,121 +1472,108 @@ int Geometry::readGeometry(pugi::xml_node root)
 				if(!strcmp(v_input.name(), "input")) {
 					if(!strcmp(v_input.attribute("semantic").value(), "POSITION")) {
 						positions = sources.getSource(v_input.attribute("source").value());
-						copyVertexData(positions);
+						if(positions && copyVertexData(positions))
+							return 3;
 					} else if(!strcmp(v_input.attribute("semantic").value(), "NORMAL")) {
 						normals = sources.getSource(v_input.attribute("source").value());
-						copyNormalData(normals);
+						if(normals && normals != copied_normals) {
+							normals_base = this->normals.size();
+							if(copyNormalData(normals))
+								return 3;
+							copied_normals = normals;
+						}
 						vtxNormals = true;
 					} else if(!strcmp(v_input.attribute("semantic").value(), "TEXCOORD")) {
 						tex1_coords = sources.getSource(v_input.attribute("source").value());
+						if(tex1_coords && tex1_coords != copied_uvs) {
+							uvs_base = uvs.size();
+							if(copyUVData(tex1_coords))
+								return 3;
+							copied_uvs = tex1_coords;
+						}
 						vtxTexCoords = true;
 					}
 				}
 			}
-		} else if(!strcmp(child.name(), "triangles")) {
-			//Get per triangle inputs
-			numInputs = 0;
+		} else if(!strcmp(child.name(), "triangles") || !strcmp(child.name(), "polylist") || !strcmp(child.name(), "polygons") ||
+			!strcmp(child.name(), "trifans") || !strcmp(child.name(), "tristrips")) {
+			//Get per corner inputs. Inputs may share an offset so the stride is the largest offset plus one.
+			PrimitiveLayout layout;
+			layout.num_inputs = 0;
+			layout.vertex_offset = 0;
+			layout.normal_offset = -1;
+			layout.uv_offset = -1;
+			bool primNormals = false;
+			bool primTexCoords = false;
+
 			for(pugi::xml_node t_input = child.first_child(); t_input; t_input = t_input.next_sibling()) {
 				if(!strcmp(t_input.name(), "input")) {
-					numInputs++;
+					unsigned int offset = atoi(t_input.attribute("offset").value());
+					if(offset + 1 > layout.num_inputs)
+						layout.num_inputs = offset + 1;
+
 					if(!strcmp(t_input.attribute("semantic").value(), "VERTEX")) {
-						vtxOffset = atoi(t_input.attribute("offset").value());
+						layout.vertex_offset = offset;
 					} else if(!strcmp(t_input.attribute("semantic").value(), "NORMAL")) {
 						normals = sources.getSource(t_input.attribute("source").value());
-						copyNormalData(normals);
+						if(normals && normals != copied_normals) {
+							normals_base = this->normals.size();
+							if(copyNormalData(normals))
+								return 3;
+							copied_normals = normals;
+						}
 						triNormals = true;
-						normalOffset = atoi(t_input.attribute("offset").value());
+						primNormals = normals != NULL;
+						layout.normal_offset = offset;
 					} else if(!strcmp(t_input.attribute("semantic").value(), "TEXCOORD")) {
+						//Only the first texture coordinate set is used
+						if(primTexCoords)
+							continue;
+
 						tex1_coords = sources.getSource(t_input.attribute("source").value());
+						if(tex1_coords && tex1_coords != copied_uvs) {
+							uvs_base = uvs.size();
+							if(copyUVData(tex1_coords))
+								return 3;
+							copied_uvs = tex1_coords;
+						}
 						triTexCoords = true;
-						texOffset = atoi(t_input.attribute("offset").value());
+						primTexCoords = tex1_coords != NULL;
+						layout.uv_offset = offset;
 					}
 				}
 			}
 
-			//Buffer for each triangle
-			int bufferSize = numInputs * 3;
-			int *triBuffer = new int[bufferSize];
-
-			//Read the primitive descriptors and add triangles to the mesh
-			int numTriangles = atoi(child.attribute("count").value());
-			if(child.child("p")) {
-				std::string text = child.child("p").text().get();
-				std::istringstream iss(text);
-
-				for(int i = 0; i < numTriangles; i++) {
-					//Read indices into buffer
-					for(int j = 0; j < bufferSize; j++)
-						iss >> triBuffer[j];
-					
-					//Construct the triangle from buffer data
-					Triangle t;
-					t.vertices[0] = triBuffer[vtxOffset];
-					t.vertices[1] = triBuffer[numInputs + vtxOffset];
-					t.vertices[2] = triBuffer[numInputs + numInputs + vtxOffset];
-
-					//Normal indices if they are present
-					if(vtxNormals) {
-						t.normals[0] = triBuffer[vtxOffset];
-						t.normals[1] = triBuffer[numInputs + vtxOffset];
-						t.normals[2] = triBuffer[numInputs + numInputs + vtxOffset]; 
-					} else if(triNormals) {
-						t.normals[0] = triBuffer[normalOffset];
-						t.normals[1] = triBuffer[numInputs + normalOffset];
-						t.normals[2] = triBuffer[numInputs + numInputs + normalOffset];
-					}
+			if(layout.num_inputs == 0)
+				continue;
 
-					//Copy texture coordinates from source if available
-					if(vtxTexCoords) {
-						Vector2D coord;
-						int index;
-						
-						index = triBuffer[vtxOffset];
-						coord.u = tex1_coords->accessFloatParameter(index, PT_S);
-						coord.v = tex1_coords->accessFloatParameter(index, PT_T);
-						t.uvs[0] = coord;
-
-						index = triBuffer[numInputs + vtxOffset];
-						coord.u = tex1_coords->accessFloatParameter(index, PT_S);
-						coord.v = tex1_coords->accessFloatParameter(index, PT_T);
-						t.uvs[1] = coord;
-
-						index = triBuffer[numInputs + numInputs + vtxOffset];
-						coord.u = tex1_coords->accessFloatParameter(index, PT_S);
-						coord.v = tex1_coords->accessFloatParameter(index, PT_T);
-						t.uvs[2] = coord;
-					} else if(triTexCoords) {
-						Vector2D coord;
-						int index;
-						
-						index = triBuffer[texOffset];
-						coord.u = tex1_coords->accessFloatParameter(index, PT_S);
-						coord.v = tex1_coords->accessFloatParameter(index, PT_T);
-						t.uvs[0] = coord;
-
-						index = triBuffer[numInputs + texOffset];
-						coord.u = tex1_coords->accessFloatParameter(index, PT_S);
-						coord.v = tex1_coords->accessFloatParameter(index, PT_T);
-						t.uvs[1] = coord;
-
-						index = triBuffer[numInputs + numInputs + texOffset];
-						coord.u = tex1_coords->accessFloatParameter(index, PT_S);
-						coord.v = tex1_coords->accessFloatParameter(index, PT_T);
-						t.uvs[2] = coord;
-					}
+			//Attributes indexed by vertex use the vertex index
+			if(!primNormals)
+				layout.normal_offset = vtxNormals ? (int)layout.vertex_offset : -1;
+			if(!primTexCoords)
+				layout.uv_offset = vtxTexCoords ? (int)layout.vertex_offset : -1;
 
-					//Add triangle to mesh
-					addTriangle(t);
-				}
+			//Triangles without normals share a single zero normal
+			if(layout.normal_offset < 0 && default_normal < 0) {
+				Vector3D n;
+				n.x = n.y = n.z = 0.0f;
+				default_normal = addNormal(n);
 			}
 
-			delete triBuffer;
-		} else if(!strcmp(child.name(), "trifans")) {
-			//TODO
-		} else if(!strcmp(child.name(), "tristrips")) {
-			//TODO
+			//Triangles without texture coordinates share a single default coordinate
+			if(layout.uv_offset < 0 && default_uv < 0) {
+				Vector2D uv;
+				uv.u = uv.v = 0.0f;
+				default_uv = addUV(uv);
+			}
+
+			layout.normal_base = layout.normal_offset < 0 ? default_normal : normals_base;
+			layout.uv_base = layout.uv_offset < 0 ? default_uv : uvs_base;
+
+			//Triangulate the primitives into the mesh
+			readPrimitives(this, child, &layout, &buffers);
 		}
-    }
+	}
 
 	if(vtxNormals && triNormals) {
 		//ERROR
@@ -714,41 +1585,96 @@ int Geometry::readGeometry(pugi::xml_node root)
 		return 1;
 	}
 
+	//Files written with a texture coordinate per corner repeat most values
+	mergeUVs();
+
 	return 0;
 }
 
-//Copy vertex data
-void Geometry::copyVertexData(CSource *source)
+//Copy one parameter of a source into a component of consecutive buffer elements
+static void copyComponent(FloatView view, float *dest, unsigned int dest_stride, unsigned int count)
 {
-	int nVertices = source->getNumElements();
-	
-	//Copy each vertex
-	for(int i = 0; i < nVertices; i++)
-	{
-		Vector3D v;
-		v.x = source->accessFloatParameter(i, PT_X);
-		v.y = source->accessFloatParameter(i, PT_Y);
-		v.z = source->accessFloatParameter(i, PT_Z);
+	unsigned int available = view.data ? (view.count < count ? view.count : count) : 0;
+
+	for(unsigned int i = 0; i < available; i++)
+		dest[i * dest_stride] = view.data[i * view.stride];
+
+	//Parameters missing from the source read as 0
+	for(unsigned int i = available; i < count; i++)
+		dest[i * dest_stride] = 0.0f;
+}
+
+//Append the X, Y and Z parameters of a source to a vector buffer
+static int copyVectors(CSource *source, Vector3DBuffer &buffer, ReferenceBuffer &references)
+{
+	if(source->getType() != ST_FLOAT)
+		return 1;
+
+	unsigned int count = source->getNumElements();
+	if(count == 0)
+		return 0;
+
+	FloatView x = source->getFloatView(PT_X);
+	FloatView y = source->getFloatView(PT_Y);
+	FloatView z = source->getFloatView(PT_Z);
+
+	unsigned int base = buffer.size();
+	buffer.resize(base + count);
+	references.resize(base + count, 0);
 
-		addVertex(v);
+	//Tightly packed XYZ data has the same layout as the buffer
+	if(x.data && x.stride == 3 && x.count >= count && y.data == x.data + 1 && z.data == x.data + 2) {
+		memcpy(&buffer[base], x.data, count * sizeof(Vector3D));
+		return 0;
 	}
+
+	copyComponent(x, &buffer[base].x, 3, count);
+	copyComponent(y, &buffer[base].y, 3, count);
+	copyComponent(z, &buffer[base].z, 3, count);
+
+	return 0;
+}
+
+//Copy vertex data
+int Geometry::copyVertexData(CSource *source)
+{
+	bounds_valid = false;
+
+	return copyVectors(source, vertices, vbuffer_references);
 }
 
 //Copy normal data
-void Geometry::copyNormalData(CSource *source)
+int Geometry::copyNormalData(CSource *source)
 {
-	int nNormals = source->getNumElements();
-	
-	//Copy each vertex
-	for(int i = 0; i < nNormals; i++)
-	{
-		Vector3D n;
-		n.x = source->accessFloatParameter(i, PT_X);
-		n.y = source->accessFloatParameter(i, PT_Y);
-		n.z = source->accessFloatParameter(i, PT_Z);
+	return copyVectors(source, normals, nbuffer_references);
+}
 
-		addNormal(n);
-	}
+//Copy texture coordinate data
+int Geometry::copyUVData(CSource *source)
+{
+	if(source->getType() != ST_FLOAT)
+		return 1;
+
+	unsigned int count = source->getNumElements();
+	if(count == 0)
+		return 0;
+
+	//Coordinates are named S and T by most exporters and U and V by some
+	FloatView u = source->getFloatView(PT_S);
+	FloatView v = source->getFloatView(PT_T);
+	if(!u.data)
+		u = source->getFloatView(PT_U);
+	if(!v.data)
+		v = source->getFloatView(PT_V);
+
+	unsigned int base = uvs.size();
+	uvs.resize(base + count);
+	uvbuffer_references.resize(base + count, 0);
+
+	copyComponent(u, &uvs[base].u, 2, count);
+	copyComponent(v, &uvs[base].v, 2, count);
+
+	return 0;
 }
 
 //Generation function does nothing for default
@@ -763,6 +1689,12 @@ Transform *Geometry::getTransform()
 	return &t;
 }
 
+//Update the cached world matrix
+void Geometry::updateWorldMatrices(Transform *parent)
+{
+	t.getWorldMatrix(parent);
+}
+
 //Add a filter to the object
 void Geometry::addFilter(GeometryFilter *filter)
 {
@@ -773,8 +1705,65 @@ void Geometry::addFilter(GeometryFilter *filter)
 void Geometry::filter()
 {
 	int num_filters = filters.size();
-	for(int i = 0; i < num_filters; i++)
+	for(int i = 0; i < num_filters; i++) {
+		int usage = filters[i]->getNormalUsage();
+
+		if(usage & FN_REPLACES) {
+			//Look for a later replacement with no reader in between
+			bool superseded = false;
+			for(int j = i + 1; j < num_filters; j++) {
+				int later = filters[j]->getNormalUsage();
+				if(later & FN_REPLACES) {
+					superseded = true;
+					break;
+				}
+
+				if(later & FN_READS)
+					break;
+			}
+
+			if(superseded)
+				continue;
+		}
+
 		filters[i]->run(this);
+		bounds_valid = false;
+
+		//Free the normals that were just replaced
+		if((usage & FN_REPLACES) && (usage & FN_APPENDS))
+			compactNormals();
+	}
+}
+
+//Set the material texture
+void Geometry::setTexture(ProceduralTexture *tex)
+{
+	texture = tex;
+}
+
+//Get the material texture
+ProceduralTexture *Geometry::getTexture()
+{
+	return texture;
+}
+
+//Bind a material to an instance
+void Geometry::writeMaterialBinding(pugi::xml_node instance_node, ProceduralTexture *mat)
+{
+	if(!mat)
+		return;
+
+	//The material symbol is the material id used by the triangles
+	std::string material_id = mat->getMaterialId();
+	pugi::xml_node technique_node = instance_node.append_child("bind_material").append_child("technique_common");
+	pugi::xml_node material_node = technique_node.append_child("instance_material");
+	material_node.append_attribute("symbol") = material_id.c_str();
+	material_node.append_attribute("target") = (std::string("#") + material_id).c_str();
+
+	pugi::xml_node bind_node = material_node.append_child("bind_vertex_input");
+	bind_node.append_attribute("semantic") = "UVSET0";
+	bind_node.append_attribute("input_semantic") = "TEXCOORD";
+	bind_node.append_attribute("input_set") = 0;
 }
 
 //Clears mesh data in the geometry
@@ -784,7 +1773,20 @@ void Geometry::clearMesh()
 	vbuffer_references.clear();
 	normals.clear();
 	nbuffer_references.clear();
+	uvs.clear();
+	uvbuffer_references.clear();
 	triangles.clear();
+	references_valid = true;
+	bounds_valid = false;
+
+	for(unsigned int i = 0; i < channels.size(); i++)
+		delete channels[i];
+	channels.clear();
+
+	//Meshlets refer to the old triangles
+	delete meshlets;
+	meshlets = NULL;
+	topology_valid = false;
 }
 
 //Clones the mesh data into another geometry
@@ -792,6 +1794,7 @@ void Geometry::cloneMesh(Geometry *g)
 {
 	int num_vertices = vertices.size();
 	int num_normals = normals.size();
+	int num_uvs = uvs.size();
 	int num_triangles = triangles.size();
 
 	//Clone each vertex
@@ -802,9 +1805,23 @@ void Geometry::cloneMesh(Geometry *g)
 	for(int i = 0; i < num_normals; i++)
 		g->addNormal(normals[i]);
 
+	//Clone each texture coordinate
+	for(int i = 0; i < num_uvs; i++)
+		g->addUV(uvs[i]);
+
 	//Clone each triangle
 	for(int i = 0; i < num_triangles; i++)
 		g->addTriangle(triangles[i]);
+
+	//Clone each data channel
+	for(unsigned int i = 0; i < channels.size(); i++) {
+		AttributeChannel *channel = channels[i];
+		AttributeChannel *copy = g->addChannel(channel->getName(), channel->getSemantic(), channel->getBinding(), channel->getNumComponents());
+		if(copy && channel->getNumElements())
+			memcpy(copy->getValue(0), channel->getValue(0), channel->getNumElements() * channel->getNumComponents() * sizeof(float));
+	}
+
+	g->texture = texture;
 }
 
 //Set whether object is visible
@@ -819,63 +1836,90 @@ bool Geometry::isVisible()
 	return visible;
 }
 
+//Transform tangents stored with a stride, keeping them unit length and flipping the bitangent sign of mirrored ones
+static void transformTangents(Matrix *m, float *tangents, int count, int stride)
+{
+	float det = m->r0[0] * (m->r1[1] * m->r2[2] - m->r1[2] * m->r2[1]) -
+		m->r0[1] * (m->r1[0] * m->r2[2] - m->r1[2] * m->r2[0]) +
+		m->r0[2] * (m->r1[0] * m->r2[1] - m->r1[1] * m->r2[0]);
+
+	Vector3D tangent;
+	for(int i = 0; i < count; i++) {
+		float *value = tangents + i * stride;
+		tangent.x = value[0];
+		tangent.y = value[1];
+		tangent.z = value[2];
+		m->transformUnitNormals(&tangent, &tangent, 1);
+		value[0] = tangent.x;
+		value[1] = tangent.y;
+		value[2] = tangent.z;
+
+		if(stride == 4 && det < 0.0f)
+			value[3] = -value[3];
+	}
+}
+
 //Combine with another geometry
-void Geometry::combineInto(Geometry *g, Matrix *parent_t)
+void Geometry::combineInto(Geometry *g, Matrix *parent_t, CullingVolume *volume)
+{
+	//Compute total transform, applying this transform before the parent's
+	Matrix total_transform = t.m;
+	if(parent_t != NULL) {
+		total_transform = *parent_t;
+		total_transform.multiply(&t.m);
+	}
+
+	combineTransformedInto(g, &total_transform, volume);
+}
+
+//Combine with another geometry after the transform is complete
+void Geometry::combineTransformedInto(Geometry *g, Matrix *m, CullingVolume *volume)
 {
 	unsigned int g_num_vertices = g->getNumVertices();
 	unsigned int g_num_normals = g->getNumNormals();
+	unsigned int g_num_triangles = g->getNumTriangles();
 
 	unsigned int this_num_vertices = getNumVertices();
 	unsigned int this_num_normals = getNumNormals();
+	unsigned int this_num_uvs = getNumUVs();
 	unsigned int this_num_triangles = getNumTriangles();
 
-	//Compute total transform
-	Matrix total_transform = t.m;
-	if(parent_t != NULL)
-		total_transform.multiply(parent_t);
+	//Skip objects outside the volume before copying anything
+	if(volume) {
+		BoundingBox bounds;
+		getBounds(m, &bounds);
+		if(!volume->intersects(&bounds))
+			return;
+	}
 
-	//Copy over vertices and normals
-	Vector3D cur_vec;
-	for(unsigned int i = 0; i < this_num_vertices; i++)
-	{
-		//Transform and add vertex
-		cur_vec.x = vertices[i].x * total_transform.r0[0];
-		cur_vec.x += vertices[i].y * total_transform.r0[1];
-		cur_vec.x += vertices[i].z * total_transform.r0[2];
-		cur_vec.x += total_transform.r3[0];
-		
-		cur_vec.y = vertices[i].x * total_transform.r1[0];
-		cur_vec.y += vertices[i].y * total_transform.r1[1];
-		cur_vec.y += vertices[i].z * total_transform.r1[2];
-		cur_vec.y += total_transform.r3[1];
-
-		cur_vec.z = vertices[i].x * total_transform.r2[0];
-		cur_vec.z += vertices[i].y * total_transform.r2[1];
-		cur_vec.z += vertices[i].z * total_transform.r2[2];
-		cur_vec.z += total_transform.r3[2];
-
-		g->addVertex(cur_vec);
-	}
-
-	for(unsigned int i = 0; i < this_num_normals; i++)
-	{
-		//Transform and add vertex
-		cur_vec.x = normals[i].x * total_transform.r0[0];
-		cur_vec.x += normals[i].y * total_transform.r0[1];
-		cur_vec.x += normals[i].z * total_transform.r0[2];
-		cur_vec.x += total_transform.r3[0];
-		
-		cur_vec.y = normals[i].x * total_transform.r1[0];
-		cur_vec.y += normals[i].y * total_transform.r1[1];
-		cur_vec.y += normals[i].z * total_transform.r1[2];
-		cur_vec.y += total_transform.r3[1];
+	g->bounds_valid = false;
+
+	//Transform vertices and normals straight into the end of g's buffers
+	g->vertices.resize(g_num_vertices + this_num_vertices);
+	g->vbuffer_references.resize(g_num_vertices + this_num_vertices, 0);
+	g->resizeChannels(AB_VERTEX, g_num_vertices + this_num_vertices);
+	if(this_num_vertices)
+		m->transformPoints(&(vertices[0]), &(g->vertices[g_num_vertices]), this_num_vertices);
+
+	g->normals.resize(g_num_normals + this_num_normals);
+	g->nbuffer_references.resize(g_num_normals + this_num_normals, 0);
+	//Normals use the inverse transpose so they stay perpendicular under non-uniform scale
+	if(this_num_normals) {
+		Matrix normal_transform;
+		m->getNormalMatrix(&normal_transform);
+		normal_transform.transformUnitNormals(&(normals[0]), &(g->normals[g_num_normals]), this_num_normals);
+	}
 
-		cur_vec.z = normals[i].x * total_transform.r2[0];
-		cur_vec.z += normals[i].y * total_transform.r2[1];
-		cur_vec.z += normals[i].z * total_transform.r2[2];
-		cur_vec.z += total_transform.r3[2];
+	//Only append texture coordinates with a value not already appended
+	ScratchArray<int> uv_remap(getScratchArena(), this_num_uvs);
+	HASH_MAP<unsigned long long, int> appended_uvs;
+	for(unsigned int i = 0; i < this_num_uvs; i++) {
+		std::pair<HASH_MAP<unsigned long long, int>::iterator, bool> inserted =
+			appended_uvs.insert(std::make_pair(uvKey(uvs[i]), (int)g->getNumUVs()));
+		if(inserted.second)
+			g->addUV(uvs[i]);
 
-		g->addNormal(cur_vec);
+		uv_remap[i] = inserted.first->second;
 	}
 
 	//Copy over triangles
@@ -893,6 +1937,57 @@ void Geometry::combineInto(Geometry *g, Matrix *parent_t)
 		cur_tri.vertices[1] += g_num_vertices;
 		cur_tri.vertices[2] += g_num_vertices;
 
+		cur_tri.uvs[0] = uv_remap[cur_tri.uvs[0]];
+		cur_tri.uvs[1] = uv_remap[cur_tri.uvs[1]];
+		cur_tri.uvs[2] = uv_remap[cur_tri.uvs[2]];
+
 		g->addTriangle(cur_tri);
 	}
+
+	//Copy each data channel, adding it to g first if g does not have it
+	for(unsigned int i = 0; i < channels.size(); i++) {
+		AttributeChannel *channel = channels[i];
+		int num_components = channel->getNumComponents();
+		int count = channel->getNumElements();
+		AttributeChannel *dest = g->addChannel(channel->getName(), channel->getSemantic(), channel->getBinding(), num_components);
+		if(!dest || count == 0)
+			continue;
+
+		int first = channel->getBinding() == AB_VERTEX ? g_num_vertices : g_num_triangles * 3;
+		memcpy(dest->getValue(first), channel->getValue(0), count * num_components * sizeof(float));
+
+		//Tangents turn with the surface
+		if(channel->getSemantic() == AS_TANGENT && num_components >= 3)
+			transformTangents(m, dest->getValue(first), count, num_components);
+	}
+}
+
+//Partition the mesh into meshlets
+void Geometry::partition(unsigned int max_vertices, unsigned int max_triangles)
+{
+	//Drop old meshlets first so cleaning up does not rebuild them
+	delete meshlets;
+	meshlets = NULL;
+	cleanUp();
+
+	meshlets = new MeshletSet();
+	meshlets->build(this, max_vertices, max_triangles);
+}
+
+//Get the meshlets
+MeshletSet *Geometry::getMeshlets()
+{
+	return meshlets;
+}
+
+//Set whether vertex data is quantized
+void Geometry::setQuantized(bool q)
+{
+	quantized = q;
+}
+
+//Get the error of the last quantized save
+QuantizationError Geometry::getQuantizationError()
+{
+	return quantization_error;
 }
@@ -28,6 +28,12 @@
 #include "Transform.h"
 #include "GeometryFilter.h"
 #include "CSource.h"
+#include "MeshletSet.h"
+#include "Quantize.h"
+#include "MemoryArena.h"
+#include "MeshTopology.h"
+#include "AttributeChannel.h"
+#include "CullingVolume.h"
 
 /**
  * @brief Stores information about a single triangle
@@ -35,10 +41,17 @@
 typedef struct {
 	int vertices[3];
 	int normals[3];
-
-	Vector2D uvs[3];
+	int uvs[3];
 } Triangle;
 
+/**
+ * @brief Buffer types used for mesh storage. Allocated from the owning scene's arena if there is one.
+ */
+typedef std::vector<Vector3D, ArenaAllocator<Vector3D> > Vector3DBuffer;
+typedef std::vector<Vector2D, ArenaAllocator<Vector2D> > Vector2DBuffer;
+typedef std::vector<Triangle, ArenaAllocator<Triangle> > TriangleBuffer;
+typedef std::vector<int, ArenaAllocator<int> > ReferenceBuffer;
+
 /**
  * @brief Defines the different types of per vertex data
  */
@@ -49,6 +62,7 @@ enum vertex_data_type {
 };
 
 class Scene;
+class ProceduralTexture;
 
 /**
  * @brief Base class for all geometric objects
@@ -64,39 +78,76 @@ private:
 	 * Vertex buffer storage
 	 * An array of vertices referenced by triangles
 	 */
-	std::vector<Vector3D> vertices;
+	Vector3DBuffer vertices;
 
 	/**
 	 * Reference counters for the vertex buffer
 	 * Keeps track of which vertices are in use so that garbage collection can be performed.
 	 */
-	std::vector<int> vbuffer_references;
+	ReferenceBuffer vbuffer_references;
 
 	/**
 	 * Normal buffer storage
 	 * An array of normals referenced by triangles
 	 */
-	std::vector<Vector3D> normals;
+	Vector3DBuffer normals;
 
 	/**
 	 * Reference counters for the normal buffer
 	 */
-	std::vector<int> nbuffer_references;
+	ReferenceBuffer nbuffer_references;
+
+	/**
+	 * Texture coordinate buffer storage
+	 * An array of uv coordinates referenced by triangles
+	 */
+	Vector2DBuffer uvs;
+
+	/**
+	 * Reference counters for the texture coordinate buffer
+	 */
+	ReferenceBuffer uvbuffer_references;
 
 	/**
 	 * Triangle buffer storage
 	 * An array of triangles in the geometry.
 	 */
-	std::vector<Triangle> triangles;
+	TriangleBuffer triangles;
+
+	/**
+	 * Extra data channels such as tangents, colors and texture coordinate sets
+	 * Each is kept sized to the vertex buffer or to three corners per triangle.
+	 */
+	std::vector<AttributeChannel*> channels;
 
 	std::string name;		/**< Name of the object used when saving. */
 
+	MemoryArena *arena;		/**< Arena the object and its buffers are allocated from or NULL for the heap. */
+
 	int id;					/**< ID number of this object. */
 
 	std::string unique_id;	/**< Concatenation of name and id used for COLLADA unique id. */
 
 	bool visible;			/**< If visible is false, this geometry is purely used as a base for instancing. */
 
+	MeshletSet *meshlets;	/**< Cluster partitioning of the mesh or NULL if not partitioned. */
+
+	MeshTopology *topology;	/**< Connectivity of the triangles or NULL if never built. */
+	bool topology_valid;	/**< False if triangles changed since the topology was built. */
+
+	bool references_valid;	/**< False if triangles were edited in place since the reference counts were last recounted. */
+
+	BoundingBox local_bounds;	/**< Bounds of the vertex buffer. */
+	bool bounds_valid;			/**< False if vertices may have changed since local_bounds was computed. */
+
+	bool referenced;		/**< Set when a culled save writes an instance of this mesh and cleared when the mesh is saved. */
+
+	ProceduralTexture *texture;	/**< Material of the mesh or NULL for none. Owned by the scene. */
+
+	bool quantized;			/**< If quantized is true, vertex data is saved as 16 bit integers. */
+
+	QuantizationError quantization_error;	/**< Error introduced by the last quantized save. */
+
 	/**
 	 * Writes a vertex data array of this geometry to a COLLADA source node
 	 * @param root pugixml node to add the source node to
@@ -104,6 +155,28 @@ private:
 	 */
 	void writeVertexData(pugi::xml_node root, vertex_data_type data_type);
 
+	/**
+	 * Rebuilds the vertex, normal and texture coordinate reference counts in
+	 * one pass over the triangles
+	 */
+	void recountReferences();
+
+	/**
+	 * Resizes every channel with a binding
+	 * @param binding Binding of the channels to resize
+	 * @param count New number of elements
+	 */
+	void resizeChannels(attribute_binding binding, int count);
+
+	/**
+	 * Writes a vertex data array of this geometry as quantized integers.
+	 * Positions and uvs are stored as 16 bit unorm relative to the mesh bounds and
+	 * normals are stored as two 16 bit snorm octahedral components.
+	 * @param root pugixml node to add the source node to
+	 * @param data_type the type of per vertex data to create a source for
+	 */
+	void writeQuantizedVertexData(pugi::xml_node root, vertex_data_type data_type);
+
 	/**
 	 * Writes the triangle data to a COLLADA triangles node
 	 * @param root pugixml node to add the triangles to
@@ -113,14 +186,26 @@ private:
 	/**
 	 * Copies source data to vertex buffer
 	 * @param source The source containing vertex positions
+	 * @return Returns 0 if no errors occur. Fails if the source is not float
+	 * data, such as an integer array with an unknown encoding
 	 */
-	void copyVertexData(CSource *source);
+	int copyVertexData(CSource *source);
 
 	/**
 	 * Copies source data to normal buffer
 	 * @param source The source containing normal vectors
+	 * @return Returns 0 if no errors occur. Fails if the source is not float
+	 * data, such as an integer array with an unknown encoding
+	 */
+	int copyNormalData(CSource *source);
+
+	/**
+	 * Copies source data to texture coordinate buffer
+	 * @param source The source containing texture coordinates
+	 * @return Returns 0 if no errors occur. Fails if the source is not float
+	 * data, such as an integer array with an unknown encoding
 	 */
-	void copyNormalData(CSource *source);
+	int copyUVData(CSource *source);
 
 protected:
 	/**
@@ -130,11 +215,49 @@ protected:
 
 	Transform t;			/**< World space transform for this geometric object. */
 
+	/**
+	 * Binds a texture's material to the triangles of an instance
+	 * @param instance_node The instance_geometry node
+	 * @param mat The texture to bind or NULL for none
+	 */
+	void writeMaterialBinding(pugi::xml_node instance_node, ProceduralTexture *mat);
+
 public:
 	Geometry();						/**< Constructs an empty geometry. */
 	Geometry(const char *iname);	/**< Constructs object with different name. */
 
-	~Geometry();					/**< Destructor. */
+	/**
+	 * Constructs a named object whose buffers are allocated from an arena.
+	 * The object itself must be allocated with new(iarena).
+	 * @param iname Name of the object
+	 * @param iarena Arena to allocate from or NULL for the heap
+	 */
+	Geometry(const char *iname, MemoryArena *iarena);
+
+	virtual ~Geometry();			/**< Destructor. */
+
+	static void *operator new(size_t size);							/**< Allocates an object from the heap. */
+	static void *operator new(size_t size, MemoryArena *iarena);	/**< Allocates an object from an arena or the heap if NULL. */
+	static void operator delete(void *p);							/**< Frees an object allocated from the heap. */
+	static void operator delete(void *p, MemoryArena *iarena);		/**< Frees an arena object if its constructor throws. */
+
+	/**
+	 * Destroys an object allocated with either form of new
+	 * @param g The object to destroy. Arena memory is released when the arena is reset
+	 */
+	static void destroy(Geometry *g);
+
+	/**
+	 * Gets the arena this object allocates from
+	 * @return The arena or NULL if the object uses the heap
+	 */
+	MemoryArena *getArena();
+
+	/**
+	 * Gets the arena filters should use for temporary data
+	 * @return The scratch arena or NULL if the object uses the heap
+	 */
+	MemoryArena *getScratchArena();
 
 	/**
 	 * Get the unique id string for this object
@@ -162,11 +285,64 @@ public:
 	 */
 	int addTriangle(Triangle t);
 
+	/**
+	 * Reserves space for triangles that are about to be added
+	 * @param count Number of triangles that will be added
+	 */
+	void reserveTriangles(int count);
+
+	/**
+	 * Grows every buffer so a generator can fill the mesh in place through
+	 * getVertex, getNormal, getUV and editTriangles, possibly from several
+	 * threads. New entries are zeroed and reference counting stops as it does
+	 * for editTriangles
+	 * @param num_vertices Number of vertices the buffer will hold
+	 * @param num_normals Number of normals the buffer will hold
+	 * @param num_uvs Number of texture coordinates the buffer will hold
+	 * @param num_triangles Number of triangles the buffer will hold
+	 */
+	void resizeBuffers(int num_vertices, int num_normals, int num_uvs, int num_triangles);
+
+	/**
+	 * Gets the half-edge connectivity of the mesh, building it if the triangles
+	 * changed since it was last built. Changing the vertices of a triangle with
+	 * addTriangle or setTriangle, or calling editTriangles, invalidates it.
+	 * @return The topology, owned by the geometry
+	 */
+	MeshTopology *getTopology();
+
+	/**
+	 * Calculates the unit normal of every triangle. Degenerate triangles get a
+	 * zero normal
+	 * @param face_normals Array to fill, one entry per triangle
+	 */
+	void getFaceNormals(Vector3D *face_normals);
+
 	/**
 	 * Cleans up a model before saving
-	 * Removes unused vertices from the buffer
+	 * Removes unused vertices, normals and texture coordinates from the buffers
 	 */
-	void cleanUp();
+	virtual void cleanUp();
+
+	/**
+	 * Removes normals no triangle refers to, leaving the other buffers alone
+	 */
+	void compactNormals();
+
+	/**
+	 * Merges texture coordinates with equal values into one entry and points
+	 * every triangle at the entry it keeps, leaving the other buffers alone
+	 */
+	void mergeUVs();
+
+	/**
+	 * Replaces the whole normal buffer and every triangle's normal indices,
+	 * recounting references in one pass
+	 * @param new_normals The new normals
+	 * @param count Number of new normals
+	 * @param corner_normals Index of the normal for corner k of triangle t at 3 * t + k
+	 */
+	void replaceNormals(const Vector3D *new_normals, int count, const int *corner_normals);
 
 	/**
 	 * Saves the geometry in COLLADA format to the file specified
@@ -175,19 +351,60 @@ public:
 	 */
 	virtual int saveGeometry(pugi::xml_node root);
 
+	/**
+	 * Saves the geometry only if a culled save wrote an instance of it since
+	 * it was last saved this way
+	 * @param root Pointer to a pugixml node to write geometry in
+	 * @return Returns 0 if no errors occur
+	 */
+	virtual int saveReferencedGeometry(pugi::xml_node root);
+
+	/**
+	 * Records that an instance of this mesh was written by a culled save, so
+	 * saveReferencedGeometry saves it
+	 */
+	void markReferenced();
+
 	/**
 	 * Saves an instance node in COLLADA format to the scene
 	 * @param root The scene element to add the node to
 	 * @param id Unique suffix to place after the name of the node
 	 * @param parent The transform on the parent object
+	 * @param volume Objects whose world bounds are outside this volume are
+	 * skipped, or NULL to save everything
 	 * @return Returns 0 if no errors occur
 	 */
-	virtual int saveInstance(pugi::xml_node root, int *id, Transform *parent);
+	virtual int saveInstance(pugi::xml_node root, int *id, Transform *parent, CullingVolume *volume);
+
+	/**
+	 * Gets the bounds of every vertex in the buffer, in the object's own space
+	 * @details Cached until the vertex buffer is resized, cleaned up or
+	 * filtered. Code that moves vertices through getVertex outside a filter
+	 * must call invalidateBounds.
+	 * @return The bounds, empty if there are no vertices
+	 */
+	BoundingBox *getLocalBounds();
+
+	/**
+	 * Marks the cached bounds as stale after vertices were moved in place
+	 */
+	void invalidateBounds();
+
+	/**
+	 * Bounds the object's contents after a transform. The object's own
+	 * transform is not applied.
+	 * @param m Transform to apply to the contents
+	 * @param bounds Receives the axis aligned bounds
+	 */
+	virtual void getBounds(Matrix *m, BoundingBox *bounds);
 
 	/**
 	 * Read mesh data from a COLLADA node into the object's buffers
+	 * @details Integer sources written by a quantized save are decoded with
+	 * the offset and scale stored in their ShockShapes technique
 	 * @param node The COLLADA geometry node to read the mesh from
-	 * @return Returns 0 if no errors occur
+	 * @return Returns 0 if no errors occur. Returns 3 if a position, normal or
+	 * texture coordinate source holds integers that cannot be decoded
 	 */
 	virtual int readGeometry(pugi::xml_node root);
 
@@ -200,6 +417,10 @@ public:
 
 	/**
 	 * Runs filters on the geometry
+	 * @details A filter that replaces all normals is skipped when a later
+	 * filter replaces them again before any filter reads them. After each
+	 * replacement the superseded normals are freed, so the normal buffer
+	 * does not keep growing until cleanUp.
 	 */
 	virtual void filter();
 
@@ -216,6 +437,17 @@ public:
 	 */
 	void setTriangle(int id, Triangle t);
 
+	/**
+	 * Gets the triangle buffer for editing indices in place
+	 * @details Per triangle reference counting stops until the counts are
+	 * next needed, when they are rebuilt in a single pass, so addTriangle and
+	 * setTriangle also skip it meanwhile. The topology is invalidated, so get
+	 * it before editing and do not rely on getTopology until editing is done.
+	 * @return The first triangle, or NULL if there are none. Adding triangles
+	 * may move the buffer, after which triangles must be fetched again
+	 */
+	Triangle *editTriangles();
+
 	/**
 	 * Gets the total number of triangles in the mesh
 	 * @return The number of triangles in the mesh
@@ -262,6 +494,67 @@ public:
 	 */
 	int addNormal(Vector3D n);
 
+	/**
+	 * Gets the total number of texture coordinates
+	 * @return The number of texture coordinates stored
+	 */
+	int getNumUVs();
+
+	/**
+	 * Gets a texture coordinate
+	 * @param index The index of the texture coordinate to return
+	 * @return A pointer to the texture coordinate at the specified index
+	 */
+	Vector2D *getUV(int index);
+
+	/**
+	 * Adds a texture coordinate to the buffer
+	 * @param uv The texture coordinate to add
+	 * @return The index of the added texture coordinate in the buffer
+	 */
+	int addUV(Vector2D uv);
+
+	/**
+	 * Adds a data channel sized to the current mesh and zero filled, or gets
+	 * the existing channel with the same name
+	 * @param name Name of the channel, also used in the id of its saved source
+	 * @param semantic Meaning of the data
+	 * @param binding Whether the channel has an element per vertex or per triangle corner
+	 * @param num_components Floats in each element, from 1 to ATTRIBUTE_MAX_COMPONENTS
+	 * @return The channel, or NULL if num_components is out of range or a
+	 * channel with the same name has a different layout
+	 */
+	AttributeChannel *addChannel(const char *name, attribute_semantic semantic, attribute_binding binding, int num_components);
+
+	/**
+	 * Finds a data channel by name
+	 * @param name Name of the channel
+	 * @return The channel or NULL if there is none with that name
+	 */
+	AttributeChannel *findChannel(const char *name);
+
+	/**
+	 * Gets the number of data channels
+	 * @return The number of channels
+	 */
+	int getNumChannels();
+
+	/**
+	 * Gets a data channel
+	 * @param index Index of the channel, in the order they were added
+	 * @return The channel
+	 */
+	AttributeChannel *getChannel(int index);
+
+	/**
+	 * Sets a vertex's element in every per vertex channel to the average of
+	 * other vertices' elements
+	 * @param index The vertex to set
+	 * @param sources The vertices to average
+	 * @param count Number of sources
+	 */
+	void averageVertexChannels(int index, const int *sources, int count);
+
 	/**
 	 * Gets the transform so the user can modify it
 	 * @return A pointer to this object's transform
@@ -269,12 +562,32 @@ public:
 	Transform *getTransform();
 
 	/**
-	 * Clears the mesh data stored in the object
+	 * Brings the cached world matrix of this object and everything under it
+	 * up to date, so saving afterwards only reads the caches
+	 * @param parent The transform on the parent object, or NULL at the top
+	 */
+	virtual void updateWorldMatrices(Transform *parent);
+
+	/**
+	 * Sets the texture used as the material of this object. The texture must
+	 * also be added to the scene so it is saved with it
+	 * @param tex The texture or NULL for no material
+	 */
+	void setTexture(ProceduralTexture *tex);
+
+	/**
+	 * Gets the texture used as the material of this object
+	 * @return The texture or NULL if there is none
+	 */
+	ProceduralTexture *getTexture();
+
+	/**
+	 * Clears the mesh data stored in the object, including its data channels
 	 */
 	void clearMesh();
 
 	/**
-	 * Clones the mesh data into another empty geometry object
+	 * Clones the mesh data and texture into another empty geometry object
 	 * @param g The geometry to clone into. Must be an empty mesh.
 	 */
 	void cloneMesh(Geometry *g);
@@ -282,9 +595,22 @@ public:
 	/**
 	 * Combines this mesh with another geometric object
 	 * @param g Geometry to copy this object to
-	 * @param t Transform to apply to this mesh
+	 * @param parent_t Transform of the parent, applied after this object's
+	 * own, or NULL for none
+	 * @param volume Objects whose transformed bounds are outside this volume
+	 * are skipped, or NULL to combine everything
+	 */
+	void combineInto(Geometry *g, Matrix *parent_t, CullingVolume *volume);
+
+	/**
+	 * Combines this object with another geometric object once its own
+	 * transform has been applied
+	 * @param g Geometry to copy this object to
+	 * @param m Complete transform from this object's space to g's
+	 * @param volume Objects whose transformed bounds are outside this volume
+	 * are skipped, or NULL to combine everything
 	 */
-	virtual void combineInto(Geometry *g, Matrix *parent_t);
+	virtual void combineTransformedInto(Geometry *g, Matrix *m, CullingVolume *volume);
 
 	/**
 	 * Sets whether the object is visible or not
@@ -297,6 +623,32 @@ public:
 	 * @return True if visible
 	 */
 	bool isVisible();
+
+	/**
+	 * Partitions the mesh into meshlets which are saved with the geometry.
+	 * Cleans up the mesh first so the meshlets only cover used vertices
+	 * @param max_vertices Maximum number of vertices in a meshlet
+	 * @param max_triangles Maximum number of triangles in a meshlet
+	 */
+	virtual void partition(unsigned int max_vertices, unsigned int max_triangles);
+
+	/**
+	 * Gets the meshlets built by partition
+	 * @return Pointer to the meshlets or NULL if the mesh has not been partitioned
+	 */
+	MeshletSet *getMeshlets();
+
+	/**
+	 * Sets whether vertex data is quantized when saved
+	 * @param q True to save 16 bit integer vertex data
+	 */
+	virtual void setQuantized(bool q);
+
+	/**
+	 * Gets the error introduced by the last quantized save
+	 * @return The largest position, normal and uv errors
+	 */
+	QuantizationError getQuantizationError();
 };
 
 #endif
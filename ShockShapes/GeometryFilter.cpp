@@ -81,3 +81,9 @@ void GeometryFilter::run(Geometry *g)
 {
 
 }
+
+//Assume the worst about normals
+int GeometryFilter::getNormalUsage()
+{
+	return FN_READS | FN_APPENDS;
+}
@@ -57,6 +57,18 @@ public:
 	float sample();
 };
 
+/**
+ * @brief Flags describing how a filter uses the normal buffer
+ * @details Geometry::filter uses these to skip normal passes whose results
+ * are replaced before anything reads them, and to free the normals a
+ * replacing pass leaves unreferenced.
+ */
+enum filter_normal_usage {
+	FN_READS = 1,		/**< Reads existing normals. */
+	FN_APPENDS = 2,		/**< Adds normals to the buffer. */
+	FN_REPLACES = 4		/**< Gives every corner a new normal computed from positions alone and changes nothing else. */
+};
+
 /**
  * @brief Base class for all objects that modify (filter) geometry
  * @details Stores parameters which can be set up with
@@ -78,6 +90,13 @@ public:
 	 * @param g The object to apply the filter to
 	 */
 	virtual void run(Geometry *g);
+
+	/**
+	 * Describes how the filter uses normals. Filters that do not override
+	 * this are assumed to both read and add normals.
+	 * @return Combination of filter_normal_usage flags
+	 */
+	virtual int getNormalUsage();
 };
 
 #endif
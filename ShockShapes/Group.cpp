@@ -29,10 +29,18 @@ Group::Group(const char *name)
 
 }
 
+//Named constructor using an arena
+Group::Group(const char *name, MemoryArena *iarena)
+:Geometry(name, iarena), objects(ArenaAllocator<Geometry*>(iarena))
+{
+
+}
+
 //Destructor
 Group::~Group()
 {
-
+	for(unsigned int i = 0; i < objects.size(); i++)
+		Geometry::destroy(objects[i]);
 }
 
 //Add an object to the group
@@ -56,20 +64,42 @@ int Group::saveGeometry(pugi::xml_node root)
 	return 0;
 }
 
+//Save the referenced geometry of the group
+int Group::saveReferencedGeometry(pugi::xml_node root)
+{
+	int num_objects = objects.size();
+	int result;
+
+	for(int i = 0; i < num_objects; i++) {
+		if((result = objects[i]->saveReferencedGeometry(root)))
+			return result;
+	}
+
+	return 0;
+}
+
 //Save instances in the group
-int Group::saveInstance(pugi::xml_node root, int *id, Transform *parent)
+int Group::saveInstance(pugi::xml_node root, int *id, Transform *parent, CullingVolume *volume)
 {
 	int num_objects = objects.size();
 	int result;
 
-	//Compound parent transform into the group's transform
-	Transform total_t(t);
-	if(parent)
-		total_t.combine(parent);
+	//Bring the group's world matrix up to date before its children use it
+	Matrix *world = t.getWorldMatrix(parent);
+
+	//Skip the whole group if it is outside the volume
+	if(volume) {
+		BoundingBox bounds;
+		getBounds(world, &bounds);
+		if(!volume->intersects(&bounds))
+			return 0;
+	}
+
+	updateObjectWorldMatrices();
 
 	//Iterates through each sub-object and calls its save
 	for(int i = 0; i < num_objects; i++) {
-		if(result = objects[i]->saveInstance(root, id, &total_t))
+		if(result = objects[i]->saveInstance(root, id, &t, volume))
 			return result;
 	}
 
@@ -87,8 +117,10 @@ void Group::filter()
 	//Filter all objects under the group filters
 	int num_filters = filters.size();
 	for(int i = 0; i < num_filters; i++)
-		for(int j = 0; j < num_objects; j++)
+		for(int j = 0; j < num_objects; j++) {
 			filters[i]->run(objects[j]);
+			objects[j]->invalidateBounds();
+		}
 }
 
 //Generates all sub objects
@@ -100,14 +132,94 @@ void Group::generate(int seed, Scene *scene)
 }
 
 //Override combine
-void Group::combineInto(Geometry *g, Matrix *parent_t)
+void Group::combineTransformedInto(Geometry *g, Matrix *m, CullingVolume *volume)
 {
-	//Compute total transform
-	Matrix total_transform = t.m;
-	if(parent_t != NULL)
-		total_transform.multiply(parent_t);
+	//Skip the whole group if it is outside the volume
+	if(volume) {
+		BoundingBox bounds;
+		getBounds(m, &bounds);
+		if(!volume->intersects(&bounds))
+			return;
+	}
 
 	//Combine each sub object with g
+	ScratchArray<Matrix> transforms(getScratchArena(), objects.size());
+	getObjectTransforms(m, transforms.get());
+	for(unsigned int i = 0; i < objects.size(); i++)
+		objects[i]->combineTransformedInto(g, &transforms[i], volume);
+}
+
+//Bound every sub object
+void Group::getBounds(Matrix *m, BoundingBox *bounds)
+{
+	BoundingBox object_bounds;
+	CullingVolume::emptyBounds(bounds);
+
+	ScratchArray<Matrix> transforms(getScratchArena(), objects.size());
+	getObjectTransforms(m, transforms.get());
+	for(unsigned int i = 0; i < objects.size(); i++) {
+		objects[i]->getBounds(&transforms[i], &object_bounds);
+		CullingVolume::expandBounds(bounds, &object_bounds);
+	}
+}
+
+//Multiply a matrix by each sub object's transform
+void Group::getObjectTransforms(Matrix *m, Matrix *results)
+{
+	int num_objects = objects.size();
+	for(int i = 0; i < num_objects; i++)
+		results[i] = objects[i]->getTransform()->m;
+
+	Matrix::multiplyArray(m, results, results, num_objects);
+}
+
+//Update the world matrix of each sub object
+void Group::updateObjectWorldMatrices()
+{
+	int num_objects = objects.size();
+
+	//Gather in fixed batches so saving never touches the shared scratch arena
+	Transform *transforms[TRANSFORM_BATCH_SIZE];
+	for(int first = 0; first < num_objects; first += TRANSFORM_BATCH_SIZE) {
+		int count = num_objects - first;
+		if(count > TRANSFORM_BATCH_SIZE)
+			count = TRANSFORM_BATCH_SIZE;
+
+		for(int i = 0; i < count; i++)
+			transforms[i] = objects[first + i]->getTransform();
+
+		Transform::updateWorldMatrices(&t, transforms, count);
+	}
+}
+
+//Update the cached world matrices of the group and everything in it
+void Group::updateWorldMatrices(Transform *parent)
+{
+	t.getWorldMatrix(parent);
+	updateObjectWorldMatrices();
+
+	int num_objects = objects.size();
+	for(int i = 0; i < num_objects; i++)
+		objects[i]->updateWorldMatrices(&t);
+}
+
+//Clean up each sub object
+void Group::cleanUp()
+{
+	for(unsigned int i = 0; i < objects.size(); i++)
+		objects[i]->cleanUp();
+}
+
+//Partition each sub object
+void Group::partition(unsigned int max_vertices, unsigned int max_triangles)
+{
+	for(unsigned int i = 0; i < objects.size(); i++)
+		objects[i]->partition(max_vertices, max_triangles);
+}
+
+//Set quantization of each sub object
+void Group::setQuantized(bool q)
+{
 	for(unsigned int i = 0; i < objects.size(); i++)
-		objects[i]->combineInto(g, &total_transform);
+		objects[i]->setQuantized(q);
 }
@@ -26,17 +26,37 @@
  * which can be transformed as a single object
  */
 class Group : public Geometry {
-private:
+protected:
 	/**
 	 * An array of the objects that make up this group
 	 */
-	std::vector<Geometry*> objects;
+	std::vector<Geometry*, ArenaAllocator<Geometry*> > objects;
+
+	/**
+	 * Multiplies a matrix by the transform of every sub-object in one batch
+	 * @param m Transform of the group
+	 * @param results Receives m times each sub-object's transform, one per sub-object
+	 */
+	void getObjectTransforms(Matrix *m, Matrix *results);
+
+	/**
+	 * Brings the cached world matrix of every sub-object up to date in one
+	 * batch. The group's own world matrix must already be up to date
+	 */
+	void updateObjectWorldMatrices();
 
 public:
 	Group();					/**< Constructor for an empty group. */
 	Group(const char* name);	/**< Constructor for an empty named group. */
 
-	~Group();					/**< Destructor. */
+	/**
+	 * Constructor for an empty named group allocated from an arena
+	 * @param name Name of the group
+	 * @param iarena Arena to allocate from or NULL for the heap
+	 */
+	Group(const char* name, MemoryArena *iarena);
+
+	~Group();					/**< Destructor. Destroys all objects in the group. */
 
 	/**
 	 * Saves the objects in COLLADA format to the file specified
@@ -45,13 +65,37 @@ public:
 	 */
 	virtual int saveGeometry(pugi::xml_node root);
 
+	/**
+	 * Saves each sub-object that a culled save wrote an instance of
+	 * @param root Pointer to a pugixml node to write geometry in
+	 * @return Returns 0 if no errors occur
+	 */
+	virtual int saveReferencedGeometry(pugi::xml_node root);
+
 	/**
 	 * Saves an instance node in COLLADA format to the scene
 	 * @param root The scene element to add the node to
 	 * @param id Unique suffix to place after the name of the node
+	 * @param parent The transform on the parent object
+	 * @param volume The whole group is skipped if the union of its
+	 * sub-objects' world bounds is outside this volume, and each sub-object
+	 * is culled in turn otherwise. NULL saves everything
 	 * @return Returns 0 if no errors occur
 	 */
-	virtual int saveInstance(pugi::xml_node root, int *id, Transform *parent);
+	virtual int saveInstance(pugi::xml_node root, int *id, Transform *parent, CullingVolume *volume);
+
+	/**
+	 * Brings the cached world matrices of the group and everything in it up to date
+	 * @param parent The transform on the parent object, or NULL at the top
+	 */
+	virtual void updateWorldMatrices(Transform *parent);
+
+	/**
+	 * Bounds every sub-object after a transform
+	 * @param m Transform to apply to the group's contents
+	 * @param bounds Receives the axis aligned bounds
+	 */
+	virtual void getBounds(Matrix *m, BoundingBox *bounds);
 
 	/**
 	 * Runs filters on each sub-object in the group
@@ -59,7 +103,7 @@ public:
 	virtual void filter();
 
 	/**
-	 * Adds a geometric object to this group
+	 * Adds a geometric object to this group. The group takes ownership of the object.
 	 * @param g The object to add to this group
 	 */
 	void addObject(Geometry *g);
@@ -74,9 +118,29 @@ public:
 	/**
 	 * Combines a group into another geometry
 	 * @param g Geometry to combine into
-	 * @param t Transform to apply to this geometry
+	 * @param m Complete transform from the group's space to g's
+	 * @param volume The whole group is skipped if its transformed bounds are
+	 * outside this volume, or NULL to combine everything
+	 */
+	virtual void combineTransformedInto(Geometry *g, Matrix *m, CullingVolume *volume);
+
+	/**
+	 * Cleans up each sub-object
+	 */
+	virtual void cleanUp();
+
+	/**
+	 * Partitions each sub-object into meshlets
+	 * @param max_vertices Maximum number of vertices in a meshlet
+	 * @param max_triangles Maximum number of triangles in a meshlet
+	 */
+	virtual void partition(unsigned int max_vertices, unsigned int max_triangles);
+
+	/**
+	 * Sets whether each sub-object is quantized when saved
+	 * @param q True to save 16 bit integer vertex data
 	 */
-	virtual void combineInto(Geometry *g, Matrix *parent_t);
+	virtual void setQuantized(bool q);
 };
 
 #endif
@@ -0,0 +1,28 @@
+/** @file HashMap.h
+ *
+ * @brief Selects the hash map available on the current compiler
+ *
+ * Copyright 2013, Stewart Hall
+ *
+ * Licensed under The MIT License
+ * Redistributions of files must retain the above copyright notice.
+ *
+ * @author		Stewart Hall (www.stewartghall.com)
+ * @date		10/18/2026
+ * @copyright	Copyright 2013, Stewart Hall
+ * @license		MIT License (http://www.opensource.org/licenses/mit-license.php)
+ */
+
+#ifndef _HASHMAP_
+#define _HASHMAP_
+
+#include <unordered_map>
+
+//Visual Studio 2008 only provides the TR1 hash map
+#if defined(_MSC_VER) && _MSC_VER < 1600
+#define HASH_MAP std::tr1::unordered_map
+#else
+#define HASH_MAP std::unordered_map
+#endif
+
+#endif
@@ -0,0 +1,78 @@
+/** @file IdIndex.h
+ *
+ * @brief Hash table for finding COLLADA elements by their id attribute
+ *
+ * Copyright 2013, Stewart Hall
+ *
+ * Licensed under The MIT License
+ * Redistributions of files must retain the above copyright notice.
+ *
+ * @author		Stewart Hall (www.stewartghall.com)
+ * @date		10/18/2026
+ * @copyright	Copyright 2013, Stewart Hall
+ * @license		MIT License (http://www.opensource.org/licenses/mit-license.php)
+ */
+
+#ifndef _IDINDEX_
+#define _IDINDEX_
+
+#include <string>
+#include <utility>
+
+#include "HashMap.h"
+
+/**
+ * @brief Maps id strings to the objects that own them
+ * @details Ids are compared without a leading # so the same index can be
+ * searched with either an id attribute or a url. When two objects share an
+ * id the first one added is kept, matching a front to back linear search.
+ */
+template <class T>
+class IdIndex {
+private:
+	HASH_MAP<std::string, T*> table;	/**< Objects keyed by id. */
+
+	//Skip the # at the start of a url
+	static const char *trimUrl(const char *id)
+	{
+		if(id[0] == '#')
+			return &(id[1]);
+
+		return id;
+	}
+
+public:
+	/**
+	 * Adds an object to the index
+	 * @param id The object's id
+	 * @param obj The object
+	 */
+	void add(const char *id, T *obj)
+	{
+		table.insert(std::make_pair(std::string(trimUrl(id)), obj));
+	}
+
+	/**
+	 * Finds an object by id
+	 * @param id The id or url to search for
+	 * @return Pointer to the object or NULL if there is no object with the id
+	 */
+	T *find(const char *id) const
+	{
+		typename HASH_MAP<std::string, T*>::const_iterator it = table.find(std::string(trimUrl(id)));
+		if(it == table.end())
+			return NULL;
+
+		return it->second;
+	}
+
+	/**
+	 * Removes all objects from the index
+	 */
+	void clear()
+	{
+		table.clear();
+	}
+};
+
+#endif
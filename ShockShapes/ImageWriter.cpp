@@ -0,0 +1,523 @@
+/** @file ImageWriter.cpp
+ *
+ * @brief Writes PNG and raw images a few rows at a time
+ *
+ * Copyright 2013, Stewart Hall
+ *
+ * Licensed under The MIT License
+ * Redistributions of files must retain the above copyright notice.
+ *
+ * @author		Stewart Hall (www.stewartghall.com)
+ * @date		10/18/2026
+ * @copyright	Copyright 2013, Stewart Hall
+ * @license		MIT License (http://www.opensource.org/licenses/mit-license.php)
+ */
+
+#include <string.h>
+
+#include "ImageWriter.h"
+
+//Largest block of uncompressed data a deflate stream can hold
+#define STORED_BLOCK_SIZE 65535
+
+//Largest number of bytes that can be summed before the Adler-32 sums overflow
+#define ADLER_MAX_RUN 5552
+
+//How far back a deflate match can reach
+#define DEFLATE_WINDOW 32768
+
+//Shortest and longest deflate matches
+#define DEFLATE_MIN_MATCH 3
+#define DEFLATE_MAX_MATCH 258
+
+//Number of 3 byte hashes and earlier positions tried when looking for a match
+#define DEFLATE_HASH_SIZE 32768
+#define DEFLATE_MAX_CHAIN 16
+
+//Deflate length and distance codes
+static const int length_bases[29] = {3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31,
+	35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258};
+static const int length_extra[29] = {0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2,
+	3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0};
+static const int distance_bases[30] = {1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193,
+	257, 385, 513, 769, 1025, 1537, 2049, 3073, 4097, 6145, 8193, 12289, 16385, 24577};
+static const int distance_extra[30] = {0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6,
+	7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13};
+
+//Append a 32 bit big endian integer
+static void appendInt(std::vector<unsigned char> *data, unsigned int value)
+{
+	data->push_back((unsigned char)(value >> 24));
+	data->push_back((unsigned char)(value >> 16));
+	data->push_back((unsigned char)(value >> 8));
+	data->push_back((unsigned char)value);
+}
+
+//Update a CRC-32 with more bytes
+static unsigned int updateCrc(unsigned int crc, const unsigned char *data, unsigned int length)
+{
+	static unsigned int table[256];
+	static bool table_ready = false;
+
+	if(!table_ready) {
+		for(unsigned int n = 0; n < 256; n++) {
+			unsigned int c = n;
+			for(int k = 0; k < 8; k++)
+				c = (c & 1) ? 0xedb88320u ^ (c >> 1) : c >> 1;
+
+			table[n] = c;
+		}
+
+		table_ready = true;
+	}
+
+	for(unsigned int i = 0; i < length; i++)
+		crc = table[(crc ^ data[i]) & 0xff] ^ (crc >> 8);
+
+	return crc;
+}
+
+//Reverse the lowest bits of a value
+static unsigned int reverseBits(unsigned int value, int count)
+{
+	unsigned int result = 0;
+	for(int i = 0; i < count; i++) {
+		result = (result << 1) | (value & 1);
+		value >>= 1;
+	}
+
+	return result;
+}
+
+//Hash the 3 bytes starting at data
+static unsigned int hashBytes(const unsigned char *data)
+{
+	return ((data[0] << 10) ^ (data[1] << 5) ^ data[2]) & (DEFLATE_HASH_SIZE - 1);
+}
+
+//Predictor of the Paeth PNG filter
+static int paethPredictor(int a, int b, int c)
+{
+	int p = a + b - c;
+	int pa = p > a ? p - a : a - p;
+	int pb = p > b ? p - b : b - p;
+	int pc = p > c ? p - c : c - p;
+
+	if(pa <= pb && pa <= pc)
+		return a;
+	if(pb <= pc)
+		return b;
+	return c;
+}
+
+//Apply one PNG filter to a sample given its left, up and up-left neighbours
+static unsigned char filterSample(int type, int x, int a, int b, int c)
+{
+	switch(type) {
+	case 1:
+		return (unsigned char)(x - a);
+	case 2:
+		return (unsigned char)(x - b);
+	case 3:
+		return (unsigned char)(x - ((a + b) >> 1));
+	case 4:
+		return (unsigned char)(x - paethPredictor(a, b, c));
+	default:
+		return (unsigned char)x;
+	}
+}
+
+//Filter a row with whichever PNG filter gives the smallest sum of differences
+static void filterRow(const unsigned char *row, const unsigned char *prior, int row_size, int bpp, unsigned char *out)
+{
+	int best_type = 0;
+	unsigned int best_sum = 0xffffffffu;
+	for(int type = 0; type < 5; type++) {
+		unsigned int sum = 0;
+		for(int i = 0; i < row_size; i++) {
+			int a = i >= bpp ? row[i - bpp] : 0;
+			int c = i >= bpp ? prior[i - bpp] : 0;
+			signed char d = (signed char)filterSample(type, row[i], a, prior[i], c);
+			sum += d < 0 ? -d : d;
+		}
+
+		if(sum < best_sum) {
+			best_sum = sum;
+			best_type = type;
+		}
+	}
+
+	out[0] = (unsigned char)best_type;
+	for(int i = 0; i < row_size; i++) {
+		int a = i >= bpp ? row[i - bpp] : 0;
+		int c = i >= bpp ? prior[i - bpp] : 0;
+		out[i + 1] = filterSample(best_type, row[i], a, prior[i], c);
+	}
+}
+
+//Constructor
+ImageWriter::ImageWriter()
+{
+	file = NULL;
+	format = IF_PNG;
+	width = 0;
+	height = 0;
+	channels = 0;
+	rows_written = 0;
+	adler_a = 1;
+	adler_b = 0;
+	history_start = 0;
+	bit_buffer = 0;
+	bit_count = 0;
+}
+
+//Destructor
+ImageWriter::~ImageWriter()
+{
+	if(file)
+		fclose(file);
+}
+
+//Write a PNG chunk
+int ImageWriter::writeChunk(const char *type, const unsigned char *data, unsigned int length)
+{
+	unsigned char header[8];
+	header[0] = (unsigned char)(length >> 24);
+	header[1] = (unsigned char)(length >> 16);
+	header[2] = (unsigned char)(length >> 8);
+	header[3] = (unsigned char)length;
+	memcpy(&(header[4]), type, 4);
+
+	unsigned int crc = updateCrc(0xffffffffu, (const unsigned char*)type, 4);
+	crc = updateCrc(crc, data, length) ^ 0xffffffffu;
+
+	unsigned char footer[4];
+	footer[0] = (unsigned char)(crc >> 24);
+	footer[1] = (unsigned char)(crc >> 16);
+	footer[2] = (unsigned char)(crc >> 8);
+	footer[3] = (unsigned char)crc;
+
+	if(fwrite(header, 1, 8, file) != 8)
+		return 1;
+
+	if(length && fwrite(data, 1, length, file) != length)
+		return 1;
+
+	if(fwrite(footer, 1, 4, file) != 4)
+		return 1;
+
+	return 0;
+}
+
+//Add bytes to the image data as one or more deflate blocks
+void ImageWriter::addImageData(const unsigned char *data, unsigned int length)
+{
+	//Update the checksum, reducing the sums before they can overflow
+	const unsigned char *p = data;
+	unsigned int remaining = length;
+	while(remaining) {
+		unsigned int run = remaining < ADLER_MAX_RUN ? remaining : ADLER_MAX_RUN;
+		for(unsigned int i = 0; i < run; i++) {
+			adler_a += p[i];
+			adler_b += adler_a;
+		}
+
+		adler_a %= 65521;
+		adler_b %= 65521;
+		p += run;
+		remaining -= run;
+	}
+
+	//Only the last window of earlier data can be matched
+	if(history.size() > DEFLATE_WINDOW) {
+		size_t drop = history.size() - DEFLATE_WINDOW;
+		history.erase(history.begin(), history.begin() + drop);
+		history_start += drop;
+	}
+
+	unsigned int i = (unsigned int)history.size();
+	history.insert(history.end(), data, data + length);
+	unsigned int end = (unsigned int)history.size();
+	const unsigned char *h = &(history[0]);
+
+	//Compress into a block with fixed Huffman codes that is not the last one
+	size_t saved_size = chunk.size();
+	unsigned int saved_buffer = bit_buffer;
+	int saved_count = bit_count;
+	putBits(0, 1);
+	putBits(1, 2);
+
+	while(i < end) {
+		int best_length = 0;
+		int best_distance = 0;
+
+		//Follow the chain of earlier positions with the same hash
+		if(i + DEFLATE_MIN_MATCH <= end) {
+			unsigned long long position = history_start + i;
+			unsigned long long candidate = hash_heads[hashBytes(h + i)];
+			int max_length = end - i < DEFLATE_MAX_MATCH ? end - i : DEFLATE_MAX_MATCH;
+
+			for(int steps = 0; candidate && steps < DEFLATE_MAX_CHAIN; steps++) {
+				unsigned long long earlier = candidate - 1;
+				if(earlier < history_start || position - earlier > DEFLATE_WINDOW)
+					break;
+
+				const unsigned char *a = h + (earlier - history_start);
+				const unsigned char *b = h + i;
+				int match = 0;
+				while(match < max_length && a[match] == b[match])
+					match++;
+
+				if(match > best_length) {
+					best_length = match;
+					best_distance = (int)(position - earlier);
+					if(match == max_length)
+						break;
+				}
+
+				//A slot reused by a later position ends the chain
+				unsigned long long next = hash_chain[earlier & (DEFLATE_WINDOW - 1)];
+				if(next >= candidate)
+					break;
+				candidate = next;
+			}
+		}
+
+		if(best_length >= DEFLATE_MIN_MATCH) {
+			putMatch(best_length, best_distance);
+			for(int k = 0; k < best_length; k++, i++) {
+				if(i + DEFLATE_MIN_MATCH <= end)
+					insertHash(i);
+			}
+		} else {
+			putSymbol(h[i]);
+			if(i + DEFLATE_MIN_MATCH <= end)
+				insertHash(i);
+			i++;
+		}
+	}
+	putSymbol(256);
+
+	//Data that does not compress, such as noise, is stored as is instead
+	unsigned long long compressed_bits = (unsigned long long)(chunk.size() - saved_size) * 8 + bit_count - saved_count;
+	unsigned long long stored_bits = (unsigned long long)(length / STORED_BLOCK_SIZE + 1) * 42 + (unsigned long long)length * 8;
+	if(compressed_bits > stored_bits) {
+		chunk.resize(saved_size);
+		bit_buffer = saved_buffer;
+		bit_count = saved_count;
+		putStored(data, length);
+	}
+}
+
+//Append bytes as stored deflate blocks
+void ImageWriter::putStored(const unsigned char *data, unsigned int length)
+{
+	while(length) {
+		unsigned int block = length < STORED_BLOCK_SIZE ? length : STORED_BLOCK_SIZE;
+
+		//Stored block that is not the last one, starting on a byte boundary
+		putBits(0, 3);
+		if(bit_count)
+			putBits(0, 8 - bit_count);
+
+		chunk.push_back((unsigned char)block);
+		chunk.push_back((unsigned char)(block >> 8));
+		chunk.push_back((unsigned char)~block);
+		chunk.push_back((unsigned char)(~block >> 8));
+		chunk.insert(chunk.end(), data, data + block);
+
+		data += block;
+		length -= block;
+	}
+}
+
+//Record a position in the hash chains
+void ImageWriter::insertHash(unsigned int index)
+{
+	unsigned long long position = history_start + index;
+	unsigned int hash = hashBytes(&(history[index]));
+
+	hash_chain[position & (DEFLATE_WINDOW - 1)] = hash_heads[hash];
+	hash_heads[hash] = position + 1;
+}
+
+//Append bits to the compressed data
+void ImageWriter::putBits(unsigned int bits, int count)
+{
+	bit_buffer |= bits << bit_count;
+	bit_count += count;
+
+	while(bit_count >= 8) {
+		chunk.push_back((unsigned char)bit_buffer);
+		bit_buffer >>= 8;
+		bit_count -= 8;
+	}
+}
+
+//Append a fixed Huffman code. Codes are packed starting from their top bit.
+void ImageWriter::putSymbol(int symbol)
+{
+	if(symbol < 144)
+		putBits(reverseBits(0x30 + symbol, 8), 8);
+	else if(symbol < 256)
+		putBits(reverseBits(0x190 + symbol - 144, 9), 9);
+	else if(symbol < 280)
+		putBits(reverseBits(symbol - 256, 7), 7);
+	else
+		putBits(reverseBits(0xc0 + symbol - 280, 8), 8);
+}
+
+//Append a length and distance pair
+void ImageWriter::putMatch(int length, int distance)
+{
+	int code = 28;
+	while(length_bases[code] > length)
+		code--;
+
+	putSymbol(257 + code);
+	putBits(length - length_bases[code], length_extra[code]);
+
+	code = 29;
+	while(distance_bases[code] > distance)
+		code--;
+
+	putBits(reverseBits(code, 5), 5);
+	putBits(distance - distance_bases[code], distance_extra[code]);
+}
+
+//Create the file
+int ImageWriter::open(const char *filename, image_format iformat, int iwidth, int iheight, int ichannels)
+{
+	static const unsigned char signature[8] = {137, 80, 78, 71, 13, 10, 26, 10};
+
+	if(file || iwidth <= 0 || iheight <= 0)
+		return 1;
+
+	unsigned char color_type;
+	if(ichannels == 1)
+		color_type = 0;
+	else if(ichannels == 3)
+		color_type = 2;
+	else if(ichannels == 4)
+		color_type = 6;
+	else
+		return 1;
+
+	file = fopen(filename, "wb");
+	if(!file)
+		return 1;
+
+	format = iformat;
+	width = iwidth;
+	height = iheight;
+	channels = ichannels;
+	rows_written = 0;
+	adler_a = 1;
+	adler_b = 0;
+
+	if(format == IF_RAW)
+		return 0;
+
+	if(fwrite(signature, 1, 8, file) != 8)
+		return 1;
+
+	//Image header for 8 bit samples without interlacing
+	chunk.clear();
+	appendInt(&chunk, (unsigned int)width);
+	appendInt(&chunk, (unsigned int)height);
+	chunk.push_back(8);
+	chunk.push_back(color_type);
+	chunk.push_back(0);
+	chunk.push_back(0);
+	chunk.push_back(0);
+	if(writeChunk("IHDR", &(chunk[0]), (unsigned int)chunk.size()))
+		return 1;
+
+	//zlib header for a deflate stream with a 32K window
+	chunk.clear();
+	chunk.push_back(0x78);
+	chunk.push_back(0x01);
+
+	//The first row has nothing above it to filter against
+	previous_row.assign((size_t)width * channels, 0);
+	history.clear();
+	history_start = 0;
+	hash_heads.assign(DEFLATE_HASH_SIZE, 0);
+	hash_chain.assign(DEFLATE_WINDOW, 0);
+
+	bit_buffer = 0;
+	bit_count = 0;
+
+	return 0;
+}
+
+//Write rows of pixels
+int ImageWriter::writeRows(const unsigned char *pixels, int count)
+{
+	if(!file || count < 0 || rows_written + count > height)
+		return 1;
+
+	if(count == 0)
+		return 0;
+
+	unsigned int row_size = (unsigned int)(width * channels);
+	rows_written += count;
+
+	if(format == IF_RAW) {
+		size_t size = (size_t)row_size * count;
+		return fwrite(pixels, 1, size, file) == size ? 0 : 1;
+	}
+
+	//Each row starts with the type of the filter applied to it
+	filtered.resize((size_t)(row_size + 1) * count);
+	for(int i = 0; i < count; i++) {
+		const unsigned char *row = pixels + (size_t)row_size * i;
+		filterRow(row, &(previous_row[0]), row_size, channels, &(filtered[(size_t)(row_size + 1) * i]));
+		memcpy(&(previous_row[0]), row, row_size);
+	}
+	addImageData(&(filtered[0]), (unsigned int)filtered.size());
+
+	//Bits that do not fill a byte yet wait for the next rows
+	if(chunk.empty())
+		return 0;
+
+	int error = writeChunk("IDAT", &(chunk[0]), (unsigned int)chunk.size());
+	chunk.clear();
+
+	return error;
+}
+
+//Finish the file
+int ImageWriter::close()
+{
+	if(!file)
+		return 1;
+
+	int error = (rows_written == height) ? 0 : 1;
+	if(format == IF_PNG) {
+		//Empty final block followed by the checksum of the image data
+		putBits(1, 1);
+		putBits(1, 2);
+		putSymbol(256);
+		if(bit_count)
+			putBits(0, 8 - bit_count);
+		appendInt(&chunk, (adler_b << 16) | adler_a);
+
+		history.clear();
+		filtered.clear();
+
+		if(writeChunk("IDAT", &(chunk[0]), (unsigned int)chunk.size()))
+			error = 1;
+
+		if(writeChunk("IEND", NULL, 0))
+			error = 1;
+
+		chunk.clear();
+	}
+
+	if(fclose(file))
+		error = 1;
+
+	file = NULL;
+	return error;
+}
@@ -0,0 +1,141 @@
+/** @file ImageWriter.h
+ *
+ * @brief Writes PNG and raw images a few rows at a time
+ *
+ * Copyright 2013, Stewart Hall
+ *
+ * Licensed under The MIT License
+ * Redistributions of files must retain the above copyright notice.
+ *
+ * @author		Stewart Hall (www.stewartghall.com)
+ * @date		10/18/2026
+ * @copyright	Copyright 2013, Stewart Hall
+ * @license		MIT License (http://www.opensource.org/licenses/mit-license.php)
+ */
+
+#ifndef _IMAGEWRITER_
+#define _IMAGEWRITER_
+
+#include <stdio.h>
+#include <vector>
+
+/**
+ * @brief File formats images can be written in
+ */
+enum image_format {
+	IF_PNG,		/**< PNG with filtered, deflate compressed image data. */
+	IF_RAW		/**< Rows of 8 bit samples from top to bottom with no header. */
+};
+
+/**
+ * @brief Streams an 8 bit image to disk row by row
+ * @details Only the rows passed to each writeRows call and the last 32K of
+ * image data are held in memory, so images larger than memory can be written.
+ * PNG rows are filtered and compressed with fixed Huffman codes as each band
+ * arrives, falling back to stored blocks for bands that do not compress, and
+ * each band is written as soon as it is ready.
+ */
+class ImageWriter {
+private:
+	FILE *file;							/**< Open file or NULL. */
+	image_format format;				/**< Format being written. */
+	int width;							/**< Pixels per row. */
+	int height;							/**< Number of rows. */
+	int channels;						/**< Samples per pixel. */
+	int rows_written;					/**< Rows written so far. */
+	unsigned int adler_a;				/**< Running Adler-32 sums of the PNG image data. */
+	unsigned int adler_b;
+	std::vector<unsigned char> chunk;	/**< Data of the PNG chunk being built. */
+	std::vector<unsigned char> previous_row;	/**< Unfiltered previous row, used by the PNG filters. */
+	std::vector<unsigned char> filtered;		/**< Filtered rows waiting to be compressed. */
+	std::vector<unsigned char> history;			/**< Recent image data that matches can refer back to. */
+	unsigned long long history_start;			/**< Position in the image data of the first byte of history. */
+	std::vector<unsigned long long> hash_heads;	/**< One more than the position of the latest occurrence of each 3 byte hash or 0. */
+	std::vector<unsigned long long> hash_chain;	/**< Earlier occurrence with the same hash for each position in the window. */
+	unsigned int bit_buffer;					/**< Compressed bits that do not yet make a whole byte. */
+	int bit_count;								/**< Number of bits in bit_buffer. */
+
+	ImageWriter(const ImageWriter &c);				/**< Writers own a file and cannot be copied. */
+	ImageWriter &operator=(const ImageWriter &c);	/**< Writers own a file and cannot be copied. */
+
+	/**
+	 * Writes a PNG chunk with its length and checksum
+	 * @param type Four character chunk type
+	 * @param data Chunk data
+	 * @param length Size of data in bytes
+	 * @return Returns 0 if no errors occur
+	 */
+	int writeChunk(const char *type, const unsigned char *data, unsigned int length);
+
+	/**
+	 * Adds bytes to the image data and its checksum
+	 * @param data Bytes to add
+	 * @param length Number of bytes
+	 */
+	void addImageData(const unsigned char *data, unsigned int length);
+
+	/**
+	 * Appends bits to the compressed data, least significant bit first
+	 * @param bits Bits to append
+	 * @param count Number of bits
+	 */
+	void putBits(unsigned int bits, int count);
+
+	/**
+	 * Appends the fixed Huffman code of a literal, length or end of block symbol
+	 * @param symbol Symbol from 0 to 287
+	 */
+	void putSymbol(int symbol);
+
+	/**
+	 * Appends bytes as uncompressed deflate blocks
+	 * @param data Bytes to append
+	 * @param length Number of bytes
+	 */
+	void putStored(const unsigned char *data, unsigned int length);
+
+	/**
+	 * Appends a reference to earlier data
+	 * @param length Number of bytes to copy, from 3 to 258
+	 * @param distance How far back the bytes start, from 1 to 32768
+	 */
+	void putMatch(int length, int distance);
+
+	/**
+	 * Records a position so later data can match it
+	 * @param index Index of the position in history
+	 */
+	void insertHash(unsigned int index);
+
+public:
+	ImageWriter();		/**< Constructs a writer with no file. */
+
+	~ImageWriter();		/**< Destructor. Closes the file if open. */
+
+	/**
+	 * Creates the file and writes its header
+	 * @param filename Name of the file to create
+	 * @param iformat Format to write
+	 * @param iwidth Pixels per row
+	 * @param iheight Number of rows
+	 * @param ichannels Samples per pixel: 1 for gray, 3 for RGB or 4 for RGBA
+	 * @return Returns 0 if no errors occur
+	 */
+	int open(const char *filename, image_format iformat, int iwidth, int iheight, int ichannels);
+
+	/**
+	 * Writes the next rows of the image
+	 * @param pixels width * channels samples for each row, top row first
+	 * @param count Number of rows
+	 * @return Returns 0 if no errors occur
+	 */
+	int writeRows(const unsigned char *pixels, int count);
+
+	/**
+	 * Finishes the file once every row has been written
+	 * @return Returns 0 if no errors occur and all rows were written
+	 */
+	int close();
+};
+
+#endif
@@ -21,6 +21,13 @@ Instance::Instance(Geometry *obj)
 	original = obj;
 }
 
+//Constructor using an arena
+Instance::Instance(Geometry *obj, MemoryArena *iarena)
+:Geometry("Geometry", iarena)
+{
+	original = obj;
+}
+
 //Destructor
 Instance::~Instance()
 {
@@ -34,12 +41,23 @@ int Instance::saveGeometry(pugi::xml_node root)
 }
 
 //Saves an instance of the original object
-int Instance::saveInstance(pugi::xml_node root, int *id, Transform *parent)
+int Instance::saveInstance(pugi::xml_node root, int *id, Transform *parent, CullingVolume *volume)
 {
 	//Make sure node pointer is valid
 	if(!root)
 		return 1;
 
+	//Skip instances outside the volume, otherwise make sure the original is saved
+	Matrix *world = t.getWorldMatrix(parent);
+	if(volume) {
+		BoundingBox bounds;
+		original->getBounds(world, &bounds);
+		if(!volume->intersects(&bounds))
+			return 0;
+
+		original->markReferenced();
+	}
+
 	std::ostringstream name_stream;
 	name_stream << original->getUniqueId() << "-Inst-" << (*id);
 	*id = *id + 1;
@@ -47,17 +65,13 @@ int Instance::saveInstance(pugi::xml_node root, int *id, Transform *parent)
 	pugi::xml_node node = root.append_child("node");
 	node.append_attribute("name") = name_stream.str().c_str();
 
-	//Compound parent transform into the group's transform
-	Transform total_t(t);
-	if(parent)
-		total_t.combine(parent);
-
-	//Add the transform element
-	total_t.save(node);
+	//Add the world transform element
+	world->save(node);
 
 	//Add the geometry instance element
 	pugi::xml_node instance_node = node.append_child("instance_geometry");
 	instance_node.append_attribute("url") = (std::string("#") + original->getUniqueId()).c_str();
+	writeMaterialBinding(instance_node, original->getTexture());
 
 	return 0;
 }
@@ -68,14 +82,22 @@ void Instance::filter()
 
 }
 
+//Override partitioning
+void Instance::partition(unsigned int max_vertices, unsigned int max_triangles)
+{
+	//The original holds the meshlets, only clean up our own buffers
+	cleanUp();
+}
+
 //Override combine
-void Instance::combineInto(Geometry *g, Matrix *parent_t)
+void Instance::combineTransformedInto(Geometry *g, Matrix *m, CullingVolume *volume)
 {
-	//Compute total transform
-	Matrix total_transform = t.m;
-	if(parent_t != NULL)
-		total_transform.multiply(parent_t);
+	//Combine with parent, matching where saved instances place it
+	original->combineTransformedInto(g, m, volume);
+}
 
-	//Combine with parent
-	original->combineInto(g, &total_transform);
+//Bound the original
+void Instance::getBounds(Matrix *m, BoundingBox *bounds)
+{
+	original->getBounds(m, bounds);
 }
@@ -33,6 +33,13 @@ private:
 public:
 	Instance(Geometry *obj);		/**< Constructor for instance of an object. */
 
+	/**
+	 * Constructor for an instance allocated from an arena
+	 * @param obj The object to instance. The instance does not own it
+	 * @param iarena Arena to allocate from or NULL for the heap
+	 */
+	Instance(Geometry *obj, MemoryArena *iarena);
+
 	~Instance();					/**< Destructor. */
 
 	/**
@@ -46,9 +53,19 @@ public:
 	 * Saves an instance node in COLLADA format to the scene
 	 * @param root The scene element to add the node to
 	 * @param id Unique suffix to place after the name of the node
+	 * @param parent The transform on the parent object
+	 * @param volume The instance is skipped if the original's mesh placed by
+	 * the instance's world matrix is outside this volume, or NULL to save it
 	 * @return Returns 0 if no errors occur
 	 */
-	virtual int saveInstance(pugi::xml_node root, int *id, Transform *parent);
+	virtual int saveInstance(pugi::xml_node root, int *id, Transform *parent, CullingVolume *volume);
+
+	/**
+	 * Bounds the original's contents after a transform
+	 * @param m Transform to apply to the original's contents
+	 * @param bounds Receives the axis aligned bounds
+	 */
+	virtual void getBounds(Matrix *m, BoundingBox *bounds);
 
 	/**
 	 * An instance cannot be filtered, so this does nothing
@@ -56,11 +73,20 @@ public:
 	virtual void filter();
 
 	/**
-	 * An instance has to combine it's parent geometry
+	 * An instance has to combine it's parent geometry, placed by the
+	 * instance's transform in place of the original's
 	 * @param g Geometry to combine into
-	 * @param t Transform to apply to this geometry
+	 * @param m Complete transform from the instance's space to g's
+	 * @param volume Volume the original is culled against, or NULL for none
+	 */
+	virtual void combineTransformedInto(Geometry *g, Matrix *m, CullingVolume *volume);
+
+	/**
+	 * An instance has no mesh of its own, so this only cleans up its buffers
+	 * @param max_vertices Maximum number of vertices in a meshlet
+	 * @param max_triangles Maximum number of triangles in a meshlet
 	 */
-	virtual void combineInto(Geometry *g, Matrix *parent_t);
+	virtual void partition(unsigned int max_vertices, unsigned int max_triangles);
 };
 
 #endif
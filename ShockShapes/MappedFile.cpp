@@ -0,0 +1,151 @@
+/** @file MappedFile.cpp
+ *
+ * @brief Maps a file into memory so it can be parsed in place
+ *
+ * Copyright 2013, Stewart Hall
+ *
+ * Licensed under The MIT License
+ * Redistributions of files must retain the above copyright notice.
+ *
+ * @author		Stewart Hall (www.stewartghall.com)
+ * @date		10/18/2026
+ * @copyright	Copyright 2013, Stewart Hall
+ * @license		MIT License (http://www.opensource.org/licenses/mit-license.php)
+ */
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+#include "MappedFile.h"
+
+//Constructor
+MappedFile::MappedFile()
+{
+	data = NULL;
+	size = 0;
+
+#ifdef _WIN32
+	file_handle = INVALID_HANDLE_VALUE;
+	mapping_handle = NULL;
+#endif
+}
+
+//Destructor
+MappedFile::~MappedFile()
+{
+	close();
+}
+
+#ifdef _WIN32
+
+//Map a file
+int MappedFile::open(const char *filename)
+{
+	close();
+
+	file_handle = CreateFileA(filename, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+	if(file_handle == INVALID_HANDLE_VALUE)
+		return 1;
+
+	LARGE_INTEGER file_size;
+	if(!GetFileSizeEx(file_handle, &file_size) || file_size.QuadPart == 0 || (unsigned long long)file_size.QuadPart > (size_t)-1) {
+		close();
+		return 1;
+	}
+
+	//Pages are copied when written so the file itself is never modified
+	mapping_handle = CreateFileMappingA(file_handle, NULL, PAGE_WRITECOPY, 0, 0, NULL);
+	if(!mapping_handle) {
+		close();
+		return 1;
+	}
+
+	data = (char*)MapViewOfFile(mapping_handle, FILE_MAP_COPY, 0, 0, 0);
+	if(!data) {
+		close();
+		return 1;
+	}
+
+	size = (size_t)file_size.QuadPart;
+
+	return 0;
+}
+
+//Unmap the file
+void MappedFile::close()
+{
+	if(data)
+		UnmapViewOfFile(data);
+
+	if(mapping_handle)
+		CloseHandle(mapping_handle);
+
+	if(file_handle != INVALID_HANDLE_VALUE)
+		CloseHandle(file_handle);
+
+	data = NULL;
+	size = 0;
+	file_handle = INVALID_HANDLE_VALUE;
+	mapping_handle = NULL;
+}
+
+#else
+
+//Map a file
+int MappedFile::open(const char *filename)
+{
+	close();
+
+	int fd = ::open(filename, O_RDONLY);
+	if(fd < 0)
+		return 1;
+
+	struct stat file_stat;
+	if(fstat(fd, &file_stat) || file_stat.st_size <= 0) {
+		::close(fd);
+		return 1;
+	}
+
+	//Private mapping so writes are copied and never reach the file
+	void *view = mmap(NULL, (size_t)file_stat.st_size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+	::close(fd);
+
+	if(view == MAP_FAILED)
+		return 1;
+
+	data = (char*)view;
+	size = (size_t)file_stat.st_size;
+
+	return 0;
+}
+
+//Unmap the file
+void MappedFile::close()
+{
+	if(data)
+		munmap(data, size);
+
+	data = NULL;
+	size = 0;
+}
+
+#endif
+
+//Get the mapped data
+char *MappedFile::getData()
+{
+	return data;
+}
+
+//Get the size of the data
+size_t MappedFile::getSize()
+{
+	return size;
+}
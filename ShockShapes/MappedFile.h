@@ -0,0 +1,71 @@
+/** @file MappedFile.h
+ *
+ * @brief Maps a file into memory so it can be parsed in place
+ *
+ * Copyright 2013, Stewart Hall
+ *
+ * Licensed under The MIT License
+ * Redistributions of files must retain the above copyright notice.
+ *
+ * @author		Stewart Hall (www.stewartghall.com)
+ * @date		10/18/2026
+ * @copyright	Copyright 2013, Stewart Hall
+ * @license		MIT License (http://www.opensource.org/licenses/mit-license.php)
+ */
+
+#ifndef _MAPPEDFILE_
+#define _MAPPEDFILE_
+
+#include <stddef.h>
+
+#include "CommonDefs.h"
+
+/**
+ * @brief Copy on write view of a whole file
+ * @details The mapped memory can be written to without changing the file,
+ * which lets pugixml parse it in place. The view is released when the
+ * object is destroyed or closed.
+ */
+class MappedFile {
+private:
+	char *data;				/**< Start of the mapped file or NULL if nothing is mapped. */
+	size_t size;			/**< Size of the file in bytes. */
+
+#ifdef _WIN32
+	void *file_handle;		/**< Handle of the open file. */
+	void *mapping_handle;	/**< Handle of the file mapping object. */
+#endif
+
+	MappedFile(const MappedFile &c);				/**< Mapped files cannot be copied. */
+	MappedFile &operator=(const MappedFile &c);		/**< Mapped files cannot be copied. */
+
+public:
+	MappedFile();			/**< Constructs an object with nothing mapped. */
+	~MappedFile();			/**< Destructor. Unmaps the file. */
+
+	/**
+	 * Maps a file into memory
+	 * @param filename The local file to map
+	 * @return Returns 0 if no errors occur. Empty files cannot be mapped
+	 */
+	int open(const char *filename);
+
+	/**
+	 * Unmaps the file if one is mapped
+	 */
+	void close();
+
+	/**
+	 * Gets the mapped contents of the file
+	 * @return Pointer to the first byte or NULL if nothing is mapped
+	 */
+	char *getData();
+
+	/**
+	 * Gets the size of the mapped file
+	 * @return Size in bytes
+	 */
+	size_t getSize();
+};
+
+#endif
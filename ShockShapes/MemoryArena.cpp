@@ -0,0 +1,150 @@
+/** @file MemoryArena.cpp
+ *
+ * @brief Monotonic memory arena used to back per-scene storage
+ *
+ * Copyright 2013, Stewart Hall
+ *
+ * Licensed under The MIT License
+ * Redistributions of files must retain the above copyright notice.
+ *
+ * @author		Stewart Hall (www.stewartghall.com)
+ * @date		10/18/2026
+ * @copyright	Copyright 2013, Stewart Hall
+ * @license		MIT License (http://www.opensource.org/licenses/mit-license.php)
+ */
+
+#include "MemoryArena.h"
+
+//Rounds a size up to the arena alignment
+static size_t alignSize(size_t size)
+{
+	return (size + ARENA_ALIGNMENT - 1) & ~((size_t)ARENA_ALIGNMENT - 1);
+}
+
+//Returns the first aligned byte after a block header
+static char *blockData(ArenaBlock *block)
+{
+	size_t address = (size_t)(block + 1);
+	return (char*)alignSize(address);
+}
+
+//Constructor
+MemoryArena::MemoryArena()
+{
+	current = NULL;
+	used = 0;
+	block_size = ARENA_BLOCK_SIZE;
+	scratch = NULL;
+}
+
+//Constructor with block size
+MemoryArena::MemoryArena(size_t iblock_size)
+{
+	current = NULL;
+	used = 0;
+	block_size = iblock_size;
+	scratch = NULL;
+}
+
+//Destructor
+MemoryArena::~MemoryArena()
+{
+	while(current) {
+		ArenaBlock *next = current->next;
+		::operator delete(current);
+		current = next;
+	}
+
+	delete scratch;
+}
+
+//Add a new block
+void MemoryArena::grow(size_t min_size)
+{
+	size_t size = min_size > block_size ? min_size : block_size;
+
+	ArenaBlock *block = (ArenaBlock*)::operator new(sizeof(ArenaBlock) + size + ARENA_ALIGNMENT);
+	block->next = current;
+	block->size = size;
+
+	current = block;
+	used = 0;
+}
+
+//Allocate memory
+void *MemoryArena::allocate(size_t size)
+{
+	size = alignSize(size);
+
+	if(!current || used + size > current->size)
+		grow(size);
+
+	void *p = blockData(current) + used;
+	used += size;
+
+	return p;
+}
+
+//Give back the most recent allocation
+void MemoryArena::deallocate(void *p, size_t size)
+{
+	size = alignSize(size);
+
+	if(current && size <= used && (char*)p == blockData(current) + used - size)
+		used -= size;
+}
+
+//Release all memory
+void MemoryArena::reset()
+{
+	if(current) {
+		ArenaBlock *block = current->next;
+		while(block) {
+			ArenaBlock *next = block->next;
+			::operator delete(block);
+			block = next;
+		}
+
+		current->next = NULL;
+	}
+
+	used = 0;
+
+	if(scratch)
+		scratch->reset();
+}
+
+//Get the current position
+ArenaMark MemoryArena::getMark()
+{
+	ArenaMark mark;
+	mark.block = current;
+	mark.used = used;
+
+	return mark;
+}
+
+//Release everything since a mark
+void MemoryArena::rewind(ArenaMark mark)
+{
+	//Free blocks added after the mark, keeping one block if the arena was empty
+	while(current && current != mark.block) {
+		if(!mark.block && !current->next)
+			break;
+
+		ArenaBlock *next = current->next;
+		::operator delete(current);
+		current = next;
+	}
+
+	used = (current == mark.block) ? mark.used : 0;
+}
+
+//Get the scratch arena
+MemoryArena *MemoryArena::getScratch()
+{
+	if(!scratch)
+		scratch = new MemoryArena(block_size);
+
+	return scratch;
+}
@@ -0,0 +1,217 @@
+/** @file MemoryArena.h
+ *
+ * @brief Monotonic memory arena used to back per-scene storage
+ *
+ * Copyright 2013, Stewart Hall
+ *
+ * Licensed under The MIT License
+ * Redistributions of files must retain the above copyright notice.
+ *
+ * @author		Stewart Hall (www.stewartghall.com)
+ * @date		10/18/2026
+ * @copyright	Copyright 2013, Stewart Hall
+ * @license		MIT License (http://www.opensource.org/licenses/mit-license.php)
+ */
+
+#ifndef _MEMORYARENA_
+#define _MEMORYARENA_
+
+#include <stddef.h>
+#include <new>
+
+#include "CommonDefs.h"
+
+#define ARENA_BLOCK_SIZE 65536
+#define ARENA_ALIGNMENT 16
+
+/**
+ * @brief Header of a block of memory owned by an arena
+ */
+typedef struct ArenaBlock {
+	struct ArenaBlock *next;	/**< Block allocated before this one. */
+	size_t size;				/**< Usable bytes following the header. */
+} ArenaBlock;
+
+/**
+ * @brief Position in an arena that can be rewound to
+ */
+typedef struct {
+	ArenaBlock *block;			/**< Block that was current when the mark was taken. */
+	size_t used;				/**< Bytes used in that block. */
+} ArenaMark;
+
+/**
+ * @brief Allocates memory by bumping a pointer through large blocks
+ * @details Individual allocations are never freed, except that the most
+ * recent allocation can be given back. All memory is released at once with
+ * reset. Each arena owns a second arena for temporary scratch data which
+ * is released with mark and rewind.
+ */
+class MemoryArena {
+private:
+	ArenaBlock *current;		/**< Block allocations are taken from. Older blocks are linked behind it. */
+	size_t used;				/**< Bytes used in the current block. */
+	size_t block_size;			/**< Default size of new blocks. */
+
+	MemoryArena *scratch;		/**< Arena for temporary data or NULL if not created yet. */
+
+	/**
+	 * Adds a new block to the arena
+	 * @param min_size The number of bytes that must fit in the block
+	 */
+	void grow(size_t min_size);
+
+	MemoryArena(const MemoryArena &c);				/**< Arenas cannot be copied. */
+	MemoryArena &operator=(const MemoryArena &c);	/**< Arenas cannot be copied. */
+
+public:
+	MemoryArena();							/**< Constructs an empty arena. */
+	MemoryArena(size_t iblock_size);		/**< Constructs an empty arena with a different block size. */
+
+	~MemoryArena();							/**< Destructor. Frees all blocks. */
+
+	/**
+	 * Allocates memory from the arena
+	 * @param size Number of bytes to allocate
+	 * @return Pointer to memory aligned to ARENA_ALIGNMENT
+	 */
+	void *allocate(size_t size);
+
+	/**
+	 * Gives memory back to the arena if it was the most recent allocation
+	 * @param p Pointer returned by allocate
+	 * @param size Size that was passed to allocate
+	 */
+	void deallocate(void *p, size_t size);
+
+	/**
+	 * Releases all memory. Only the most recent block is kept for reuse.
+	 */
+	void reset();
+
+	/**
+	 * Gets the current allocation position for a later rewind
+	 * @return The current position
+	 */
+	ArenaMark getMark();
+
+	/**
+	 * Releases everything allocated since a mark
+	 * @param mark Value returned by getMark
+	 */
+	void rewind(ArenaMark mark);
+
+	/**
+	 * Gets the arena used for temporary data
+	 * @return The scratch arena, created on first use
+	 */
+	MemoryArena *getScratch();
+};
+
+/**
+ * @brief Standard allocator that takes memory from an arena
+ * @details A NULL arena allocates from the heap so containers using this
+ * allocator work the same way whether or not they belong to a scene.
+ */
+template <class T>
+class ArenaAllocator {
+public:
+	typedef T value_type;
+	typedef T *pointer;
+	typedef const T *const_pointer;
+	typedef T &reference;
+	typedef const T &const_reference;
+	typedef size_t size_type;
+	typedef ptrdiff_t difference_type;
+
+	template <class U>
+	struct rebind {
+		typedef ArenaAllocator<U> other;
+	};
+
+	MemoryArena *arena;		/**< Arena to allocate from or NULL for the heap. */
+
+	ArenaAllocator() : arena(NULL) {}
+	ArenaAllocator(MemoryArena *iarena) : arena(iarena) {}
+
+	template <class U>
+	ArenaAllocator(const ArenaAllocator<U> &c) : arena(c.arena) {}
+
+	pointer address(reference x) const { return &x; }
+	const_pointer address(const_reference x) const { return &x; }
+
+	pointer allocate(size_type n, const void *hint = 0)
+	{
+		if(arena)
+			return (pointer)arena->allocate(n * sizeof(T));
+
+		return (pointer)::operator new(n * sizeof(T));
+	}
+
+	void deallocate(pointer p, size_type n)
+	{
+		if(arena)
+			arena->deallocate(p, n * sizeof(T));
+		else
+			::operator delete(p);
+	}
+
+	size_type max_size() const { return ((size_type)-1) / sizeof(T); }
+
+	void construct(pointer p, const T &val) { new((void*)p) T(val); }
+	void destroy(pointer p) { p->~T(); }
+};
+
+template <class T, class U>
+bool operator==(const ArenaAllocator<T> &a, const ArenaAllocator<U> &b)
+{
+	return a.arena == b.arena;
+}
+
+template <class T, class U>
+bool operator!=(const ArenaAllocator<T> &a, const ArenaAllocator<U> &b)
+{
+	return a.arena != b.arena;
+}
+
+/**
+ * @brief Temporary array of plain data released when it goes out of scope
+ * @details Taken from a scratch arena when one is given, otherwise from the heap.
+ * Arrays sharing a scratch arena must be destroyed in reverse order of creation.
+ */
+template <class T>
+class ScratchArray {
+private:
+	MemoryArena *scratch;
+	ArenaMark mark;
+	T *data;
+
+	ScratchArray(const ScratchArray &c);
+	ScratchArray &operator=(const ScratchArray &c);
+
+public:
+	ScratchArray(MemoryArena *iscratch, size_t count)
+	:scratch(iscratch)
+	{
+		if(scratch) {
+			mark = scratch->getMark();
+			data = (T*)scratch->allocate(count * sizeof(T));
+		} else {
+			data = new T[count];
+		}
+	}
+
+	~ScratchArray()
+	{
+		if(scratch)
+			scratch->rewind(mark);
+		else
+			delete[] data;
+	}
+
+	T &operator[](size_t index) { return data[index]; }
+
+	T *get() { return data; }
+};
+
+#endif
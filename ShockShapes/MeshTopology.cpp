@@ -0,0 +1,217 @@
+/** @file MeshTopology.cpp
+ *
+ * @brief Half-edge connectivity of a triangle mesh
+ *
+ * Copyright 2013, Stewart Hall
+ *
+ * Licensed under The MIT License
+ * Redistributions of files must retain the above copyright notice.
+ *
+ * @author		Stewart Hall (www.stewartghall.com)
+ * @date		10/18/2026
+ * @copyright	Copyright 2013, Stewart Hall
+ * @license		MIT License (http://www.opensource.org/licenses/mit-license.php)
+ */
+
+#include "MeshTopology.h"
+#include "Geometry.h"
+#include "HashMap.h"
+
+//Key for the unordered pair of vertices joined by an edge
+static unsigned long long edgeKey(int a, int b)
+{
+	if(a > b) {
+		int temp = a;
+		a = b;
+		b = temp;
+	}
+
+	return ((unsigned long long)(unsigned int)a << 32) | (unsigned long long)(unsigned int)b;
+}
+
+//Constructor
+MeshTopology::MeshTopology()
+:corner_vertices(), twins(), edges(), edge_halfedges(), edge_counts(), vertex_offsets(), vertex_corners(), boundary_vertices()
+{
+
+}
+
+//Build the topology of a mesh
+void MeshTopology::build(Geometry *g)
+{
+	int num_triangles = g->getNumTriangles();
+	int num_vertices = g->getNumVertices();
+	int num_halfedges = num_triangles * 3;
+
+	corner_vertices.resize(num_halfedges);
+	for(int t = 0; t < num_triangles; t++) {
+		Triangle *tri = g->getTriangle(t);
+		corner_vertices[t * 3] = tri->vertices[0];
+		corner_vertices[t * 3 + 1] = tri->vertices[1];
+		corner_vertices[t * 3 + 2] = tri->vertices[2];
+	}
+
+	//Group corners by vertex with a counting sort
+	vertex_offsets.assign(num_vertices + 1, 0);
+	for(int c = 0; c < num_halfedges; c++)
+		vertex_offsets[corner_vertices[c] + 1]++;
+
+	for(int v = 0; v < num_vertices; v++)
+		vertex_offsets[v + 1] += vertex_offsets[v];
+
+	vertex_corners.resize(num_halfedges);
+	std::vector<int> cursor(vertex_offsets.begin(), vertex_offsets.end() - 1);
+	for(int c = 0; c < num_halfedges; c++)
+		vertex_corners[cursor[corner_vertices[c]]++] = c;
+
+	//Give every vertex pair an edge index and pair up opposite half-edges
+	HASH_MAP<unsigned long long, int> edge_ids;
+	edge_ids.rehash(num_halfedges);
+
+	edges.resize(num_halfedges);
+	twins.assign(num_halfedges, -1);
+	edge_halfedges.clear();
+	edge_counts.clear();
+
+	for(int h = 0; h < num_halfedges; h++) {
+		int a = corner_vertices[h];
+		int b = corner_vertices[next(h)];
+
+		std::pair<HASH_MAP<unsigned long long, int>::iterator, bool> inserted =
+			edge_ids.insert(std::make_pair(edgeKey(a, b), (int)edge_halfedges.size()));
+		int e = inserted.first->second;
+		edges[h] = e;
+
+		if(inserted.second) {
+			edge_halfedges.push_back(h);
+			edge_counts.push_back(1);
+			continue;
+		}
+
+		edge_counts[e]++;
+		int first = edge_halfedges[e];
+		if(edge_counts[e] == 2) {
+			//Twins only if the two triangles agree on winding
+			if(corner_vertices[first] == b && corner_vertices[next(first)] == a) {
+				twins[h] = first;
+				twins[first] = h;
+			}
+		} else if(edge_counts[e] == 3 && twins[first] >= 0) {
+			//A third triangle makes the edge non-manifold
+			twins[twins[first]] = -1;
+			twins[first] = -1;
+		}
+	}
+
+	//Mark the ends of boundary edges
+	boundary_vertices.assign(num_vertices, 0);
+	for(int h = 0; h < num_halfedges; h++) {
+		if(edge_counts[edges[h]] == 1) {
+			boundary_vertices[corner_vertices[h]] = 1;
+			boundary_vertices[corner_vertices[next(h)]] = 1;
+		}
+	}
+}
+
+//Get the number of half-edges
+int MeshTopology::getNumHalfEdges()
+{
+	return corner_vertices.size();
+}
+
+//Get the number of edges
+int MeshTopology::getNumEdges()
+{
+	return edge_halfedges.size();
+}
+
+//Get the start vertex of a half-edge
+int MeshTopology::getVertex(int h)
+{
+	return corner_vertices[h];
+}
+
+//Get the twin of a half-edge
+int MeshTopology::getTwin(int h)
+{
+	return twins[h];
+}
+
+//Get the edge of a half-edge
+int MeshTopology::getEdge(int h)
+{
+	return edges[h];
+}
+
+//Get a half-edge on an edge
+int MeshTopology::getEdgeHalfEdge(int e)
+{
+	return edge_halfedges[e];
+}
+
+//Get the triangle across an edge
+int MeshTopology::getNeighborTriangle(int t, int k)
+{
+	int twin = twins[t * 3 + k];
+
+	return twin < 0 ? -1 : triangle(twin);
+}
+
+//Get the number of corners at a vertex
+int MeshTopology::getNumVertexCorners(int v)
+{
+	if(v < 0 || v + 1 >= (int)vertex_offsets.size())
+		return 0;
+
+	return vertex_offsets[v + 1] - vertex_offsets[v];
+}
+
+//Get the corners at a vertex
+const int *MeshTopology::getVertexCorners(int v)
+{
+	if(getNumVertexCorners(v) == 0)
+		return NULL;
+
+	return &vertex_corners[vertex_offsets[v]];
+}
+
+//Get the neighboring vertices
+void MeshTopology::getOneRing(int v, std::vector<int> *ring)
+{
+	ring->clear();
+
+	int num_corners = getNumVertexCorners(v);
+	const int *corners = getVertexCorners(v);
+	for(int i = 0; i < num_corners; i++) {
+		int neighbors[2];
+		neighbors[0] = corner_vertices[next(corners[i])];
+		neighbors[1] = corner_vertices[prev(corners[i])];
+
+		for(int j = 0; j < 2; j++) {
+			if(neighbors[j] == v)
+				continue;
+
+			bool found = false;
+			for(unsigned int k = 0; k < ring->size() && !found; k++)
+				found = (*ring)[k] == neighbors[j];
+
+			if(!found)
+				ring->push_back(neighbors[j]);
+		}
+	}
+}
+
+//Check for a boundary edge
+bool MeshTopology::isBoundaryEdge(int h)
+{
+	return edge_counts[edges[h]] == 1;
+}
+
+//Check for a boundary vertex
+bool MeshTopology::isBoundaryVertex(int v)
+{
+	if(v < 0 || v >= (int)boundary_vertices.size())
+		return false;
+
+	return boundary_vertices[v] != 0;
+}
@@ -0,0 +1,160 @@
+/** @file MeshTopology.h
+ *
+ * @brief Half-edge connectivity of a triangle mesh
+ *
+ * Copyright 2013, Stewart Hall
+ *
+ * Licensed under The MIT License
+ * Redistributions of files must retain the above copyright notice.
+ *
+ * @author		Stewart Hall (www.stewartghall.com)
+ * @date		10/18/2026
+ * @copyright	Copyright 2013, Stewart Hall
+ * @license		MIT License (http://www.opensource.org/licenses/mit-license.php)
+ */
+
+#ifndef _MESHTOPOLOGY_
+#define _MESHTOPOLOGY_
+
+#include <vector>
+
+#include "CommonDefs.h"
+
+class Geometry;
+
+/**
+ * @brief Half-edge connectivity built from the triangle buffer of a mesh
+ * @details Half-edges are stored implicitly as corners. Corner c is corner
+ * c % 3 of triangle c / 3, and half-edge c runs from the vertex of corner c
+ * to the vertex of the next corner of the same triangle. Each pair of
+ * vertices joined by one or more half-edges is an edge with its own index.
+ * An edge with exactly two half-edges running in opposite directions is
+ * manifold and its half-edges are twins. Any other edge has no twins.
+ * Edges used by a single half-edge are boundary edges.
+ */
+class MeshTopology {
+private:
+	std::vector<int> corner_vertices;	/**< Vertex of each corner. */
+	std::vector<int> twins;				/**< Opposite half-edge of each half-edge or -1. */
+	std::vector<int> edges;				/**< Edge of each half-edge. */
+	std::vector<int> edge_halfedges;	/**< First half-edge of each edge. */
+	std::vector<int> edge_counts;		/**< Number of half-edges on each edge. */
+	std::vector<int> vertex_offsets;	/**< Start of each vertex's corners in vertex_corners. Has one extra entry at the end. */
+	std::vector<int> vertex_corners;	/**< Corners grouped by vertex, in increasing order within each vertex. */
+	std::vector<char> boundary_vertices;	/**< Nonzero for vertices on a boundary edge. */
+
+public:
+	MeshTopology();			/**< Constructs an empty topology. */
+
+	/**
+	 * Builds the topology from the triangles of a mesh in O(T) using an edge hash
+	 * @param g The mesh to read triangles from
+	 */
+	void build(Geometry *g);
+
+	/**
+	 * Gets the number of half-edges, which is three per triangle
+	 * @return Number of half-edges
+	 */
+	int getNumHalfEdges();
+
+	/**
+	 * Gets the number of distinct edges
+	 * @return Number of edges
+	 */
+	int getNumEdges();
+
+	/**
+	 * Gets the next half-edge around the same triangle
+	 * @param h A half-edge
+	 * @return The half-edge leaving the end vertex of h
+	 */
+	static int next(int h) { return (h % 3 == 2) ? h - 2 : h + 1; }
+
+	/**
+	 * Gets the previous half-edge around the same triangle
+	 * @param h A half-edge
+	 * @return The half-edge arriving at the start vertex of h
+	 */
+	static int prev(int h) { return (h % 3 == 0) ? h + 2 : h - 1; }
+
+	/**
+	 * Gets the triangle a half-edge belongs to
+	 * @param h A half-edge
+	 * @return Index of the triangle
+	 */
+	static int triangle(int h) { return h / 3; }
+
+	/**
+	 * Gets the vertex a half-edge starts at
+	 * @param h A half-edge
+	 * @return Index of the vertex
+	 */
+	int getVertex(int h);
+
+	/**
+	 * Gets the half-edge running the opposite way along the same edge
+	 * @param h A half-edge
+	 * @return The twin or -1 if the edge is a boundary or not manifold
+	 */
+	int getTwin(int h);
+
+	/**
+	 * Gets the edge a half-edge lies on
+	 * @param h A half-edge
+	 * @return Index of the edge
+	 */
+	int getEdge(int h);
+
+	/**
+	 * Gets the first half-edge that lies on an edge
+	 * @param e An edge
+	 * @return A half-edge on the edge
+	 */
+	int getEdgeHalfEdge(int e);
+
+	/**
+	 * Gets the triangle across one edge of a triangle
+	 * @param t A triangle
+	 * @param k The edge of the triangle, running from corner k to corner k + 1
+	 * @return Index of the neighboring triangle or -1 if there is none
+	 */
+	int getNeighborTriangle(int t, int k);
+
+	/**
+	 * Gets the number of corners that use a vertex
+	 * @param v A vertex
+	 * @return Number of corners
+	 */
+	int getNumVertexCorners(int v);
+
+	/**
+	 * Gets the corners that use a vertex, which are also the half-edges leaving it
+	 * @param v A vertex
+	 * @return Pointer to getNumVertexCorners(v) corner indices in increasing order
+	 */
+	const int *getVertexCorners(int v);
+
+	/**
+	 * Gets the vertices joined to a vertex by an edge
+	 * @param v A vertex
+	 * @param ring Cleared and filled with each neighboring vertex once
+	 */
+	void getOneRing(int v, std::vector<int> *ring);
+
+	/**
+	 * Checks if an edge is used by only one triangle
+	 * @param h A half-edge on the edge
+	 * @return True if the edge is a boundary
+	 */
+	bool isBoundaryEdge(int h);
+
+	/**
+	 * Checks if a vertex lies on a boundary edge
+	 * @param v A vertex
+	 * @return True if the vertex is on a boundary
+	 */
+	bool isBoundaryVertex(int v);
+};
+
+#endif
@@ -0,0 +1,407 @@
+/** @file MeshletSet.cpp
+ *
+ * @brief Partitions a mesh into small clusters that can be culled individually
+ *
+ * Copyright 2013, Stewart Hall
+ *
+ * Licensed under The MIT License
+ * Redistributions of files must retain the above copyright notice.
+ *
+ * @author		Stewart Hall (www.stewartghall.com)
+ * @date		10/18/2026
+ * @copyright	Copyright 2013, Stewart Hall
+ * @license		MIT License (http://www.opensource.org/licenses/mit-license.php)
+ */
+
+#include <math.h>
+#include <algorithm>
+#include <sstream>
+#include <iomanip>
+#include <string>
+
+#include "MeshletSet.h"
+#include "Geometry.h"
+
+/**
+ * @brief Triangle index paired with the morton code of its centroid
+ */
+typedef struct {
+	unsigned int code;
+	int triangle;
+} MortonKey;
+
+//Orders triangles along the morton curve
+static bool mortonLess(const MortonKey &a, const MortonKey &b)
+{
+	return a.code < b.code;
+}
+
+//Spreads the lower 10 bits of v so there are two zero bits between each
+static unsigned int spreadBits(unsigned int v)
+{
+	v &= 0x3ff;
+	v = (v | (v << 16)) & 0x030000ff;
+	v = (v | (v << 8)) & 0x0300f00f;
+	v = (v | (v << 4)) & 0x030c30c3;
+	v = (v | (v << 2)) & 0x09249249;
+
+	return v;
+}
+
+//Scales an offset from the minimum corner to a 10 bit grid coordinate
+static unsigned int gridCoordinate(float offset, float scale)
+{
+	//Rounding can put the centroid slightly outside the bounds
+	float v = offset * scale;
+	v = std::max(0.0f, std::min(1023.0f, v));
+
+	return (unsigned int)v;
+}
+
+//Constructor
+MeshletSet::MeshletSet()
+:meshlets(), bounds(), vertices(), triangles()
+{
+	max_vertices = MESHLET_MAX_VERTICES;
+	max_triangles = MESHLET_MAX_TRIANGLES;
+}
+
+//Destructor
+MeshletSet::~MeshletSet()
+{
+
+}
+
+//Remove all meshlets
+void MeshletSet::clear()
+{
+	meshlets.clear();
+	bounds.clear();
+	vertices.clear();
+	triangles.clear();
+}
+
+//Partition a mesh
+void MeshletSet::build(Geometry *g, unsigned int imax_vertices, unsigned int imax_triangles)
+{
+	clear();
+
+	//Local indices are stored in a byte and a triangle needs 3 vertices
+	max_vertices = imax_vertices > 255 ? 255 : imax_vertices;
+	if(max_vertices < 3)
+		max_vertices = 3;
+	max_triangles = imax_triangles < 1 ? 1 : imax_triangles;
+
+	int num_triangles = g->getNumTriangles();
+	int num_vertices = g->getNumVertices();
+	if(num_triangles == 0)
+		return;
+
+	//Find the extents of the mesh to quantize centroids against
+	Vector3D vmin = *g->getVertex(0);
+	Vector3D vmax = vmin;
+	for(int i = 1; i < num_vertices; i++) {
+		Vector3D *v = g->getVertex(i);
+		vmin.x = std::min(vmin.x, v->x); vmax.x = std::max(vmax.x, v->x);
+		vmin.y = std::min(vmin.y, v->y); vmax.y = std::max(vmax.y, v->y);
+		vmin.z = std::min(vmin.z, v->z); vmax.z = std::max(vmax.z, v->z);
+	}
+
+	float extent = std::max(vmax.x - vmin.x, std::max(vmax.y - vmin.y, vmax.z - vmin.z));
+	float scale = extent > 0.0f ? 1023.0f / extent : 0.0f;
+
+	//Sort triangles by the morton code of their centroid
+	std::vector<MortonKey> order(num_triangles);
+	for(int i = 0; i < num_triangles; i++) {
+		Triangle *t = g->getTriangle(i);
+		Vector3D *v1 = g->getVertex(t->vertices[0]);
+		Vector3D *v2 = g->getVertex(t->vertices[1]);
+		Vector3D *v3 = g->getVertex(t->vertices[2]);
+
+		float cx = (v1->x + v2->x + v3->x) * (1.0f / 3.0f) - vmin.x;
+		float cy = (v1->y + v2->y + v3->y) * (1.0f / 3.0f) - vmin.y;
+		float cz = (v1->z + v2->z + v3->z) * (1.0f / 3.0f) - vmin.z;
+
+		order[i].code = (spreadBits(gridCoordinate(cx, scale)) << 2) |
+			(spreadBits(gridCoordinate(cy, scale)) << 1) |
+			spreadBits(gridCoordinate(cz, scale));
+		order[i].triangle = i;
+	}
+	std::stable_sort(order.begin(), order.end(), mortonLess);
+
+	//Local index of each vertex in the meshlet being built or -1
+	std::vector<int> local_index(num_vertices, -1);
+
+	Meshlet current;
+	current.vertex_offset = 0;
+	current.vertex_count = 0;
+	current.triangle_offset = 0;
+	current.triangle_count = 0;
+
+	//Greedily pack triangles into meshlets
+	for(int i = 0; i < num_triangles; i++) {
+		Triangle *t = g->getTriangle(order[i].triangle);
+
+		unsigned int new_vertices = 0;
+		for(int j = 0; j < 3; j++) {
+			if(local_index[t->vertices[j]] == -1)
+				new_vertices++;
+		}
+
+		//Close the current meshlet when the triangle does not fit
+		if(current.vertex_count + new_vertices > max_vertices || current.triangle_count + 1 > max_triangles) {
+			for(unsigned int j = 0; j < current.vertex_count; j++)
+				local_index[vertices[current.vertex_offset + j]] = -1;
+
+			meshlets.push_back(current);
+
+			current.vertex_offset = vertices.size();
+			current.vertex_count = 0;
+			current.triangle_offset = triangles.size() / 3;
+			current.triangle_count = 0;
+		}
+
+		for(int j = 0; j < 3; j++) {
+			int v = t->vertices[j];
+			if(local_index[v] == -1) {
+				local_index[v] = current.vertex_count++;
+				vertices.push_back(v);
+			}
+
+			triangles.push_back((unsigned char)local_index[v]);
+		}
+
+		current.triangle_count++;
+	}
+
+	meshlets.push_back(current);
+
+	//Compute culling data for each meshlet
+	int num_meshlets = meshlets.size();
+	bounds.resize(num_meshlets);
+	for(int i = 0; i < num_meshlets; i++)
+		bounds[i] = computeBounds(g, meshlets[i]);
+}
+
+//Compute the bounding sphere and normal cone
+MeshletBounds MeshletSet::computeBounds(Geometry *g, Meshlet &m)
+{
+	MeshletBounds b;
+	unsigned int *mv = &vertices[m.vertex_offset];
+	unsigned char *mt = &triangles[m.triangle_offset * 3];
+
+	//Bounding sphere centered on the vertex average
+	Vector3D center;
+	center.x = center.y = center.z = 0.0f;
+	for(unsigned int i = 0; i < m.vertex_count; i++) {
+		Vector3D *v = g->getVertex(mv[i]);
+		center.x += v->x;
+		center.y += v->y;
+		center.z += v->z;
+	}
+
+	float inv_count = 1.0f / (float)m.vertex_count;
+	center.x *= inv_count;
+	center.y *= inv_count;
+	center.z *= inv_count;
+
+	float radius_sq = 0.0f;
+	for(unsigned int i = 0; i < m.vertex_count; i++) {
+		Vector3D *v = g->getVertex(mv[i]);
+		float dx = v->x - center.x;
+		float dy = v->y - center.y;
+		float dz = v->z - center.z;
+		radius_sq = std::max(radius_sq, dx * dx + dy * dy + dz * dz);
+	}
+
+	b.center = center;
+	b.radius = sqrtf(radius_sq);
+
+	//Face normals of each triangle
+	std::vector<Vector3D> face_normals(m.triangle_count);
+	Vector3D axis;
+	axis.x = axis.y = axis.z = 0.0f;
+	for(unsigned int i = 0; i < m.triangle_count; i++) {
+		Vector3D *v1 = g->getVertex(mv[mt[i * 3]]);
+		Vector3D *v2 = g->getVertex(mv[mt[i * 3 + 1]]);
+		Vector3D *v3 = g->getVertex(mv[mt[i * 3 + 2]]);
+
+		Vector3D e1, e2, n;
+		e1.x = v2->x - v1->x; e1.y = v2->y - v1->y; e1.z = v2->z - v1->z;
+		e2.x = v3->x - v1->x; e2.y = v3->y - v1->y; e2.z = v3->z - v1->z;
+
+		n.x = e1.y * e2.z - e1.z * e2.y;
+		n.y = e1.z * e2.x - e1.x * e2.z;
+		n.z = e1.x * e2.y - e1.y * e2.x;
+
+		float length = sqrtf(n.x * n.x + n.y * n.y + n.z * n.z);
+		float inv_length = length > 0.0f ? 1.0f / length : 0.0f;
+		n.x *= inv_length;
+		n.y *= inv_length;
+		n.z *= inv_length;
+
+		face_normals[i] = n;
+		axis.x += n.x;
+		axis.y += n.y;
+		axis.z += n.z;
+	}
+
+	float axis_length = sqrtf(axis.x * axis.x + axis.y * axis.y + axis.z * axis.z);
+	float inv_axis_length = axis_length > 0.0f ? 1.0f / axis_length : 0.0f;
+	axis.x *= inv_axis_length;
+	axis.y *= inv_axis_length;
+	axis.z *= inv_axis_length;
+
+	//Find the widest angle between the axis and any face
+	float min_dot = 1.0f;
+	for(unsigned int i = 0; i < m.triangle_count; i++) {
+		Vector3D &n = face_normals[i];
+		min_dot = std::min(min_dot, n.x * axis.x + n.y * axis.y + n.z * axis.z);
+	}
+
+	//Cone spans more than a hemisphere so it can never be culled
+	if(min_dot <= 0.0f || axis_length == 0.0f) {
+		b.cone_apex = center;
+		b.cone_axis.x = b.cone_axis.y = b.cone_axis.z = 0.0f;
+		b.cone_cutoff = 1.0f;
+
+		return b;
+	}
+
+	//Move the apex back along the axis until every triangle plane is in front of it
+	float max_t = 0.0f;
+	for(unsigned int i = 0; i < m.triangle_count; i++) {
+		Vector3D *v1 = g->getVertex(mv[mt[i * 3]]);
+		Vector3D &n = face_normals[i];
+
+		float dc = (center.x - v1->x) * n.x + (center.y - v1->y) * n.y + (center.z - v1->z) * n.z;
+		float dn = axis.x * n.x + axis.y * n.y + axis.z * n.z;
+
+		if(dn > 0.0f)
+			max_t = std::max(max_t, dc / dn);
+	}
+
+	b.cone_apex.x = center.x - axis.x * max_t;
+	b.cone_apex.y = center.y - axis.y * max_t;
+	b.cone_apex.z = center.z - axis.z * max_t;
+	b.cone_axis = axis;
+	b.cone_cutoff = sqrtf(1.0f - min_dot * min_dot);
+
+	return b;
+}
+
+//Save meshlet arrays to an extra node
+int MeshletSet::save(pugi::xml_node root)
+{
+	if(!root)
+		return 1;
+
+	pugi::xml_node extra_node = root.append_child("extra");
+	pugi::xml_node technique_node = extra_node.append_child("technique");
+	technique_node.append_attribute("profile") = "ShockShapes";
+
+	pugi::xml_node meshlets_node = technique_node.append_child("meshlets");
+	meshlets_node.append_attribute("count") = (unsigned int)meshlets.size();
+	meshlets_node.append_attribute("max_vertices") = max_vertices;
+	meshlets_node.append_attribute("max_triangles") = max_triangles;
+
+	//Descriptors as vertex offset, vertex count, triangle offset, triangle count
+	std::ostringstream desc_stream;
+	int num_meshlets = meshlets.size();
+	for(int i = 0; i < num_meshlets; i++) {
+		desc_stream << meshlets[i].vertex_offset << " " << meshlets[i].vertex_count << " ";
+		desc_stream << meshlets[i].triangle_offset << " " << meshlets[i].triangle_count;
+		if(i != num_meshlets - 1)
+			desc_stream << " ";
+	}
+
+	pugi::xml_node desc_node = meshlets_node.append_child("int_array");
+	desc_node.append_attribute("name") = "descriptors";
+	desc_node.append_attribute("count") = num_meshlets * 4;
+	desc_node.text() = desc_stream.str().c_str();
+
+	//Global vertex indices
+	std::ostringstream vertex_stream;
+	int num_indices = vertices.size();
+	for(int i = 0; i < num_indices; i++) {
+		vertex_stream << vertices[i];
+		if(i != num_indices - 1)
+			vertex_stream << " ";
+	}
+
+	pugi::xml_node vertex_node = meshlets_node.append_child("int_array");
+	vertex_node.append_attribute("name") = "vertices";
+	vertex_node.append_attribute("count") = num_indices;
+	vertex_node.text() = vertex_stream.str().c_str();
+
+	//Local triangle indices
+	std::ostringstream tri_stream;
+	int num_tri_indices = triangles.size();
+	for(int i = 0; i < num_tri_indices; i++) {
+		tri_stream << (unsigned int)triangles[i];
+		if(i != num_tri_indices - 1)
+			tri_stream << " ";
+	}
+
+	pugi::xml_node tri_node = meshlets_node.append_child("int_array");
+	tri_node.append_attribute("name") = "triangles";
+	tri_node.append_attribute("count") = num_tri_indices;
+	tri_node.text() = tri_stream.str().c_str();
+
+	//Bounds as center, radius, cone apex, cone axis, cone cutoff
+	std::ostringstream bounds_stream;
+	bounds_stream << std::setiosflags(std::ios::showpoint);
+	for(int i = 0; i < num_meshlets; i++) {
+		MeshletBounds &b = bounds[i];
+		bounds_stream << DEC_FORMAT << b.center.x << " " << DEC_FORMAT << b.center.y << " " << DEC_FORMAT << b.center.z << " ";
+		bounds_stream << DEC_FORMAT << b.radius << " ";
+		bounds_stream << DEC_FORMAT << b.cone_apex.x << " " << DEC_FORMAT << b.cone_apex.y << " " << DEC_FORMAT << b.cone_apex.z << " ";
+		bounds_stream << DEC_FORMAT << b.cone_axis.x << " " << DEC_FORMAT << b.cone_axis.y << " " << DEC_FORMAT << b.cone_axis.z << " ";
+		bounds_stream << DEC_FORMAT << b.cone_cutoff;
+		if(i != num_meshlets - 1)
+			bounds_stream << " ";
+	}
+
+	pugi::xml_node bounds_node = meshlets_node.append_child("float_array");
+	bounds_node.append_attribute("name") = "bounds";
+	bounds_node.append_attribute("count") = num_meshlets * 11;
+	bounds_node.text() = bounds_stream.str().c_str();
+
+	return 0;
+}
+
+//Accessors
+int MeshletSet::getNumMeshlets()
+{
+	return meshlets.size();
+}
+
+unsigned int MeshletSet::getMaxVertices()
+{
+	return max_vertices;
+}
+
+unsigned int MeshletSet::getMaxTriangles()
+{
+	return max_triangles;
+}
+
+Meshlet *MeshletSet::getMeshlet(int index)
+{
+	return &meshlets[index];
+}
+
+MeshletBounds *MeshletSet::getBounds(int index)
+{
+	return &bounds[index];
+}
+
+unsigned int *MeshletSet::getVertexIndices()
+{
+	return vertices.empty() ? NULL : &vertices[0];
+}
+
+unsigned char *MeshletSet::getTriangleIndices()
+{
+	return triangles.empty() ? NULL : &triangles[0];
+}
@@ -0,0 +1,119 @@
+/** @file MeshletSet.h
+ *
+ * @brief Partitions a mesh into small clusters that can be culled individually
+ *
+ * Copyright 2013, Stewart Hall
+ *
+ * Licensed under The MIT License
+ * Redistributions of files must retain the above copyright notice.
+ *
+ * @author		Stewart Hall (www.stewartghall.com)
+ * @date		10/18/2026
+ * @copyright	Copyright 2013, Stewart Hall
+ * @license		MIT License (http://www.opensource.org/licenses/mit-license.php)
+ */
+
+#ifndef _MESHLETSET_
+#define _MESHLETSET_
+
+#include <vector>
+
+#include "pugixml.hpp"
+#include "CommonDefs.h"
+
+#define MESHLET_MAX_VERTICES 64
+#define MESHLET_MAX_TRIANGLES 124
+
+class Geometry;
+
+/**
+ * @brief Describes where a single meshlet's data lives in the shared arrays
+ */
+typedef struct {
+	unsigned int vertex_offset;		/**< First entry in the meshlet vertex array. */
+	unsigned int vertex_count;		/**< Number of vertices used by the meshlet. */
+	unsigned int triangle_offset;	/**< First triangle in the meshlet triangle array. */
+	unsigned int triangle_count;	/**< Number of triangles in the meshlet. */
+} Meshlet;
+
+/**
+ * @brief Culling information for a single meshlet
+ * @details A meshlet is back facing for a viewer at position p when
+ * dot(normalize(apex - p), axis) >= cutoff. A cutoff of 1 disables cone culling.
+ */
+typedef struct {
+	Vector3D center;				/**< Center of the bounding sphere. */
+	float radius;					/**< Radius of the bounding sphere. */
+
+	Vector3D cone_apex;				/**< Apex of the normal cone. */
+	Vector3D cone_axis;				/**< Average facing direction of the meshlet. */
+	float cone_cutoff;				/**< Sine of the cone's half angle. */
+} MeshletBounds;
+
+/**
+ * @brief A mesh partitioned into bounded clusters
+ * @details Triangles are ordered by the position of their centroid along a
+ * morton curve and greedily packed into clusters so that each cluster is
+ * spatially compact. The data is stored in flat arrays: each Meshlet indexes a
+ * range of global vertex indices and a range of local triangles whose corners
+ * index into that vertex range.
+ */
+class MeshletSet {
+private:
+	std::vector<Meshlet> meshlets;				/**< Descriptor of each meshlet. */
+	std::vector<MeshletBounds> bounds;			/**< Culling data of each meshlet. */
+	std::vector<unsigned int> vertices;			/**< Global vertex indices referenced by meshlets. */
+	std::vector<unsigned char> triangles;		/**< Meshlet local vertex indices, three per triangle. */
+
+	unsigned int max_vertices;					/**< Vertex limit used when building. */
+	unsigned int max_triangles;					/**< Triangle limit used when building. */
+
+	/**
+	 * Computes the bounding sphere and normal cone of a meshlet
+	 * @param g The geometry the meshlet was built from
+	 * @param m The meshlet to compute bounds for
+	 * @return The bounds of the meshlet
+	 */
+	MeshletBounds computeBounds(Geometry *g, Meshlet &m);
+
+public:
+	MeshletSet();						/**< Constructs an empty set. */
+
+	~MeshletSet();						/**< Destructor. */
+
+	/**
+	 * Partitions a mesh into meshlets. Any previous partitioning is discarded.
+	 * @param g The geometry to partition
+	 * @param imax_vertices Maximum vertices per meshlet. Clamped to 255
+	 * @param imax_triangles Maximum triangles per meshlet
+	 */
+	void build(Geometry *g, unsigned int imax_vertices, unsigned int imax_triangles);
+
+	/**
+	 * Removes all meshlets
+	 */
+	void clear();
+
+	/**
+	 * Saves the meshlet arrays as a COLLADA extra technique
+	 * @param root The node to add the extra element to
+	 * @return Returns 0 if no errors occur
+	 */
+	int save(pugi::xml_node root);
+
+	int getNumMeshlets();						/**< Returns the number of meshlets. */
+
+	unsigned int getMaxVertices();				/**< Returns the vertex limit of each meshlet. */
+
+	unsigned int getMaxTriangles();				/**< Returns the triangle limit of each meshlet. */
+
+	Meshlet *getMeshlet(int index);				/**< Returns a meshlet descriptor by index. */
+
+	MeshletBounds *getBounds(int index);		/**< Returns the culling data of a meshlet. */
+
+	unsigned int *getVertexIndices();			/**< Returns the array of global vertex indices. */
+
+	unsigned char *getTriangleIndices();		/**< Returns the array of local triangle indices. */
+};
+
+#endif
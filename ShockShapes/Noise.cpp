@@ -0,0 +1,288 @@
+/** @file Noise.cpp
+ *
+ * @brief Seeded gradient noise evaluated in batches with SSE2
+ *
+ * Copyright 2013, Stewart Hall
+ *
+ * Licensed under The MIT License
+ * Redistributions of files must retain the above copyright notice.
+ *
+ * @author		Stewart Hall (www.stewartghall.com)
+ * @date		10/18/2026
+ * @copyright	Copyright 2013, Stewart Hall
+ * @license		MIT License (http://www.opensource.org/licenses/mit-license.php)
+ */
+
+#include <math.h>
+
+#include "Noise.h"
+
+#ifdef NOISE_SSE2
+#include <emmintrin.h>
+#endif
+
+//Smooth interpolation weight with zero first and second derivatives at 0 and 1
+static float fade(float t)
+{
+	return t * t * t * (t * (t * 6.0f - 15.0f) + 10.0f);
+}
+
+//Linear interpolation
+static float lerp(float t, float a, float b)
+{
+	return a + t * (b - a);
+}
+
+//Dot product of an offset with one of 12 gradient directions picked by a hash
+static float grad(int hash, float x, float y, float z)
+{
+	int h = hash & 15;
+	float u = h < 8 ? x : y;
+	float v = h < 4 ? y : (h == 12 || h == 14 ? x : z);
+
+	return ((h & 1) ? -u : u) + ((h & 2) ? -v : v);
+}
+
+#ifdef NOISE_SSE2
+//Pick a where mask is set and b elsewhere
+static __m128 select4(__m128 mask, __m128 a, __m128 b)
+{
+	return _mm_or_ps(_mm_and_ps(mask, a), _mm_andnot_ps(mask, b));
+}
+
+//Four lane version of fade
+static __m128 fade4(__m128 t)
+{
+	__m128 inner = _mm_add_ps(_mm_mul_ps(t, _mm_sub_ps(_mm_mul_ps(t, _mm_set1_ps(6.0f)), _mm_set1_ps(15.0f))), _mm_set1_ps(10.0f));
+	return _mm_mul_ps(_mm_mul_ps(_mm_mul_ps(t, t), t), inner);
+}
+
+//Four lane version of lerp
+static __m128 lerp4(__m128 t, __m128 a, __m128 b)
+{
+	return _mm_add_ps(a, _mm_mul_ps(t, _mm_sub_ps(b, a)));
+}
+
+//Four lane version of grad
+static __m128 grad4(__m128i hash, __m128 x, __m128 y, __m128 z)
+{
+	__m128i h = _mm_and_si128(hash, _mm_set1_epi32(15));
+
+	__m128 below8 = _mm_castsi128_ps(_mm_cmplt_epi32(h, _mm_set1_epi32(8)));
+	__m128 below4 = _mm_castsi128_ps(_mm_cmplt_epi32(h, _mm_set1_epi32(4)));
+	__m128 use_x = _mm_castsi128_ps(_mm_or_si128(_mm_cmpeq_epi32(h, _mm_set1_epi32(12)), _mm_cmpeq_epi32(h, _mm_set1_epi32(14))));
+
+	__m128 u = select4(below8, x, y);
+	__m128 v = select4(below4, y, select4(use_x, x, z));
+
+	//Bits 0 and 1 of the hash flip the signs
+	__m128 u_sign = _mm_castsi128_ps(_mm_slli_epi32(_mm_and_si128(h, _mm_set1_epi32(1)), 31));
+	__m128 v_sign = _mm_castsi128_ps(_mm_slli_epi32(_mm_and_si128(h, _mm_set1_epi32(2)), 30));
+
+	return _mm_add_ps(_mm_xor_ps(u, u_sign), _mm_xor_ps(v, v_sign));
+}
+
+//Round down to the next integer
+static __m128 floor4(__m128 x)
+{
+	__m128 truncated = _mm_cvtepi32_ps(_mm_cvttps_epi32(x));
+	__m128 too_big = _mm_cmplt_ps(x, truncated);
+
+	return _mm_sub_ps(truncated, _mm_and_ps(too_big, _mm_set1_ps(1.0f)));
+}
+#endif
+
+//Constructor
+GradientNoise::GradientNoise(unsigned int seed)
+{
+	for(int i = 0; i < 256; i++)
+		perm[i] = i;
+
+	//Shuffle with a generator of our own so every platform gets the same table
+	unsigned int state = seed * 747796405u + 2891336453u;
+	for(int i = 255; i > 0; i--) {
+		state ^= state << 13;
+		state ^= state >> 17;
+		state ^= state << 5;
+
+		int j = (int)(state % (unsigned int)(i + 1));
+		int t = perm[i];
+		perm[i] = perm[j];
+		perm[j] = t;
+	}
+
+	for(int i = 0; i < 256; i++)
+		perm[i + 256] = perm[i];
+}
+
+//Destructor
+GradientNoise::~GradientNoise()
+{
+
+}
+
+//Noise at one point
+float GradientNoise::sample(float x, float y, float z)
+{
+	float fx = floorf(x);
+	float fy = floorf(y);
+	float fz = floorf(z);
+
+	int X = (int)fx & 255;
+	int Y = (int)fy & 255;
+	int Z = (int)fz & 255;
+
+	x -= fx;
+	y -= fy;
+	z -= fz;
+
+	float u = fade(x);
+	float v = fade(y);
+	float w = fade(z);
+
+	//Hash the eight corners of the cell
+	int A = perm[X] + Y;
+	int AA = perm[A] + Z;
+	int AB = perm[A + 1] + Z;
+	int B = perm[X + 1] + Y;
+	int BA = perm[B] + Z;
+	int BB = perm[B + 1] + Z;
+
+	return lerp(w, lerp(v, lerp(u, grad(perm[AA], x, y, z), grad(perm[BA], x - 1.0f, y, z)),
+			lerp(u, grad(perm[AB], x, y - 1.0f, z), grad(perm[BB], x - 1.0f, y - 1.0f, z))),
+		lerp(v, lerp(u, grad(perm[AA + 1], x, y, z - 1.0f), grad(perm[BA + 1], x - 1.0f, y, z - 1.0f)),
+			lerp(u, grad(perm[AB + 1], x, y - 1.0f, z - 1.0f), grad(perm[BB + 1], x - 1.0f, y - 1.0f, z - 1.0f))));
+}
+
+//Noise at a batch of points
+void GradientNoise::noiseBatch(const float *x, const float *y, const float *z, float *result)
+{
+#ifdef NOISE_SSE2
+	int cell[3][4];
+	int hashes[8][4];
+	__m128 one = _mm_set1_ps(1.0f);
+	__m128i mask = _mm_set1_epi32(255);
+
+	for(int half = 0; half < NOISE_BATCH_SIZE; half += 4) {
+		__m128 px = _mm_loadu_ps(x + half);
+		__m128 py = _mm_loadu_ps(y + half);
+		__m128 pz = _mm_loadu_ps(z + half);
+
+		__m128 fx = floor4(px);
+		__m128 fy = floor4(py);
+		__m128 fz = floor4(pz);
+
+		_mm_storeu_si128((__m128i*)cell[0], _mm_and_si128(_mm_cvttps_epi32(fx), mask));
+		_mm_storeu_si128((__m128i*)cell[1], _mm_and_si128(_mm_cvttps_epi32(fy), mask));
+		_mm_storeu_si128((__m128i*)cell[2], _mm_and_si128(_mm_cvttps_epi32(fz), mask));
+
+		px = _mm_sub_ps(px, fx);
+		py = _mm_sub_ps(py, fy);
+		pz = _mm_sub_ps(pz, fz);
+
+		//SSE2 has no gather, so the permutation lookups are done per lane
+		for(int i = 0; i < 4; i++) {
+			int A = perm[cell[0][i]] + cell[1][i];
+			int AA = perm[A] + cell[2][i];
+			int AB = perm[A + 1] + cell[2][i];
+			int B = perm[cell[0][i] + 1] + cell[1][i];
+			int BA = perm[B] + cell[2][i];
+			int BB = perm[B + 1] + cell[2][i];
+
+			hashes[0][i] = perm[AA];
+			hashes[1][i] = perm[BA];
+			hashes[2][i] = perm[AB];
+			hashes[3][i] = perm[BB];
+			hashes[4][i] = perm[AA + 1];
+			hashes[5][i] = perm[BA + 1];
+			hashes[6][i] = perm[AB + 1];
+			hashes[7][i] = perm[BB + 1];
+		}
+
+		__m128 u = fade4(px);
+		__m128 v = fade4(py);
+		__m128 w = fade4(pz);
+
+		__m128 px1 = _mm_sub_ps(px, one);
+		__m128 py1 = _mm_sub_ps(py, one);
+		__m128 pz1 = _mm_sub_ps(pz, one);
+
+		__m128 g0 = grad4(_mm_loadu_si128((__m128i*)hashes[0]), px, py, pz);
+		__m128 g1 = grad4(_mm_loadu_si128((__m128i*)hashes[1]), px1, py, pz);
+		__m128 g2 = grad4(_mm_loadu_si128((__m128i*)hashes[2]), px, py1, pz);
+		__m128 g3 = grad4(_mm_loadu_si128((__m128i*)hashes[3]), px1, py1, pz);
+		__m128 g4 = grad4(_mm_loadu_si128((__m128i*)hashes[4]), px, py, pz1);
+		__m128 g5 = grad4(_mm_loadu_si128((__m128i*)hashes[5]), px1, py, pz1);
+		__m128 g6 = grad4(_mm_loadu_si128((__m128i*)hashes[6]), px, py1, pz1);
+		__m128 g7 = grad4(_mm_loadu_si128((__m128i*)hashes[7]), px1, py1, pz1);
+
+		__m128 r = lerp4(w, lerp4(v, lerp4(u, g0, g1), lerp4(u, g2, g3)),
+			lerp4(v, lerp4(u, g4, g5), lerp4(u, g6, g7)));
+
+		_mm_storeu_ps(result + half, r);
+	}
+#else
+	for(int i = 0; i < NOISE_BATCH_SIZE; i++)
+		result[i] = sample(x[i], y[i], z[i]);
+#endif
+}
+
+//Fractal noise at one point
+float GradientNoise::fractal(float x, float y, float z, int octaves, float lacunarity, float gain)
+{
+	float sum = 0.0f;
+	float amplitude = 1.0f;
+	float total_amplitude = 0.0f;
+	float frequency = 1.0f;
+
+	for(int i = 0; i < octaves; i++) {
+		sum += amplitude * sample(x * frequency, y * frequency, z * frequency);
+		total_amplitude += amplitude;
+
+		frequency *= lacunarity;
+		amplitude *= gain;
+	}
+
+	if(total_amplitude > 0.0f)
+		sum /= total_amplitude;
+
+	return sum;
+}
+
+//Fractal noise at a batch of points
+void GradientNoise::fractalBatch(const float *x, const float *y, const float *z, int octaves, float lacunarity, float gain, float *result)
+{
+	float px[NOISE_BATCH_SIZE];
+	float py[NOISE_BATCH_SIZE];
+	float pz[NOISE_BATCH_SIZE];
+	float octave[NOISE_BATCH_SIZE];
+
+	float amplitude = 1.0f;
+	float total_amplitude = 0.0f;
+	float frequency = 1.0f;
+
+	for(int i = 0; i < NOISE_BATCH_SIZE; i++)
+		result[i] = 0.0f;
+
+	for(int o = 0; o < octaves; o++) {
+		for(int i = 0; i < NOISE_BATCH_SIZE; i++) {
+			px[i] = x[i] * frequency;
+			py[i] = y[i] * frequency;
+			pz[i] = z[i] * frequency;
+		}
+
+		noiseBatch(px, py, pz, octave);
+		for(int i = 0; i < NOISE_BATCH_SIZE; i++)
+			result[i] += amplitude * octave[i];
+
+		total_amplitude += amplitude;
+		frequency *= lacunarity;
+		amplitude *= gain;
+	}
+
+	if(total_amplitude > 0.0f) {
+		float inv_total = 1.0f / total_amplitude;
+		for(int i = 0; i < NOISE_BATCH_SIZE; i++)
+			result[i] *= inv_total;
+	}
+}
@@ -0,0 +1,88 @@
+/** @file Noise.h
+ *
+ * @brief Seeded gradient noise evaluated in batches with SSE2
+ *
+ * Copyright 2013, Stewart Hall
+ *
+ * Licensed under The MIT License
+ * Redistributions of files must retain the above copyright notice.
+ *
+ * @author		Stewart Hall (www.stewartghall.com)
+ * @date		10/18/2026
+ * @copyright	Copyright 2013, Stewart Hall
+ * @license		MIT License (http://www.opensource.org/licenses/mit-license.php)
+ */
+
+#ifndef _NOISE_
+#define _NOISE_
+
+#if defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2) || defined(__SSE2__)
+#define NOISE_SSE2
+#endif
+
+/**
+ * Number of points evaluated together by the batch functions
+ */
+#define NOISE_BATCH_SIZE 8
+
+/**
+ * @brief Perlin gradient noise and fractal sums of it
+ * @details The value at a point depends only on the point and the seed,
+ * so points can be evaluated in any order or in parallel and give the same
+ * result. Values are roughly between -1 and 1 and are 0 at integer
+ * coordinates. The batch functions take NOISE_BATCH_SIZE points as separate
+ * x, y and z arrays and use SSE2 when the compiler targets it.
+ */
+class GradientNoise {
+private:
+	int perm[512];		/**< Seeded permutation of 0 to 255, repeated twice. */
+
+	/**
+	 * Evaluates noise at NOISE_BATCH_SIZE points
+	 * @param x X coordinates
+	 * @param y Y coordinates
+	 * @param z Z coordinates
+	 * @param result Set to the noise at each point
+	 */
+	void noiseBatch(const float *x, const float *y, const float *z, float *result);
+
+public:
+	GradientNoise(unsigned int seed);	/**< Constructs the noise for a seed. */
+
+	~GradientNoise();					/**< Destructor. */
+
+	/**
+	 * Evaluates noise at one point
+	 * @param x X coordinate
+	 * @param y Y coordinate
+	 * @param z Z coordinate
+	 * @return The noise value
+	 */
+	float sample(float x, float y, float z);
+
+	/**
+	 * Evaluates fractal Brownian motion at one point
+	 * @param x X coordinate
+	 * @param y Y coordinate
+	 * @param z Z coordinate
+	 * @param octaves Number of noise layers to add
+	 * @param lacunarity Frequency multiplier between octaves
+	 * @param gain Amplitude multiplier between octaves
+	 * @return The sum of the octaves divided by the sum of their amplitudes
+	 */
+	float fractal(float x, float y, float z, int octaves, float lacunarity, float gain);
+
+	/**
+	 * Evaluates fractal Brownian motion at NOISE_BATCH_SIZE points
+	 * @param x X coordinates
+	 * @param y Y coordinates
+	 * @param z Z coordinates
+	 * @param octaves Number of noise layers to add
+	 * @param lacunarity Frequency multiplier between octaves
+	 * @param gain Amplitude multiplier between octaves
+	 * @param result Set to the value at each point
+	 */
+	void fractalBatch(const float *x, const float *y, const float *z, int octaves, float lacunarity, float gain, float *result);
+};
+
+#endif
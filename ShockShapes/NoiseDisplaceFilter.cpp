@@ -0,0 +1,132 @@
+/** @file NoiseDisplaceFilter.cpp
+ *
+ * @brief Geometry filter that displaces a surface with fractal noise
+ *
+ * Copyright 2013, Stewart Hall
+ *
+ * Licensed under The MIT License
+ * Redistributions of files must retain the above copyright notice.
+ *
+ * @author		Stewart Hall (www.stewartghall.com)
+ * @date		10/18/2026
+ * @copyright	Copyright 2013, Stewart Hall
+ * @license		MIT License (http://www.opensource.org/licenses/mit-license.php)
+ */
+
+#include <math.h>
+
+#include "NoiseDisplaceFilter.h"
+
+//Constructor
+NoiseDisplaceFilter::NoiseDisplaceFilter(float imagnitude, float ifrequency, int ioctaves, unsigned int iseed)
+:GeometryFilter("NoiseDisplace"), noise(iseed)
+{
+	magnitude = imagnitude;
+	frequency = ifrequency;
+	octaves = ioctaves;
+	lacunarity = 2.0f;
+	gain = 0.5f;
+	parent_space = true;
+}
+
+//Destructor
+NoiseDisplaceFilter::~NoiseDisplaceFilter()
+{
+
+}
+
+//Change how octaves are combined
+void NoiseDisplaceFilter::setFractal(float ilacunarity, float igain)
+{
+	lacunarity = ilacunarity;
+	gain = igain;
+}
+
+//Choose where noise is sampled
+void NoiseDisplaceFilter::setParentSpace(bool p)
+{
+	parent_space = p;
+}
+
+//Run the filter
+void NoiseDisplaceFilter::run(Geometry *g)
+{
+	int num_vertices = g->getNumVertices();
+	int num_batches = (num_vertices + NOISE_BATCH_SIZE - 1) / NOISE_BATCH_SIZE;
+
+	//Build connectivity before the parallel loop reads it
+	MeshTopology *topology = g->getTopology();
+	Matrix *m = &(g->getTransform()->m);
+
+	//Each batch only reads and writes its own vertices
+	#pragma omp parallel for schedule(static)
+	for(int b = 0; b < num_batches; b++) {
+		float x[NOISE_BATCH_SIZE];
+		float y[NOISE_BATCH_SIZE];
+		float z[NOISE_BATCH_SIZE];
+		float offsets[NOISE_BATCH_SIZE];
+
+		int first = b * NOISE_BATCH_SIZE;
+		int count = num_vertices - first;
+		if(count > NOISE_BATCH_SIZE)
+			count = NOISE_BATCH_SIZE;
+
+		//Gather sample points, repeating the first vertex to fill the last batch
+		for(int i = 0; i < NOISE_BATCH_SIZE; i++) {
+			Vector3D *p = g->getVertex(first + (i < count ? i : 0));
+			float px = p->x;
+			float py = p->y;
+			float pz = p->z;
+
+			//Only the object's own transform is known here, not its parents
+			if(parent_space) {
+				px = m->r0[0] * p->x + m->r0[1] * p->y + m->r0[2] * p->z + m->r0[3];
+				py = m->r1[0] * p->x + m->r1[1] * p->y + m->r1[2] * p->z + m->r1[3];
+				pz = m->r2[0] * p->x + m->r2[1] * p->y + m->r2[2] * p->z + m->r2[3];
+			}
+
+			x[i] = px * frequency;
+			y[i] = py * frequency;
+			z[i] = pz * frequency;
+		}
+
+		noise.fractalBatch(x, y, z, octaves, lacunarity, gain, offsets);
+
+		for(int i = 0; i < count; i++) {
+			int v = first + i;
+
+			//Average the normals of the corners using this vertex
+			Vector3D direction;
+			direction.x = direction.y = direction.z = 0.0f;
+
+			int num_corners = topology->getNumVertexCorners(v);
+			const int *corners = topology->getVertexCorners(v);
+			for(int j = 0; j < num_corners; j++) {
+				Triangle *t = g->getTriangle(MeshTopology::triangle(corners[j]));
+				Vector3D *n = g->getNormal(t->normals[corners[j] % 3]);
+				direction.x += n->x;
+				direction.y += n->y;
+				direction.z += n->z;
+			}
+
+			//Unused vertices and cancelling normals have no direction to move in
+			float length = sqrtf(direction.x * direction.x + direction.y * direction.y + direction.z * direction.z);
+			if(length <= 0.0f)
+				continue;
+
+			float scalar = magnitude * offsets[i] / length;
+			Vector3D *p = g->getVertex(v);
+			p->x += direction.x * scalar;
+			p->y += direction.y * scalar;
+			p->z += direction.z * scalar;
+		}
+	}
+
+	return;
+}
+
+//Only reads normals
+int NoiseDisplaceFilter::getNormalUsage()
+{
+	return FN_READS;
+}
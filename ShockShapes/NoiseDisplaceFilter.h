@@ -0,0 +1,84 @@
+/** @file NoiseDisplaceFilter.h
+ *
+ * @brief Geometry filter that displaces a surface with fractal noise
+ *
+ * Copyright 2013, Stewart Hall
+ *
+ * Licensed under The MIT License
+ * Redistributions of files must retain the above copyright notice.
+ *
+ * @author		Stewart Hall (www.stewartghall.com)
+ * @date		10/18/2026
+ * @copyright	Copyright 2013, Stewart Hall
+ * @license		MIT License (http://www.opensource.org/licenses/mit-license.php)
+ */
+
+#ifndef _NOISEDISPLACEFILTER_
+#define _NOISEDISPLACEFILTER_
+
+#include "GeometryFilter.h"
+#include "Geometry.h"
+#include "Noise.h"
+
+/**
+ * @brief Moves each vertex along its normal by coherent noise
+ * @details Unlike GBumpFilter, the offset of a vertex is a smooth function
+ * of its position after the object's own transform, which places it in its
+ * parent. Surfaces in the same parent that meet, or the same object at
+ * another subdivision level, get the same offsets where they touch. Parent
+ * transforms are not applied, and TiledGroup filters its base object before
+ * placing tiles, so every tile of a tiled group gets the same offsets. Each
+ * vertex is moved once along the average of the normals of the triangle
+ * corners that use it, so the mesh stays closed. Results depend only on the
+ * seed and the vertex positions.
+ */
+class NoiseDisplaceFilter : public GeometryFilter {
+private:
+	GradientNoise noise;	/**< Noise for the seed. */
+	float magnitude;		/**< Largest distance a vertex is moved. */
+	float frequency;		/**< Noise cycles per unit of distance in the first octave. */
+	int octaves;			/**< Number of noise layers. */
+	float lacunarity;		/**< Frequency multiplier between octaves. */
+	float gain;				/**< Amplitude multiplier between octaves. */
+	bool parent_space;		/**< When set, noise is sampled after applying the object's transform. */
+
+public:
+	/**
+	 * Constructs a new noise displacement filter
+	 * @param imagnitude The largest distance to move a vertex
+	 * @param ifrequency Noise cycles per unit of distance in the first octave
+	 * @param ioctaves Number of noise layers, each adding finer detail
+	 * @param iseed Seed for the noise
+	 */
+	NoiseDisplaceFilter(float imagnitude, float ifrequency, int ioctaves, unsigned int iseed);
+
+	~NoiseDisplaceFilter();		/**< Destructor. */
+
+	/**
+	 * Changes how octaves are combined
+	 * @param ilacunarity Frequency multiplier between octaves, 2 by default
+	 * @param igain Amplitude multiplier between octaves, 0.5 by default
+	 */
+	void setFractal(float ilacunarity, float igain);
+
+	/**
+	 * Chooses where noise is sampled
+	 * @param p If true, sample in the parent's space after the object's own
+	 * transform, which is the default. If false, sample in object space
+	 */
+	void setParentSpace(bool p);
+
+	/**
+	 * Displaces the vertices of the object
+	 * @param g The object to apply the filter to
+	 */
+	virtual void run(Geometry *g);
+
+	/**
+	 * Describes how the filter uses normals
+	 * @return FN_READS
+	 */
+	virtual int getNormalUsage();
+};
+
+#endif
@@ -13,7 +13,6 @@
  * @license		MIT License (http://www.opensource.org/licenses/mit-license.php)
  */
 
-#include <math.h>
 #include <vector>
 
 #include "NormalFilter.h"
@@ -24,6 +23,7 @@ NormalFilter::NormalFilter(normal_method imethod)
 	method = imethod;
 	soften_all = true;
 	threshold = 2.0f;
+	replace = false;
 }
 
 //Destructor
@@ -45,273 +45,207 @@ void NormalFilter::disableSoftenThreshold()
 	soften_all = true;
 }
 
+//Check if the soften threshold is used
+bool NormalFilter::isSoftenThresholdEnabled()
+{
+	return !soften_all;
+}
+
+//Get the soften threshold
+float NormalFilter::getSoftenThreshold()
+{
+	return threshold;
+}
+
+//Rebuild the normal buffer on each run
+void NormalFilter::enableReplace()
+{
+	replace = true;
+}
+
+//Add to the normal buffer on each run
+void NormalFilter::disableReplace()
+{
+	replace = false;
+}
+
 //Change the generation method
 void NormalFilter::changeMethod(normal_method m)
 {
 	method = m;
 }
 
-//Re-generate normals for a mesh
-void NormalFilter::run(Geometry *g)
+//Calculate softened normals for every vertex
+int NormalFilter::softenNormals(Geometry *g, Vector3D *face_normals, Vector3D *new_normals, int *corner_normals)
 {
-	Vector3D* v1;
-	Vector3D* v2;
-	Vector3D* v3;
-	Triangle* current;
-	Triangle current_mod;
-	Vector3D edge1, edge2;
 	Vector3D normal;
-
 	int n1;
 	int count;
-	float magnitude;
 	float dot;
 	float inv_threshold = 1.0f - threshold;
-
-	int num_triangles = g->getNumTriangles();
-	if(method == NM_HARDEN) {
-		//Calculate per face normals for each triangle
-		for(int i = 0; i < num_triangles; i++) {
-			//Get the triangle
-			current = g->getTriangle(i);
-
-			//Get vertices
-			v1 = g->getVertex(current->vertices[0]);
-			v2 = g->getVertex(current->vertices[1]);
-			v3 = g->getVertex(current->vertices[2]);
-
-			//Calculate edge vectors of the triangle
-			edge1.x = v2->x - v1->x;
-			edge1.y = v2->y - v1->y;
-			edge1.z = v2->z - v1->z;
-
-			edge2.x = v3->x - v1->x;
-			edge2.y = v3->y - v1->y;
-			edge2.z = v3->z - v1->z;
-
-			//Calculate normal from cross product
-			normal.x = edge1.y * edge2.z - edge1.z * edge2.y;
-			normal.y = edge1.z * edge2.x - edge1.x * edge2.z;
-			normal.z = edge1.x * edge2.y - edge1.y * edge2.x;
-
-			//Normalize the resulting normal
-			magnitude = sqrtf(normal.x * normal.x + normal.y * normal.y + normal.z * normal.z);
-			magnitude = 1.0f / magnitude;
-			normal.x *= magnitude;
-			normal.y *= magnitude;
-			normal.z *= magnitude;
-
-			//Add normal to geometry buffer
-			n1 = g->addNormal(normal);
-
-			//Modify triangle and replace in mesh
-			current_mod.vertices[0] = current->vertices[0];
-			current_mod.vertices[1] = current->vertices[1];
-			current_mod.vertices[2] = current->vertices[2];
-
-			current_mod.uvs[0] = current->uvs[0];
-			current_mod.uvs[1] = current->uvs[1];
-			current_mod.uvs[2] = current->uvs[2];
-
-			current_mod.normals[0] = n1;
-			current_mod.normals[1] = n1;
-			current_mod.normals[2] = n1;
-
-			g->setTriangle(i, current_mod);
-		}
-	} else {
-		//Calculate all per-face normals
-		Vector3D *face_normals = new Vector3D[g->getNumTriangles()];
-		for(int i = 0; i < num_triangles; i++) {
-			//Get the triangle
-			current = g->getTriangle(i);
-
-			//Get vertices
-			v1 = g->getVertex(current->vertices[0]);
-			v2 = g->getVertex(current->vertices[1]);
-			v3 = g->getVertex(current->vertices[2]);
-
-			//Calculate edge vectors of the triangle
-			edge1.x = v2->x - v1->x;
-			edge1.y = v2->y - v1->y;
-			edge1.z = v2->z - v1->z;
-
-			edge2.x = v3->x - v1->x;
-			edge2.y = v3->y - v1->y;
-			edge2.z = v3->z - v1->z;
-
-			//Calculate normal from cross product
-			normal.x = edge1.y * edge2.z - edge1.z * edge2.y;
-			normal.y = edge1.z * edge2.x - edge1.x * edge2.z;
-			normal.z = edge1.x * edge2.y - edge1.y * edge2.x;
-
-			//Normalize the resulting normal
-			magnitude = sqrtf(normal.x * normal.x + normal.y * normal.y + normal.z * normal.z);
-			magnitude = 1.0f / magnitude;
-			normal.x *= magnitude;
-			normal.y *= magnitude;
-			normal.z *= magnitude;
-
-			//Add normal to geometry buffer
-			face_normals[i] = normal;
+	int num_new = 0;
+
+	//Shared connectivity gives the triangles around each vertex directly
+	MeshTopology *topology = g->getTopology();
+	const int *corners;
+	int num_corners;
+
+	//Triangles around the vertex, which of them each corner belongs to and their normals
+	std::vector<int> neighbors;
+	std::vector<int> corner_slots;
+	std::vector<int> n_normals;
+	std::vector<int> neighbor_normals;
+	float inverse_divisor;
+	int num_neighbors;
+	int num_vertices = g->getNumVertices();
+
+	for(int i = 0; i < num_vertices; i++) {
+		//Find all triangles that use this vertex
+		num_corners = topology->getNumVertexCorners(i);
+		corners = topology->getVertexCorners(i);
+		if(num_corners == 0)
+			continue;
+
+		for(int j = 0; j < num_corners; j++) {
+			//Degenerate triangles can use the vertex more than once
+			int t = MeshTopology::triangle(corners[j]);
+			if(neighbors.empty() || neighbors.back() != t) {
+				neighbors.push_back(t);
+				n_normals.push_back(-1);
+			}
+			corner_slots.push_back(neighbors.size() - 1);
 		}
 
-		//Iterate through each vertex and compute its normal(s)
-		std::vector<int> neighbors;
-		float inverse_divisor;
-		int num_neighbors;
-		int num_vertices = g->getNumVertices();
+		num_neighbors = neighbors.size();
+
 		if(soften_all) {
-			//Iterate through each vertex and calculate its normal
-			for(int i = 0; i < num_vertices; i++) {
-				//Find all triangles that use this vertex
-				for(int j = 0; j < num_triangles; j++) {
-					current = g->getTriangle(j);
-
-					if(current->vertices[0] == i || current->vertices[1] == i || current->vertices[2] == i)
-						neighbors.push_back(j);
-				}
-				
-				//Average normals of all triangles with this vertex
+			//Average normals of all triangles with this vertex
+			normal.x = normal.y = normal.z = 0.0f;
+			for(int j = 0; j < num_neighbors; j++) {
+				normal.x += face_normals[neighbors[j]].x;
+				normal.y += face_normals[neighbors[j]].y;
+				normal.z += face_normals[neighbors[j]].z;
+			}
+
+			inverse_divisor = 1.0f / (float)num_neighbors;
+			normal.x *= inverse_divisor;
+			normal.y *= inverse_divisor;
+			normal.z *= inverse_divisor;
+
+			n1 = num_new++;
+			new_normals[n1] = normal;
+			neighbor_normals.assign(num_neighbors, n1);
+		} else {
+			for(int j = 0; j < num_neighbors; j++) {
+				//Combine normals of all neighbors facing in a similar direction
 				normal.x = normal.y = normal.z = 0.0f;
-				num_neighbors = neighbors.size();
-				for(int j = 0; j < num_neighbors; j++) {
-					normal.x += face_normals[neighbors[j]].x;
-					normal.y += face_normals[neighbors[j]].y;
-					normal.z += face_normals[neighbors[j]].z;
+				count = 0;
+				n1 = -1;
+				for(int k = 0; k < num_neighbors; k++) {
+					//Make sure this triangle is facing in a similar direction
+					dot = face_normals[neighbors[k]].x * face_normals[neighbors[j]].x +
+						face_normals[neighbors[k]].y * face_normals[neighbors[j]].y +
+						face_normals[neighbors[k]].z * face_normals[neighbors[j]].z;
+
+					if(dot < inv_threshold)
+						continue;
+
+					//Check for already generated normal
+					if(n_normals[k] != -1) {
+						n1 = n_normals[k];
+						break;
+					}
+
+					normal.x += face_normals[neighbors[k]].x;
+					normal.y += face_normals[neighbors[k]].y;
+					normal.z += face_normals[neighbors[k]].z;
+
+					count++;
 				}
 
-				inverse_divisor = 1.0f / (float)num_neighbors;
-				normal.x *= inverse_divisor;
-				normal.y *= inverse_divisor;
-				normal.z *= inverse_divisor;
-
-				//Add this new normal to the geometry's buffer
-				n1 = g->addNormal(normal);
-
-				//Modify each triangle
-				for(int j = 0; j < num_neighbors; j++) {
-					current = g->getTriangle(neighbors[j]);
-
-					current_mod.vertices[0] = current->vertices[0];
-					current_mod.vertices[1] = current->vertices[1];
-					current_mod.vertices[2] = current->vertices[2];
-
-					current_mod.uvs[0] = current->uvs[0];
-					current_mod.uvs[1] = current->uvs[1];
-					current_mod.uvs[2] = current->uvs[2];
-
-					if(current->vertices[0] == i) {
-						current_mod.normals[0] = n1;
-						current_mod.normals[1] = current->normals[1];
-						current_mod.normals[2] = current->normals[2];
-					} else if(current->vertices[1] == i) {
-						current_mod.normals[0] = current->normals[0];
-						current_mod.normals[1] = n1;
-						current_mod.normals[2] = current->normals[2];
-					} else {
-						current_mod.normals[0] = current->normals[0];
-						current_mod.normals[1] = current->normals[1];
-						current_mod.normals[2] = n1;
-					}
+				//Average the normal and add it
+				if(n1 == -1) {
+					inverse_divisor = 1.0f / (float)count;
+					normal.x *= inverse_divisor;
+					normal.y *= inverse_divisor;
+					normal.z *= inverse_divisor;
 
-					g->setTriangle(neighbors[j], current_mod);
+					n1 = num_new++;
+					new_normals[n1] = normal;
+					n_normals[j] = n1;
 				}
 
-				//Clear the neighbors list
-				neighbors.clear();
+				neighbor_normals.push_back(n1);
 			}
-		} else {
-			std::vector<int> n_normals;
-			//Iterate through each vertex and calculate its normal
-			for(int i = 0; i < num_vertices; i++) {
-				//Find all triangles that use this vertex
-				for(int j = 0; j < num_triangles; j++) {
-					current = g->getTriangle(j);
-
-					if(current->vertices[0] == i || current->vertices[1] == i || current->vertices[2] == i) {
-						neighbors.push_back(j);
-						n_normals.push_back(-1);
-					}
-				}
+		}
 
-				num_neighbors = neighbors.size();
-
-				//Modify each triangle
-				for(int j = 0; j < num_neighbors; j++) {
-					current = g->getTriangle(neighbors[j]);
-
-					//Combine normals of all neighbors facing in a similar direction
-					normal.x = normal.y = normal.z = 0.0f;
-					count = 0;
-					n1 = -1;
-					for(int k = 0; k < num_neighbors; k++) {
-						//Make sure this triangle is facing in a similar direction
-						dot = face_normals[neighbors[k]].x * face_normals[neighbors[j]].x +
-							face_normals[neighbors[k]].y * face_normals[neighbors[j]].y +
-							face_normals[neighbors[k]].z * face_normals[neighbors[j]].z;
-
-						if(dot < inv_threshold)
-							continue;
-
-						//Check for already generated normal
-						if(n_normals[k] != -1) {
-							n1 = n_normals[k];
-							break;
-						}
-						
-						normal.x += face_normals[neighbors[k]].x;
-						normal.y += face_normals[neighbors[k]].y;
-						normal.z += face_normals[neighbors[k]].z;
-
-						count++;
-					}
+		//Point each corner of the vertex at its normal
+		for(int j = 0; j < num_corners; j++)
+			corner_normals[corners[j]] = neighbor_normals[corner_slots[j]];
 
-					//Average the normal and add to geometry
-					if(n1 == -1) {
-						inverse_divisor = 1.0f / (float)count;
-						normal.x *= inverse_divisor;
-						normal.y *= inverse_divisor;
-						normal.z *= inverse_divisor;
+		//Clear the neighbors list
+		neighbors.clear();
+		corner_slots.clear();
+		n_normals.clear();
+		neighbor_normals.clear();
+	}
 
-						n1 = g->addNormal(normal);
-						n_normals[j] = n1;
-					}
+	return num_new;
+}
 
-					//Modify the triangle
-					current_mod.vertices[0] = current->vertices[0];
-					current_mod.vertices[1] = current->vertices[1];
-					current_mod.vertices[2] = current->vertices[2];
-
-					current_mod.uvs[0] = current->uvs[0];
-					current_mod.uvs[1] = current->uvs[1];
-					current_mod.uvs[2] = current->uvs[2];
-
-					if(current->vertices[0] == i) {
-						current_mod.normals[0] = n1;
-						current_mod.normals[1] = current->normals[1];
-						current_mod.normals[2] = current->normals[2];
-					} else if(current->vertices[1] == i) {
-						current_mod.normals[0] = current->normals[0];
-						current_mod.normals[1] = n1;
-						current_mod.normals[2] = current->normals[2];
-					} else {
-						current_mod.normals[0] = current->normals[0];
-						current_mod.normals[1] = current->normals[1];
-						current_mod.normals[2] = n1;
-					}
+//Re-generate normals for a mesh
+void NormalFilter::run(Geometry *g)
+{
+	int num_triangles = g->getNumTriangles();
+	MemoryArena *scratch = g->getScratchArena();
 
-					g->setTriangle(neighbors[j], current_mod);
-				}
+	//Calculate all per-face normals
+	ScratchArray<Vector3D> face_normals(scratch, num_triangles);
+	g->getFaceNormals(face_normals.get());
 
-				//Clear the neighbors list
-				neighbors.clear();
-				n_normals.clear();
-			}
+	//New normals and the new normal of each corner, or -1 to keep the old one
+	ScratchArray<Vector3D> new_normals(scratch, num_triangles * 3);
+	ScratchArray<int> corner_normals(scratch, num_triangles * 3);
+	for(int i = 0; i < num_triangles * 3; i++)
+		corner_normals[i] = -1;
+
+	int num_new;
+	if(method == NM_HARDEN) {
+		for(int i = 0; i < num_triangles; i++) {
+			new_normals[i] = face_normals[i];
+			corner_normals[i * 3] = corner_normals[i * 3 + 1] = corner_normals[i * 3 + 2] = i;
 		}
+		num_new = num_triangles;
+	} else {
+		num_new = softenNormals(g, face_normals.get(), new_normals.get(), corner_normals.get());
+	}
+
+	//Rebuild the buffer in place with no per triangle reference updates
+	if(replace) {
+		g->replaceNormals(new_normals.get(), num_new, corner_normals.get());
+		return;
+	}
 
-		delete[] face_normals;
+	//Add new normals to the end of the buffer
+	int base = g->getNumNormals();
+	for(int i = 0; i < num_new; i++)
+		g->addNormal(new_normals[i]);
+
+	//Point each changed corner at its new normal, recounting references later
+	Triangle *triangles = g->editTriangles();
+	for(int i = 0; i < num_triangles; i++) {
+		const int *corner = corner_normals.get() + i * 3;
+		for(int k = 0; k < 3; k++) {
+			if(corner[k] != -1)
+				triangles[i].normals[k] = base + corner[k];
+		}
 	}
 
 	return;
 }
+
+//Replaces every normal, adding to the buffer unless rebuilding it
+int NormalFilter::getNormalUsage()
+{
+	return replace ? FN_REPLACES : FN_APPENDS | FN_REPLACES;
+}
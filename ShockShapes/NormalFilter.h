@@ -44,6 +44,18 @@ private:
 	 */
 	float threshold;
 
+	bool replace;			/**< Set to true when the normal buffer is rebuilt instead of added to. */
+
+	/**
+	 * Calculates NM_SOFTEN normals
+	 * @param g The object being filtered
+	 * @param face_normals Unit normal of each triangle
+	 * @param new_normals Receives the new normals, at most one per corner
+	 * @param corner_normals Receives the index into new_normals of each corner's normal
+	 * @return Number of new normals
+	 */
+	int softenNormals(Geometry *g, Vector3D *face_normals, Vector3D *new_normals, int *corner_normals);
+
 public:
 	NormalFilter(normal_method imethod);	/**< Creates a new filter based on the specified generation method. */
 
@@ -60,6 +72,31 @@ public:
 	 */
 	void disableSoftenThreshold();
 
+	/**
+	 * Checks if only faces within the soften threshold are softened
+	 * @return True if the threshold is enabled
+	 */
+	bool isSoftenThresholdEnabled();
+
+	/**
+	 * Gets the threshold for softening
+	 * @return The threshold passed to enableSoftenThreshold
+	 */
+	float getSoftenThreshold();
+
+	/**
+	 * Rebuilds the normal buffer from scratch on each run, rewriting all
+	 * triangle normal indices in one pass. Normals from earlier filters are
+	 * discarded rather than left unreferenced until cleanUp.
+	 */
+	void enableReplace();
+
+	/**
+	 * Adds new normals to the end of the buffer on each run, leaving the
+	 * old ones in place. This is the default.
+	 */
+	void disableReplace();
+
 	/**
 	 * Changes the method of normal generation
 	 * @param m Method to use
@@ -71,6 +108,12 @@ public:
 	 * @param g The object to apply the filter to
 	 */
 	virtual void run(Geometry *g);
+
+	/**
+	 * Describes how the filter uses normals
+	 * @return FN_APPENDS | FN_REPLACES
+	 */
+	virtual int getNormalUsage();
 };
 
 #endif
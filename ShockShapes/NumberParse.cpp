@@ -0,0 +1,235 @@
+/** @file NumberParse.cpp
+ *
+ * @brief Fast parsing of whitespace separated numbers in COLLADA text
+ *
+ * Copyright 2013, Stewart Hall
+ *
+ * Licensed under The MIT License
+ * Redistributions of files must retain the above copyright notice.
+ *
+ * @author		Stewart Hall (www.stewartghall.com)
+ * @date		10/18/2026
+ * @copyright	Copyright 2013, Stewart Hall
+ * @license		MIT License (http://www.opensource.org/licenses/mit-license.php)
+ */
+
+#include <stdlib.h>
+
+#include "NumberParse.h"
+
+#define MAX_MANTISSA_DIGITS 19
+#define MAX_EXACT_EXPONENT 22
+
+/**
+ * Powers of ten that are exact in a double
+ */
+static const double powers_of_ten[MAX_EXACT_EXPONENT + 1] = {
+	1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+	1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+};
+
+//Skip XML whitespace
+static const char *skipSpace(const char *p)
+{
+	while(*p == ' ' || *p == '\t' || *p == '\n' || *p == '\r')
+		p++;
+
+	return p;
+}
+
+//Check for a decimal digit
+static bool isDigit(char c)
+{
+	return c >= '0' && c <= '9';
+}
+
+//Read a single float, returns NULL if there is no number
+static const char *parseFloat(const char *p, float *value)
+{
+	const char *start = p;
+
+	bool negative = false;
+	if(*p == '-') {
+		negative = true;
+		p++;
+	} else if(*p == '+') {
+		p++;
+	}
+
+	//Accumulate significant digits as an integer and track the decimal exponent
+	unsigned long long mantissa = 0;
+	int digits = 0;
+	int exponent = 0;
+	bool found_digit = false;
+
+	while(isDigit(*p)) {
+		if(digits < MAX_MANTISSA_DIGITS) {
+			mantissa = mantissa * 10 + (*p - '0');
+			if(mantissa)
+				digits++;
+		} else {
+			exponent++;
+		}
+
+		found_digit = true;
+		p++;
+	}
+
+	if(*p == '.') {
+		p++;
+
+		while(isDigit(*p)) {
+			if(digits < MAX_MANTISSA_DIGITS) {
+				mantissa = mantissa * 10 + (*p - '0');
+				if(mantissa)
+					digits++;
+				exponent--;
+			}
+
+			found_digit = true;
+			p++;
+		}
+	}
+
+	//Let the C library handle inf, nan and anything unusual
+	if(!found_digit) {
+		char *end;
+		double v = strtod(start, &end);
+		if(end == start)
+			return NULL;
+
+		*value = (float)v;
+		return end;
+	}
+
+	//Exponent part is only read if it contains digits
+	if(*p == 'e' || *p == 'E') {
+		const char *e = p + 1;
+		bool negative_exponent = false;
+		if(*e == '-') {
+			negative_exponent = true;
+			e++;
+		} else if(*e == '+') {
+			e++;
+		}
+
+		if(isDigit(*e)) {
+			int e_value = 0;
+			while(isDigit(*e)) {
+				if(e_value < 10000)
+					e_value = e_value * 10 + (*e - '0');
+				e++;
+			}
+
+			exponent += negative_exponent ? -e_value : e_value;
+			p = e;
+		}
+	}
+
+	//Scale by an exact power of ten when possible
+	double v = (double)mantissa;
+	if(mantissa == 0) {
+		v = 0.0;
+	} else if(exponent >= 0 && exponent <= MAX_EXACT_EXPONENT) {
+		v *= powers_of_ten[exponent];
+	} else if(exponent < 0 && exponent >= -MAX_EXACT_EXPONENT) {
+		v /= powers_of_ten[-exponent];
+	} else {
+		char *end;
+		*value = (float)strtod(start, &end);
+		return end;
+	}
+
+	*value = (float)(negative ? -v : v);
+
+	return p;
+}
+
+//Read a single integer, returns NULL if there is no number
+static const char *parseInt(const char *p, int *value)
+{
+	bool negative = false;
+	if(*p == '-') {
+		negative = true;
+		p++;
+	} else if(*p == '+') {
+		p++;
+	}
+
+	if(!isDigit(*p))
+		return NULL;
+
+	int v = 0;
+	while(isDigit(*p)) {
+		v = v * 10 + (*p - '0');
+		p++;
+	}
+
+	*value = negative ? -v : v;
+
+	return p;
+}
+
+//Read an array of floats
+const char *parseFloatArray(const char *text, float *values, unsigned int count)
+{
+	const char *p = text;
+	unsigned int i = 0;
+
+	for(; i < count; i++) {
+		p = skipSpace(p);
+
+		const char *next = parseFloat(p, &values[i]);
+		if(!next)
+			break;
+
+		p = next;
+	}
+
+	//Fill in values missing from the text
+	for(; i < count; i++)
+		values[i] = 0.0f;
+
+	return p;
+}
+
+//Read an array of integers
+const char *parseIntArray(const char *text, int *values, unsigned int count)
+{
+	const char *p = text;
+	unsigned int i = 0;
+
+	for(; i < count; i++) {
+		p = skipSpace(p);
+
+		const char *next = parseInt(p, &values[i]);
+		if(!next)
+			break;
+
+		p = next;
+	}
+
+	//Fill in values missing from the text
+	for(; i < count; i++)
+		values[i] = 0;
+
+	return p;
+}
+
+//Count values in text
+unsigned int countValues(const char *text)
+{
+	unsigned int count = 0;
+	const char *p = skipSpace(text);
+
+	while(*p) {
+		count++;
+
+		while(*p && *p != ' ' && *p != '\t' && *p != '\n' && *p != '\r')
+			p++;
+
+		p = skipSpace(p);
+	}
+
+	return count;
+}
@@ -0,0 +1,47 @@
+/** @file NumberParse.h
+ *
+ * @brief Fast parsing of whitespace separated numbers in COLLADA text
+ *
+ * Copyright 2013, Stewart Hall
+ *
+ * Licensed under The MIT License
+ * Redistributions of files must retain the above copyright notice.
+ *
+ * @author		Stewart Hall (www.stewartghall.com)
+ * @date		10/18/2026
+ * @copyright	Copyright 2013, Stewart Hall
+ * @license		MIT License (http://www.opensource.org/licenses/mit-license.php)
+ */
+
+#ifndef _NUMBERPARSE_
+#define _NUMBERPARSE_
+
+#include "CommonDefs.h"
+
+/**
+ * Reads floats from text separated by XML whitespace. The text is read in
+ * place so it can point straight into a parsed document.
+ * @param text The text to read from
+ * @param values Receives the numbers read
+ * @param count Number of values to read. Values missing from the text are set to 0
+ * @return Pointer to the text following the last number read
+ */
+const char *parseFloatArray(const char *text, float *values, unsigned int count);
+
+/**
+ * Reads integers from text separated by XML whitespace
+ * @param text The text to read from
+ * @param values Receives the numbers read
+ * @param count Number of values to read. Values missing from the text are set to 0
+ * @return Pointer to the text following the last number read
+ */
+const char *parseIntArray(const char *text, int *values, unsigned int count);
+
+/**
+ * Counts the whitespace separated values in text
+ * @param text The text to count values in
+ * @return Number of values
+ */
+unsigned int countValues(const char *text);
+
+#endif
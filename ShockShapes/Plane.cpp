@@ -0,0 +1,81 @@
+/** @file Plane.cpp
+ *
+ * @brief Generates flat rectangular grids
+ *
+ * Copyright 2013, Stewart Hall
+ *
+ * Licensed under The MIT License
+ * Redistributions of files must retain the above copyright notice.
+ *
+ * @author		Stewart Hall (www.stewartghall.com)
+ * @date		10/18/2026
+ * @copyright	Copyright 2013, Stewart Hall
+ * @license		MIT License (http://www.opensource.org/licenses/mit-license.php)
+ */
+
+#include "Plane.h"
+
+//Default constructor
+Plane::Plane()
+:Primitive("Plane")
+{
+	x_size = z_size = 1.0f;
+	x_segments = z_segments = 1;
+}
+
+//Sized constructor
+Plane::Plane(float x, float z, int x_segs, int z_segs)
+:Primitive("Plane")
+{
+	x_size = x;
+	z_size = z;
+	x_segments = x_segs < 1 ? 1 : x_segs;
+	z_segments = z_segs < 1 ? 1 : z_segs;
+}
+
+//Destructor
+Plane::~Plane()
+{
+
+}
+
+//A plane is a single patch
+int Plane::getNumPatches()
+{
+	return 1;
+}
+
+//Columns run along +X and rows along -Z so the grid faces +Y
+void Plane::getPatch(int patch, PrimitivePatch *desc)
+{
+	desc->columns = x_segments;
+	desc->rows = z_segments;
+	desc->flags = PF_FLAT;
+}
+
+//Every grid point is its own vertex
+int Plane::getNumPositions()
+{
+	return (x_segments + 1) * (z_segments + 1);
+}
+
+//Vertices are stored row by row
+int Plane::getVertexIndex(int patch, int row, int column)
+{
+	return row * (x_segments + 1) + column;
+}
+
+//Evaluate a grid point
+void Plane::evaluate(int patch, int row, int column, Vector3D *position, Vector3D *normal, Vector2D *uv)
+{
+	uv->u = (float)column / (float)x_segments;
+	uv->v = (float)row / (float)z_segments;
+
+	position->x = (uv->u - 0.5f) * x_size;
+	position->y = 0.0f;
+	position->z = (0.5f - uv->v) * z_size;
+
+	normal->x = 0.0f;
+	normal->y = 1.0f;
+	normal->z = 0.0f;
+}
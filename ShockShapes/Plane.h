@@ -0,0 +1,84 @@
+/** @file Plane.h
+ *
+ * @brief Generates flat rectangular grids
+ *
+ * Copyright 2013, Stewart Hall
+ *
+ * Licensed under The MIT License
+ * Redistributions of files must retain the above copyright notice.
+ *
+ * @author		Stewart Hall (www.stewartghall.com)
+ * @date		10/18/2026
+ * @copyright	Copyright 2013, Stewart Hall
+ * @license		MIT License (http://www.opensource.org/licenses/mit-license.php)
+ */
+
+#ifndef _PLANE_
+#define _PLANE_
+
+#include "Primitive.h"
+
+/**
+ * @brief Generates a grid in the XZ plane centered at the origin and facing +Y
+ */
+class Plane : public Primitive {
+private:
+	float x_size, z_size;			/**< Dimensions of the plane. */
+	int x_segments, z_segments;		/**< Number of cells along each axis. */
+
+protected:
+	/**
+	 * Gets the number of patches
+	 * @return 1
+	 */
+	virtual int getNumPatches();
+
+	/**
+	 * Describes the grid, with columns along +X and rows along -Z
+	 * @param patch Index of the patch
+	 * @param desc Receives the size of the patch
+	 */
+	virtual void getPatch(int patch, PrimitivePatch *desc);
+
+	/**
+	 * Gets the number of vertices
+	 * @return One per grid point
+	 */
+	virtual int getNumPositions();
+
+	/**
+	 * Finds the vertex of a grid point
+	 * @param patch Index of the patch
+	 * @param row Row of the grid point
+	 * @param column Column of the grid point
+	 * @return Index of the vertex
+	 */
+	virtual int getVertexIndex(int patch, int row, int column);
+
+	/**
+	 * Evaluates the plane at a grid point
+	 * @param patch Index of the patch
+	 * @param row Row of the grid point
+	 * @param column Column of the grid point
+	 * @param position Receives the position
+	 * @param normal Receives the unit normal
+	 * @param uv Receives the texture coordinate
+	 */
+	virtual void evaluate(int patch, int row, int column, Vector3D *position, Vector3D *normal, Vector2D *uv);
+
+public:
+	Plane();						/**< Default constructor makes a unit square of one cell. */
+
+	/**
+	 * Makes a grid with the specified size and resolution
+	 * @param x Size along the X axis
+	 * @param z Size along the Z axis
+	 * @param x_segs Number of cells along the X axis
+	 * @param z_segs Number of cells along the Z axis
+	 */
+	Plane(float x, float z, int x_segs, int z_segs);
+
+	~Plane();						/**< Destructor. */
+};
+
+#endif
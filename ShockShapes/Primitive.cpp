@@ -0,0 +1,165 @@
+/** @file Primitive.cpp
+ *
+ * @brief Base for parametric shapes generated at their final resolution
+ *
+ * Copyright 2013, Stewart Hall
+ *
+ * Licensed under The MIT License
+ * Redistributions of files must retain the above copyright notice.
+ *
+ * @author		Stewart Hall (www.stewartghall.com)
+ * @date		10/18/2026
+ * @copyright	Copyright 2013, Stewart Hall
+ * @license		MIT License (http://www.opensource.org/licenses/mit-license.php)
+ */
+
+#include <vector>
+
+#include "Primitive.h"
+
+//Set the indices of one corner of a triangle
+static void setCorner(Triangle *t, int k, int vertex, int normal, int uv)
+{
+	t->vertices[k] = vertex;
+	t->normals[k] = normal;
+	t->uvs[k] = uv;
+}
+
+//Constructor
+Primitive::Primitive(const char *name)
+:Geometry(name)
+{
+
+}
+
+//Destructor
+Primitive::~Primitive()
+{
+
+}
+
+//Generates the object's mesh
+void Primitive::generate(int seed, Scene *scene)
+{
+	generatePatches();
+}
+
+//Append every patch to the buffers
+void Primitive::generatePatches()
+{
+	int num_patches = getNumPatches();
+	std::vector<PrimitivePatch> patches(num_patches);
+
+	//Count everything up front so the buffers are sized once
+	int num_normals = 0;
+	int num_uvs = 0;
+	int num_triangles = 0;
+	for(int p = 0; p < num_patches; p++) {
+		getPatch(p, &patches[p]);
+		int columns = patches[p].columns;
+		int rows = patches[p].rows;
+		int points = (columns + 1) * (rows + 1);
+
+		num_normals += (patches[p].flags & PF_FLAT) ? 1 : points;
+		num_uvs += points;
+		num_triangles += 2 * columns * rows;
+		if(patches[p].flags & PF_COLLAPSE_FIRST)
+			num_triangles -= columns;
+		if(patches[p].flags & PF_COLLAPSE_LAST)
+			num_triangles -= columns;
+	}
+
+	int first_vertex = getNumVertices();
+	int first_normal = getNumNormals();
+	int first_uv = getNumUVs();
+	int first_triangle = getNumTriangles();
+	resizeBuffers(first_vertex + getNumPositions(), first_normal + num_normals, first_uv + num_uvs, first_triangle + num_triangles);
+
+	for(int p = 0; p < num_patches; p++) {
+		writePatch(p, patches[p], first_vertex, first_normal, first_uv, first_triangle);
+
+		int columns = patches[p].columns;
+		int rows = patches[p].rows;
+		int points = (columns + 1) * (rows + 1);
+		first_normal += (patches[p].flags & PF_FLAT) ? 1 : points;
+		first_uv += points;
+		first_triangle += 2 * columns * rows;
+		if(patches[p].flags & PF_COLLAPSE_FIRST)
+			first_triangle -= columns;
+		if(patches[p].flags & PF_COLLAPSE_LAST)
+			first_triangle -= columns;
+	}
+}
+
+//Fill one patch in place
+void Primitive::writePatch(int patch, const PrimitivePatch &desc, int first_vertex, int first_normal, int first_uv, int first_triangle)
+{
+	int columns = desc.columns;
+	int rows = desc.rows;
+	int stride = columns + 1;
+	bool flat = (desc.flags & PF_FLAT) != 0;
+	bool collapse_first = (desc.flags & PF_COLLAPSE_FIRST) != 0;
+	bool collapse_last = (desc.flags & PF_COLLAPSE_LAST) != 0;
+	bool wrap_columns = (desc.flags & PF_WRAP_COLUMNS) != 0;
+	bool wrap_rows = (desc.flags & PF_WRAP_ROWS) != 0;
+
+	if(columns <= 0 || rows <= 0)
+		return;
+
+	Vector3D *vertex_data = getVertex(0);
+	Vector3D *normal_data = getNormal(0);
+	Vector2D *uv_data = getUV(0);
+	Triangle *triangle_data = editTriangles();
+
+	//Each row writes its own grid points and the cells above it
+	#pragma omp parallel for schedule(static) if(rows >= PRIMITIVE_PARALLEL_ROWS)
+	for(int row = 0; row <= rows; row++) {
+		Vector3D position, normal;
+		Vector2D uv;
+
+		//Only one point writes each shared vertex
+		bool row_owns = !(wrap_rows && row == rows);
+		bool collapsed = (collapse_first && row == 0) || (collapse_last && row == rows);
+
+		for(int column = 0; column <= columns; column++) {
+			evaluate(patch, row, column, &position, &normal, &uv);
+
+			if(row_owns && !(wrap_columns && column == columns) && !(collapsed && column > 0))
+				vertex_data[first_vertex + getVertexIndex(patch, row, column)] = position;
+			uv_data[first_uv + row * stride + column] = uv;
+			if(!flat)
+				normal_data[first_normal + row * stride + column] = normal;
+			else if(row == 0 && column == 0)
+				normal_data[first_normal] = normal;
+		}
+
+		if(row == rows)
+			continue;
+
+		//A collapsed row only keeps the triangle of each cell with area
+		bool single_below = collapse_first && row == 0;
+		bool single_above = collapse_last && row == rows - 1;
+		int t = first_triangle + 2 * columns * row;
+		if(collapse_first && row > 0)
+			t -= columns;
+
+		for(int column = 0; column < columns; column++) {
+			int points[4] = {row * stride + column, row * stride + column + 1,
+				(row + 1) * stride + column + 1, (row + 1) * stride + column};
+			int vertex[4] = {first_vertex + getVertexIndex(patch, row, column), first_vertex + getVertexIndex(patch, row, column + 1),
+				first_vertex + getVertexIndex(patch, row + 1, column + 1), first_vertex + getVertexIndex(patch, row + 1, column)};
+			static const int corners[2][3] = {{0, 1, 2}, {0, 2, 3}};
+
+			for(int half = 0; half < 2; half++) {
+				if((half == 0 && single_below) || (half == 1 && single_above))
+					continue;
+
+				for(int k = 0; k < 3; k++) {
+					int c = corners[half][k];
+					setCorner(&triangle_data[t], k, vertex[c], flat ? first_normal : first_normal + points[c], first_uv + points[c]);
+				}
+				t++;
+			}
+		}
+	}
+}
@@ -0,0 +1,140 @@
+/** @file Primitive.h
+ *
+ * @brief Base for parametric shapes generated at their final resolution
+ *
+ * Copyright 2013, Stewart Hall
+ *
+ * Licensed under The MIT License
+ * Redistributions of files must retain the above copyright notice.
+ *
+ * @author		Stewart Hall (www.stewartghall.com)
+ * @date		10/18/2026
+ * @copyright	Copyright 2013, Stewart Hall
+ * @license		MIT License (http://www.opensource.org/licenses/mit-license.php)
+ */
+
+#ifndef _PRIMITIVE_
+#define _PRIMITIVE_
+
+#include "Geometry.h"
+
+/**
+ * Patches with at least this many rows are filled on multiple threads
+ */
+#define PRIMITIVE_PARALLEL_ROWS 64
+
+/**
+ * Options for how a patch is built
+ */
+enum patch_flags {
+	PF_FLAT = 1,				/**< Every corner of the patch shares one normal. */
+	PF_COLLAPSE_FIRST = 2,		/**< Row 0 meets at one point, so its cells are single triangles. */
+	PF_COLLAPSE_LAST = 4,		/**< The last row meets at one point, so its cells are single triangles. */
+	PF_WRAP_COLUMNS = 8,		/**< The last column shares its vertices with column 0. */
+	PF_WRAP_ROWS = 16			/**< The last row shares its vertices with row 0. */
+};
+
+/**
+ * @brief Size of a rectangular grid of cells making up part of a primitive
+ */
+typedef struct {
+	int columns;		/**< Number of cells across. */
+	int rows;			/**< Number of cells up. */
+	int flags;			/**< Combination of patch_flags. */
+} PrimitivePatch;
+
+/**
+ * @brief A shape made of grids of cells evaluated directly at the requested
+ * resolution
+ * @details Subclasses describe their surface as patches of
+ * (columns + 1) * (rows + 1) grid points. Each grid point gets its own normal
+ * and texture coordinate, but points that land on the same position, such as
+ * along seams, at poles or where faces of a box meet, map to one shared vertex
+ * so filters see a connected mesh. Points marked by the collapse and wrap
+ * flags are evaluated but do not write their shared vertex, so no two
+ * threads write the same vertex. The exact size of every buffer is known
+ * before anything is written, so the buffers are sized once and filled in
+ * place, a row per thread for large patches. Cells are split into two
+ * triangles facing the direction of increasing column crossed with
+ * increasing row, so subclasses lay out their grids with that pointing out.
+ */
+class Primitive : public Geometry {
+private:
+	/**
+	 * Fills one patch's vertices, normals, texture coordinates and triangles
+	 * @param patch Index of the patch
+	 * @param desc Size of the patch
+	 * @param first_vertex Index of the shape's first vertex
+	 * @param first_normal Index of the patch's first normal
+	 * @param first_uv Index of the patch's first texture coordinate
+	 * @param first_triangle Index of the patch's first triangle
+	 */
+	void writePatch(int patch, const PrimitivePatch &desc, int first_vertex, int first_normal, int first_uv, int first_triangle);
+
+protected:
+	/**
+	 * Gets the number of patches making up the shape
+	 * @return The number of patches
+	 */
+	virtual int getNumPatches() = 0;
+
+	/**
+	 * Describes a patch
+	 * @param patch Index of the patch
+	 * @param desc Receives the size of the patch
+	 */
+	virtual void getPatch(int patch, PrimitivePatch *desc) = 0;
+
+	/**
+	 * Gets the number of distinct vertex positions in the shape
+	 * @return The number of vertices to allocate
+	 */
+	virtual int getNumPositions() = 0;
+
+	/**
+	 * Finds the shared vertex of a grid point. Grid points at the same
+	 * position must give the same index. Other points where patches meet are
+	 * written by each patch in turn, so they should evaluate to the same
+	 * position
+	 * @param patch Index of the patch
+	 * @param row Row of the grid point, from 0 to rows
+	 * @param column Column of the grid point, from 0 to columns
+	 * @return Index of the vertex, counted from the first vertex of the shape
+	 */
+	virtual int getVertexIndex(int patch, int row, int column) = 0;
+
+	/**
+	 * Evaluates the surface at a grid point. Called from multiple threads at
+	 * once, so it must not change the object
+	 * @param patch Index of the patch
+	 * @param row Row of the grid point, from 0 to rows
+	 * @param column Column of the grid point, from 0 to columns
+	 * @param position Receives the position
+	 * @param normal Receives the unit normal
+	 * @param uv Receives the texture coordinate
+	 */
+	virtual void evaluate(int patch, int row, int column, Vector3D *position, Vector3D *normal, Vector2D *uv) = 0;
+
+	/**
+	 * Appends the patches' mesh to the buffers
+	 */
+	void generatePatches();
+
+public:
+	/**
+	 * Constructs an empty primitive
+	 * @param name Name of the object
+	 */
+	Primitive(const char *name);
+
+	~Primitive();				/**< Destructor. */
+
+	/**
+	 * Generates the primitive's mesh
+	 * @param seed The value to seed the random number generator with
+	 * @param scene The scene that this geometry will belong to
+	 */
+	virtual void generate(int seed, Scene *scene);
+};
+
+#endif
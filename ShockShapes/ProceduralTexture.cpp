@@ -0,0 +1,212 @@
+/** @file ProceduralTexture.cpp
+ *
+ * @brief Renders texture node graphs to image files used as materials
+ *
+ * Copyright 2013, Stewart Hall
+ *
+ * Licensed under The MIT License
+ * Redistributions of files must retain the above copyright notice.
+ *
+ * @author		Stewart Hall (www.stewartghall.com)
+ * @date		10/18/2026
+ * @copyright	Copyright 2013, Stewart Hall
+ * @license		MIT License (http://www.opensource.org/licenses/mit-license.php)
+ */
+
+#include "ProceduralTexture.h"
+
+#ifdef NOISE_SSE2
+#include <emmintrin.h>
+#endif
+
+//Constructor
+ProceduralTexture::ProceduralTexture(const char *iname, TextureNode *iroot, int iwidth, int iheight)
+:name(iname)
+{
+	filename = name + ".png";
+	format = IF_PNG;
+	width = iwidth;
+	height = iheight;
+	root = iroot;
+
+	low_color.x = low_color.y = low_color.z = 0.0f;
+	high_color.x = high_color.y = high_color.z = 1.0f;
+}
+
+//Destructor
+ProceduralTexture::~ProceduralTexture()
+{
+
+}
+
+//Set the color range
+void ProceduralTexture::setColors(Vector3D ilow, Vector3D ihigh)
+{
+	low_color = ilow;
+	high_color = ihigh;
+}
+
+//Change the output file
+void ProceduralTexture::setOutput(const char *ifilename, image_format iformat)
+{
+	filename = ifilename;
+	format = iformat;
+}
+
+//Get the name
+const char *ProceduralTexture::getName()
+{
+	return name.c_str();
+}
+
+//Get the material id
+std::string ProceduralTexture::getMaterialId()
+{
+	return name + "-Material";
+}
+
+//Shade one tile
+void ProceduralTexture::renderTile(int tile_x, int y, int rows, unsigned char *pixels)
+{
+	float u[TEXTURE_BATCH_SIZE];
+	float v[TEXTURE_BATCH_SIZE];
+	float values[TEXTURE_BATCH_SIZE];
+	int channels[3][TEXTURE_BATCH_SIZE];
+
+	float low[3] = {low_color.x * 255.0f, low_color.y * 255.0f, low_color.z * 255.0f};
+	float range[3] = {high_color.x * 255.0f - low[0], high_color.y * 255.0f - low[1], high_color.z * 255.0f - low[2]};
+
+	int first_x = tile_x * TEXTURE_TILE_SIZE;
+	int end_x = first_x + TEXTURE_TILE_SIZE;
+	if(end_x > width)
+		end_x = width;
+
+	float inv_width = 1.0f / (float)width;
+	float inv_height = 1.0f / (float)height;
+
+	for(int row = 0; row < rows; row++) {
+		//Texture v runs from the bottom of the image to the top
+		float texel_v = 1.0f - ((float)(y + row) + 0.5f) * inv_height;
+		unsigned char *out = pixels + ((size_t)row * width + first_x) * 3;
+
+		for(int x = first_x; x < end_x; x += TEXTURE_BATCH_SIZE) {
+			int count = end_x - x;
+			if(count > TEXTURE_BATCH_SIZE)
+				count = TEXTURE_BATCH_SIZE;
+
+			//Pad the last batch of a row by repeating its last pixel
+			for(int i = 0; i < TEXTURE_BATCH_SIZE; i++) {
+				int px = x + (i < count ? i : count - 1);
+				u[i] = ((float)px + 0.5f) * inv_width;
+				v[i] = texel_v;
+			}
+
+			root->evaluate(u, v, values);
+
+			//Map values to 8 bit colors
+#ifdef NOISE_SSE2
+			__m128 zero = _mm_setzero_ps();
+			__m128 one = _mm_set1_ps(1.0f);
+			__m128 half = _mm_set1_ps(0.5f);
+			for(int i = 0; i < TEXTURE_BATCH_SIZE; i += 4) {
+				__m128 t = _mm_min_ps(_mm_max_ps(_mm_loadu_ps(values + i), zero), one);
+				for(int c = 0; c < 3; c++) {
+					__m128 color = _mm_add_ps(_mm_add_ps(_mm_set1_ps(low[c]), _mm_mul_ps(t, _mm_set1_ps(range[c]))), half);
+					_mm_storeu_si128((__m128i*)(channels[c] + i), _mm_cvttps_epi32(color));
+				}
+			}
+#else
+			for(int i = 0; i < TEXTURE_BATCH_SIZE; i++) {
+				float t = values[i] < 0.0f ? 0.0f : (values[i] > 1.0f ? 1.0f : values[i]);
+				for(int c = 0; c < 3; c++)
+					channels[c][i] = (int)(low[c] + t * range[c] + 0.5f);
+			}
+#endif
+
+			for(int i = 0; i < count; i++) {
+				for(int c = 0; c < 3; c++) {
+					int value = channels[c][i];
+					*out++ = (unsigned char)(value < 0 ? 0 : (value > 255 ? 255 : value));
+				}
+			}
+		}
+	}
+}
+
+//Render the image to its file
+int ProceduralTexture::render()
+{
+	if(!root || width <= 0 || height <= 0)
+		return 1;
+
+	ImageWriter writer;
+	if(writer.open(filename.c_str(), format, width, height, 3))
+		return 1;
+
+	//Only one row of tiles is held in memory
+	unsigned char *pixels = new unsigned char[(size_t)width * TEXTURE_TILE_SIZE * 3];
+	int tiles_x = (width + TEXTURE_TILE_SIZE - 1) / TEXTURE_TILE_SIZE;
+	int error = 0;
+
+	for(int y = 0; y < height && !error; y += TEXTURE_TILE_SIZE) {
+		int rows = height - y;
+		if(rows > TEXTURE_TILE_SIZE)
+			rows = TEXTURE_TILE_SIZE;
+
+		#pragma omp parallel for schedule(dynamic)
+		for(int tile_x = 0; tile_x < tiles_x; tile_x++)
+			renderTile(tile_x, y, rows, pixels);
+
+		error = writer.writeRows(pixels, rows);
+	}
+
+	delete[] pixels;
+
+	if(writer.close())
+		error = 1;
+
+	return error;
+}
+
+//Add the material to COLLADA libraries
+int ProceduralTexture::saveMaterial(pugi::xml_node lib_images, pugi::xml_node lib_effects, pugi::xml_node lib_materials)
+{
+	if(!lib_images || !lib_effects || !lib_materials)
+		return 1;
+
+	std::string image_id = name + "-Image";
+	std::string effect_id = name + "-Effect";
+	std::string sampler_sid = name + "-Sampler";
+
+	//Image refers to the rendered file
+	pugi::xml_node image_node = lib_images.append_child("image");
+	image_node.append_attribute("id") = image_id.c_str();
+	image_node.append_attribute("name") = name.c_str();
+	pugi::xml_node init_node = image_node.append_child("init_from");
+	init_node.append_child("ref").text() = filename.c_str();
+
+	//Effect samples the image for the diffuse color
+	pugi::xml_node effect_node = lib_effects.append_child("effect");
+	effect_node.append_attribute("id") = effect_id.c_str();
+	pugi::xml_node profile_node = effect_node.append_child("profile_COMMON");
+
+	pugi::xml_node param_node = profile_node.append_child("newparam");
+	param_node.append_attribute("sid") = sampler_sid.c_str();
+	pugi::xml_node sampler_node = param_node.append_child("sampler2D");
+	sampler_node.append_child("instance_image").append_attribute("url") = (std::string("#") + image_id).c_str();
+
+	pugi::xml_node technique_node = profile_node.append_child("technique");
+	technique_node.append_attribute("sid") = "common";
+	pugi::xml_node diffuse_node = technique_node.append_child("lambert").append_child("diffuse");
+	pugi::xml_node texture_node = diffuse_node.append_child("texture");
+	texture_node.append_attribute("texture") = sampler_sid.c_str();
+	texture_node.append_attribute("texcoord") = "UVSET0";
+
+	//Material instantiates the effect
+	pugi::xml_node material_node = lib_materials.append_child("material");
+	material_node.append_attribute("id") = getMaterialId().c_str();
+	material_node.append_attribute("name") = name.c_str();
+	material_node.append_child("instance_effect").append_attribute("url") = (std::string("#") + effect_id).c_str();
+
+	return 0;
+}
@@ -0,0 +1,115 @@
+/** @file ProceduralTexture.h
+ *
+ * @brief Renders texture node graphs to image files used as materials
+ *
+ * Copyright 2013, Stewart Hall
+ *
+ * Licensed under The MIT License
+ * Redistributions of files must retain the above copyright notice.
+ *
+ * @author		Stewart Hall (www.stewartghall.com)
+ * @date		10/18/2026
+ * @copyright	Copyright 2013, Stewart Hall
+ * @license		MIT License (http://www.opensource.org/licenses/mit-license.php)
+ */
+
+#ifndef _PROCEDURALTEXTURE_
+#define _PROCEDURALTEXTURE_
+
+#include <string>
+
+#include "pugixml.hpp"
+#include "CommonDefs.h"
+#include "TextureNode.h"
+#include "ImageWriter.h"
+
+/**
+ * Width and height in pixels of the tiles rendered in parallel. Rendering
+ * holds one row of tiles in memory at a time.
+ */
+#define TEXTURE_TILE_SIZE 64
+
+/**
+ * @brief An RGB image generated from a texture node
+ * @details The root node's value at each pixel picks a color between the
+ * low and high colors. Rendering works through the image one row of tiles
+ * at a time, shading the tiles of a row on multiple threads and writing the
+ * row to disk before starting the next. The texture is also a COLLADA
+ * material with the image as its diffuse color, which geometries refer to
+ * with Geometry::setTexture.
+ */
+class ProceduralTexture {
+private:
+	std::string name;			/**< Name used for the image, effect and material ids. */
+	std::string filename;		/**< File the image is written to. */
+	image_format format;		/**< Format of the image file. */
+	int width;					/**< Width in pixels. */
+	int height;					/**< Height in pixels. */
+	TextureNode *root;			/**< Node giving the value of each pixel. */
+	Vector3D low_color;			/**< Color for a value of 0, with components from 0 to 1. */
+	Vector3D high_color;		/**< Color for a value of 1, with components from 0 to 1. */
+
+	/**
+	 * Shades one tile into a row of tiles
+	 * @param tile_x Index of the tile within the row
+	 * @param y First image row of the tile row
+	 * @param rows Number of rows in the tile row
+	 * @param pixels RGB samples for the whole tile row
+	 */
+	void renderTile(int tile_x, int y, int rows, unsigned char *pixels);
+
+public:
+	/**
+	 * Constructs a texture that is written to name.png
+	 * @param iname Name of the texture
+	 * @param iroot Node giving the value of each pixel. Not owned by the texture
+	 * @param iwidth Width in pixels
+	 * @param iheight Height in pixels
+	 */
+	ProceduralTexture(const char *iname, TextureNode *iroot, int iwidth, int iheight);
+
+	~ProceduralTexture();		/**< Destructor. */
+
+	/**
+	 * Sets the colors the root node's value moves between
+	 * @param ilow Color for a value of 0, with components from 0 to 1
+	 * @param ihigh Color for a value of 1, with components from 0 to 1
+	 */
+	void setColors(Vector3D ilow, Vector3D ihigh);
+
+	/**
+	 * Changes the file the image is written to
+	 * @param ifilename Name of the file, which is also the image path in COLLADA files
+	 * @param iformat Format of the file
+	 */
+	void setOutput(const char *ifilename, image_format iformat);
+
+	/**
+	 * Gets the name of the texture
+	 * @return The name
+	 */
+	const char *getName();
+
+	/**
+	 * Gets the id of the texture's COLLADA material
+	 * @return The material id
+	 */
+	std::string getMaterialId();
+
+	/**
+	 * Renders the image and writes it to its file
+	 * @return Returns 0 if no errors occur
+	 */
+	int render();
+
+	/**
+	 * Adds the image, effect and material to COLLADA libraries
+	 * @param lib_images The library_images node
+	 * @param lib_effects The library_effects node
+	 * @param lib_materials The library_materials node
+	 * @return Returns 0 if no errors occur
+	 */
+	int saveMaterial(pugi::xml_node lib_images, pugi::xml_node lib_effects, pugi::xml_node lib_materials);
+};
+
+#endif
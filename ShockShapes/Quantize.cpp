@@ -0,0 +1,88 @@
+/** @file Quantize.cpp
+ *
+ * @brief Helpers for encoding vertex attributes with fewer bits
+ *
+ * Copyright 2013, Stewart Hall
+ *
+ * Licensed under The MIT License
+ * Redistributions of files must retain the above copyright notice.
+ *
+ * @author		Stewart Hall (www.stewartghall.com)
+ * @date		10/18/2026
+ * @copyright	Copyright 2013, Stewart Hall
+ * @license		MIT License (http://www.opensource.org/licenses/mit-license.php)
+ */
+
+#include <math.h>
+
+#include "Quantize.h"
+
+//Encode an unsigned normalized value
+unsigned short quantizeUnorm16(float v)
+{
+	if(v < 0.0f)
+		v = 0.0f;
+	else if(v > 1.0f)
+		v = 1.0f;
+
+	return (unsigned short)(v * (float)QUANTIZE_UNORM16_MAX + 0.5f);
+}
+
+//Encode a signed normalized value
+short quantizeSnorm16(float v)
+{
+	if(v < -1.0f)
+		v = -1.0f;
+	else if(v > 1.0f)
+		v = 1.0f;
+
+	float scaled = v * (float)QUANTIZE_SNORM16_MAX;
+
+	return (short)(scaled >= 0.0f ? scaled + 0.5f : scaled - 0.5f);
+}
+
+//Octahedral encoding of a unit vector
+void octEncode(Vector3D n, short *x, short *y)
+{
+	//Project onto the octahedron
+	float l1 = fabsf(n.x) + fabsf(n.y) + fabsf(n.z);
+	float inv_l1 = l1 > 0.0f ? 1.0f / l1 : 0.0f;
+	float px = n.x * inv_l1;
+	float py = n.y * inv_l1;
+
+	//Fold the lower hemisphere over the diagonals
+	if(n.z < 0.0f) {
+		float fx = (1.0f - fabsf(py)) * (px >= 0.0f ? 1.0f : -1.0f);
+		float fy = (1.0f - fabsf(px)) * (py >= 0.0f ? 1.0f : -1.0f);
+		px = fx;
+		py = fy;
+	}
+
+	*x = quantizeSnorm16(px);
+	*y = quantizeSnorm16(py);
+}
+
+//Octahedral decoding of a unit vector
+Vector3D octDecode(short x, short y)
+{
+	Vector3D n;
+	n.x = (float)x / (float)QUANTIZE_SNORM16_MAX;
+	n.y = (float)y / (float)QUANTIZE_SNORM16_MAX;
+	n.z = 1.0f - fabsf(n.x) - fabsf(n.y);
+
+	//Unfold the lower hemisphere
+	if(n.z < 0.0f) {
+		float fx = (1.0f - fabsf(n.y)) * (n.x >= 0.0f ? 1.0f : -1.0f);
+		float fy = (1.0f - fabsf(n.x)) * (n.y >= 0.0f ? 1.0f : -1.0f);
+		n.x = fx;
+		n.y = fy;
+	}
+
+	float length = sqrtf(n.x * n.x + n.y * n.y + n.z * n.z);
+	float inv_length = 1.0f / length;
+	n.x *= inv_length;
+	n.y *= inv_length;
+	n.z *= inv_length;
+
+	return n;
+}
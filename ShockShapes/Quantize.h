@@ -0,0 +1,63 @@
+/** @file Quantize.h
+ *
+ * @brief Helpers for encoding vertex attributes with fewer bits
+ *
+ * Copyright 2013, Stewart Hall
+ *
+ * Licensed under The MIT License
+ * Redistributions of files must retain the above copyright notice.
+ *
+ * @author		Stewart Hall (www.stewartghall.com)
+ * @date		10/18/2026
+ * @copyright	Copyright 2013, Stewart Hall
+ * @license		MIT License (http://www.opensource.org/licenses/mit-license.php)
+ */
+
+#ifndef _QUANTIZE_
+#define _QUANTIZE_
+
+#include "CommonDefs.h"
+
+#define QUANTIZE_UNORM16_MAX 65535
+#define QUANTIZE_SNORM16_MAX 32767
+
+/**
+ * @brief Largest error introduced by quantizing a mesh
+ */
+typedef struct {
+	float position_error;	/**< Largest distance along any axis between a position and its decoded value. */
+	float normal_error;		/**< Largest angle in degrees between a normal and its decoded value. */
+	float uv_error;			/**< Largest difference in u or v between a coordinate and its decoded value. */
+} QuantizationError;
+
+/**
+ * Encodes a value in [0, 1] as a 16 bit unsigned normalized integer
+ * @param v The value to encode. Clamped to [0, 1]
+ * @return The encoded value
+ */
+unsigned short quantizeUnorm16(float v);
+
+/**
+ * Encodes a value in [-1, 1] as a 16 bit signed normalized integer
+ * @param v The value to encode. Clamped to [-1, 1]
+ * @return The encoded value
+ */
+short quantizeSnorm16(float v);
+
+/**
+ * Encodes a unit vector with the octahedral mapping
+ * @param n The vector to encode
+ * @param x Receives the first encoded component
+ * @param y Receives the second encoded component
+ */
+void octEncode(Vector3D n, short *x, short *y);
+
+/**
+ * Decodes a unit vector stored with the octahedral mapping
+ * @param x The first encoded component
+ * @param y The second encoded component
+ * @return The normalized decoded vector
+ */
+Vector3D octDecode(short x, short y);
+
+#endif
@@ -13,13 +13,87 @@
  * @license		MIT License (http://www.opensource.org/licenses/mit-license.php)
  */
 
+#include <math.h>
+#include <algorithm>
+#include <sstream>
+
 #include "Scene.h"
 #include "Instance.h"
+#include "MappedFile.h"
+#include "NumberParse.h"
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+//Read the 16 values of a COLLADA matrix in row major order
+static void readMatrix(pugi::xml_node matrix_node, Matrix *m)
+{
+	float values[16];
+	parseFloatArray(matrix_node.text().get(), values, 16);
+
+	for(int i = 0; i < 4; i++) {
+		m->r0[i] = values[i];
+		m->r1[i] = values[4 + i];
+		m->r2[i] = values[8 + i];
+		m->r3[i] = values[12 + i];
+	}
+}
+
+/**
+ * @brief A top level object and the grid cell it is saved in
+ */
+typedef struct {
+	int cell[3];		/**< Cell coordinates. */
+	int object;			/**< Index of the object in the scene. */
+} ChunkObject;
+
+//Orders objects by cell, then by index so chunks keep scene order
+class ChunkObjectLess {
+public:
+	bool operator()(const ChunkObject &a, const ChunkObject &b) const
+	{
+		for(int i = 0; i < 3; i++) {
+			if(a.cell[i] != b.cell[i])
+				return a.cell[i] < b.cell[i];
+		}
+		return a.object < b.object;
+	}
+};
+
+//Check if two objects are in the same cell
+static bool sameCell(const ChunkObject &a, const ChunkObject &b)
+{
+	return a.cell[0] == b.cell[0] && a.cell[1] == b.cell[1] && a.cell[2] == b.cell[2];
+}
+
+//Point geometry and material references in a scene at another file
+static void referenceLibrary(pugi::xml_node node, const std::string &library)
+{
+	for(pugi::xml_node child = node.first_child(); child; child = child.next_sibling()) {
+		if(!strcmp(child.name(), "instance_geometry"))
+			child.attribute("url") = (library + child.attribute("url").as_string()).c_str();
+		else if(!strcmp(child.name(), "instance_material"))
+			child.attribute("target") = (library + child.attribute("target").as_string()).c_str();
+
+		referenceLibrary(child, library);
+	}
+}
+
+//Write a vector as space separated values
+static std::string formatVector(const Vector3D &v)
+{
+	std::ostringstream stream;
+	stream << v.x << " " << v.y << " " << v.z;
+	return stream.str();
+}
 
 //Default constructor
 Scene::Scene()
 :objects(), name("ShockShapes-Scene"), units_per_meter(1.0f)
 {
+	parallel_load = true;
+	fast_load = false;
 
 }
 
@@ -27,13 +101,24 @@ Scene::Scene()
 Scene::Scene(const char *sname)
 :objects(), name(sname), units_per_meter(1.0f)
 {
+	parallel_load = true;
+	fast_load = false;
 
 }
 
 //Destructor
 Scene::~Scene()
 {
+	clear();
+
+	for(unsigned int i = 0; i < load_arenas.size(); i++)
+		delete load_arenas[i];
+}
 
+//Get the scene's memory arena
+MemoryArena *Scene::getArena()
+{
+	return &arena;
 }
 
 //Add a geometric object to the scene
@@ -41,10 +126,32 @@ int Scene::addObject(Geometry *g)
 {
 	int id = objects.size();
 	objects.push_back(g);
+	object_index.add(g->getUniqueId(), g);
+
+	return id;
+}
+
+//Add a texture to the scene
+int Scene::addTexture(ProceduralTexture *tex)
+{
+	int id = textures.size();
+	textures.push_back(tex);
 
 	return id;
 }
 
+//Render all textures
+int Scene::renderTextures()
+{
+	int num_textures = textures.size();
+	for(int i = 0; i < num_textures; i++) {
+		if(textures[i]->render())
+			return 1;
+	}
+
+	return 0;
+}
+
 //Generate the scene
 void Scene::generate(int seed)
 {
@@ -60,12 +167,14 @@ void Scene::generate(int seed)
 //Save the scene to a COLLADA file
 int Scene::save(const char *filename)
 {
-	char buf[128];
-	time_t now;
+	return save(filename, NULL);
+}
 
+//Start a COLLADA document
+pugi::xml_node Scene::createDocument(pugi::xml_document *doc, const char *timestamp)
+{
 	//Initialize the document root
-	pugi::xml_document doc;
-	pugi::xml_node collada_node = doc.append_child("COLLADA");
+	pugi::xml_node collada_node = doc->append_child("COLLADA");
 	collada_node.append_attribute("xmlns") = "http://www.collada.org/2008/03/COLLADASchema";
 	collada_node.append_attribute("version") = "1.5.0";
 
@@ -78,10 +187,8 @@ int Scene::save(const char *filename)
 
 	pugi::xml_node created_node = asset_node.append_child("created");
 	pugi::xml_node modified_node = asset_node.append_child("modified");
-	time(&now);
-	strftime(buf, sizeof(buf), "%Y-%m-%dT%H:%M:%SZ", gmtime(&now));
-	created_node.text() = buf;
-	modified_node.text() = buf;
+	created_node.text() = timestamp;
+	modified_node.text() = timestamp;
 
 	pugi::xml_node unit_node = asset_node.append_child("unit");
 	unit_node.append_attribute("meter") = 1.0f / units_per_meter;
@@ -89,6 +196,40 @@ int Scene::save(const char *filename)
 	pugi::xml_node up_node = asset_node.append_child("up_axis");
 	up_node.text() = "Y_UP";
 
+	return collada_node;
+}
+
+//Add the materials used by objects
+int Scene::saveMaterials(pugi::xml_node collada_node)
+{
+	int num_textures = textures.size();
+	if(num_textures) {
+		pugi::xml_node lib_images = collada_node.append_child("library_images");
+		pugi::xml_node lib_effects = collada_node.append_child("library_effects");
+		pugi::xml_node lib_materials = collada_node.append_child("library_materials");
+		for(int i = 0; i < num_textures; i++) {
+			if(textures[i]->saveMaterial(lib_images, lib_effects, lib_materials))
+				return 1;
+		}
+	}
+
+	return 0;
+}
+
+//Save the parts of the scene inside a volume to a COLLADA file
+int Scene::save(const char *filename, CullingVolume *volume)
+{
+	char buf[128];
+	time_t now;
+
+	time(&now);
+	strftime(buf, sizeof(buf), "%Y-%m-%dT%H:%M:%SZ", gmtime(&now));
+
+	pugi::xml_document doc;
+	pugi::xml_node collada_node = createDocument(&doc, buf);
+	if(saveMaterials(collada_node))
+		return 1;
+
 	//Add the library of geometric objects and scenes
 	pugi::xml_node lib_geometry = collada_node.append_child("library_geometries");
 	pugi::xml_node lib_scenes = collada_node.append_child("library_visual_scenes");
@@ -103,15 +244,192 @@ int Scene::save(const char *filename)
 	//Add each geometric object to the library and the scene
 	int num_objects = objects.size();
 	int id = 0;
+	if(volume) {
+		//Write the instances first so only the meshes they use are saved
+		for(int i = 0; i < num_objects; i++) {
+			if(objects[i]->isVisible() && objects[i]->saveInstance(vscene_node, &id, NULL, volume))
+				return 1;
+		}
+
+		for(int i = 0; i < num_objects; i++) {
+			if(objects[i]->saveReferencedGeometry(lib_geometry))
+				return 1;
+		}
+	} else {
+		for(int i = 0; i < num_objects; i++) {
+			if(objects[i]->saveGeometry(lib_geometry))
+				return 1;
+
+			if(objects[i]->isVisible() && objects[i]->saveInstance(vscene_node, &id, NULL, NULL))
+				return 1;
+		}
+	}
+
+	//Write to the file
+	if(!doc.save_file(filename))
+		return 1;
+
+	return 0;
+}
+
+//Save the scene as a grid of chunk files
+int Scene::saveChunks(const char *filename, float cell_size)
+{
+	char buf[128];
+	time_t now;
+
+	if(cell_size <= 0.0f)
+		return 1;
+
+	time(&now);
+	strftime(buf, sizeof(buf), "%Y-%m-%dT%H:%M:%SZ", gmtime(&now));
+
+	//Chunk and library files are named after the index and placed beside it
+	std::string path(filename);
+	std::string::size_type slash = path.find_last_of("/\\");
+	std::string::size_type dot = path.find_last_of('.');
+	if(dot == std::string::npos || (slash != std::string::npos && dot < slash))
+		dot = path.size();
+	std::string directory = slash == std::string::npos ? std::string() : path.substr(0, slash + 1);
+	std::string base = path.substr(directory.size(), dot - directory.size());
+	std::string library = base + "_library.dae";
+
+	//Write every mesh and material once to the shared library
+	pugi::xml_document library_doc;
+	pugi::xml_node library_node = createDocument(&library_doc, buf);
+	if(saveMaterials(library_node))
+		return 1;
+
+	pugi::xml_node lib_geometry = library_node.append_child("library_geometries");
+	int num_objects = objects.size();
 	for(int i = 0; i < num_objects; i++) {
 		if(objects[i]->saveGeometry(lib_geometry))
 			return 1;
+	}
+
+	if(!library_doc.save_file((directory + library).c_str()))
+		return 1;
+
+	//Place each visible object by the center of its world bounds. Bounds and
+	//every world matrix are found here, so saving the chunks in parallel only
+	//reads cached matrices and allocates no scratch from the shared arena.
+	std::vector<ChunkObject> placed;
+	std::vector<BoundingBox> object_bounds(num_objects);
+	for(int i = 0; i < num_objects; i++) {
+		if(!objects[i]->isVisible())
+			continue;
+
+		objects[i]->updateWorldMatrices(NULL);
+
+		BoundingBox &bounds = object_bounds[i];
+		objects[i]->getBounds(objects[i]->getTransform()->getWorldMatrix(NULL), &bounds);
+
+		ChunkObject chunk_object;
+		float center[3] = {0.0f, 0.0f, 0.0f};
+		if(bounds.min.x <= bounds.max.x && bounds.min.y <= bounds.max.y && bounds.min.z <= bounds.max.z) {
+			center[0] = 0.5f * (bounds.min.x + bounds.max.x);
+			center[1] = 0.5f * (bounds.min.y + bounds.max.y);
+			center[2] = 0.5f * (bounds.min.z + bounds.max.z);
+		}
+		for(int j = 0; j < 3; j++)
+			chunk_object.cell[j] = (int)floorf(center[j] / cell_size);
+		chunk_object.object = i;
+		placed.push_back(chunk_object);
+	}
+
+	std::sort(placed.begin(), placed.end(), ChunkObjectLess());
+
+	//Group the sorted objects into chunks
+	int num_placed = placed.size();
+	std::vector<int> chunk_starts;
+	std::vector<int> chunk_objects(num_placed);
+	for(int i = 0; i < num_placed; i++) {
+		if(i == 0 || !sameCell(placed[i - 1], placed[i]))
+			chunk_starts.push_back(i);
+		chunk_objects[i] = placed[i].object;
+	}
+
+	int num_chunks = chunk_starts.size();
+	chunk_starts.push_back(num_placed);
+
+	std::vector<std::string> chunk_files(num_chunks);
+	for(int c = 0; c < num_chunks; c++) {
+		const int *cell = placed[chunk_starts[c]].cell;
+		std::ostringstream name_stream;
+		name_stream << base << "_" << cell[0] << "_" << cell[1] << "_" << cell[2] << ".dae";
+		chunk_files[c] = name_stream.str();
+	}
+
+	//Write each chunk on its own thread. Every top level object is in exactly one
+	//chunk, and the world matrices its save reads are already up to date.
+	std::vector<int> results(num_chunks);
+	#pragma omp parallel for schedule(dynamic)
+	for(int c = 0; c < num_chunks; c++)
+		results[c] = saveChunk((directory + chunk_files[c]).c_str(), library, buf, &chunk_objects[chunk_starts[c]], chunk_starts[c + 1] - chunk_starts[c]);
+
+	for(int c = 0; c < num_chunks; c++) {
+		if(results[c])
+			return 1;
+	}
+
+	//List the chunks with their cells and bounds in the index
+	pugi::xml_document index_doc;
+	pugi::xml_node index_node = index_doc.append_child("chunk_index");
+	index_node.append_attribute("library") = library.c_str();
+	index_node.append_attribute("cell_size") = cell_size;
+
+	for(int c = 0; c < num_chunks; c++) {
+		const int *cell = placed[chunk_starts[c]].cell;
+		BoundingBox bounds;
+		CullingVolume::emptyBounds(&bounds);
+		for(int i = chunk_starts[c]; i < chunk_starts[c + 1]; i++)
+			CullingVolume::expandBounds(&bounds, &object_bounds[placed[i].object]);
+
+		std::ostringstream cell_stream;
+		cell_stream << cell[0] << " " << cell[1] << " " << cell[2];
+
+		pugi::xml_node chunk_node = index_node.append_child("chunk");
+		chunk_node.append_attribute("file") = chunk_files[c].c_str();
+		chunk_node.append_attribute("cell") = cell_stream.str().c_str();
+		chunk_node.append_attribute("objects") = chunk_starts[c + 1] - chunk_starts[c];
+
+		//Objects can overhang their cell, so the bounds are those of the contents
+		if(bounds.min.x <= bounds.max.x && bounds.min.y <= bounds.max.y && bounds.min.z <= bounds.max.z) {
+			pugi::xml_node bounds_node = chunk_node.append_child("bounds");
+			bounds_node.append_attribute("min") = formatVector(bounds.min).c_str();
+			bounds_node.append_attribute("max") = formatVector(bounds.max).c_str();
+		}
+	}
+
+	if(!index_doc.save_file(filename))
+		return 1;
+
+	return 0;
+}
+
+//Save one chunk of a partitioned scene
+int Scene::saveChunk(const char *filename, const std::string &library, const char *timestamp, const int *chunk_objects, int count)
+{
+	pugi::xml_document doc;
+	pugi::xml_node collada_node = createDocument(&doc, timestamp);
 
-		if(objects[i]->isVisible() && objects[i]->saveInstance(vscene_node, &id, NULL))
+	pugi::xml_node lib_scenes = collada_node.append_child("library_visual_scenes");
+	pugi::xml_node vscene_node = lib_scenes.append_child("visual_scene");
+	vscene_node.append_attribute("id") = "DefaultScene";
+
+	pugi::xml_node scene_node = collada_node.append_child("scene");
+	pugi::xml_node scene_inst_node = scene_node.append_child("instance_visual_scene");
+	scene_inst_node.append_attribute("url") = "#DefaultScene";
+
+	int id = 0;
+	for(int i = 0; i < count; i++) {
+		if(objects[chunk_objects[i]]->saveInstance(vscene_node, &id, NULL, NULL))
 			return 1;
 	}
 
-	//Write to the file
+	//Meshes and materials live in the library file
+	referenceLibrary(vscene_node, library);
+
 	if(!doc.save_file(filename))
 		return 1;
 
@@ -121,8 +439,18 @@ int Scene::save(const char *filename)
 //Load a scene from a COLLADA file
 int Scene::load(const char *filename)
 {
+	MappedFile mapped_file;
 	pugi::xml_document load_file;
-	pugi::xml_parse_result result = load_file.load_file(filename);
+	pugi::xml_parse_result result;
+	int status = 0;
+
+	//Parse the mapped file in place without end of line or attribute whitespace
+	//processing. Numeric text is read straight from the mapping.
+	if(fast_load && !mapped_file.open(filename))
+		result = load_file.load_buffer_inplace(mapped_file.getData(), mapped_file.getSize(),
+			pugi::parse_minimal | pugi::parse_escapes | pugi::parse_cdata);
+	else
+		result = load_file.load_file(filename);
 
 	//Exit if the file could not be parsed
 	if(result.status != pugi::xml_parse_status::status_ok)
@@ -163,22 +491,9 @@ int Scene::load(const char *filename)
 			}
 			else if(!strcmp(top_node.name(), "library_geometries"))
 			{
-				for(pugi::xml_node geom_node = top_node.first_child(); geom_node; geom_node = geom_node.next_sibling())
-				{
-					if(!strcmp(geom_node.name(), "geometry"))
-					{
-						Geometry *g = new Geometry();
-						if(!g->readGeometry(geom_node))
-						{
-							g->setVisibility(false);
-							addObject(g);
-						}
-						else
-						{
-							delete g;
-						}
-					}
-				}
+				//Keep loading the rest of the file if a geometry fails
+				if(loadGeometryLibrary(top_node))
+					status = 2;
 			}
 			else if(!strcmp(top_node.name(), "library_visual_scenes"))
 			{
@@ -202,7 +517,7 @@ int Scene::load(const char *filename)
 		}
 	}
 
-	return 0;
+	return status;
 }
 
 void Scene::loadNode(pugi::xml_node node, Group *parent)
@@ -215,23 +530,17 @@ void Scene::loadNode(pugi::xml_node node, Group *parent)
 
 			if(base_geom)
 			{
-				Geometry *g = new Instance(base_geom);
+				Geometry *g = new(&arena) Instance(base_geom, &arena);
 
-				if(node.child("matrix"))
+				//Inside a group the node's matrix is already on the group
+				if(parent == NULL && node.child("matrix"))
 				{
 					//Transform the object if necessary
 					Transform *t = g->getTransform();
 					Matrix m;
 
 					//Read matrix from COLLADA node
-					pugi::xml_node matrix_node = node.child("matrix");
-					std::string text = matrix_node.text().get();
-					std::istringstream iss(text);
-
-					iss >> m.r0[0]; iss >> m.r0[1]; iss >> m.r0[2]; iss >> m.r0[3];
-					iss >> m.r1[0]; iss >> m.r1[1]; iss >> m.r1[2]; iss >> m.r1[3];
-					iss >> m.r2[0]; iss >> m.r2[1]; iss >> m.r2[2]; iss >> m.r2[3];
-					iss >> m.r3[0]; iss >> m.r3[1]; iss >> m.r3[2]; iss >> m.r3[3];
+					readMatrix(node.child("matrix"), &m);
 
 					t->setMatrix(m);
 				}
@@ -248,32 +557,108 @@ void Scene::loadNode(pugi::xml_node node, Group *parent)
 		}
 		else if(!strcmp(node_child.name(), "node"))
 		{
-			Group *geom_group = new Group();
+			Group *geom_group = new(&arena) Group("Group", &arena);
 
-			if(node.child("matrix"))
+			if(node_child.child("matrix"))
 			{
 				//Transform the object if necessary
 				Transform *t = geom_group->getTransform();
 				Matrix m;
 
 				//Read matrix from COLLADA node
-				pugi::xml_node matrix_node = node.child("matrix");
-				std::string text = matrix_node.text().get();
-				std::istringstream iss(text);
-
-				iss >> m.r0[0]; iss >> m.r0[1]; iss >> m.r0[2]; iss >> m.r0[3];
-				iss >> m.r1[0]; iss >> m.r1[1]; iss >> m.r1[2]; iss >> m.r1[3];
-				iss >> m.r2[0]; iss >> m.r2[1]; iss >> m.r2[2]; iss >> m.r2[3];
-				iss >> m.r3[0]; iss >> m.r3[1]; iss >> m.r3[2]; iss >> m.r3[3];
+				readMatrix(node_child.child("matrix"), &m);
 
 				t->setMatrix(m);
 			}
 
 			loadNode(node_child, geom_group);
 
-			addObject(geom_group);
+			if(parent != NULL)
+			{
+				parent->addObject(geom_group);
+			}
+			else
+			{
+				addObject(geom_group);
+			}
+		}
+	}
+}
+
+//Load all geometries in a library
+int Scene::loadGeometryLibrary(pugi::xml_node library)
+{
+	std::vector<pugi::xml_node> geom_nodes;
+	for(pugi::xml_node geom_node = library.first_child(); geom_node; geom_node = geom_node.next_sibling())
+	{
+		if(!strcmp(geom_node.name(), "geometry"))
+			geom_nodes.push_back(geom_node);
+	}
+
+	int num_geoms = geom_nodes.size();
+	if(num_geoms == 0)
+		return 0;
+
+	//Split the geometries into contiguous batches
+	int num_batches = 1;
+#ifdef _OPENMP
+	if(parallel_load)
+		num_batches = omp_get_max_threads() * LOAD_BATCHES_PER_THREAD;
+#endif
+	if(num_batches > num_geoms)
+		num_batches = num_geoms;
+
+	//The first batch uses the scene arena and the others use their own
+	while((int)load_arenas.size() < num_batches - 1)
+		load_arenas.push_back(new MemoryArena());
+
+	//Construct objects serially so ids are assigned in file order
+	std::vector<Geometry*> geoms(num_geoms);
+	std::vector<int> results(num_geoms);
+	for(int b = 0; b < num_batches; b++)
+	{
+		MemoryArena *batch_arena = b == 0 ? &arena : load_arenas[b - 1];
+		for(int i = b * num_geoms / num_batches; i < (b + 1) * num_geoms / num_batches; i++)
+			geoms[i] = new(batch_arena) Geometry("Geometry", batch_arena);
+	}
+
+	//Parse each batch on any thread. Only the batch's own arena is touched.
+	#pragma omp parallel for schedule(dynamic)
+	for(int b = 0; b < num_batches; b++)
+	{
+		for(int i = b * num_geoms / num_batches; i < (b + 1) * num_geoms / num_batches; i++)
+			results[i] = geoms[i]->readGeometry(geom_nodes[i]);
+	}
+
+	//Add geometries to the scene in file order
+	int status = 0;
+	for(int i = 0; i < num_geoms; i++)
+	{
+		if(!results[i])
+		{
+			geoms[i]->setVisibility(false);
+			addObject(geoms[i]);
+		}
+		else
+		{
+			Geometry::destroy(geoms[i]);
+			status = 1;
 		}
 	}
+
+	return status;
+}
+
+//Set parallel loading
+void Scene::setParallelLoad(bool p)
+{
+	parallel_load = p;
+}
+
+//Set fast loading
+void Scene::setFastLoad(bool f)
+{
+	fast_load = f;
 }
 
 //Clear a scene
@@ -281,32 +666,38 @@ void Scene::clear()
 {
 	for(unsigned int i = 0; i < objects.size(); i++)
 	{
-		delete objects[i];
+		Geometry::destroy(objects[i]);
 	}
 
 	objects.clear();
+	object_index.clear();
+
+	for(unsigned int i = 0; i < textures.size(); i++)
+		delete textures[i];
+	textures.clear();
+
+	//Release all scene memory at once
+	arena.reset();
+	for(unsigned int i = 0; i < load_arenas.size(); i++)
+		load_arenas[i]->reset();
 }
 
 //Find an object by id
 Geometry *Scene::findObject(const char *id)
 {
-	//Remove # symbol if present in url
-	if(id[0] == '#')
-		id = &(id[1]);
-
-	for(unsigned int i = 0; i < objects.size(); i++)
-	{
-		if(!strcmp(objects[i]->getUniqueId(), id))
-			return objects[i];
-	}
-
-	return NULL;
+	return object_index.find(id);
 }
 
 //Consolidate all objects into a single mesh
 void Scene::consolidate()
 {
-	Geometry *entire_scene = new Geometry("scene");
+	consolidate(NULL);
+}
+
+//Consolidate the objects inside a volume into a single mesh
+void Scene::consolidate(CullingVolume *volume)
+{
+	Geometry *entire_scene = new(&arena) Geometry("scene", &arena);
 
 	//Combine all objects
 	for(unsigned int i = 0; i < objects.size(); i++)
@@ -314,18 +705,36 @@ void Scene::consolidate()
 		objects[i]->cleanUp();
 		if(objects[i]->isVisible())
 		{
-			objects[i]->combineInto(entire_scene, NULL);
+			objects[i]->combineInto(entire_scene, NULL, volume);
 		}
 	}
 
 	//Delete all objects
 	for(unsigned int i = 0; i < objects.size(); i++)
 	{
-		delete objects[i];
+		Geometry::destroy(objects[i]);
 	}
 	objects.clear();
+	object_index.clear();
+
+	//Keep one copy of texture coordinates shared between objects
+	entire_scene->mergeUVs();
 
 	//Add super-object to scene
 	entire_scene->cleanUp();
 	addObject(entire_scene);
 }
+
+//Partition all objects into meshlets
+void Scene::partition(unsigned int max_vertices, unsigned int max_triangles)
+{
+	for(unsigned int i = 0; i < objects.size(); i++)
+		objects[i]->partition(max_vertices, max_triangles);
+}
+
+//Set quantization of all objects
+void Scene::setQuantized(bool q)
+{
+	for(unsigned int i = 0; i < objects.size(); i++)
+		objects[i]->setQuantized(q);
+}
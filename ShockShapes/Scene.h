@@ -23,6 +23,10 @@
 #include "pugixml.hpp"
 #include "Geometry.h"
 #include "Group.h"
+#include "IdIndex.h"
+#include "ProceduralTexture.h"
+
+#define LOAD_BATCHES_PER_THREAD 4
 
 /**
  * @brief Manages scene assets and file I/O for scenes
@@ -36,23 +40,96 @@ private:
 	 */
 	std::vector<Geometry*> objects;
 
+	/**
+	 * Objects keyed by unique id for finding instanced geometry
+	 */
+	IdIndex<Geometry> object_index;
+
+	/**
+	 * Textures used as materials by objects in the scene
+	 */
+	std::vector<ProceduralTexture*> textures;
+
+	/**
+	 * Memory for objects created by the scene and their mesh buffers
+	 */
+	MemoryArena arena;
+
+	/**
+	 * Extra arenas so geometries can be parsed on several threads at once.
+	 * Each batch of a parallel load allocates from its own arena.
+	 */
+	std::vector<MemoryArena*> load_arenas;
+
+	bool parallel_load;		/**< True if geometry libraries are parsed on multiple threads. */
+	bool fast_load;			/**< True if files are mapped and parsed in place with minimal processing. Off by default. */
+
 	std::string name;
 
 	float units_per_meter;
 
+	/**
+	 * Starts a COLLADA document with the root and asset nodes
+	 * @param doc The empty document to fill
+	 * @param timestamp Creation and modification time to record
+	 * @return The COLLADA root node
+	 */
+	pugi::xml_node createDocument(pugi::xml_document *doc, const char *timestamp);
+
+	/**
+	 * Adds the image, effect and material libraries for the scene's textures
+	 * @param collada_node The COLLADA root node to add the libraries to
+	 * @return Returns 0 if no errors occur
+	 */
+	int saveMaterials(pugi::xml_node collada_node);
+
+	/**
+	 * Writes one chunk of a partitioned scene. Only touches the listed
+	 * objects, so chunks can be written on separate threads
+	 * @param filename The file to write the chunk to
+	 * @param library File name of the shared library, relative to the chunk
+	 * @param timestamp Creation and modification time to record
+	 * @param chunk_objects Indices of the top level objects in the chunk
+	 * @param count Number of objects in the chunk
+	 * @return Returns 0 if no errors occur
+	 */
+	int saveChunk(const char *filename, const std::string &library, const char *timestamp, const int *chunk_objects, int count);
+
 public:
 	Scene();					/**< Default empty scene constructor. */
 	Scene(const char *sname);	/**< Constructor that names the scene. */
 
-	~Scene();					/**< Destructor. */
+	~Scene();					/**< Destructor. Destroys all objects in the scene. */
+
+	/**
+	 * Gets the arena used for objects that belong to this scene.
+	 * Objects allocated with new(arena) and constructed with the arena are
+	 * released all at once when the scene is cleared.
+	 * @return Pointer to the scene's arena
+	 */
+	MemoryArena *getArena();
 
 	/**
-	 * Adds a geometric object to the scene
+	 * Adds a geometric object to the scene. The scene takes ownership of the object.
 	 * @param g Pointer to an object that is any child of Geometry
 	 * @return Returns the id number that can be used to query the object
 	 */
 	int addObject(Geometry *g);
 
+	/**
+	 * Adds a texture to the scene so it is saved as a material. The scene takes
+	 * ownership of the texture.
+	 * @param tex Pointer to the texture
+	 * @return Returns the id number of the texture
+	 */
+	int addTexture(ProceduralTexture *tex);
+
+	/**
+	 * Renders every texture in the scene to its image file
+	 * @return Returns 0 if no errors occur
+	 */
+	int renderTextures();
+
 	/**
 	 * Generates the scene and all objects contained
 	 * @param seed Number to seed the random number generator with
@@ -66,10 +143,36 @@ public:
 	 */
 	int save(const char *filename);
 
+	/**
+	 * Writes the parts of the scene inside a volume to a COLLADA file. Only
+	 * meshes with an instance inside the volume are written to the geometry
+	 * library
+	 * @param filename The local file name to use for writing
+	 * @param volume Objects whose bounds are outside this volume are left out
+	 * @return Returns 0 if no errors occur
+	 */
+	int save(const char *filename, CullingVolume *volume);
+
+	/**
+	 * Writes the scene as a grid of chunk files for streaming. Each visible
+	 * top level object goes in the cell containing the center of its world
+	 * bounds. Every mesh and material is written once to a shared library
+	 * file, which the chunks reference by URL, and the chunks are then
+	 * written in parallel. An index file lists each chunk with its cell and
+	 * bounds. For an index named level.xml the library is level_library.dae
+	 * and the chunk in cell (x, y, z) is level_x_y_z.dae, all in the index's
+	 * directory.
+	 * @param filename The local file name to use for the index
+	 * @param cell_size Edge length of the grid's cubic cells
+	 * @return Returns 0 if no errors occur
+	 */
+	int saveChunks(const char *filename, float cell_size);
+
 	/**
 	 * Loads the scene from a COLLADA file with the supplied name
 	 * @param filename The local file to load from
-	 * @return Returns 0 if no errors occur
+	 * @return Returns 0 if no errors occur. Returns 2 if the file was read but
+	 * some geometries could not be and were left out
 	 */
 	int load(const char *filename);
 
@@ -80,6 +183,29 @@ public:
 	 */
 	void loadNode(pugi::xml_node node, Group *parent);
 
+	/**
+	 * Load every geometry in a library_geometries node. Geometries are parsed
+	 * in parallel when parallel loading is enabled and added to the scene in
+	 * file order once all of them are read.
+	 * @param library The xml COLLADA library node to process
+	 * @return Returns 0 if every geometry was read
+	 */
+	int loadGeometryLibrary(pugi::xml_node library);
+
+	/**
+	 * Sets whether load parses geometries on multiple threads
+	 * @param p True to parse in parallel. Has no effect without OpenMP
+	 */
+	void setParallelLoad(bool p);
+
+	/**
+	 * Sets whether load maps the file and parses it in place. The fast path
+	 * skips end of line and attribute whitespace processing, neither of which
+	 * affects the numeric arrays of a mesh. Off by default.
+	 * @param f True to use the fast path
+	 */
+	void setFastLoad(bool f);
+
 	/**
 	 * Finds a geometric object by id
 	 * @param id The string to search for
@@ -93,7 +219,27 @@ public:
 	void consolidate();
 
 	/**
-	 * Clears a scene of all data
+	 * Copies the mesh data inside a volume into a single geometry object,
+	 * discarding everything else
+	 * @param volume Objects whose bounds are outside this volume are left out
+	 */
+	void consolidate(CullingVolume *volume);
+
+	/**
+	 * Partitions every object in the scene into meshlets for per cluster culling
+	 * @param max_vertices Maximum number of vertices in a meshlet
+	 * @param max_triangles Maximum number of triangles in a meshlet
+	 */
+	void partition(unsigned int max_vertices, unsigned int max_triangles);
+
+	/**
+	 * Sets whether the objects currently in the scene save quantized vertex data
+	 * @param q True to save positions, normals and uvs as 16 bit integers
+	 */
+	void setQuantized(bool q);
+
+	/**
+	 * Clears a scene of all data and releases the scene's arena
 	 */
 	void clear();
 };
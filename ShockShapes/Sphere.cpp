@@ -0,0 +1,336 @@
+/** @file Sphere.cpp
+ *
+ * @brief Generates spheres by latitude and longitude or by subdividing an icosahedron
+ *
+ * Copyright 2013, Stewart Hall
+ *
+ * Licensed under The MIT License
+ * Redistributions of files must retain the above copyright notice.
+ *
+ * @author		Stewart Hall (www.stewartghall.com)
+ * @date		10/18/2026
+ * @copyright	Copyright 2013, Stewart Hall
+ * @license		MIT License (http://www.opensource.org/licenses/mit-license.php)
+ */
+
+#include <math.h>
+
+#include "Sphere.h"
+
+/**
+ * @brief A unit icosahedron with its edges and a texture net
+ */
+typedef struct {
+	Vector3D corners[12];		/**< North pole, upper ring, lower ring, south pole. */
+	int faces[20][3];			/**< Corners of each face, counterclockwise from outside. */
+	int edges[30][2];			/**< Corners at the ends of each edge, lowest first. */
+	int face_edges[20][3];		/**< Edges from corner 0 to 1, 1 to 2 and 2 to 0 of each face. */
+	Vector2D face_uvs[20][3];	/**< Texture coordinate of each corner of each face. */
+} Icosahedron;
+
+//Fill in an icosahedron's tables
+static void buildIcosahedron(Icosahedron *ico)
+{
+	float ring_y = 1.0f / sqrtf(5.0f);
+	float ring_radius = 2.0f / sqrtf(5.0f);
+
+	ico->corners[0].x = 0.0f; ico->corners[0].y = 1.0f; ico->corners[0].z = 0.0f;
+	ico->corners[11].x = 0.0f; ico->corners[11].y = -1.0f; ico->corners[11].z = 0.0f;
+	for(int k = 0; k < 5; k++) {
+		float upper = 2.0f * PI * (float)k / 5.0f;
+		float lower = 2.0f * PI * ((float)k + 0.5f) / 5.0f;
+
+		ico->corners[1 + k].x = ring_radius * cosf(upper);
+		ico->corners[1 + k].y = ring_y;
+		ico->corners[1 + k].z = -ring_radius * sinf(upper);
+
+		ico->corners[6 + k].x = ring_radius * cosf(lower);
+		ico->corners[6 + k].y = -ring_y;
+		ico->corners[6 + k].z = -ring_radius * sinf(lower);
+	}
+
+	//Each strip of the net is a top, upper, lower and bottom face
+	for(int k = 0; k < 5; k++) {
+		int next = (k + 1) % 5;
+		int strip[4][3] = {
+			{0, 1 + k, 1 + next},
+			{1 + k, 6 + k, 1 + next},
+			{1 + next, 6 + k, 6 + next},
+			{6 + k, 11, 6 + next}
+		};
+		float u = (float)k;
+		float strip_uvs[4][3][2] = {
+			{{u + 0.5f, 3.0f}, {u, 2.0f}, {u + 1.0f, 2.0f}},
+			{{u, 2.0f}, {u + 0.5f, 1.0f}, {u + 1.0f, 2.0f}},
+			{{u + 1.0f, 2.0f}, {u + 0.5f, 1.0f}, {u + 1.5f, 1.0f}},
+			{{u + 0.5f, 1.0f}, {u + 1.0f, 0.0f}, {u + 1.5f, 1.0f}}
+		};
+
+		for(int f = 0; f < 4; f++) {
+			for(int c = 0; c < 3; c++) {
+				ico->faces[k * 4 + f][c] = strip[f][c];
+				ico->face_uvs[k * 4 + f][c].u = strip_uvs[f][c][0] / 5.0f;
+				ico->face_uvs[k * 4 + f][c].v = strip_uvs[f][c][1] / 3.0f;
+			}
+		}
+	}
+
+	//Number the edges in the order faces first reach them
+	int num_edges = 0;
+	for(int f = 0; f < 20; f++) {
+		for(int c = 0; c < 3; c++) {
+			int a = ico->faces[f][c];
+			int b = ico->faces[f][(c + 1) % 3];
+			int lo = a < b ? a : b;
+			int hi = a < b ? b : a;
+
+			int e = 0;
+			while(e < num_edges && (ico->edges[e][0] != lo || ico->edges[e][1] != hi))
+				e++;
+			if(e == num_edges) {
+				ico->edges[e][0] = lo;
+				ico->edges[e][1] = hi;
+				num_edges++;
+			}
+
+			ico->face_edges[f][c] = e;
+		}
+	}
+}
+
+//Project the point i / f of the way from a to b and j / f of the way from a to c onto the sphere
+static void projectPoint(const Vector3D &a, const Vector3D &b, const Vector3D &c, int i, int j, int f, float radius, Vector3D *position, Vector3D *normal)
+{
+	float s = (float)i / (float)f;
+	float t = (float)j / (float)f;
+	Vector3D p = {a.x + (b.x - a.x) * s + (c.x - a.x) * t,
+		a.y + (b.y - a.y) * s + (c.y - a.y) * t,
+		a.z + (b.z - a.z) * s + (c.z - a.z) * t};
+	float length = sqrtf(p.x * p.x + p.y * p.y + p.z * p.z);
+
+	normal->x = p.x / length;
+	normal->y = p.y / length;
+	normal->z = p.z / length;
+
+	position->x = normal->x * radius;
+	position->y = normal->y * radius;
+	position->z = normal->z * radius;
+}
+
+//Find the vertex k / f of the way along an edge from one of its ends
+static int edgeVertex(const Icosahedron *ico, int edge, int from, int k, int f)
+{
+	if(from != ico->edges[edge][0])
+		k = f - k;
+
+	return 12 + edge * (f - 1) + k - 1;
+}
+
+//Find the vertex of a point on a face. Corners come first, then the points
+//inside each edge, then the points inside each face.
+static int icosphereVertex(const Icosahedron *ico, int face, int i, int j, int f)
+{
+	const int *corners = ico->faces[face];
+	const int *edges = ico->face_edges[face];
+
+	if(i == 0 && j == 0)
+		return corners[0];
+	if(i == f)
+		return corners[1];
+	if(j == f)
+		return corners[2];
+	if(j == 0)
+		return edgeVertex(ico, edges[0], corners[0], i, f);
+	if(i + j == f)
+		return edgeVertex(ico, edges[1], corners[1], j, f);
+	if(i == 0)
+		return edgeVertex(ico, edges[2], corners[0], j, f);
+
+	int face_start = 12 + 30 * (f - 1) + face * (f - 1) * (f - 2) / 2;
+	return face_start + (j - 1) * (f - 1) - (j - 1) * j / 2 + (i - 1);
+}
+
+//Default constructor
+Sphere::Sphere()
+:Primitive("Sphere")
+{
+	tessellation = ST_UV;
+	radius = 1.0f;
+	segments = 32;
+	rings = 16;
+	subdivisions = 0;
+}
+
+//UV sphere constructor
+Sphere::Sphere(float r, int segs, int num_rings)
+:Primitive("Sphere")
+{
+	tessellation = ST_UV;
+	radius = r;
+	segments = segs < 3 ? 3 : segs;
+	rings = num_rings < 2 ? 2 : num_rings;
+	subdivisions = 0;
+}
+
+//Icosphere constructor
+Sphere::Sphere(float r, int subdivs)
+:Primitive("Sphere")
+{
+	tessellation = ST_ICOSPHERE;
+	radius = r;
+	segments = 0;
+	rings = 0;
+	subdivisions = subdivs < 0 ? 0 : subdivs;
+}
+
+//Destructor
+Sphere::~Sphere()
+{
+
+}
+
+//Generates the object's mesh
+void Sphere::generate(int seed, Scene *scene)
+{
+	if(tessellation == ST_ICOSPHERE)
+		generateIcosphere();
+	else
+		generatePatches();
+}
+
+//A UV sphere is a single patch
+int Sphere::getNumPatches()
+{
+	return 1;
+}
+
+//Describe the UV sphere
+void Sphere::getPatch(int patch, PrimitivePatch *desc)
+{
+	desc->columns = segments;
+	desc->rows = rings;
+	desc->flags = PF_COLLAPSE_FIRST | PF_COLLAPSE_LAST | PF_WRAP_COLUMNS;
+}
+
+//Count the poles and the rings between them
+int Sphere::getNumPositions()
+{
+	return 2 + (rings - 1) * segments;
+}
+
+//The south pole is first and the north pole last
+int Sphere::getVertexIndex(int patch, int row, int column)
+{
+	if(row == 0)
+		return 0;
+	if(row == rings)
+		return 1 + (rings - 1) * segments;
+
+	return 1 + (row - 1) * segments + column % segments;
+}
+
+//Evaluate a grid point
+void Sphere::evaluate(int patch, int row, int column, Vector3D *position, Vector3D *normal, Vector2D *uv)
+{
+	uv->u = (float)column / (float)segments;
+	uv->v = (float)row / (float)rings;
+
+	float theta = PI * (1.0f - uv->v);
+	float phi = 2.0f * PI * uv->u;
+
+	normal->x = sinf(theta) * cosf(phi);
+	normal->y = cosf(theta);
+	normal->z = -sinf(theta) * sinf(phi);
+
+	position->x = normal->x * radius;
+	position->y = normal->y * radius;
+	position->z = normal->z * radius;
+}
+
+//Append an icosphere to the buffers
+void Sphere::generateIcosphere()
+{
+	Icosahedron ico;
+	buildIcosahedron(&ico);
+
+	//Count everything up front so the buffers are sized once
+	int f = 1 << subdivisions;
+	int num_vertices = 10 * f * f + 2;
+	int face_points = (f + 1) * (f + 2) / 2;
+
+	int first_vertex = getNumVertices();
+	int first_normal = getNumNormals();
+	int first_uv = getNumUVs();
+	int first_triangle = getNumTriangles();
+	resizeBuffers(first_vertex + num_vertices, first_normal + num_vertices, first_uv + 20 * face_points, first_triangle + 20 * f * f);
+
+	Vector3D *vertex_data = getVertex(first_vertex);
+	Vector3D *normal_data = getNormal(first_normal);
+	Vector2D *uv_data = getUV(first_uv);
+	Triangle *triangle_data = editTriangles() + first_triangle;
+
+	//Normals are shared along with the vertices
+	for(int c = 0; c < 12; c++)
+		projectPoint(ico.corners[c], ico.corners[c], ico.corners[c], 0, 0, 1, radius, &vertex_data[c], &normal_data[c]);
+
+	//Points along each edge are found from the edge itself, so the faces on
+	//either side agree
+	for(int e = 0; e < 30; e++) {
+		const Vector3D &a = ico.corners[ico.edges[e][0]];
+		const Vector3D &b = ico.corners[ico.edges[e][1]];
+		for(int k = 1; k < f; k++) {
+			int v = edgeVertex(&ico, e, ico.edges[e][0], k, f);
+			projectPoint(a, b, a, k, 0, f, radius, &vertex_data[v], &normal_data[v]);
+		}
+	}
+
+	//Each face writes its own inner points, texture coordinates and triangles
+	#pragma omp parallel for schedule(static) if(f >= PRIMITIVE_PARALLEL_ROWS)
+	for(int face = 0; face < 20; face++) {
+		const Vector3D &a = ico.corners[ico.faces[face][0]];
+		const Vector3D &b = ico.corners[ico.faces[face][1]];
+		const Vector3D &c = ico.corners[ico.faces[face][2]];
+		const Vector2D *corner_uvs = ico.face_uvs[face];
+		Vector2D *face_uvs = uv_data + face * face_points;
+
+		for(int j = 0; j <= f; j++) {
+			for(int i = 0; i + j <= f; i++) {
+				if(i > 0 && j > 0 && i + j < f) {
+					int v = icosphereVertex(&ico, face, i, j, f);
+					projectPoint(a, b, c, i, j, f, radius, &vertex_data[v], &normal_data[v]);
+				}
+
+				float s = (float)i / (float)f;
+				float t = (float)j / (float)f;
+				Vector2D *uv = &face_uvs[j * (f + 1) - j * (j - 1) / 2 + i];
+				uv->u = corner_uvs[0].u + (corner_uvs[1].u - corner_uvs[0].u) * s + (corner_uvs[2].u - corner_uvs[0].u) * t;
+				uv->v = corner_uvs[0].v + (corner_uvs[1].v - corner_uvs[0].v) * s + (corner_uvs[2].v - corner_uvs[0].v) * t;
+			}
+		}
+
+		//Each row of the face has upward triangles and the downward ones between them
+		Triangle *t = triangle_data + face * f * f;
+		int uv_start = first_uv + face * face_points;
+		for(int j = 0; j < f; j++) {
+			for(int i = 0; i + j < f; i++) {
+				int points[4][2] = {{i, j}, {i + 1, j}, {i + 1, j + 1}, {i, j + 1}};
+				static const int halves[2][3] = {{0, 1, 3}, {1, 2, 3}};
+
+				for(int half = 0; half < 2; half++) {
+					if(half == 1 && i + j == f - 1)
+						continue;
+
+					for(int k = 0; k < 3; k++) {
+						int pi = points[halves[half][k]][0];
+						int pj = points[halves[half][k]][1];
+						int v = icosphereVertex(&ico, face, pi, pj, f);
+						t->vertices[k] = first_vertex + v;
+						t->normals[k] = first_normal + v;
+						t->uvs[k] = uv_start + pj * (f + 1) - pj * (pj - 1) / 2 + pi;
+					}
+					t++;
+				}
+			}
+		}
+	}
+}
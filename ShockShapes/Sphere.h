@@ -0,0 +1,119 @@
+/** @file Sphere.h
+ *
+ * @brief Generates spheres by latitude and longitude or by subdividing an icosahedron
+ *
+ * Copyright 2013, Stewart Hall
+ *
+ * Licensed under The MIT License
+ * Redistributions of files must retain the above copyright notice.
+ *
+ * @author		Stewart Hall (www.stewartghall.com)
+ * @date		10/18/2026
+ * @copyright	Copyright 2013, Stewart Hall
+ * @license		MIT License (http://www.opensource.org/licenses/mit-license.php)
+ */
+
+#ifndef _SPHERE_
+#define _SPHERE_
+
+#include "Primitive.h"
+
+/**
+ * How the sphere's surface is divided into triangles
+ */
+enum sphere_tessellation {
+	ST_UV,				/**< Rings of latitude and segments of longitude meeting at the poles. */
+	ST_ICOSPHERE		/**< Icosahedron faces divided into even triangles, with no poles. */
+};
+
+/**
+ * @brief Generates a sphere centered at the origin with smooth normals
+ * @details A UV sphere shares one vertex at each pole and along the seam,
+ * where only the texture coordinates are duplicated. An icosphere with n
+ * subdivisions has the 20 * 4^n triangles that n midpoint subdivisions of an
+ * icosahedron would give, built in one pass. Its texture coordinates follow
+ * the usual net of five strips of four faces.
+ */
+class Sphere : public Primitive {
+private:
+	sphere_tessellation tessellation;	/**< How the surface is divided. */
+	float radius;						/**< Radius of the sphere. */
+	int segments;						/**< Number of cells around a UV sphere. */
+	int rings;							/**< Number of cells from pole to pole of a UV sphere. */
+	int subdivisions;					/**< Number of times the faces of an icosphere are halved. */
+
+	/**
+	 * Appends an icosphere to the buffers
+	 */
+	void generateIcosphere();
+
+protected:
+	/**
+	 * Gets the number of patches
+	 * @return 1
+	 */
+	virtual int getNumPatches();
+
+	/**
+	 * Describes the UV sphere, with columns running east and rows running
+	 * north
+	 * @param patch Index of the patch
+	 * @param desc Receives the size of the patch
+	 */
+	virtual void getPatch(int patch, PrimitivePatch *desc);
+
+	/**
+	 * Gets the number of vertices in a UV sphere
+	 * @return One per pole and one per grid point between them
+	 */
+	virtual int getNumPositions();
+
+	/**
+	 * Finds the vertex of a grid point
+	 * @param patch Index of the patch
+	 * @param row Row of the grid point
+	 * @param column Column of the grid point
+	 * @return Index of the vertex
+	 */
+	virtual int getVertexIndex(int patch, int row, int column);
+
+	/**
+	 * Evaluates the UV sphere at a grid point
+	 * @param patch Index of the patch
+	 * @param row Row of the grid point
+	 * @param column Column of the grid point
+	 * @param position Receives the position
+	 * @param normal Receives the unit normal
+	 * @param uv Receives the texture coordinate
+	 */
+	virtual void evaluate(int patch, int row, int column, Vector3D *position, Vector3D *normal, Vector2D *uv);
+
+public:
+	Sphere();					/**< Default constructor makes a UV sphere of radius 1 with 32 segments and 16 rings. */
+
+	/**
+	 * Makes a UV sphere
+	 * @param r Radius of the sphere
+	 * @param segs Number of cells around the equator. At least 3
+	 * @param num_rings Number of cells from pole to pole. At least 2
+	 */
+	Sphere(float r, int segs, int num_rings);
+
+	/**
+	 * Makes an icosphere
+	 * @param r Radius of the sphere
+	 * @param subdivs Number of times each face of the icosahedron is halved
+	 */
+	Sphere(float r, int subdivs);
+
+	~Sphere();					/**< Destructor. */
+
+	/**
+	 * Generates the sphere's mesh
+	 * @param seed The value to seed the random number generator with
+	 * @param scene The scene that this geometry will belong to
+	 */
+	virtual void generate(int seed, Scene *scene);
+};
+
+#endif
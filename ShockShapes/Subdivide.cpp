@@ -13,13 +13,33 @@
  * @license		MIT License (http://www.opensource.org/licenses/mit-license.php)
  */
 
+#include <math.h>
+#include <algorithm>
+#include <vector>
+
 #include "Subdivide.h"
+#include "HashMap.h"
 
 //Constructor
 Subdivide::Subdivide(int ilevels)
 :GeometryFilter("Subdivide")
 {
 	levels = ilevels;
+	scheme = SS_MIDPOINT;
+	crease_all = true;
+	threshold = 2.0f;
+	disableAdaptive();
+}
+
+//Constructor with scheme
+Subdivide::Subdivide(int ilevels, subdivision_scheme ischeme)
+:GeometryFilter("Subdivide")
+{
+	levels = ilevels;
+	scheme = ischeme;
+	crease_all = true;
+	threshold = 2.0f;
+	disableAdaptive();
 }
 
 //Destructor
@@ -28,187 +48,487 @@ Subdivide::~Subdivide()
 
 }
 
-//Perform one iteration of subdivision
-void Subdivide::subd(Geometry *g)
+//Sets up crease threshold
+void Subdivide::enableCreaseThreshold(float t)
 {
-	std::vector<Midpoint> midpoints;
-	std::vector<NormalInt> norm_ints;
+	crease_all = false;
+	threshold = t;
+}
 
-	int mid1, mid2, mid3;
-	int nint1, nint2, nint3;
-	Triangle *current;
-	Vector3D *v1;
-	Vector3D *v2;
-	Vector3D midpoint;
-	Vector3D interpolated_normal;
-	Vector2D uv1, uv2, uv3;
-	Triangle temp;
+//Disables crease threshold
+void Subdivide::disableCreaseThreshold()
+{
+	crease_all = true;
+}
 
-	//Iterate through each triangle
-	int num_triangles = g->getNumTriangles();
-	for(int i = 0; i < num_triangles; i++) {
-		mid1 = -1; mid2 = -1; mid3 = -1;
-		nint1 = -1; nint2 = -1; nint3 = -1;
-		current = g->getTriangle(i);
+//Use the same threshold as a normal filter
+void Subdivide::matchCreases(NormalFilter *f)
+{
+	if(f->isSoftenThresholdEnabled())
+		enableCreaseThreshold(f->getSoftenThreshold());
+	else
+		disableCreaseThreshold();
+}
+
+//Split long edges
+void Subdivide::enableEdgeLengthLimit(float length)
+{
+	limit_edge_length = true;
+	max_edge_length = length;
+}
 
-		//Check for existing midpoints
-		int num_midpoints = midpoints.size();
-		for(int j = 0; j < num_midpoints; j++) {
-			if(current->vertices[0] == midpoints[j].v1) {
-				if(current->vertices[1] == midpoints[j].v2)
-					mid1 = midpoints[j].vmid;
-				else if(current->vertices[2] == midpoints[j].v2)
-					mid3 = midpoints[j].vmid;
-			} else if(current->vertices[1] == midpoints[j].v1) {
-				if(current->vertices[0] == midpoints[j].v2)
-					mid1 = midpoints[j].vmid;
-				else if(current->vertices[2] == midpoints[j].v2)
-					mid2 = midpoints[j].vmid;
-			} else if(current->vertices[2] == midpoints[j].v1) {
-				if(current->vertices[0] == midpoints[j].v2)
-					mid3 = midpoints[j].vmid;
-				else if(current->vertices[1] == midpoints[j].v2)
-					mid2 = midpoints[j].vmid;
+//Split curved triangles
+void Subdivide::enableCurvatureLimit(float t)
+{
+	limit_curvature = true;
+	curvature = t;
+}
+
+//Split edges that look large from a viewpoint
+void Subdivide::enableScreenSizeLimit(Vector3D ieye, float size)
+{
+	limit_screen_size = true;
+	eye = ieye;
+	max_screen_size = size;
+}
+
+//Split triangles in a box
+void Subdivide::enableRegionOfInterest(Vector3D imin, Vector3D imax)
+{
+	limit_region = true;
+	region_min = imin;
+	region_max = imax;
+}
+
+//Go back to uniform subdivision
+void Subdivide::disableAdaptive()
+{
+	limit_edge_length = false;
+	max_edge_length = 0.0f;
+	limit_curvature = false;
+	curvature = 2.0f;
+	limit_screen_size = false;
+	eye.x = eye.y = eye.z = 0.0f;
+	max_screen_size = 0.0f;
+	limit_region = false;
+	region_min = region_max = eye;
+}
+
+//Check for adaptive refinement
+bool Subdivide::isAdaptive()
+{
+	return limit_edge_length || limit_curvature || limit_screen_size || limit_region;
+}
+
+//Key for an unordered pair of attribute indices
+static unsigned long long attributePairKey(int a, int b)
+{
+	if(a > b) {
+		int t = a;
+		a = b;
+		b = t;
+	}
+
+	return ((unsigned long long)(unsigned int)a << 32) | (unsigned int)b;
+}
+
+
+//Check if a half-edge is the diagonal that splits a quad into two triangles
+static bool isQuadDiagonal(int h, bool quads)
+{
+	return quads && (h % 6 == 2 || h % 6 == 3);
+}
+
+//Get the face a half-edge belongs to
+static int faceOf(int h, bool quads)
+{
+	return quads ? h / 6 : h / 3;
+}
+
+//Get the half-edge leaving corner i of a face
+static int faceHalfEdge(int f, int i, bool quads)
+{
+	//A quad (a, b, c, d) is stored as triangles (a, b, c) and (a, c, d)
+	static const int quad_halfedges[4] = {0, 1, 4, 5};
+
+	if(quads)
+		return f * 6 + quad_halfedges[i];
+
+	return f * 3 + i;
+}
+
+//Corners 0 to 2 are the triangle's and 3 to 5 are the new vertices on edges 0 to 2
+static const int split_one[2][3] = {{0, 3, 2}, {3, 1, 2}};
+static const int split_two_corner[3] = {4, 2, 5};
+static const int split_two_short[2][3] = {{0, 1, 4}, {0, 4, 5}};
+static const int split_two_long[2][3] = {{0, 1, 5}, {1, 4, 5}};
+static const int split_three[4][3] = {{0, 3, 5}, {3, 4, 5}, {3, 1, 4}, {5, 4, 2}};
+static const int *const split_three_pattern[4] = {split_three[0], split_three[1], split_three[2], split_three[3]};
+static const int unrotated[6] = {0, 1, 2, 3, 4, 5};
+
+//Fill the per corner channels of the triangles a triangle was split into
+static void splitCornerChannels(Geometry *g, int old_triangle, const int *new_triangles, const int *const *pattern, const int *rotated, int num_new)
+{
+	float values[6][ATTRIBUTE_MAX_COMPONENTS];
+
+	int num_channels = g->getNumChannels();
+	for(int c = 0; c < num_channels; c++) {
+		AttributeChannel *channel = g->getChannel(c);
+		if(channel->getBinding() != AB_CORNER)
+			continue;
+
+		//Read every value before the old triangle's corners are overwritten
+		int num_components = channel->getNumComponents();
+		for(int k = 0; k < 3; k++) {
+			const float *a = channel->getValue(old_triangle * 3 + k);
+			const float *b = channel->getValue(old_triangle * 3 + (k + 1) % 3);
+			for(int j = 0; j < num_components; j++) {
+				values[k][j] = a[j];
+				values[k + 3][j] = (a[j] + b[j]) * 0.5f;
 			}
 		}
 
-		//Calculate remaining midpoints
-		if(mid1 == -1) {
-			Midpoint m;
-			m.v1 = current->vertices[0];
-			m.v2 = current->vertices[1];
+		for(int t = 0; t < num_new; t++) {
+			for(int k = 0; k < 3; k++) {
+				float *dest = channel->getValue(new_triangles[t] * 3 + k);
+				const float *source = values[rotated[pattern[t][k]]];
+				for(int j = 0; j < num_components; j++)
+					dest[j] = source[j];
+			}
+		}
+	}
+}
 
-			v1 = g->getVertex(m.v1);
-			v2 = g->getVertex(m.v2);
-			midpoint.x = (v1->x + v2->x) * 0.5f;
-			midpoint.y = (v1->y + v2->y) * 0.5f;
-			midpoint.z = (v1->z + v2->z) * 0.5f;
+//Copy the per corner channels of a mesh, leaving an empty copy for per vertex channels
+static void copyCornerChannels(Geometry *g, std::vector<std::vector<float> > *copies)
+{
+	int num_channels = g->getNumChannels();
+	copies->resize(num_channels);
+	for(int c = 0; c < num_channels; c++) {
+		AttributeChannel *channel = g->getChannel(c);
+		if(channel->getBinding() != AB_CORNER || channel->getNumElements() == 0)
+			continue;
 
-			mid1 = m.vmid = g->addVertex(midpoint);
-			midpoints.push_back(m);
+		const float *first = channel->getValue(0);
+		(*copies)[c].assign(first, first + channel->getNumElements() * channel->getNumComponents());
+	}
+}
+
+//Fill the per corner channels of the triangles a Catmull-Clark face was split into
+static void splitFaceCornerChannels(Geometry *g, const std::vector<std::vector<float> > &old_values, const int *halfedges, int face_size, int first_triangle)
+{
+	float corners[4][ATTRIBUTE_MAX_COMPONENTS];
+	float mids[4][ATTRIBUTE_MAX_COMPONENTS];
+	float center[ATTRIBUTE_MAX_COMPONENTS];
+	float inv_face_size = 1.0f / (float)face_size;
+
+	int num_channels = g->getNumChannels();
+	for(int c = 0; c < num_channels; c++) {
+		AttributeChannel *channel = g->getChannel(c);
+		if(channel->getBinding() != AB_CORNER)
+			continue;
+
+		//Half-edge h leaves corner h, so old corner values are indexed by half-edge
+		int num_components = channel->getNumComponents();
+		const float *old = &(old_values[c][0]);
+		for(int j = 0; j < num_components; j++)
+			center[j] = 0.0f;
+
+		for(int i = 0; i < face_size; i++) {
+			const float *a = old + halfedges[i] * num_components;
+			const float *b = old + MeshTopology::next(halfedges[i]) * num_components;
+			for(int j = 0; j < num_components; j++) {
+				corners[i][j] = a[j];
+				mids[i][j] = (a[j] + b[j]) * 0.5f;
+				center[j] += a[j] * inv_face_size;
+			}
 		}
 
-		if(mid2 == -1) {
-			Midpoint m;
-			m.v1 = current->vertices[1];
-			m.v2 = current->vertices[2];
+		//Same corner order as the triangles built in subdCatmullClark
+		for(int i = 0; i < face_size; i++) {
+			const float *sources[6] = {corners[i], mids[i], center, corners[i], center, mids[(i + face_size - 1) % face_size]};
+			for(int k = 0; k < 6; k++) {
+				float *dest = channel->getValue((first_triangle + i * 2) * 3 + k);
+				for(int j = 0; j < num_components; j++)
+					dest[j] = sources[k][j];
+			}
+		}
+	}
+}
+
+//Collect the edges around a vertex and the vertices at their other ends
+static void gatherVertexEdges(MeshTopology *topology, int v, bool quads, std::vector<int> *edges, std::vector<int> *ends)
+{
+	edges->clear();
+	ends->clear();
+
+	int num_corners = topology->getNumVertexCorners(v);
+	const int *corners = topology->getVertexCorners(v);
+	for(int i = 0; i < num_corners; i++) {
+		//Check both the half-edge leaving the vertex and the one arriving at it
+		int leaving = corners[i];
+		int arriving = MeshTopology::prev(leaving);
+		for(int j = 0; j < 2; j++) {
+			int h = j ? arriving : leaving;
+			if(isQuadDiagonal(h, quads))
+				continue;
 
-			v1 = g->getVertex(m.v1);
-			v2 = g->getVertex(m.v2);
-			midpoint.x = (v1->x + v2->x) * 0.5f;
-			midpoint.y = (v1->y + v2->y) * 0.5f;
-			midpoint.z = (v1->z + v2->z) * 0.5f;
+			int end = j ? topology->getVertex(arriving) : topology->getVertex(MeshTopology::next(leaving));
+			int e = topology->getEdge(h);
+			if(end == v || std::find(edges->begin(), edges->end(), e) != edges->end())
+				continue;
 
-			mid2 = m.vmid = g->addVertex(midpoint);
-			midpoints.push_back(m);
+			edges->push_back(e);
+			ends->push_back(end);
 		}
+	}
+}
 
-		if(mid3 == -1) {
-			Midpoint m;
-			m.v1 = current->vertices[2];
-			m.v2 = current->vertices[0];
+//Add a scaled vector to another
+static void addScaled(Vector3D *sum, Vector3D *v, float scale)
+{
+	sum->x += v->x * scale;
+	sum->y += v->y * scale;
+	sum->z += v->z * scale;
+}
+
+//Get the dot product of two vectors
+static float dotProduct(Vector3D *a, Vector3D *b)
+{
+	return a->x * b->x + a->y * b->y + a->z * b->z;
+}
+
+//Get the distance between two points
+static float distance(Vector3D *a, Vector3D *b)
+{
+	float dx = a->x - b->x;
+	float dy = a->y - b->y;
+	float dz = a->z - b->z;
+
+	return sqrtf(dx * dx + dy * dy + dz * dz);
+}
+
+//Find the edges kept sharp by the smooth schemes
+void Subdivide::findCreases(Geometry *g, MeshTopology *topology, char *sharp)
+{
+	int num_edges = topology->getNumEdges();
 
-			v1 = g->getVertex(m.v1);
-			v2 = g->getVertex(m.v2);
-			midpoint.x = (v1->x + v2->x) * 0.5f;
-			midpoint.y = (v1->y + v2->y) * 0.5f;
-			midpoint.z = (v1->z + v2->z) * 0.5f;
+	//Calculate per face normals if creases depend on them
+	ScratchArray<Vector3D> face_normals(g->getScratchArena(), crease_all ? 0 : g->getNumTriangles());
+	if(!crease_all)
+		g->getFaceNormals(&(face_normals[0]));
 
-			mid3 = m.vmid = g->addVertex(midpoint);
-			midpoints.push_back(m);
+	//Boundary and non-manifold edges are always sharp
+	float inv_threshold = 1.0f - threshold;
+	for(int e = 0; e < num_edges; e++) {
+		int h = topology->getEdgeHalfEdge(e);
+		int twin = topology->getTwin(h);
+		if(twin == -1) {
+			sharp[e] = 1;
+		} else if(crease_all) {
+			sharp[e] = 0;
+		} else {
+			float dot = dotProduct(&(face_normals[MeshTopology::triangle(h)]), &(face_normals[MeshTopology::triangle(twin)]));
+			sharp[e] = dot < inv_threshold ? 1 : 0;
 		}
+	}
+}
 
-		//Don't interpolate normals if they are the same
-		if(current->normals[0] == current->normals[1])
-			nint1 = current->normals[0];
-
-		if(current->normals[1] == current->normals[2])
-			nint2 = current->normals[1];
-
-		if(current->normals[2] == current->normals[0])
-			nint3 = current->normals[2];
-
-		//Check for pre-calculated interpolations of normals
-		if(nint1 == -1 || nint2 == -1 || nint3 == -1) {
-			int num_norm_ints = norm_ints.size();
-			for(int j = 0; j < num_norm_ints; j++) {
-				if(current->normals[0] == norm_ints[j].n1) {
-					if(current->normals[1] == norm_ints[j].n2)
-						nint1 = norm_ints[j].nmid;
-					else if(current->normals[2] == norm_ints[j].n2)
-						nint3 = norm_ints[j].nmid;
-				} else if(current->normals[1] == norm_ints[j].n1) {
-					if(current->normals[0] == norm_ints[j].n2)
-						nint1 = norm_ints[j].nmid;
-					else if(current->normals[2] == norm_ints[j].n2)
-						nint2 = norm_ints[j].nmid;
-				} else if(current->normals[2] == norm_ints[j].n1) {
-					if(current->normals[0] == norm_ints[j].n2)
-						nint3 = norm_ints[j].nmid;
-					else if(current->normals[1] == norm_ints[j].n2)
-						nint2 = norm_ints[j].nmid;
-				}
+//Add the new vertex, normal and texture coordinate on each half-edge
+void Subdivide::splitEdges(Geometry *g, MeshTopology *topology, const Vector3D *edge_points, const char *split, bool quads, int *vertex_mids, int *normal_mids, int *uv_mids)
+{
+	Triangle *current;
+	Vector3D *v1;
+	Vector3D *v2;
+	Vector3D midpoint;
+	Vector3D interpolated_normal;
+	Vector2D *uv1;
+	Vector2D *uv2;
+	Vector2D interpolated_uv;
+
+	int num_halfedges = g->getNumTriangles() * 3;
+
+	//Triangles sharing an edge share its new vertex
+	ScratchArray<int> edge_vertices(g->getScratchArena(), topology->getNumEdges());
+
+	//Interpolated normals and texture coordinates are shared by every edge with the same end indices
+	HASH_MAP<unsigned long long, int> normal_pairs;
+	HASH_MAP<unsigned long long, int> uv_pairs;
+	HASH_MAP<unsigned long long, int>::iterator found;
+
+	for(int h = 0; h < num_halfedges; h++) {
+		int e = topology->getEdge(h);
+		if(isQuadDiagonal(h, quads) || (split && !split[e]))
+			continue;
+
+		current = g->getTriangle(MeshTopology::triangle(h));
+		int k1 = h % 3;
+		int k2 = (k1 + 1) % 3;
+
+		//The first half-edge of an edge is always visited first
+		if(topology->getEdgeHalfEdge(e) == h) {
+			if(edge_points) {
+				midpoint = edge_points[e];
+			} else {
+				v1 = g->getVertex(current->vertices[k1]);
+				v2 = g->getVertex(current->vertices[k2]);
+				midpoint.x = (v1->x + v2->x) * 0.5f;
+				midpoint.y = (v1->y + v2->y) * 0.5f;
+				midpoint.z = (v1->z + v2->z) * 0.5f;
 			}
+
+			edge_vertices[e] = g->addVertex(midpoint);
+
+			int ends[2] = {current->vertices[k1], current->vertices[k2]};
+			g->averageVertexChannels(edge_vertices[e], ends, 2);
 		}
 
-		//Calculate new normal interpolations
-		if(nint1 == -1) {
-			NormalInt ni;
-			ni.n1 = current->normals[0];
-			ni.n2 = current->normals[1];
+		vertex_mids[h] = edge_vertices[e];
 
-			v1 = g->getNormal(ni.n1);
-			v2 = g->getNormal(ni.n2);
+		//Don't interpolate normals if they are the same or were interpolated already
+		int n1 = current->normals[k1];
+		int n2 = current->normals[k2];
+		if(n1 == n2) {
+			normal_mids[h] = n1;
+		} else if((found = normal_pairs.find(attributePairKey(n1, n2))) != normal_pairs.end()) {
+			normal_mids[h] = found->second;
+		} else {
+			v1 = g->getNormal(n1);
+			v2 = g->getNormal(n2);
 
 			interpolated_normal.x = (v1->x + v2->x) * 0.5f;
 			interpolated_normal.y = (v1->y + v2->y) * 0.5f;
-			interpolated_normal.z = (v1->x + v2->z) * 0.5f;
+			interpolated_normal.z = (v1->z + v2->z) * 0.5f;
 
-			nint1 = ni.nmid = g->addNormal(interpolated_normal);
-			norm_ints.push_back(ni);
+			normal_mids[h] = g->addNormal(interpolated_normal);
+			normal_pairs[attributePairKey(n1, n2)] = normal_mids[h];
 		}
 
-		if(nint2 == -1) {
-			NormalInt ni;
-			ni.n1 = current->normals[1];
-			ni.n2 = current->normals[2];
+		//Same for texture coordinates
+		int t1 = current->uvs[k1];
+		int t2 = current->uvs[k2];
+		if(t1 == t2) {
+			uv_mids[h] = t1;
+		} else if((found = uv_pairs.find(attributePairKey(t1, t2))) != uv_pairs.end()) {
+			uv_mids[h] = found->second;
+		} else {
+			uv1 = g->getUV(t1);
+			uv2 = g->getUV(t2);
 
-			v1 = g->getNormal(ni.n1);
-			v2 = g->getNormal(ni.n2);
+			interpolated_uv.u = (uv1->u + uv2->u) * 0.5f;
+			interpolated_uv.v = (uv1->v + uv2->v) * 0.5f;
 
-			interpolated_normal.x = (v1->x + v2->x) * 0.5f;
-			interpolated_normal.y = (v1->y + v2->y) * 0.5f;
-			interpolated_normal.z = (v1->x + v2->z) * 0.5f;
+			uv_mids[h] = g->addUV(interpolated_uv);
+			uv_pairs[attributePairKey(t1, t2)] = uv_mids[h];
+		}
+	}
+}
 
-			nint2 = ni.nmid = g->addNormal(interpolated_normal);
-			norm_ints.push_back(ni);
+//Compute Loop positions for the existing vertices and for the new vertex on each edge
+static void loopPositions(Geometry *g, MeshTopology *topology, const char *sharp, Vector3D *edge_points, Vector3D *vertex_points)
+{
+	std::vector<int> edges;
+	std::vector<int> ends;
+	Vector3D *v;
+	Vector3D point;
+
+	//New vertices weigh the edge ends by 3/8 and the opposite vertices by 1/8
+	int num_edges = topology->getNumEdges();
+	for(int e = 0; e < num_edges; e++) {
+		int h = topology->getEdgeHalfEdge(e);
+		point.x = point.y = point.z = 0.0f;
+		if(sharp[e]) {
+			addScaled(&point, g->getVertex(topology->getVertex(h)), 0.5f);
+			addScaled(&point, g->getVertex(topology->getVertex(MeshTopology::next(h))), 0.5f);
+		} else {
+			int twin = topology->getTwin(h);
+			addScaled(&point, g->getVertex(topology->getVertex(h)), 0.375f);
+			addScaled(&point, g->getVertex(topology->getVertex(twin)), 0.375f);
+			addScaled(&point, g->getVertex(topology->getVertex(MeshTopology::prev(h))), 0.125f);
+			addScaled(&point, g->getVertex(topology->getVertex(MeshTopology::prev(twin))), 0.125f);
 		}
 
-		if(nint3 == -1) {
-			NormalInt ni;
-			ni.n1 = current->normals[2];
-			ni.n2 = current->normals[0];
+		edge_points[e] = point;
+	}
 
-			v1 = g->getNormal(ni.n1);
-			v2 = g->getNormal(ni.n2);
+	//Existing vertices move towards their neighbors
+	int num_vertices = g->getNumVertices();
+	for(int i = 0; i < num_vertices; i++) {
+		v = g->getVertex(i);
+		gatherVertexEdges(topology, i, false, &edges, &ends);
 
-			interpolated_normal.x = (v1->x + v2->x) * 0.5f;
-			interpolated_normal.y = (v1->y + v2->y) * 0.5f;
-			interpolated_normal.z = (v1->x + v2->z) * 0.5f;
+		//Count creases and remember the ends of the first two
+		int num_sharp = 0;
+		int crease_ends[2];
+		int num_edges_around = edges.size();
+		for(int j = 0; j < num_edges_around; j++) {
+			if(sharp[edges[j]]) {
+				if(num_sharp < 2)
+					crease_ends[num_sharp] = ends[j];
+				num_sharp++;
+			}
+		}
 
-			nint3 = ni.nmid = g->addNormal(interpolated_normal);
-			norm_ints.push_back(ni);
+		point.x = point.y = point.z = 0.0f;
+		if(num_edges_around == 0 || num_sharp > 2) {
+			//Unused vertices and corners stay in place
+			point = *v;
+		} else if(num_sharp == 2) {
+			//Vertices on a crease only follow the crease
+			addScaled(&point, v, 0.75f);
+			addScaled(&point, g->getVertex(crease_ends[0]), 0.125f);
+			addScaled(&point, g->getVertex(crease_ends[1]), 0.125f);
+		} else {
+			float beta = num_edges_around == 3 ? 3.0f / 16.0f : 3.0f / (8.0f * (float)num_edges_around);
+			addScaled(&point, v, 1.0f - beta * (float)num_edges_around);
+			for(int j = 0; j < num_edges_around; j++)
+				addScaled(&point, g->getVertex(ends[j]), beta);
 		}
 
-		//Interpolate uvs
-		uv1.u = (current->uvs[0].u + current->uvs[1].u) * 0.5f;
-		uv1.v = (current->uvs[0].v + current->uvs[1].v) * 0.5f;
+		vertex_points[i] = point;
+	}
+}
+
+//Perform one iteration of subdivision
+void Subdivide::subd(Geometry *g)
+{
+	Triangle *current;
+	Triangle temp;
+
+	int num_triangles = g->getNumTriangles();
+	int num_halfedges = num_triangles * 3;
+	int num_vertices = g->getNumVertices();
+
+	MeshTopology *topology = g->getTopology();
+	int num_edges = topology->getNumEdges();
+
+	MemoryArena *scratch = g->getScratchArena();
+	ScratchArray<int> vertex_mids(scratch, num_halfedges);
+	ScratchArray<int> normal_mids(scratch, num_halfedges);
+	ScratchArray<int> uv_mids(scratch, num_halfedges);
+
+	//Loop positions are computed from the mesh before it is split
+	bool smooth = (scheme == SS_LOOP);
+	ScratchArray<char> sharp(scratch, smooth ? num_edges : 0);
+	ScratchArray<Vector3D> edge_points(scratch, smooth ? num_edges : 0);
+	ScratchArray<Vector3D> vertex_points(scratch, smooth ? num_vertices : 0);
+	if(smooth) {
+		findCreases(g, topology, &(sharp[0]));
+		loopPositions(g, topology, &(sharp[0]), &(edge_points[0]), &(vertex_points[0]));
+	}
 
-		uv2.u = (current->uvs[1].u + current->uvs[2].u) * 0.5f;
-		uv2.v = (current->uvs[1].v + current->uvs[2].v) * 0.5f;
+	splitEdges(g, topology, smooth ? &(edge_points[0]) : NULL, NULL, false, &(vertex_mids[0]), &(normal_mids[0]), &(uv_mids[0]));
 
-		uv3.u = (current->uvs[2].u + current->uvs[0].u) * 0.5f;
-		uv3.v = (current->uvs[2].v + current->uvs[0].v) * 0.5f;
+	//Split the triangles in place, recounting references once afterwards
+	g->editTriangles();
+
+	//Iterate through each triangle
+	int new_triangles[4];
+	for(int i = 0; i < num_triangles; i++) {
+		int mid1 = vertex_mids[i * 3], mid2 = vertex_mids[i * 3 + 1], mid3 = vertex_mids[i * 3 + 2];
+		int nint1 = normal_mids[i * 3], nint2 = normal_mids[i * 3 + 1], nint3 = normal_mids[i * 3 + 2];
+		int uvint1 = uv_mids[i * 3], uvint2 = uv_mids[i * 3 + 1], uvint3 = uv_mids[i * 3 + 2];
+		current = g->getTriangle(i);
 
 		//Tesselate the triangle
 		//Triangle 1
@@ -218,35 +538,35 @@ void Subdivide::subd(Geometry *g)
 
 		temp.vertices[1] = mid1;
 		temp.normals[1] = nint1;
-		temp.uvs[1] = uv1;
+		temp.uvs[1] = uvint1;
 
 		temp.vertices[2] = mid3;
 		temp.normals[2] = nint3;
-		temp.uvs[2] = uv3;
+		temp.uvs[2] = uvint3;
 
-		g->addTriangle(temp);
+		new_triangles[0] = g->addTriangle(temp);
 		current = g->getTriangle(i);
 
 		//Triangle 2
 		temp.vertices[0] = mid1;
 		temp.normals[0] = nint1;
-		temp.uvs[0] = uv1;
+		temp.uvs[0] = uvint1;
 
 		temp.vertices[1] = mid2;
 		temp.normals[1] = nint2;
-		temp.uvs[1] = uv2;
+		temp.uvs[1] = uvint2;
 
 		temp.vertices[2] = mid3;
 		temp.normals[2] = nint3;
-		temp.uvs[2] = uv3;
+		temp.uvs[2] = uvint3;
 
-		g->addTriangle(temp);
+		new_triangles[1] = g->addTriangle(temp);
 		current = g->getTriangle(i);
 
 		//Triangle 3
 		temp.vertices[0] = mid1;
 		temp.normals[0] = nint1;
-		temp.uvs[0] = uv1;
+		temp.uvs[0] = uvint1;
 
 		temp.vertices[1] = current->vertices[1];
 		temp.normals[1] = current->normals[1];
@@ -254,36 +574,465 @@ void Subdivide::subd(Geometry *g)
 
 		temp.vertices[2] = mid2;
 		temp.normals[2] = nint2;
-		temp.uvs[2] = uv2;
+		temp.uvs[2] = uvint2;
 
-		g->addTriangle(temp);
+		new_triangles[2] = g->addTriangle(temp);
 		current = g->getTriangle(i);
 
 		//Triangle 4
 		temp.vertices[0] = mid3;
 		temp.normals[0] = nint3;
-		temp.uvs[0] = uv3;
+		temp.uvs[0] = uvint3;
 
 		temp.vertices[1] = mid2;
 		temp.normals[1] = nint2;
-		temp.uvs[1] = uv2;
+		temp.uvs[1] = uvint2;
 
 		temp.vertices[2] = current->vertices[2];
 		temp.normals[2] = current->normals[2];
 		temp.uvs[2] = current->uvs[2];
 
-		g->setTriangle(i, temp);
+		*current = temp;
+
+		new_triangles[3] = i;
+		splitCornerChannels(g, i, new_triangles, split_three_pattern, unrotated, 4);
+	}
+
+	//Move the existing vertices
+	if(smooth) {
+		for(int i = 0; i < num_vertices; i++)
+			*(g->getVertex(i)) = vertex_points[i];
 	}
 
 	return;
 }
 
+//Perform one iteration of Catmull-Clark subdivision
+void Subdivide::subdCatmullClark(Geometry *g, bool quads)
+{
+	Triangle *current;
+	Triangle temp;
+	Vector3D *v;
+	Vector3D point;
+	Vector3D face_average;
+	Vector3D *n;
+	Vector2D *uv;
+	Vector2D uv_average;
+	std::vector<int> edges;
+	std::vector<int> ends;
+
+	int num_triangles = g->getNumTriangles();
+	int num_halfedges = num_triangles * 3;
+	int num_vertices = g->getNumVertices();
+	if(num_triangles == 0)
+		return;
+
+	//Pairs only form quads if nothing changed the triangle count since the last level
+	if(num_triangles % 2)
+		quads = false;
+
+	int face_size = quads ? 4 : 3;
+	int num_faces = quads ? num_triangles / 2 : num_triangles;
+	float inv_face_size = 1.0f / (float)face_size;
+
+	MeshTopology *topology = g->getTopology();
+	int num_edges = topology->getNumEdges();
+
+	MemoryArena *scratch = g->getScratchArena();
+	ScratchArray<char> sharp(scratch, num_edges);
+	ScratchArray<Vector3D> face_points(scratch, num_faces);
+	ScratchArray<Vector3D> edge_points(scratch, num_edges);
+	ScratchArray<Vector3D> vertex_points(scratch, num_vertices);
+	ScratchArray<int> vertex_mids(scratch, num_halfedges);
+	ScratchArray<int> normal_mids(scratch, num_halfedges);
+	ScratchArray<int> uv_mids(scratch, num_halfedges);
+	ScratchArray<Triangle> old_triangles(scratch, num_triangles);
+
+	findCreases(g, topology, &(sharp[0]));
+
+	//Face points are the centroid of each face
+	for(int f = 0; f < num_faces; f++) {
+		point.x = point.y = point.z = 0.0f;
+		for(int i = 0; i < face_size; i++)
+			addScaled(&point, g->getVertex(topology->getVertex(faceHalfEdge(f, i, quads))), inv_face_size);
+
+		face_points[f] = point;
+	}
+
+	//Smooth edge points also average the face points on both sides
+	for(int e = 0; e < num_edges; e++) {
+		int h = topology->getEdgeHalfEdge(e);
+		point.x = point.y = point.z = 0.0f;
+		if(sharp[e] || isQuadDiagonal(h, quads)) {
+			addScaled(&point, g->getVertex(topology->getVertex(h)), 0.5f);
+			addScaled(&point, g->getVertex(topology->getVertex(MeshTopology::next(h))), 0.5f);
+		} else {
+			int twin = topology->getTwin(h);
+			addScaled(&point, g->getVertex(topology->getVertex(h)), 0.25f);
+			addScaled(&point, g->getVertex(topology->getVertex(twin)), 0.25f);
+			addScaled(&point, &(face_points[faceOf(h, quads)]), 0.25f);
+			addScaled(&point, &(face_points[faceOf(twin, quads)]), 0.25f);
+		}
+
+		edge_points[e] = point;
+	}
+
+	//Existing vertices move towards the face and edge centers around them
+	for(int i = 0; i < num_vertices; i++) {
+		v = g->getVertex(i);
+		gatherVertexEdges(topology, i, quads, &edges, &ends);
+
+		//Count creases and remember the ends of the first two
+		int num_sharp = 0;
+		int crease_ends[2];
+		int num_edges_around = edges.size();
+		for(int j = 0; j < num_edges_around; j++) {
+			if(sharp[edges[j]]) {
+				if(num_sharp < 2)
+					crease_ends[num_sharp] = ends[j];
+				num_sharp++;
+			}
+		}
+
+		point.x = point.y = point.z = 0.0f;
+		if(num_edges_around == 0 || num_sharp > 2) {
+			//Unused vertices and corners stay in place
+			point = *v;
+		} else if(num_sharp == 2) {
+			//Vertices on a crease only follow the crease
+			addScaled(&point, v, 0.75f);
+			addScaled(&point, g->getVertex(crease_ends[0]), 0.125f);
+			addScaled(&point, g->getVertex(crease_ends[1]), 0.125f);
+		} else {
+			//Average the face points around the vertex, visiting each face once
+			face_average.x = face_average.y = face_average.z = 0.0f;
+			int num_faces_around = 0;
+			int last_face = -1;
+			int num_corners = topology->getNumVertexCorners(i);
+			const int *corners = topology->getVertexCorners(i);
+			for(int j = 0; j < num_corners; j++) {
+				int f = faceOf(corners[j], quads);
+				if(f != last_face) {
+					addScaled(&face_average, &(face_points[f]), 1.0f);
+					num_faces_around++;
+					last_face = f;
+				}
+			}
+
+			//(Q + 2R + (n - 3)S) / n where R averages the edge midpoints
+			float inv_n = 1.0f / (float)num_edges_around;
+			addScaled(&point, &face_average, inv_n / (float)num_faces_around);
+			addScaled(&point, v, (float)(num_edges_around - 3) * inv_n + inv_n);
+			for(int j = 0; j < num_edges_around; j++)
+				addScaled(&point, g->getVertex(ends[j]), inv_n * inv_n);
+		}
+
+		vertex_points[i] = point;
+	}
+
+	//Keep the old triangles since their slots are reused for the new ones
+	for(int i = 0; i < num_triangles; i++)
+		old_triangles[i] = *(g->getTriangle(i));
+
+	std::vector<std::vector<float> > old_corner_values;
+	copyCornerChannels(g, &old_corner_values);
+
+	splitEdges(g, topology, &(edge_points[0]), NULL, quads, &(vertex_mids[0]), &(normal_mids[0]), &(uv_mids[0]));
+
+	//Each face becomes one quad per corner, stored as two consecutive triangles
+	int new_triangles = num_faces * face_size * 2;
+	//Fill the slots in place, recounting references once afterwards
+	g->editTriangles();
+	g->reserveTriangles(new_triangles - num_triangles);
+	for(int i = num_triangles; i < new_triangles; i++)
+		g->addTriangle(old_triangles[0]);
+
+	Triangle *triangles = g->getTriangle(0);
+
+	int corner_vertices[4];
+	int corner_normals[4];
+	int corner_uvs[4];
+	int halfedges[4];
+	for(int f = 0; f < num_faces; f++) {
+		for(int i = 0; i < face_size; i++) {
+			halfedges[i] = faceHalfEdge(f, i, quads);
+			current = &(old_triangles[MeshTopology::triangle(halfedges[i])]);
+			corner_vertices[i] = current->vertices[halfedges[i] % 3];
+			corner_normals[i] = current->normals[halfedges[i] % 3];
+			corner_uvs[i] = current->uvs[halfedges[i] % 3];
+		}
+
+		int face_vertex = g->addVertex(face_points[f]);
+		g->averageVertexChannels(face_vertex, corner_vertices, face_size);
+
+		//Flat faces keep their shared normal and texture coordinate
+		bool same_normals = true;
+		bool same_uvs = true;
+		for(int i = 1; i < face_size; i++) {
+			same_normals = same_normals && corner_normals[i] == corner_normals[0];
+			same_uvs = same_uvs && corner_uvs[i] == corner_uvs[0];
+		}
+
+		int face_normal = corner_normals[0];
+		if(!same_normals) {
+			face_average.x = face_average.y = face_average.z = 0.0f;
+			for(int i = 0; i < face_size; i++) {
+				n = g->getNormal(corner_normals[i]);
+				addScaled(&face_average, n, inv_face_size);
+			}
+
+			face_normal = g->addNormal(face_average);
+		}
+
+		int face_uv = corner_uvs[0];
+		if(!same_uvs) {
+			uv_average.u = uv_average.v = 0.0f;
+			for(int i = 0; i < face_size; i++) {
+				uv = g->getUV(corner_uvs[i]);
+				uv_average.u += uv->u * inv_face_size;
+				uv_average.v += uv->v * inv_face_size;
+			}
+
+			face_uv = g->addUV(uv_average);
+		}
+
+		for(int i = 0; i < face_size; i++) {
+			int h = halfedges[i];
+			int h_prev = halfedges[(i + face_size - 1) % face_size];
+			int first = (f * face_size + i) * 2;
+
+			//Triangle from the corner to the next edge point and the face point
+			temp.vertices[0] = corner_vertices[i];
+			temp.normals[0] = corner_normals[i];
+			temp.uvs[0] = corner_uvs[i];
+
+			temp.vertices[1] = vertex_mids[h];
+			temp.normals[1] = normal_mids[h];
+			temp.uvs[1] = uv_mids[h];
+
+			temp.vertices[2] = face_vertex;
+			temp.normals[2] = face_normal;
+			temp.uvs[2] = face_uv;
+
+			triangles[first] = temp;
+
+			//Triangle from the corner to the face point and the previous edge point
+			temp.vertices[1] = face_vertex;
+			temp.normals[1] = face_normal;
+			temp.uvs[1] = face_uv;
+
+			temp.vertices[2] = vertex_mids[h_prev];
+			temp.normals[2] = normal_mids[h_prev];
+			temp.uvs[2] = uv_mids[h_prev];
+
+			triangles[first + 1] = temp;
+		}
+
+		splitFaceCornerChannels(g, old_corner_values, halfedges, face_size, f * face_size * 2);
+	}
+
+	//Move the existing vertices
+	for(int i = 0; i < num_vertices; i++)
+		*(g->getVertex(i)) = vertex_points[i];
+
+	return;
+}
+
+//Split the edges that need refining once
+bool Subdivide::subdAdaptive(Geometry *g)
+{
+	Triangle *current;
+	Triangle temp;
+	Vector3D *v1;
+	Vector3D *v2;
+	Vector3D center;
+
+	int num_triangles = g->getNumTriangles();
+	int num_halfedges = num_triangles * 3;
+
+	MeshTopology *topology = g->getTopology();
+	int num_edges = topology->getNumEdges();
+
+	MemoryArena *scratch = g->getScratchArena();
+	ScratchArray<char> split(scratch, num_edges);
+	ScratchArray<int> vertex_mids(scratch, num_halfedges);
+	ScratchArray<int> normal_mids(scratch, num_halfedges);
+	ScratchArray<int> uv_mids(scratch, num_halfedges);
+
+	//Edges that are too long by themselves
+	for(int e = 0; e < num_edges; e++) {
+		int h = topology->getEdgeHalfEdge(e);
+		v1 = g->getVertex(topology->getVertex(h));
+		v2 = g->getVertex(topology->getVertex(MeshTopology::next(h)));
+		float length = distance(v1, v2);
+
+		split[e] = 0;
+		if(limit_edge_length && length > max_edge_length)
+			split[e] = 1;
+
+		if(limit_screen_size) {
+			center.x = (v1->x + v2->x) * 0.5f;
+			center.y = (v1->y + v2->y) * 0.5f;
+			center.z = (v1->z + v2->z) * 0.5f;
+			if(length > max_screen_size * distance(&center, &eye))
+				split[e] = 1;
+		}
+	}
+
+	//Whole triangles that are curved or in the region of interest
+	Vector3D corner_normals[3];
+	float inv_curvature = 1.0f - curvature;
+	for(int i = 0; i < num_triangles; i++) {
+		current = g->getTriangle(i);
+		bool refine = false;
+		if(limit_region) {
+			center.x = center.y = center.z = 0.0f;
+			for(int k = 0; k < 3; k++)
+				addScaled(&center, g->getVertex(current->vertices[k]), 1.0f / 3.0f);
+
+			refine = center.x >= region_min.x && center.y >= region_min.y && center.z >= region_min.z &&
+				center.x <= region_max.x && center.y <= region_max.y && center.z <= region_max.z;
+		}
+
+		//Interpolated normals bend less across smaller triangles, so this converges
+		if(limit_curvature && !refine) {
+			for(int k = 0; k < 3; k++) {
+				corner_normals[k] = *(g->getNormal(current->normals[k]));
+				float length = sqrtf(dotProduct(&(corner_normals[k]), &(corner_normals[k])));
+				if(length > 0.0f) {
+					corner_normals[k].x /= length;
+					corner_normals[k].y /= length;
+					corner_normals[k].z /= length;
+				}
+			}
+
+			for(int k = 0; k < 3 && !refine; k++)
+				refine = dotProduct(&(corner_normals[k]), &(corner_normals[(k + 1) % 3])) < inv_curvature;
+		}
+
+		if(refine) {
+			for(int k = 0; k < 3; k++)
+				split[topology->getEdge(i * 3 + k)] = 1;
+		}
+	}
+
+	//Stop once nothing needs refining
+	bool any_split = false;
+	for(int e = 0; e < num_edges && !any_split; e++)
+		any_split = split[e] != 0;
+
+	if(!any_split)
+		return false;
+
+	splitEdges(g, topology, NULL, &(split[0]), false, &(vertex_mids[0]), &(normal_mids[0]), &(uv_mids[0]));
+
+	int vertices[6];
+	int normals[6];
+	int uvs[6];
+	const int *pattern[4];
+	int rotated[6];
+	int new_triangles[4];
+
+	//Split the triangles in place, recounting references once afterwards
+	g->editTriangles();
+	for(int i = 0; i < num_triangles; i++) {
+		current = g->getTriangle(i);
+
+		//Count split edges and find the one to rotate to edge 0
+		int num_split = 0;
+		int first_edge = 0;
+		for(int k = 0; k < 3; k++) {
+			vertices[k] = current->vertices[k];
+			normals[k] = current->normals[k];
+			uvs[k] = current->uvs[k];
+
+			if(split[topology->getEdge(i * 3 + k)]) {
+				vertices[k + 3] = vertex_mids[i * 3 + k];
+				normals[k + 3] = normal_mids[i * 3 + k];
+				uvs[k + 3] = uv_mids[i * 3 + k];
+				num_split++;
+			} else {
+				first_edge = k;
+			}
+		}
+
+		if(num_split == 0)
+			continue;
+
+		//One split edge goes to edge 0, two leave edge 0 unsplit
+		int rotation = 0;
+		if(num_split == 1) {
+			for(int k = 0; k < 3; k++) {
+				if(split[topology->getEdge(i * 3 + k)])
+					rotation = k;
+			}
+		} else if(num_split == 2) {
+			rotation = first_edge;
+		}
+
+		for(int k = 0; k < 3; k++) {
+			rotated[k] = (k + rotation) % 3;
+			rotated[k + 3] = (k + rotation) % 3 + 3;
+		}
+
+		int num_new = 0;
+		if(num_split == 1) {
+			pattern[0] = split_one[0];
+			pattern[1] = split_one[1];
+			num_new = 2;
+		} else if(num_split == 2) {
+			//Cut the remaining quad along its shorter diagonal
+			float short_diagonal = distance(g->getVertex(vertices[rotated[0]]), g->getVertex(vertices[rotated[4]]));
+			float long_diagonal = distance(g->getVertex(vertices[rotated[1]]), g->getVertex(vertices[rotated[5]]));
+			const int (*quad)[3] = short_diagonal <= long_diagonal ? split_two_short : split_two_long;
+
+			pattern[0] = split_two_corner;
+			pattern[1] = quad[0];
+			pattern[2] = quad[1];
+			num_new = 3;
+		} else {
+			for(int j = 0; j < 4; j++)
+				pattern[j] = split_three[j];
+			num_new = 4;
+		}
+
+		//The first new triangle replaces the old one
+		for(int j = 0; j < num_new; j++) {
+			for(int k = 0; k < 3; k++) {
+				int c = rotated[pattern[j][k]];
+				temp.vertices[k] = vertices[c];
+				temp.normals[k] = normals[c];
+				temp.uvs[k] = uvs[c];
+			}
+
+			if(j == 0) {
+				*current = temp;
+				new_triangles[j] = i;
+			} else {
+				new_triangles[j] = g->addTriangle(temp);
+			}
+		}
+
+		splitCornerChannels(g, i, new_triangles, pattern, rotated, num_new);
+	}
+
+	return true;
+}
+
 //Run the filter on specified object
 void Subdivide::run(Geometry *g)
 {
 	//Run the subdivision algorithm levels times
-	for(int i = 0; i < levels; i++)
-		subd(g);
+	for(int i = 0; i < levels; i++) {
+		if(scheme == SS_CATMULL_CLARK) {
+			subdCatmullClark(g, i > 0);
+		} else if(scheme == SS_MIDPOINT && isAdaptive()) {
+			if(!subdAdaptive(g))
+				break;
+		} else {
+			subd(g);
+		}
+	}
 
 	return;
 }
@@ -20,30 +20,84 @@
 
 #include "GeometryFilter.h"
 #include "Geometry.h"
+#include "NormalFilter.h"
 
 /**
- * @brief Structure used to keep track of which midpoints have been computed
+ * @brief Defines the rules used to place new and existing vertices
  */
-typedef struct {
-	int v1, v2;
-	int vmid;
-} Midpoint;
-
-/**
- * @brief Structure used to keep track of which interpolated normals have been calculated
- */
-typedef struct {
-	int n1, n2;
-	int nmid;
-} NormalInt;
+enum subdivision_scheme {
+	SS_MIDPOINT,		/**< Splits edges at their midpoints and keeps the surface flat. */
+	SS_LOOP,			/**< Loop subdivision of the triangles into a smooth surface. */
+	SS_CATMULL_CLARK	/**< Catmull-Clark subdivision into quads, each stored as two consecutive triangles. */
+};
 
 /**
  * @brief Subdivides polygons of a mesh
- * @details TODO
+ * @details Each level splits every triangle into four, or into three quads
+ * for SS_CATMULL_CLARK. Later Catmull-Clark levels treat each pair of
+ * triangles made by the level before as one quad. The smooth schemes move
+ * vertices using the mesh topology and keep boundary edges, and edges
+ * between faces that differ by more than the crease threshold, sharp.
+ * Normals and texture coordinates are interpolated linearly, so smooth
+ * results should be followed by a NormalFilter.
+ *
+ * With SS_MIDPOINT the filter can refine adaptively instead. Each level
+ * then splits only the edges that are too long, too large on screen or on
+ * triangles whose normals bend too much or that are inside a region of interest, and stops
+ * early once nothing needs refining. Triangles with one or two split edges
+ * are divided into two or three so neighbors always share their new
+ * vertices and no T-junctions are made.
  */
 class Subdivide : public GeometryFilter {
 private:
 	int levels;
+	subdivision_scheme scheme;	/**< Rules for placing vertices. */
+	bool crease_all;			/**< Set to true when only boundary edges are kept sharp. */
+
+	/**
+	 * @details If crease_all is set to false, edges between triangles whose
+	 * face normals have a dot product below 1 - threshold are creases. This
+	 * has the same meaning as the NormalFilter soften threshold.
+	 */
+	float threshold;
+
+	bool limit_edge_length;		/**< Set to true when adaptive refinement splits long edges. */
+	float max_edge_length;		/**< Longest edge left unsplit. */
+	bool limit_curvature;		/**< Set to true when adaptive refinement splits curved triangles. */
+	float curvature;			/**< Curvature threshold, with the same meaning as the crease threshold. */
+	bool limit_screen_size;		/**< Set to true when adaptive refinement splits edges that look large. */
+	Vector3D eye;				/**< Viewpoint used for screen size. */
+	float max_screen_size;		/**< Largest edge length over distance from the eye left unsplit. */
+	bool limit_region;			/**< Set to true when adaptive refinement splits triangles in a region. */
+	Vector3D region_min;		/**< Minimum corner of the region of interest. */
+	Vector3D region_max;		/**< Maximum corner of the region of interest. */
+
+	/**
+	 * Checks if any adaptive refinement criteria are enabled
+	 * @return True if levels should refine adaptively
+	 */
+	bool isAdaptive();
+
+	/**
+	 * Finds the edges that the smooth schemes keep sharp
+	 * @param g The geometric object being subdivided
+	 * @param topology Connectivity of g
+	 * @param sharp Set to nonzero for each sharp edge
+	 */
+	void findCreases(Geometry *g, MeshTopology *topology, char *sharp);
+
+	/**
+	 * Adds a vertex, normal and texture coordinate on each half-edge
+	 * @param g The geometric object being subdivided
+	 * @param topology Connectivity of g
+	 * @param edge_points Position of each edge's new vertex or NULL for its midpoint
+	 * @param split Nonzero for each edge to split or NULL to split every edge
+	 * @param quads True if triangle pairs are quads whose diagonals are skipped
+	 * @param vertex_mids Set to the new vertex of each half-edge
+	 * @param normal_mids Set to the new normal of each half-edge
+	 * @param uv_mids Set to the new texture coordinate of each half-edge
+	 */
+	void splitEdges(Geometry *g, MeshTopology *topology, const Vector3D *edge_points, const char *split, bool quads, int *vertex_mids, int *normal_mids, int *uv_mids);
 
 	/**
 	 * Subdivides the object once
@@ -51,11 +105,77 @@ private:
 	 */
 	void subd(Geometry *g);
 
+	/**
+	 * Subdivides the object once with Catmull-Clark rules
+	 * @param g The geometric object to subdivide
+	 * @param quads True if the triangles are pairs made by a previous level
+	 */
+	void subdCatmullClark(Geometry *g, bool quads);
+
+	/**
+	 * Splits the edges that meet the adaptive refinement criteria once
+	 * @param g The geometric object to subdivide
+	 * @return True if any edge was split
+	 */
+	bool subdAdaptive(Geometry *g);
+
 public:
-	Subdivide(int ilevels);			/**< Constructs a filter that will subdivide ilevels times. */
+	Subdivide(int ilevels);								/**< Constructs a filter that will subdivide ilevels times at edge midpoints. */
+	Subdivide(int ilevels, subdivision_scheme ischeme);	/**< Constructs a filter that will subdivide ilevels times with a scheme. */
 
 	~Subdivide();					/**< Destructor. */
 
+	/**
+	 * Keeps edges between faces that differ too much sharp
+	 * @param t The crease threshold. Should be between 0 and 2
+	 */
+	void enableCreaseThreshold(float t);
+
+	/**
+	 * Disables crease threshold so only boundaries stay sharp
+	 */
+	void disableCreaseThreshold();
+
+	/**
+	 * Uses the soften threshold of a normal filter as the crease threshold, so
+	 * edges that the filter leaves hard are also kept sharp
+	 * @param f The normal filter to match
+	 */
+	void matchCreases(NormalFilter *f);
+
+	/**
+	 * Refines adaptively, splitting edges longer than a limit
+	 * @param length The longest edge to leave unsplit
+	 */
+	void enableEdgeLengthLimit(float length);
+
+	/**
+	 * Refines adaptively, splitting triangles whose corner normals differ from
+	 * each other by more than a threshold, so smooth shading gets more detail
+	 * @param t The curvature threshold. Should be between 0 and 2
+	 */
+	void enableCurvatureLimit(float t);
+
+	/**
+	 * Refines adaptively, splitting edges that look large from a viewpoint
+	 * @param ieye The viewpoint
+	 * @param size The largest edge length over distance to leave unsplit, about
+	 * the angle in radians the edge covers
+	 */
+	void enableScreenSizeLimit(Vector3D ieye, float size);
+
+	/**
+	 * Refines adaptively, splitting every triangle with its center in a box
+	 * @param imin Minimum corner of the box
+	 * @param imax Maximum corner of the box
+	 */
+	void enableRegionOfInterest(Vector3D imin, Vector3D imax);
+
+	/**
+	 * Disables all adaptive refinement criteria so every level is uniform
+	 */
+	void disableAdaptive();
+
 	/**
 	 * Subdivides the object levels times
 	 * @param g The object to apply the filter to
@@ -0,0 +1,216 @@
+/** @file TangentFilter.cpp
+ *
+ * @brief Generates per corner tangents for normal mapping
+ *
+ * Copyright 2013, Stewart Hall
+ *
+ * Licensed under The MIT License
+ * Redistributions of files must retain the above copyright notice.
+ *
+ * @author		Stewart Hall (www.stewartghall.com)
+ * @date		10/18/2026
+ * @copyright	Copyright 2013, Stewart Hall
+ * @license		MIT License (http://www.opensource.org/licenses/mit-license.php)
+ */
+
+#include <math.h>
+#include <algorithm>
+
+#include "TangentFilter.h"
+
+/**
+ * @brief A triangle corner and the key of the group it shares a tangent with
+ */
+typedef struct {
+	int vertex;			/**< Vertex index. */
+	int normal;			/**< Normal index. */
+	int uv;				/**< Texture coordinate index. */
+	int orientation;	/**< 1 if the triangle's texture winding matches its vertex winding. */
+	int corner;			/**< Corner k of triangle t at 3 * t + k. */
+} TangentCorner;
+
+//Orders corners by group, then by corner so the result does not depend on the sort
+class TangentCornerLess {
+public:
+	bool operator()(const TangentCorner &a, const TangentCorner &b) const
+	{
+		if(a.vertex != b.vertex)
+			return a.vertex < b.vertex;
+		if(a.normal != b.normal)
+			return a.normal < b.normal;
+		if(a.uv != b.uv)
+			return a.uv < b.uv;
+		if(a.orientation != b.orientation)
+			return a.orientation < b.orientation;
+		return a.corner < b.corner;
+	}
+};
+
+//Check if two corners share a tangent
+static bool sameGroup(const TangentCorner &a, const TangentCorner &b)
+{
+	return a.vertex == b.vertex && a.normal == b.normal && a.uv == b.uv && a.orientation == b.orientation;
+}
+
+//Dot product of two vectors
+static float dotProduct(const Vector3D &a, const Vector3D &b)
+{
+	return a.x * b.x + a.y * b.y + a.z * b.z;
+}
+
+//Scale a vector to unit length, leaving zero length vectors alone
+static void normalize(Vector3D *v)
+{
+	float length = sqrtf(dotProduct(*v, *v));
+	if(length > 1e-20f) {
+		v->x /= length;
+		v->y /= length;
+		v->z /= length;
+	}
+}
+
+//Remove the part of a vector along a unit normal and scale the rest to unit length
+static Vector3D projectToPlane(Vector3D v, const Vector3D &n)
+{
+	float d = dotProduct(v, n);
+	v.x -= n.x * d;
+	v.y -= n.y * d;
+	v.z -= n.z * d;
+	normalize(&v);
+
+	return v;
+}
+
+//Constructor
+TangentFilter::TangentFilter()
+:GeometryFilter("Tangent")
+{
+
+}
+
+//Destructor
+TangentFilter::~TangentFilter()
+{
+
+}
+
+//Run the filter on specified object
+void TangentFilter::run(Geometry *g)
+{
+	int num_triangles = g->getNumTriangles();
+	AttributeChannel *channel = g->addChannel("tangent", AS_TANGENT, AB_CORNER, 4);
+	if(!channel || num_triangles == 0)
+		return;
+
+	int num_corners = num_triangles * 3;
+	MemoryArena *scratch = g->getScratchArena();
+	ScratchArray<Vector3D> weighted(scratch, num_corners);
+	ScratchArray<TangentCorner> corners(scratch, num_corners);
+
+	//A mesh without texture coordinates only gets arbitrary tangents
+	bool has_uvs = g->getNumUVs() > 0;
+
+	Vector3D p[3];
+	Vector2D uv[3];
+	for(int t = 0; t < num_triangles; t++) {
+		Triangle *current = g->getTriangle(t);
+		for(int k = 0; k < 3; k++) {
+			p[k] = *(g->getVertex(current->vertices[k]));
+			uv[k].u = has_uvs ? g->getUV(current->uvs[k])->u : 0.0f;
+			uv[k].v = has_uvs ? g->getUV(current->uvs[k])->v : 0.0f;
+		}
+
+		Vector3D d1 = {p[1].x - p[0].x, p[1].y - p[0].y, p[1].z - p[0].z};
+		Vector3D d2 = {p[2].x - p[0].x, p[2].y - p[0].y, p[2].z - p[0].z};
+		float s1 = uv[1].u - uv[0].u, t1 = uv[1].v - uv[0].v;
+		float s2 = uv[2].u - uv[0].u, t2 = uv[2].v - uv[0].v;
+
+		//Direction of increasing u, flipped on triangles whose texture is mirrored
+		float signed_area = s1 * t2 - t1 * s2;
+		int orientation = signed_area >= 0.0f ? 1 : 0;
+		Vector3D face_tangent = {t2 * d1.x - t1 * d2.x, t2 * d1.y - t1 * d2.y, t2 * d1.z - t1 * d2.z};
+		if(signed_area == 0.0f) {
+			face_tangent.x = face_tangent.y = face_tangent.z = 0.0f;
+		} else {
+			normalize(&face_tangent);
+			if(!orientation) {
+				face_tangent.x = -face_tangent.x;
+				face_tangent.y = -face_tangent.y;
+				face_tangent.z = -face_tangent.z;
+			}
+		}
+
+		for(int k = 0; k < 3; k++) {
+			int c = t * 3 + k;
+			Vector3D n = *(g->getNormal(current->normals[k]));
+			normalize(&n);
+
+			//Weight by the corner angle measured in the plane of the normal
+			Vector3D e1 = {p[(k + 1) % 3].x - p[k].x, p[(k + 1) % 3].y - p[k].y, p[(k + 1) % 3].z - p[k].z};
+			Vector3D e2 = {p[(k + 2) % 3].x - p[k].x, p[(k + 2) % 3].y - p[k].y, p[(k + 2) % 3].z - p[k].z};
+			float cosine = dotProduct(projectToPlane(e1, n), projectToPlane(e2, n));
+			cosine = cosine > 1.0f ? 1.0f : (cosine < -1.0f ? -1.0f : cosine);
+			float angle = acosf(cosine);
+
+			Vector3D tangent = projectToPlane(face_tangent, n);
+			weighted[c].x = tangent.x * angle;
+			weighted[c].y = tangent.y * angle;
+			weighted[c].z = tangent.z * angle;
+
+			corners[c].vertex = current->vertices[k];
+			corners[c].normal = current->normals[k];
+			corners[c].uv = current->uvs[k];
+			corners[c].orientation = orientation;
+			corners[c].corner = c;
+		}
+	}
+
+	std::sort(corners.get(), corners.get() + num_corners, TangentCornerLess());
+
+	//Sum each group and give every corner in it the result
+	int first = 0;
+	while(first < num_corners) {
+		int last = first + 1;
+		while(last < num_corners && sameGroup(corners[first], corners[last]))
+			last++;
+
+		Vector3D sum = {0.0f, 0.0f, 0.0f};
+		for(int i = first; i < last; i++) {
+			sum.x += weighted[corners[i].corner].x;
+			sum.y += weighted[corners[i].corner].y;
+			sum.z += weighted[corners[i].corner].z;
+		}
+
+		//Without texture coordinate area pick any direction in the tangent plane
+		if(dotProduct(sum, sum) < 1e-20f) {
+			Vector3D n = *(g->getNormal(corners[first].normal));
+			normalize(&n);
+			Vector3D axis = {0.0f, 0.0f, 0.0f};
+			if(fabsf(n.x) <= fabsf(n.y) && fabsf(n.x) <= fabsf(n.z))
+				axis.x = 1.0f;
+			else if(fabsf(n.y) <= fabsf(n.z))
+				axis.y = 1.0f;
+			else
+				axis.z = 1.0f;
+			sum = projectToPlane(axis, n);
+		}
+
+		normalize(&sum);
+		float sign = corners[first].orientation ? 1.0f : -1.0f;
+		for(int i = first; i < last; i++) {
+			float *value = channel->getValue(corners[i].corner);
+			value[0] = sum.x;
+			value[1] = sum.y;
+			value[2] = sum.z;
+			value[3] = sign;
+		}
+
+		first = last;
+	}
+}
+
+//Tangents are built from the existing normals
+int TangentFilter::getNormalUsage()
+{
+	return FN_READS;
+}
@@ -0,0 +1,56 @@
+/** @file TangentFilter.h
+ *
+ * @brief Generates per corner tangents for normal mapping
+ *
+ * Copyright 2013, Stewart Hall
+ *
+ * Licensed under The MIT License
+ * Redistributions of files must retain the above copyright notice.
+ *
+ * @author		Stewart Hall (www.stewartghall.com)
+ * @date		10/18/2026
+ * @copyright	Copyright 2013, Stewart Hall
+ * @license		MIT License (http://www.opensource.org/licenses/mit-license.php)
+ */
+
+#ifndef _TANGENTFILTER_
+#define _TANGENTFILTER_
+
+#include "GeometryFilter.h"
+#include "Geometry.h"
+
+/**
+ * @brief Fills a "tangent" channel with a tangent frame for each corner
+ * @details Follows the MikkTSpace conventions so normal maps baked by tools
+ * using it line up: each triangle's tangent comes from its texture
+ * coordinate derivatives, is projected into the plane of each corner's
+ * normal and weighted by the corner angle, and the results are summed over
+ * corners sharing a vertex, normal and texture coordinate on triangles of
+ * the same texture winding. The channel is a 4 component per corner
+ * AS_TANGENT channel holding the unit tangent and, in w, the bitangent sign,
+ * so bitangent = w * cross(normal, tangent). Unlike MikkTSpace, corners are
+ * grouped by index rather than by value, and corners whose whole group has no
+ * texture coordinate area get an arbitrary tangent perpendicular to the
+ * normal. Run it after the filters that change normals and texture
+ * coordinates; Subdivide interpolates tangents that already exist.
+ */
+class TangentFilter : public GeometryFilter {
+public:
+	TangentFilter();		/**< Constructs a tangent filter. */
+
+	~TangentFilter();		/**< Destructor. */
+
+	/**
+	 * Generates tangents
+	 * @param g The object to apply the filter to
+	 */
+	virtual void run(Geometry *g);
+
+	/**
+	 * Describes how the filter uses normals
+	 * @return FN_READS
+	 */
+	virtual int getNormalUsage();
+};
+
+#endif
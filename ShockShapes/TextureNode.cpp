@@ -0,0 +1,196 @@
+/** @file TextureNode.cpp
+ *
+ * @brief Composable nodes that describe procedural textures
+ *
+ * Copyright 2013, Stewart Hall
+ *
+ * Licensed under The MIT License
+ * Redistributions of files must retain the above copyright notice.
+ *
+ * @author		Stewart Hall (www.stewartghall.com)
+ * @date		10/18/2026
+ * @copyright	Copyright 2013, Stewart Hall
+ * @license		MIT License (http://www.opensource.org/licenses/mit-license.php)
+ */
+
+#include <math.h>
+
+#include "TextureNode.h"
+
+//Limit a value to between 0 and 1
+static float clamp01(float x)
+{
+	return x < 0.0f ? 0.0f : (x > 1.0f ? 1.0f : x);
+}
+
+//Constructor
+TextureNode::TextureNode()
+{
+
+}
+
+//Destructor
+TextureNode::~TextureNode()
+{
+
+}
+
+//Constructor
+NoiseNode::NoiseNode(unsigned int seed, float ifrequency, int ioctaves)
+:noise(seed)
+{
+	frequency = ifrequency;
+	octaves = ioctaves;
+	lacunarity = 2.0f;
+	gain = 0.5f;
+}
+
+//Destructor
+NoiseNode::~NoiseNode()
+{
+
+}
+
+//Change how octaves are combined
+void NoiseNode::setFractal(float ilacunarity, float igain)
+{
+	lacunarity = ilacunarity;
+	gain = igain;
+}
+
+//Evaluate noise
+void NoiseNode::evaluate(const float *u, const float *v, float *result)
+{
+	float x[TEXTURE_BATCH_SIZE];
+	float y[TEXTURE_BATCH_SIZE];
+	float z[TEXTURE_BATCH_SIZE];
+
+	//Sample between lattice planes, where the noise is never flat
+	for(int i = 0; i < TEXTURE_BATCH_SIZE; i++) {
+		x[i] = u[i] * frequency;
+		y[i] = v[i] * frequency;
+		z[i] = 0.5f;
+	}
+
+	noise.fractalBatch(x, y, z, octaves, lacunarity, gain, result);
+
+	for(int i = 0; i < TEXTURE_BATCH_SIZE; i++)
+		result[i] = clamp01(result[i] * 0.5f + 0.5f);
+}
+
+//Constructor
+GradientNode::GradientNode(float idu, float idv)
+{
+	du = idu;
+	dv = idv;
+}
+
+//Destructor
+GradientNode::~GradientNode()
+{
+
+}
+
+//Evaluate the gradient
+void GradientNode::evaluate(const float *u, const float *v, float *result)
+{
+	for(int i = 0; i < TEXTURE_BATCH_SIZE; i++)
+		result[i] = clamp01(u[i] * du + v[i] * dv);
+}
+
+//Constructor
+PatternNode::PatternNode(texture_pattern ipattern, float irepeat)
+{
+	pattern = ipattern;
+	repeat = irepeat;
+}
+
+//Destructor
+PatternNode::~PatternNode()
+{
+
+}
+
+//Evaluate the pattern
+void PatternNode::evaluate(const float *u, const float *v, float *result)
+{
+	//Mortar takes this fraction of a brick's height
+	const float mortar = 0.1f;
+
+	for(int i = 0; i < TEXTURE_BATCH_SIZE; i++) {
+		float x = u[i] * repeat;
+		float y = v[i] * repeat;
+		float row = floorf(y);
+
+		if(pattern == TP_CHECKER) {
+			int sum = (int)floorf(x) + (int)row;
+			result[i] = (sum & 1) ? 1.0f : 0.0f;
+		} else if(pattern == TP_STRIPES) {
+			result[i] = ((int)floorf(x) & 1) ? 1.0f : 0.0f;
+		} else {
+			//Bricks are twice as wide as they are tall
+			float brick_x = x * 0.5f;
+			if((int)row & 1)
+				brick_x += 0.5f;
+
+			float fx = (brick_x - floorf(brick_x)) * 2.0f;
+			float fy = y - row;
+			bool in_mortar = fy < mortar * 0.5f || fy > 1.0f - mortar * 0.5f ||
+				fx < mortar * 0.5f || fx > 2.0f - mortar * 0.5f;
+			result[i] = in_mortar ? 0.0f : 1.0f;
+		}
+	}
+}
+
+//Constructor
+BlendNode::BlendNode(TextureNode *ia, TextureNode *ib, blend_mode imode, float ifactor)
+{
+	a = ia;
+	b = ib;
+	mask = NULL;
+	mode = imode;
+	factor = ifactor;
+}
+
+//Destructor
+BlendNode::~BlendNode()
+{
+
+}
+
+//Set the mask
+void BlendNode::setMask(TextureNode *imask)
+{
+	mask = imask;
+}
+
+//Evaluate the blend
+void BlendNode::evaluate(const float *u, const float *v, float *result)
+{
+	float second[TEXTURE_BATCH_SIZE];
+	float weights[TEXTURE_BATCH_SIZE];
+
+	a->evaluate(u, v, result);
+	b->evaluate(u, v, second);
+
+	if(mask) {
+		mask->evaluate(u, v, weights);
+		for(int i = 0; i < TEXTURE_BATCH_SIZE; i++)
+			weights[i] *= factor;
+	} else {
+		for(int i = 0; i < TEXTURE_BATCH_SIZE; i++)
+			weights[i] = factor;
+	}
+
+	for(int i = 0; i < TEXTURE_BATCH_SIZE; i++) {
+		float combined;
+		if(mode == BM_MIX)
+			combined = second[i];
+		else if(mode == BM_ADD)
+			combined = result[i] + second[i];
+		else
+			combined = result[i] * second[i];
+
+		result[i] = clamp01(result[i] + weights[i] * (combined - result[i]));
+	}
+}
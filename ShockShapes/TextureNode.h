@@ -0,0 +1,196 @@
+/** @file TextureNode.h
+ *
+ * @brief Composable nodes that describe procedural textures
+ *
+ * Copyright 2013, Stewart Hall
+ *
+ * Licensed under The MIT License
+ * Redistributions of files must retain the above copyright notice.
+ *
+ * @author		Stewart Hall (www.stewartghall.com)
+ * @date		10/18/2026
+ * @copyright	Copyright 2013, Stewart Hall
+ * @license		MIT License (http://www.opensource.org/licenses/mit-license.php)
+ */
+
+#ifndef _TEXTURENODE_
+#define _TEXTURENODE_
+
+#include "Noise.h"
+
+/**
+ * Number of texels evaluated together by a node
+ */
+#define TEXTURE_BATCH_SIZE NOISE_BATCH_SIZE
+
+/**
+ * @brief Base class for all texture nodes
+ * @details A node maps texture coordinates to a value between 0 and 1.
+ * Nodes are evaluated in batches of TEXTURE_BATCH_SIZE texels from several
+ * threads at once, so evaluate must not change the node. Nodes that combine
+ * other nodes do not own them.
+ */
+class TextureNode {
+public:
+	TextureNode();				/**< Default constructor. */
+
+	virtual ~TextureNode();		/**< Destructor. */
+
+	/**
+	 * Evaluates the node at a batch of texture coordinates
+	 * @param u TEXTURE_BATCH_SIZE u coordinates
+	 * @param v TEXTURE_BATCH_SIZE v coordinates
+	 * @param result Set to the value at each coordinate
+	 */
+	virtual void evaluate(const float *u, const float *v, float *result) = 0;
+};
+
+/**
+ * @brief Fractal gradient noise
+ */
+class NoiseNode : public TextureNode {
+private:
+	GradientNoise noise;	/**< Noise for the seed. */
+	float frequency;		/**< Noise cycles across the texture in the first octave. */
+	int octaves;			/**< Number of noise layers. */
+	float lacunarity;		/**< Frequency multiplier between octaves. */
+	float gain;				/**< Amplitude multiplier between octaves. */
+
+public:
+	/**
+	 * Constructs a noise node
+	 * @param seed Seed for the noise
+	 * @param ifrequency Noise cycles across the texture in the first octave
+	 * @param ioctaves Number of noise layers, each adding finer detail
+	 */
+	NoiseNode(unsigned int seed, float ifrequency, int ioctaves);
+
+	~NoiseNode();				/**< Destructor. */
+
+	/**
+	 * Changes how octaves are combined
+	 * @param ilacunarity Frequency multiplier between octaves, 2 by default
+	 * @param igain Amplitude multiplier between octaves, 0.5 by default
+	 */
+	void setFractal(float ilacunarity, float igain);
+
+	/**
+	 * Evaluates noise, mapped from -1 to 1 onto 0 to 1
+	 * @param u TEXTURE_BATCH_SIZE u coordinates
+	 * @param v TEXTURE_BATCH_SIZE v coordinates
+	 * @param result Set to the value at each coordinate
+	 */
+	virtual void evaluate(const float *u, const float *v, float *result);
+};
+
+/**
+ * @brief Linear ramp across the texture
+ */
+class GradientNode : public TextureNode {
+private:
+	float du;		/**< Change in value per unit of u. */
+	float dv;		/**< Change in value per unit of v. */
+
+public:
+	/**
+	 * Constructs a gradient node with value u * idu + v * idv, clamped to 0 to 1
+	 * @param idu Change in value per unit of u
+	 * @param idv Change in value per unit of v
+	 */
+	GradientNode(float idu, float idv);
+
+	~GradientNode();			/**< Destructor. */
+
+	/**
+	 * Evaluates the gradient
+	 * @param u TEXTURE_BATCH_SIZE u coordinates
+	 * @param v TEXTURE_BATCH_SIZE v coordinates
+	 * @param result Set to the value at each coordinate
+	 */
+	virtual void evaluate(const float *u, const float *v, float *result);
+};
+
+/**
+ * @brief Defines the repeating patterns a pattern node can make
+ */
+enum texture_pattern {
+	TP_CHECKER,		/**< Alternating squares of 0 and 1. */
+	TP_STRIPES,		/**< Alternating vertical stripes of 0 and 1. */
+	TP_BRICKS		/**< Bricks of 1 in mortar of 0, with every other row shifted by half a brick. */
+};
+
+/**
+ * @brief Repeating pattern of 0 and 1
+ */
+class PatternNode : public TextureNode {
+private:
+	texture_pattern pattern;	/**< Pattern to make. */
+	float repeat;				/**< Number of pattern cells across the texture. */
+
+public:
+	/**
+	 * Constructs a pattern node
+	 * @param ipattern Pattern to make
+	 * @param irepeat Number of squares, stripes or brick rows across the texture
+	 */
+	PatternNode(texture_pattern ipattern, float irepeat);
+
+	~PatternNode();				/**< Destructor. */
+
+	/**
+	 * Evaluates the pattern
+	 * @param u TEXTURE_BATCH_SIZE u coordinates
+	 * @param v TEXTURE_BATCH_SIZE v coordinates
+	 * @param result Set to the value at each coordinate
+	 */
+	virtual void evaluate(const float *u, const float *v, float *result);
+};
+
+/**
+ * @brief Defines how a blend node combines its inputs
+ */
+enum blend_mode {
+	BM_MIX,			/**< Moves from a towards b by the blend factor. */
+	BM_ADD,			/**< Adds b scaled by the blend factor to a, clamped to 1. */
+	BM_MULTIPLY		/**< Multiplies a by b, with the blend factor moving from no change to a full product. */
+};
+
+/**
+ * @brief Combines two nodes, optionally masked by a third
+ */
+class BlendNode : public TextureNode {
+private:
+	TextureNode *a;			/**< First input. */
+	TextureNode *b;			/**< Second input. */
+	TextureNode *mask;		/**< Scales the blend factor per texel or NULL. */
+	blend_mode mode;		/**< How the inputs are combined. */
+	float factor;			/**< Strength of the blend from 0 to 1. */
+
+public:
+	/**
+	 * Constructs a blend node
+	 * @param ia First input
+	 * @param ib Second input
+	 * @param imode How the inputs are combined
+	 * @param ifactor Strength of the blend from 0 to 1
+	 */
+	BlendNode(TextureNode *ia, TextureNode *ib, blend_mode imode, float ifactor);
+
+	~BlendNode();				/**< Destructor. */
+
+	/**
+	 * Scales the blend factor by another node
+	 * @param imask The node to use or NULL to blend evenly
+	 */
+	void setMask(TextureNode *imask);
+
+	/**
+	 * Evaluates both inputs and combines them
+	 * @param u TEXTURE_BATCH_SIZE u coordinates
+	 * @param v TEXTURE_BATCH_SIZE v coordinates
+	 * @param result Set to the value at each coordinate
+	 */
+	virtual void evaluate(const float *u, const float *v, float *result);
+};
+
+#endif
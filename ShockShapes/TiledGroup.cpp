@@ -15,6 +15,7 @@
 
 #include "TiledGroup.h"
 #include "Instance.h"
+#include "Scene.h"
 
 //Default constructor
 TiledGroup::TiledGroup()
@@ -75,6 +76,8 @@ void TiledGroup::setTiledProperties(int distinct, float x, float z, float x_off,
 //Generate the tiled surface
 void TiledGroup::generate(int seed, Scene *scene)
 {
+	MemoryArena *arena = scene ? scene->getArena() : NULL;
+
 	float tile_half_x = 0.5f * tile_x;
 	float tile_half_z = 0.5f * tile_z;
 
@@ -94,8 +97,10 @@ void TiledGroup::generate(int seed, Scene *scene)
 	//Loop through rows of tiles and determine tile location
 	float offset = 0.0f;
 	float z_location = z_start;
+	row_starts.clear();
 	while(z_location < z_end) {
 		float x_location = x_start;
+		row_starts.push_back(objects.size());
 
 		//Offset x
 		if(offset >= tile_x)
@@ -126,7 +131,7 @@ void TiledGroup::generate(int seed, Scene *scene)
 				base_object->generate(seed, scene);
 				base_object->filter();
 				
-				Geometry *tile_copy = new Geometry();
+				Geometry *tile_copy = new(arena) Geometry("Geometry", arena);
 				base_object->cloneMesh(tile_copy);
 
 				//Add the copy to this group
@@ -137,7 +142,7 @@ void TiledGroup::generate(int seed, Scene *scene)
 				tiles[object_index] = tile_copy;
 			} else {
 				//Create an instance of the tile
-				Instance *tile_inst = new Instance(tiles[object_index]);
+				Instance *tile_inst = new(arena) Instance(tiles[object_index], arena);
 				tile_inst->getTransform()->setTranslation(x_location, 0.0f, z_location);
 
 				addObject(tile_inst);
@@ -163,11 +168,106 @@ void TiledGroup::generate(int seed, Scene *scene)
 		//Increment to next row of tiles
 		z_location += tile_z;
 	}
+	row_starts.push_back(objects.size());
+}
+
+//Check that the rows cover every object
+bool TiledGroup::hasRows()
+{
+	return !row_starts.empty() && row_starts.front() == 0 && row_starts.back() == (int)objects.size();
+}
+
+//Bound each row of tiles
+void TiledGroup::getRowBounds(Matrix *m, BoundingBox *row_bounds, BoundingBox *bounds)
+{
+	BoundingBox object_bounds;
+	CullingVolume::emptyBounds(bounds);
+
+	ScratchArray<Matrix> transforms(getScratchArena(), objects.size());
+	getObjectTransforms(m, transforms.get());
+
+	for(unsigned int row = 0; row + 1 < row_starts.size(); row++) {
+		CullingVolume::emptyBounds(&row_bounds[row]);
+		for(int i = row_starts[row]; i < row_starts[row + 1]; i++) {
+			objects[i]->getBounds(&transforms[i], &object_bounds);
+			CullingVolume::expandBounds(&row_bounds[row], &object_bounds);
+		}
+
+		CullingVolume::expandBounds(bounds, &row_bounds[row]);
+	}
+}
+
+//Save instances of the tiles in rows inside the volume
+int TiledGroup::saveInstance(pugi::xml_node root, int *id, Transform *parent, CullingVolume *volume)
+{
+	//Rows are only known for generated groups whose objects have not changed since
+	if(!volume || !hasRows())
+		return Group::saveInstance(root, id, parent, volume);
+
+	Matrix *world = t.getWorldMatrix(parent);
+	int num_rows = row_starts.size() - 1;
+	std::vector<BoundingBox> row_bounds(num_rows);
+	BoundingBox bounds;
+	if(num_rows > 0)
+		getRowBounds(world, &row_bounds[0], &bounds);
+	else
+		CullingVolume::emptyBounds(&bounds);
+
+	if(!volume->intersects(&bounds))
+		return 0;
+
+	updateObjectWorldMatrices();
+
+	int result;
+	for(int row = 0; row < num_rows; row++) {
+		if(!volume->intersects(&row_bounds[row]))
+			continue;
+
+		for(int i = row_starts[row]; i < row_starts[row + 1]; i++) {
+			if((result = objects[i]->saveInstance(root, id, &t, volume)))
+				return result;
+		}
+	}
+
+	return 0;
+}
+
+//Combine the tiles in rows inside the volume
+void TiledGroup::combineTransformedInto(Geometry *g, Matrix *m, CullingVolume *volume)
+{
+	if(!volume || !hasRows()) {
+		Group::combineTransformedInto(g, m, volume);
+		return;
+	}
+
+	int num_rows = row_starts.size() - 1;
+	std::vector<BoundingBox> row_bounds(num_rows);
+	BoundingBox bounds;
+	if(num_rows > 0)
+		getRowBounds(m, &row_bounds[0], &bounds);
+	else
+		CullingVolume::emptyBounds(&bounds);
+
+	if(!volume->intersects(&bounds))
+		return;
+
+	ScratchArray<Matrix> transforms(getScratchArena(), objects.size());
+	getObjectTransforms(m, transforms.get());
+
+	for(int row = 0; row < num_rows; row++) {
+		if(!volume->intersects(&row_bounds[row]))
+			continue;
+
+		for(int i = row_starts[row]; i < row_starts[row + 1]; i++)
+			objects[i]->combineTransformedInto(g, &transforms[i], volume);
+	}
 }
 
 //Retrieves a partial width tile
 Geometry *TiledGroup::getPartialTile(float width, int seed, Scene *scene)
 {
+	MemoryArena *arena = scene ? scene->getArena() : NULL;
+
 	if(tem == TEM_SCALE) {
 		if(partial_tiles.size() == 0) {
 			//Generate
@@ -175,7 +275,7 @@ Geometry *TiledGroup::getPartialTile(float width, int seed, Scene *scene)
 			base_object->generate(seed, scene);
 			base_object->filter();
 					
-			Geometry *tile_copy = new Geometry();
+			Geometry *tile_copy = new(arena) Geometry("Geometry", arena);
 			base_object->cloneMesh(tile_copy);
 
 			//Scale
@@ -186,7 +286,7 @@ Geometry *TiledGroup::getPartialTile(float width, int seed, Scene *scene)
 			return tile_copy;
 		} else {
 			//Return instance
-			Instance *tile_inst = new Instance(partial_tiles[0]);
+			Instance *tile_inst = new(arena) Instance(partial_tiles[0], arena);
 			tile_inst->getTransform()->setScale(width / tile_x, 1.0f, 1.0f);
 
 			return tile_inst;
@@ -58,6 +58,27 @@ private:
 	float x_offset;					/**< Amount to offset tiles by in x for each z step. */
 	tile_end_method tem;			/**< How to handle edges of the group where tiles overlap the boundary. */
 
+	/**
+	 * Index of the first object in each row of tiles, followed by the number
+	 * of objects
+	 */
+	std::vector<int> row_starts;
+
+	/**
+	 * Checks that the rows from the last generate cover every object, so
+	 * nothing was added before or after generating
+	 * @return True if the rows can be used to cull
+	 */
+	bool hasRows();
+
+	/**
+	 * Bounds each row of tiles and the whole group after a transform
+	 * @param m Transform to apply to the group's contents
+	 * @param row_bounds Receives the bounds of each row
+	 * @param bounds Receives the union of the rows
+	 */
+	void getRowBounds(Matrix *m, BoundingBox *row_bounds, BoundingBox *bounds);
+
 	/**
 	 * Gets a pointer to a partial width tile
 	 * @param width The desired width of the tile needed
@@ -96,6 +117,26 @@ public:
 	 * @param scene The scene that this geometry will belong to
 	 */
 	virtual void generate(int seed, Scene *scene);
+
+	/**
+	 * Saves instance nodes for the tiles, skipping whole rows outside the
+	 * volume before testing the tiles in the remaining rows
+	 * @param root The scene element to add the nodes to
+	 * @param id Unique suffix to place after the name of the node
+	 * @param parent The transform on the parent object
+	 * @param volume Volume to cull against, or NULL to save every tile
+	 * @return Returns 0 if no errors occur
+	 */
+	virtual int saveInstance(pugi::xml_node root, int *id, Transform *parent, CullingVolume *volume);
+
+	/**
+	 * Combines the tiles with another object, skipping whole rows outside
+	 * the volume
+	 * @param g The geometry to combine this object into
+	 * @param m Complete transform from the group's space to g's
+	 * @param volume Volume to cull against, or NULL to combine every tile
+	 */
+	virtual void combineTransformedInto(Geometry *g, Matrix *m, CullingVolume *volume);
 };
 
 #endif
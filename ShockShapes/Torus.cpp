@@ -0,0 +1,89 @@
+/** @file Torus.cpp
+ *
+ * @brief Generates rings with a circular cross section
+ *
+ * Copyright 2013, Stewart Hall
+ *
+ * Licensed under The MIT License
+ * Redistributions of files must retain the above copyright notice.
+ *
+ * @author		Stewart Hall (www.stewartghall.com)
+ * @date		10/18/2026
+ * @copyright	Copyright 2013, Stewart Hall
+ * @license		MIT License (http://www.opensource.org/licenses/mit-license.php)
+ */
+
+#include <math.h>
+
+#include "Torus.h"
+
+//Default constructor
+Torus::Torus()
+:Primitive("Torus")
+{
+	major_radius = 1.0f;
+	minor_radius = 0.25f;
+	segments = 48;
+	sides = 16;
+}
+
+//Sized constructor
+Torus::Torus(float major, float minor, int segs, int num_sides)
+:Primitive("Torus")
+{
+	major_radius = major;
+	minor_radius = minor;
+	segments = segs < 3 ? 3 : segs;
+	sides = num_sides < 3 ? 3 : num_sides;
+}
+
+//Destructor
+Torus::~Torus()
+{
+
+}
+
+//A torus is a single patch
+int Torus::getNumPatches()
+{
+	return 1;
+}
+
+//Describe the torus
+void Torus::getPatch(int patch, PrimitivePatch *desc)
+{
+	desc->columns = segments;
+	desc->rows = sides;
+	desc->flags = PF_WRAP_COLUMNS | PF_WRAP_ROWS;
+}
+
+//One vertex per distinct grid point
+int Torus::getNumPositions()
+{
+	return segments * sides;
+}
+
+//Both the last column and the last row wrap around
+int Torus::getVertexIndex(int patch, int row, int column)
+{
+	return (row % sides) * segments + column % segments;
+}
+
+//Evaluate a grid point. Rows start on the outside of the tube and go over the top.
+void Torus::evaluate(int patch, int row, int column, Vector3D *position, Vector3D *normal, Vector2D *uv)
+{
+	uv->u = (float)column / (float)segments;
+	uv->v = (float)row / (float)sides;
+
+	float phi = 2.0f * PI * uv->u;
+	float psi = 2.0f * PI * uv->v;
+	float ring = major_radius + minor_radius * cosf(psi);
+
+	position->x = ring * cosf(phi);
+	position->y = minor_radius * sinf(psi);
+	position->z = -ring * sinf(phi);
+
+	normal->x = cosf(psi) * cosf(phi);
+	normal->y = sinf(psi);
+	normal->z = -cosf(psi) * sinf(phi);
+}
@@ -0,0 +1,89 @@
+/** @file Torus.h
+ *
+ * @brief Generates rings with a circular cross section
+ *
+ * Copyright 2013, Stewart Hall
+ *
+ * Licensed under The MIT License
+ * Redistributions of files must retain the above copyright notice.
+ *
+ * @author		Stewart Hall (www.stewartghall.com)
+ * @date		10/18/2026
+ * @copyright	Copyright 2013, Stewart Hall
+ * @license		MIT License (http://www.opensource.org/licenses/mit-license.php)
+ */
+
+#ifndef _TORUS_
+#define _TORUS_
+
+#include "Primitive.h"
+
+/**
+ * @brief Generates a torus around the Y axis centered at the origin
+ * @details The surface wraps in both directions, so every vertex is shared
+ * and only texture coordinates are duplicated along the two seams.
+ */
+class Torus : public Primitive {
+private:
+	float major_radius;				/**< Distance from the center to the middle of the tube. */
+	float minor_radius;				/**< Radius of the tube. */
+	int segments;					/**< Number of cells around the ring. */
+	int sides;						/**< Number of cells around the tube. */
+
+protected:
+	/**
+	 * Gets the number of patches
+	 * @return 1
+	 */
+	virtual int getNumPatches();
+
+	/**
+	 * Describes the torus, with columns running around the ring and rows
+	 * running around the tube
+	 * @param patch Index of the patch
+	 * @param desc Receives the size of the patch
+	 */
+	virtual void getPatch(int patch, PrimitivePatch *desc);
+
+	/**
+	 * Gets the number of vertices
+	 * @return segments * sides
+	 */
+	virtual int getNumPositions();
+
+	/**
+	 * Finds the vertex of a grid point
+	 * @param patch Index of the patch
+	 * @param row Row of the grid point
+	 * @param column Column of the grid point
+	 * @return Index of the vertex
+	 */
+	virtual int getVertexIndex(int patch, int row, int column);
+
+	/**
+	 * Evaluates the torus at a grid point
+	 * @param patch Index of the patch
+	 * @param row Row of the grid point
+	 * @param column Column of the grid point
+	 * @param position Receives the position
+	 * @param normal Receives the unit normal
+	 * @param uv Receives the texture coordinate
+	 */
+	virtual void evaluate(int patch, int row, int column, Vector3D *position, Vector3D *normal, Vector2D *uv);
+
+public:
+	Torus();						/**< Default constructor makes a torus of radii 1 and 0.25 with 48 segments and 16 sides. */
+
+	/**
+	 * Makes a torus with the specified size and resolution
+	 * @param major Distance from the center to the middle of the tube
+	 * @param minor Radius of the tube
+	 * @param segs Number of cells around the ring. At least 3
+	 * @param num_sides Number of cells around the tube. At least 3
+	 */
+	Torus(float major, float minor, int segs, int num_sides);
+
+	~Torus();						/**< Destructor. */
+};
+
+#endif
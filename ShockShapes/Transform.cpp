@@ -15,6 +15,10 @@
 
 #include "Transform.h"
 
+#ifdef MATRIX_SSE2
+#include <emmintrin.h>
+#endif
+
 //Constructor
 Transform::Transform()
 {
@@ -23,6 +27,11 @@ Transform::Transform()
 	xr = yr = zr = 0.0f;
 
 	m.identity();
+
+	world_dirty = true;
+	world_parent = NULL;
+	world_parent_stamp = 0;
+	world_stamp = 0;
 }
 
 //Copy constructor
@@ -33,6 +42,11 @@ Transform::Transform(Transform &c)
 	xr = c.xr; yr = c.yr; zr = c.zr;
 
 	m = c.m;
+
+	world_dirty = true;
+	world_parent = NULL;
+	world_parent_stamp = 0;
+	world_stamp = 0;
 }
 
 //Destructor
@@ -48,7 +62,7 @@ void Transform::translate(float x, float y, float z)
 	yt += y;
 	zt += z;
 
-	m.translate(x, y, z);
+	bake();
 }
 
 void Transform::scale(float x, float y, float z)
@@ -57,7 +71,7 @@ void Transform::scale(float x, float y, float z)
 	ys *= y;
 	zs *= z;
 
-	m.scale(x, y, z);
+	bake();
 }
 
 void Transform::rotate(float x, float y, float z)
@@ -66,9 +80,7 @@ void Transform::rotate(float x, float y, float z)
 	yr += y;
 	zr += z;
 
-	m.rotateX(xr);
-	m.rotateX(yr);
-	m.rotateX(zr);
+	bake();
 }
 
 //Setters for each type of transform
@@ -107,16 +119,70 @@ void Transform::reset()
 	xr = yr = zr = 0.0f;
 
 	m.identity();
+	world_dirty = true;
 }
 
 //Combine two transforms
 void Transform::combine(Transform *t)
 {
-	xt += t->xt; yt += t->yt; zt += t->zt;
-	xr += t->xr; yr += t->yr; zr += t->zr;
-	xs *= t->xs; ys *= t->ys; zs *= t->zs;
+	Matrix local = m;
+	m = t->m;
+	m.multiply(&local);
+	world_dirty = true;
+}
+
+//Get the cached world matrix
+Matrix *Transform::getWorldMatrix(Transform *parent)
+{
+	unsigned int parent_stamp = parent ? parent->world_stamp : 0;
+	if(!world_dirty && parent == world_parent && parent_stamp == world_parent_stamp)
+		return &world;
+
+	//Apply this transform first, then the parent's
+	if(parent) {
+		world = parent->world;
+		world.multiply(&m);
+	} else {
+		world = m;
+	}
+
+	world_dirty = false;
+	world_parent = parent;
+	world_parent_stamp = parent_stamp;
+	world_stamp++;
+
+	return &world;
+}
 
-	bake();
+//Update the cached world matrices of children sharing a parent
+void Transform::updateWorldMatrices(Transform *parent, Transform **children, int count)
+{
+	Matrix locals[TRANSFORM_BATCH_SIZE];
+	Transform *stale[TRANSFORM_BATCH_SIZE];
+
+	int i = 0;
+	while(i < count) {
+		//Gather a batch of children whose cache is out of date
+		int num_stale = 0;
+		for(; i < count && num_stale < TRANSFORM_BATCH_SIZE; i++) {
+			Transform *child = children[i];
+			if(!child->world_dirty && child->world_parent == parent && child->world_parent_stamp == parent->world_stamp)
+				continue;
+
+			locals[num_stale] = child->m;
+			stale[num_stale] = child;
+			num_stale++;
+		}
+
+		Matrix::multiplyArray(&(parent->world), locals, locals, num_stale);
+		for(int k = 0; k < num_stale; k++) {
+			stale[k]->world = locals[k];
+			stale[k]->world_dirty = false;
+			stale[k]->world_parent = parent;
+			stale[k]->world_parent_stamp = parent->world_stamp;
+			stale[k]->world_stamp++;
+		}
+	}
 }
 
 //Bake the transform to a matrix
@@ -128,6 +194,7 @@ void Transform::bake()
 	m.rotateY(yr);
 	m.rotateZ(zr);
 	m.scale(xs, ys, zs);
+	world_dirty = true;
 }
 
 //Save transform
@@ -140,6 +207,7 @@ int Transform::save(pugi::xml_node root)
 void Transform::setMatrix(Matrix matrix)
 {
 	m = matrix;
+	world_dirty = true;
 }
 
 //----------------------Matrix Implementation----------------------------------
@@ -194,23 +262,31 @@ void Matrix::identity()
 //Add a translation matrix
 void Matrix::translate(float x, float y, float z)
 {
-	float c0[4] = {1.0f, 0.0f, 0.0f, 0.0f};
-	float c1[4] = {0.0f, 1.0f, 0.0f, 0.0f};
-	float c2[4] = {0.0f, 0.0f, 1.0f, 0.0f};
-	float c3[4] = {x, y, z, 1.0f};
-
-	multiply(c0, c1, c2, c3);
+	//Only the last column changes
+	r0[3] += r0[0] * x + r0[1] * y + r0[2] * z;
+	r1[3] += r1[0] * x + r1[1] * y + r1[2] * z;
+	r2[3] += r2[0] * x + r2[1] * y + r2[2] * z;
+	r3[3] += r3[0] * x + r3[1] * y + r3[2] * z;
 }
 
 //Add a scaling matrix
 void Matrix::scale(float x, float y, float z)
 {
-	float c0[4] = {x, 0.0f, 0.0f, 0.0f};
-	float c1[4] = {0.0f, y, 0.0f, 0.0f};
-	float c2[4] = {0.0f, 0.0f, z, 0.0f};
-	float c3[4] = {0.0f, 0.0f, 0.0f, 1.0f};
-
-	multiply(c0, c1, c2, c3);
+	//Each of the first three columns is scaled
+#ifdef MATRIX_SSE2
+	__m128 factors = _mm_set_ps(1.0f, z, y, x);
+	_mm_storeu_ps(r0, _mm_mul_ps(_mm_loadu_ps(r0), factors));
+	_mm_storeu_ps(r1, _mm_mul_ps(_mm_loadu_ps(r1), factors));
+	_mm_storeu_ps(r2, _mm_mul_ps(_mm_loadu_ps(r2), factors));
+	_mm_storeu_ps(r3, _mm_mul_ps(_mm_loadu_ps(r3), factors));
+#else
+	float *rows[4] = {r0, r1, r2, r3};
+	for(int i = 0; i < 4; i++) {
+		rows[i][0] *= x;
+		rows[i][1] *= y;
+		rows[i][2] *= z;
+	}
+#endif
 }
 
 //Add a rotation matrix
@@ -229,52 +305,65 @@ void Matrix::rotate(float x, float y, float z, float angle)
 	multiply(c0, c1, c2, c3);
 }
 
+//Rotate two columns into each other
+void Matrix::rotateColumns(int i, int j, float c, float s)
+{
+	float *rows[4] = {r0, r1, r2, r3};
+	for(int k = 0; k < 4; k++) {
+		float a = rows[k][i];
+		float b = rows[k][j];
+		rows[k][i] = a * c + b * s;
+		rows[k][j] = b * c - a * s;
+	}
+}
+
 //Rotate with axis aligned angles
 void Matrix::rotateX(float angle)
 {
 	angle = angle * PI / 180.0f;
-	float s = sinf(angle);
-	float c = cosf(angle);
-
-	float c0[4] = {1.0f, 0.0f, 0.0f, 0.0f};
-	float c1[4] = {0.0f, c, s, 0.0f};
-	float c2[4] = {0.0f, -s, c, 0.0f};
-	float c3[4] = {0.0f, 0.0f, 0.0f, 1.0f};
-
-	multiply(c0, c1, c2, c3);
+	rotateColumns(1, 2, cosf(angle), sinf(angle));
 }
 
 void Matrix::rotateY(float angle)
 {
 	angle = angle * PI / 180.0f;
-	float s = sinf(angle);
-	float c = cosf(angle);
-
-	float c0[4] = {c, 0.0f, -s, 0.0f};
-	float c1[4] = {0.0f, 1.0f, 0.0f, 0.0f};
-	float c2[4] = {s, 0.0f, c, 0.0f};
-	float c3[4] = {0.0f, 0.0f, 0.0f, 1.0f};
-
-	multiply(c0, c1, c2, c3);
+	rotateColumns(2, 0, cosf(angle), sinf(angle));
 }
 
 void Matrix::rotateZ(float angle)
 {
 	angle = angle * PI / 180.0f;
-	float s = sinf(angle);
-	float c = cosf(angle);
-
-	float c0[4] = {c, s, 0.0f, 0.0f};
-	float c1[4] = {-s, c, 0.0f, 0.0f};
-	float c2[4] = {0.0f, 0.0f, 1.0f, 0.0f};
-	float c3[4] = {0.0f, 0.0f, 0.0f, 1.0f};
+	rotateColumns(0, 1, cosf(angle), sinf(angle));
+}
 
-	multiply(c0, c1, c2, c3);
+#ifdef MATRIX_SSE2
+//Replace a row with its product with the rows of another matrix
+static void multiplyRow(float *row, __m128 b0, __m128 b1, __m128 b2, __m128 b3)
+{
+	__m128 sum = _mm_mul_ps(_mm_set1_ps(row[0]), b0);
+	sum = _mm_add_ps(sum, _mm_mul_ps(_mm_set1_ps(row[1]), b1));
+	sum = _mm_add_ps(sum, _mm_mul_ps(_mm_set1_ps(row[2]), b2));
+	sum = _mm_add_ps(sum, _mm_mul_ps(_mm_set1_ps(row[3]), b3));
+	_mm_storeu_ps(row, sum);
 }
+#endif
 
 //Multiply by another matrix
 void Matrix::multiply(float *c0, float *c1, float *c2, float *c3)
 {
+#ifdef MATRIX_SSE2
+	//Turn the columns into rows
+	__m128 b0 = _mm_loadu_ps(c0);
+	__m128 b1 = _mm_loadu_ps(c1);
+	__m128 b2 = _mm_loadu_ps(c2);
+	__m128 b3 = _mm_loadu_ps(c3);
+	_MM_TRANSPOSE4_PS(b0, b1, b2, b3);
+
+	multiplyRow(r0, b0, b1, b2, b3);
+	multiplyRow(r1, b0, b1, b2, b3);
+	multiplyRow(r2, b0, b1, b2, b3);
+	multiplyRow(r3, b0, b1, b2, b3);
+#else
 	//Copy current matrix into a temporary matrix
 	float tr0[4] = {r0[0], r0[1], r0[2], r0[3]};
 	float tr1[4] = {r1[0], r1[1], r1[2], r1[3]};
@@ -301,18 +390,236 @@ void Matrix::multiply(float *c0, float *c1, float *c2, float *c3)
 	r3[1] = DOT(tr3,c1);
 	r3[2] = DOT(tr3,c2);
 	r3[3] = DOT(tr3,c3);
+#endif
 }
 
 //Multiply by another transform
 void Matrix::multiply(Matrix *t)
 {
+	bool affine = isAffine() && t->isAffine();
+
+#ifdef MATRIX_SSE2
+	//Load every row first in case t is this matrix
+	__m128 b0 = _mm_loadu_ps(t->r0);
+	__m128 b1 = _mm_loadu_ps(t->r1);
+	__m128 b2 = _mm_loadu_ps(t->r2);
+	__m128 b3 = _mm_loadu_ps(t->r3);
+
+	multiplyRow(r0, b0, b1, b2, b3);
+	multiplyRow(r1, b0, b1, b2, b3);
+	multiplyRow(r2, b0, b1, b2, b3);
+
+	//The product of affine matrices keeps the bottom row
+	if(!affine)
+		multiplyRow(r3, b0, b1, b2, b3);
+#else
 	//Change rows to columns
 	float tc0[4] = {t->r0[0], t->r1[0], t->r2[0], t->r3[0]};
 	float tc1[4] = {t->r0[1], t->r1[1], t->r2[1], t->r3[1]};
 	float tc2[4] = {t->r0[2], t->r1[2], t->r2[2], t->r3[2]};
 	float tc3[4] = {t->r0[3], t->r1[3], t->r2[3], t->r3[3]};
 
-	multiply(tc0, tc1, tc2, tc3);
+	float *rows[3] = {r0, r1, r2};
+	for(int i = 0; i < 3; i++) {
+		float row[4] = {rows[i][0], rows[i][1], rows[i][2], rows[i][3]};
+		rows[i][0] = DOT(row,tc0);
+		rows[i][1] = DOT(row,tc1);
+		rows[i][2] = DOT(row,tc2);
+		rows[i][3] = DOT(row,tc3);
+	}
+
+	//The product of affine matrices keeps the bottom row
+	if(!affine) {
+		float row[4] = {r3[0], r3[1], r3[2], r3[3]};
+		r3[0] = DOT(row,tc0);
+		r3[1] = DOT(row,tc1);
+		r3[2] = DOT(row,tc2);
+		r3[3] = DOT(row,tc3);
+	}
+#endif
+}
+
+//Check for an affine matrix
+bool Matrix::isAffine()
+{
+	return r3[0] == 0.0f && r3[1] == 0.0f && r3[2] == 0.0f && r3[3] == 1.0f;
+}
+
+//Multiply a matrix by many others
+void Matrix::multiplyArray(Matrix *parent, Matrix *children, Matrix *results, int count)
+{
+#ifdef MATRIX_SSE2
+	//Broadcast each element of the parent once for every product
+	const float *rows[4] = {parent->r0, parent->r1, parent->r2, parent->r3};
+	__m128 p[4][4];
+	for(int i = 0; i < 4; i++) {
+		for(int j = 0; j < 4; j++)
+			p[i][j] = _mm_set1_ps(rows[i][j]);
+	}
+	bool parent_affine = parent->isAffine();
+
+	for(int k = 0; k < count; k++) {
+		//Load the whole child first in case the result replaces it
+		bool affine = parent_affine && children[k].isAffine();
+		__m128 b0 = _mm_loadu_ps(children[k].r0);
+		__m128 b1 = _mm_loadu_ps(children[k].r1);
+		__m128 b2 = _mm_loadu_ps(children[k].r2);
+		__m128 b3 = _mm_loadu_ps(children[k].r3);
+
+		float *out[4] = {results[k].r0, results[k].r1, results[k].r2, results[k].r3};
+		int num_rows = affine ? 3 : 4;
+		for(int i = 0; i < num_rows; i++) {
+			__m128 sum = _mm_mul_ps(p[i][0], b0);
+			sum = _mm_add_ps(sum, _mm_mul_ps(p[i][1], b1));
+			sum = _mm_add_ps(sum, _mm_mul_ps(p[i][2], b2));
+			sum = _mm_add_ps(sum, _mm_mul_ps(p[i][3], b3));
+			_mm_storeu_ps(out[i], sum);
+		}
+
+		//The product of affine matrices keeps the bottom row
+		if(affine)
+			_mm_storeu_ps(out[3], _mm_set_ps(1.0f, 0.0f, 0.0f, 0.0f));
+	}
+#else
+	for(int i = 0; i < count; i++) {
+		Matrix product = *parent;
+		product.multiply(&(children[i]));
+		results[i] = product;
+	}
+#endif
+}
+
+//Transform many points
+void Matrix::transformPoints(const Vector3D *in, Vector3D *out, int count)
+{
+#ifdef MATRIX_SSE2
+	__m128 col0 = _mm_set_ps(0.0f, r2[0], r1[0], r0[0]);
+	__m128 col1 = _mm_set_ps(0.0f, r2[1], r1[1], r0[1]);
+	__m128 col2 = _mm_set_ps(0.0f, r2[2], r1[2], r0[2]);
+	__m128 col3 = _mm_set_ps(0.0f, r2[3], r1[3], r0[3]);
+
+	for(int i = 0; i < count; i++) {
+		__m128 p = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(in[i].x), col0), col3);
+		p = _mm_add_ps(p, _mm_mul_ps(_mm_set1_ps(in[i].y), col1));
+		p = _mm_add_ps(p, _mm_mul_ps(_mm_set1_ps(in[i].z), col2));
+
+		//Store exactly three floats so out may overlap in
+		_mm_storel_pi((__m64*)&(out[i].x), p);
+		_mm_store_ss(&(out[i].z), _mm_movehl_ps(p, p));
+	}
+#else
+	for(int i = 0; i < count; i++) {
+		Vector3D p = in[i];
+		out[i].x = r0[0] * p.x + r0[1] * p.y + r0[2] * p.z + r0[3];
+		out[i].y = r1[0] * p.x + r1[1] * p.y + r1[2] * p.z + r1[3];
+		out[i].z = r2[0] * p.x + r2[1] * p.y + r2[2] * p.z + r2[3];
+	}
+#endif
+}
+
+//Transform many directions
+void Matrix::transformNormals(const Vector3D *in, Vector3D *out, int count)
+{
+#ifdef MATRIX_SSE2
+	__m128 col0 = _mm_set_ps(0.0f, r2[0], r1[0], r0[0]);
+	__m128 col1 = _mm_set_ps(0.0f, r2[1], r1[1], r0[1]);
+	__m128 col2 = _mm_set_ps(0.0f, r2[2], r1[2], r0[2]);
+
+	for(int i = 0; i < count; i++) {
+		__m128 n = _mm_mul_ps(_mm_set1_ps(in[i].x), col0);
+		n = _mm_add_ps(n, _mm_mul_ps(_mm_set1_ps(in[i].y), col1));
+		n = _mm_add_ps(n, _mm_mul_ps(_mm_set1_ps(in[i].z), col2));
+
+		_mm_storel_pi((__m64*)&(out[i].x), n);
+		_mm_store_ss(&(out[i].z), _mm_movehl_ps(n, n));
+	}
+#else
+	for(int i = 0; i < count; i++) {
+		Vector3D n = in[i];
+		out[i].x = r0[0] * n.x + r0[1] * n.y + r0[2] * n.z;
+		out[i].y = r1[0] * n.x + r1[1] * n.y + r1[2] * n.z;
+		out[i].z = r2[0] * n.x + r2[1] * n.y + r2[2] * n.z;
+	}
+#endif
+}
+
+//Transform many normals and renormalize them
+void Matrix::transformUnitNormals(const Vector3D *in, Vector3D *out, int count)
+{
+#ifdef MATRIX_SSE2
+	__m128 col0 = _mm_set_ps(0.0f, r2[0], r1[0], r0[0]);
+	__m128 col1 = _mm_set_ps(0.0f, r2[1], r1[1], r0[1]);
+	__m128 col2 = _mm_set_ps(0.0f, r2[2], r1[2], r0[2]);
+
+	for(int i = 0; i < count; i++) {
+		__m128 n = _mm_mul_ps(_mm_set1_ps(in[i].x), col0);
+		n = _mm_add_ps(n, _mm_mul_ps(_mm_set1_ps(in[i].y), col1));
+		n = _mm_add_ps(n, _mm_mul_ps(_mm_set1_ps(in[i].z), col2));
+
+		//Squared length in the lowest lane
+		__m128 squares = _mm_mul_ps(n, n);
+		__m128 length = _mm_add_ss(squares, _mm_add_ss(_mm_shuffle_ps(squares, squares, _MM_SHUFFLE(1, 1, 1, 1)), _mm_movehl_ps(squares, squares)));
+		if(_mm_cvtss_f32(length) > 0.0f) {
+			length = _mm_sqrt_ss(length);
+			n = _mm_div_ps(n, _mm_shuffle_ps(length, length, _MM_SHUFFLE(0, 0, 0, 0)));
+		}
+
+		_mm_storel_pi((__m64*)&(out[i].x), n);
+		_mm_store_ss(&(out[i].z), _mm_movehl_ps(n, n));
+	}
+#else
+	for(int i = 0; i < count; i++) {
+		Vector3D n = in[i];
+		float x = r0[0] * n.x + r0[1] * n.y + r0[2] * n.z;
+		float y = r1[0] * n.x + r1[1] * n.y + r1[2] * n.z;
+		float z = r2[0] * n.x + r2[1] * n.y + r2[2] * n.z;
+
+		float length = sqrtf(x * x + y * y + z * z);
+		if(length > 0.0f) {
+			x /= length;
+			y /= length;
+			z /= length;
+		}
+
+		out[i].x = x;
+		out[i].y = y;
+		out[i].z = z;
+	}
+#endif
+}
+
+//Compute the inverse transpose of the upper 3x3
+int Matrix::getNormalMatrix(Matrix *result)
+{
+	//Cofactors of the upper 3x3 are the inverse transpose scaled by the determinant
+	float c00 = r1[1] * r2[2] - r1[2] * r2[1];
+	float c01 = r1[2] * r2[0] - r1[0] * r2[2];
+	float c02 = r1[0] * r2[1] - r1[1] * r2[0];
+	float c10 = r0[2] * r2[1] - r0[1] * r2[2];
+	float c11 = r0[0] * r2[2] - r0[2] * r2[0];
+	float c12 = r0[1] * r2[0] - r0[0] * r2[1];
+	float c20 = r0[1] * r1[2] - r0[2] * r1[1];
+	float c21 = r0[2] * r1[0] - r0[0] * r1[2];
+	float c22 = r0[0] * r1[1] - r0[1] * r1[0];
+
+	float det = r0[0] * c00 + r0[1] * c01 + r0[2] * c02;
+
+	result->identity();
+	if(fabsf(det) < 1e-20f) {
+		for(int i = 0; i < 3; i++) {
+			result->r0[i] = r0[i];
+			result->r1[i] = r1[i];
+			result->r2[i] = r2[i];
+		}
+		return 1;
+	}
+
+	float inv_det = 1.0f / det;
+	result->r0[0] = c00 * inv_det; result->r0[1] = c01 * inv_det; result->r0[2] = c02 * inv_det;
+	result->r1[0] = c10 * inv_det; result->r1[1] = c11 * inv_det; result->r1[2] = c12 * inv_det;
+	result->r2[0] = c20 * inv_det; result->r2[1] = c21 * inv_det; result->r2[2] = c22 * inv_det;
+
+	return 0;
 }
 
 //Save the matrix to a COLLADA node
@@ -29,8 +29,35 @@
 
 #define DOT(x,y) (((x[0]) * (y[0])) + ((x[1]) * (y[1])) + ((x[2]) * (y[2])) + ((x[3]) * (y[3])))
 
+/**
+ * Number of world matrices updated together by Transform::updateWorldMatrices
+ */
+#define TRANSFORM_BATCH_SIZE 64
+
+#if defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2) || defined(__SSE2__)
+#define MATRIX_SSE2
+#endif
+
+/**
+ * @brief 4x4 matrix with rows r0 to r3, transforming column vectors
+ * @details Multiplies use SSE2 when the compiler targets it. Rows are loaded
+ * and stored unaligned because matrices live inside heap allocated objects
+ * that are not guaranteed 16 byte alignment. Translate, scale and the axis
+ * rotations only touch the columns they change, and products of two affine
+ * matrices skip the constant bottom row.
+ */
 class Matrix
 {
+private:
+	/**
+	 * Replaces columns i and j with their rotation by an angle
+	 * @param i Column that gains the sine times column j
+	 * @param j Column that loses the sine times column i
+	 * @param c Cosine of the angle
+	 * @param s Sine of the angle
+	 */
+	void rotateColumns(int i, int j, float c, float s);
+
 public:
 	/**
 	 * Matrices are expressed as rows for convenient indexing
@@ -108,6 +135,55 @@ public:
 	 */
 	void multiply(Matrix *t);
 
+	/**
+	 * Checks whether the bottom row is 0 0 0 1
+	 * @return True if the matrix is affine
+	 */
+	bool isAffine();
+
+	/**
+	 * Multiplies a matrix by each of an array of matrices
+	 * @param parent Matrix on the left of every product
+	 * @param children Matrices on the right of each product
+	 * @param results Receives parent times each child. May be children
+	 * @param count Number of matrices
+	 */
+	static void multiplyArray(Matrix *parent, Matrix *children, Matrix *results, int count);
+
+	/**
+	 * Transforms an array of points, treating the matrix as affine
+	 * @param in Points to transform
+	 * @param out Receives the transformed points. May be in
+	 * @param count Number of points
+	 */
+	void transformPoints(const Vector3D *in, Vector3D *out, int count);
+
+	/**
+	 * Transforms an array of directions by the upper 3x3 of the matrix
+	 * @param in Directions to transform
+	 * @param out Receives the transformed directions. May be in
+	 * @param count Number of directions
+	 */
+	void transformNormals(const Vector3D *in, Vector3D *out, int count);
+
+	/**
+	 * Transforms an array of normals by the upper 3x3 of the matrix and
+	 * scales them back to unit length. Zero length normals stay zero.
+	 * @param in Normals to transform
+	 * @param out Receives the transformed normals. May be in
+	 * @param count Number of normals
+	 */
+	void transformUnitNormals(const Vector3D *in, Vector3D *out, int count);
+
+	/**
+	 * Computes the matrix that transforms normals, the inverse transpose of
+	 * the upper 3x3, with no translation
+	 * @param result Receives the normal matrix. Set to the upper 3x3 if it
+	 * has no inverse
+	 * @return Returns 0 if the upper 3x3 has an inverse
+	 */
+	int getNormalMatrix(Matrix *result);
+
 	/**
 	 * Saves this transform into a matrix COLLADA node
 	 * @param root The node to use as a parent for the matrix
@@ -118,8 +194,19 @@ public:
 
 /**
  * Class that a user interacts with to transform nodes
+ * @details Also caches the world matrix, the product of the parent's world
+ * matrix and this transform's matrix. The cache is rebuilt with a single
+ * matrix multiply when this transform changes or the parent's world matrix
+ * is rebuilt, so walking a hierarchy top down costs one multiply per node.
  */
 class Transform {
+private:
+	Matrix world;						/**< Cached world matrix. */
+	bool world_dirty;					/**< Set when m changes after the world matrix was cached. */
+	Transform *world_parent;			/**< Parent the world matrix was cached with. */
+	unsigned int world_parent_stamp;	/**< Parent's world stamp when the world matrix was cached. */
+	unsigned int world_stamp;			/**< Increases each time the world matrix is rebuilt. */
+
 public:
 	/**
 	 * Translation coordinates
@@ -196,10 +283,33 @@ public:
 
 	/**
 	 * Combine another transform with this one
+	 * @details The matrix becomes the other matrix times this one, so the
+	 * other transform is applied after this one. The components still
+	 * describe only this transform, so changing them discards the combination.
 	 * @param t The other transform to apply to this one
 	 */
 	void combine(Transform *t);
 
+	/**
+	 * Gets the world matrix, rebuilding it only if this transform or the
+	 * parent's world matrix changed since it was cached
+	 * @param parent Transform of the parent node, whose world matrix must
+	 * already be up to date, or NULL for a root node
+	 * @return The world matrix
+	 */
+	Matrix *getWorldMatrix(Transform *parent);
+
+	/**
+	 * Brings the cached world matrices of children of one parent up to date,
+	 * multiplying the stale ones in batches, so later getWorldMatrix calls
+	 * with the same parent return the cache
+	 * @param parent Transform of the parent node, whose world matrix must
+	 * already be up to date
+	 * @param children Transforms of the children
+	 * @param count Number of children
+	 */
+	static void updateWorldMatrices(Transform *parent, Transform **children, int count);
+
 	/**
 	 * Resets the transform
 	 */
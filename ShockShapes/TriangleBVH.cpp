@@ -0,0 +1,249 @@
+/** @file TriangleBVH.cpp
+ *
+ * @brief Bounding volume hierarchy for ray queries against a mesh
+ *
+ * Copyright 2013, Stewart Hall
+ *
+ * Licensed under The MIT License
+ * Redistributions of files must retain the above copyright notice.
+ *
+ * @author		Stewart Hall (www.stewartghall.com)
+ * @date		10/18/2026
+ * @copyright	Copyright 2013, Stewart Hall
+ * @license		MIT License (http://www.opensource.org/licenses/mit-license.php)
+ */
+
+#include <math.h>
+#include <algorithm>
+
+#include "TriangleBVH.h"
+#include "Geometry.h"
+
+//Deepest tree a query can walk
+#define BVH_STACK_SIZE 64
+
+//Orders triangles by their centroid on one axis
+class CentroidLess {
+private:
+	const std::vector<Vector3D> *centroids;
+	int axis;
+
+public:
+	CentroidLess(const std::vector<Vector3D> *icentroids, int iaxis)
+	{
+		centroids = icentroids;
+		axis = iaxis;
+	}
+
+	bool operator()(int a, int b) const
+	{
+		const Vector3D &ca = (*centroids)[a];
+		const Vector3D &cb = (*centroids)[b];
+		if(axis == 0)
+			return ca.x < cb.x;
+		if(axis == 1)
+			return ca.y < cb.y;
+		return ca.z < cb.z;
+	}
+};
+
+//Get one component of a vector
+static float component(const Vector3D &v, int axis)
+{
+	return axis == 0 ? v.x : (axis == 1 ? v.y : v.z);
+}
+
+//Constructor
+TriangleBVH::TriangleBVH()
+{
+	mesh = NULL;
+}
+
+//Destructor
+TriangleBVH::~TriangleBVH()
+{
+
+}
+
+//Build the tree
+void TriangleBVH::build(Geometry *g)
+{
+	mesh = g;
+	nodes.clear();
+	triangles.clear();
+
+	int num_triangles = g->getNumTriangles();
+	if(num_triangles == 0)
+		return;
+
+	std::vector<Vector3D> centroids(num_triangles);
+	triangles.resize(num_triangles);
+	for(int i = 0; i < num_triangles; i++) {
+		Triangle *tri = g->getTriangle(i);
+		Vector3D *a = g->getVertex(tri->vertices[0]);
+		Vector3D *b = g->getVertex(tri->vertices[1]);
+		Vector3D *c = g->getVertex(tri->vertices[2]);
+
+		centroids[i].x = (a->x + b->x + c->x) / 3.0f;
+		centroids[i].y = (a->y + b->y + c->y) / 3.0f;
+		centroids[i].z = (a->z + b->z + c->z) / 3.0f;
+		triangles[i] = i;
+	}
+
+	//A binary tree with leaves of at least one triangle has fewer than twice as many nodes
+	nodes.reserve(num_triangles * 2);
+	nodes.resize(1);
+	buildNode(0, 0, num_triangles, centroids);
+}
+
+//Build one node and its children
+void TriangleBVH::buildNode(int node, int first, int count, const std::vector<Vector3D> &centroids)
+{
+	//Bound the triangles and their centroids
+	float bounds_min[3] = {1e30f, 1e30f, 1e30f};
+	float bounds_max[3] = {-1e30f, -1e30f, -1e30f};
+	float centroid_min[3] = {1e30f, 1e30f, 1e30f};
+	float centroid_max[3] = {-1e30f, -1e30f, -1e30f};
+	for(int i = first; i < first + count; i++) {
+		Triangle *tri = mesh->getTriangle(triangles[i]);
+		for(int k = 0; k < 3; k++) {
+			Vector3D *p = mesh->getVertex(tri->vertices[k]);
+			for(int axis = 0; axis < 3; axis++) {
+				float value = component(*p, axis);
+				bounds_min[axis] = value < bounds_min[axis] ? value : bounds_min[axis];
+				bounds_max[axis] = value > bounds_max[axis] ? value : bounds_max[axis];
+			}
+		}
+
+		for(int axis = 0; axis < 3; axis++) {
+			float value = component(centroids[triangles[i]], axis);
+			centroid_min[axis] = value < centroid_min[axis] ? value : centroid_min[axis];
+			centroid_max[axis] = value > centroid_max[axis] ? value : centroid_max[axis];
+		}
+	}
+
+	for(int axis = 0; axis < 3; axis++) {
+		nodes[node].bounds_min[axis] = bounds_min[axis];
+		nodes[node].bounds_max[axis] = bounds_max[axis];
+	}
+
+	if(count <= BVH_LEAF_SIZE) {
+		nodes[node].first = first;
+		nodes[node].count = count;
+		return;
+	}
+
+	//Split at the median centroid along the longest axis
+	int axis = 0;
+	for(int i = 1; i < 3; i++) {
+		if(centroid_max[i] - centroid_min[i] > centroid_max[axis] - centroid_min[axis])
+			axis = i;
+	}
+
+	int half = count / 2;
+	std::nth_element(triangles.begin() + first, triangles.begin() + first + half, triangles.begin() + first + count, CentroidLess(&centroids, axis));
+
+	int children = nodes.size();
+	nodes[node].first = children;
+	nodes[node].count = 0;
+	nodes.resize(children + 2);
+
+	buildNode(children, first, half, centroids);
+	buildNode(children + 1, first + half, count - half, centroids);
+}
+
+//Find the hit closest to the origin along a line
+bool TriangleBVH::findClosestAlong(Vector3D origin, Vector3D direction, float max_distance, BVHHit *hit)
+{
+	if(nodes.empty())
+		return false;
+
+	float o[3] = {origin.x, origin.y, origin.z};
+	float d[3] = {direction.x, direction.y, direction.z};
+	float inv_d[3];
+	for(int axis = 0; axis < 3; axis++)
+		inv_d[axis] = d[axis] != 0.0f ? 1.0f / d[axis] : (d[axis] < 0.0f ? -1e30f : 1e30f);
+
+	float best = max_distance;
+	bool found = false;
+
+	int stack[BVH_STACK_SIZE];
+	int stack_size = 0;
+	stack[stack_size++] = 0;
+
+	while(stack_size) {
+		BVHNode *node = &(nodes[stack[--stack_size]]);
+
+		//Part of the line inside the box
+		float t_enter = -max_distance;
+		float t_exit = max_distance;
+		for(int axis = 0; axis < 3; axis++) {
+			float t0 = (node->bounds_min[axis] - o[axis]) * inv_d[axis];
+			float t1 = (node->bounds_max[axis] - o[axis]) * inv_d[axis];
+			if(t0 > t1) {
+				float temp = t0;
+				t0 = t1;
+				t1 = temp;
+			}
+
+			t_enter = t0 > t_enter ? t0 : t_enter;
+			t_exit = t1 < t_exit ? t1 : t_exit;
+		}
+
+		if(t_enter > t_exit)
+			continue;
+
+		//Skip boxes that cannot hold a closer hit
+		float nearest = (t_enter <= 0.0f && t_exit >= 0.0f) ? 0.0f : (t_enter > 0.0f ? t_enter : -t_exit);
+		if(nearest > best)
+			continue;
+
+		if(node->count == 0) {
+			if(stack_size + 2 > BVH_STACK_SIZE)
+				continue;
+
+			stack[stack_size++] = node->first;
+			stack[stack_size++] = node->first + 1;
+			continue;
+		}
+
+		//Test each triangle in the leaf
+		for(int i = node->first; i < node->first + node->count; i++) {
+			Triangle *tri = mesh->getTriangle(triangles[i]);
+			Vector3D *a = mesh->getVertex(tri->vertices[0]);
+			Vector3D *b = mesh->getVertex(tri->vertices[1]);
+			Vector3D *c = mesh->getVertex(tri->vertices[2]);
+
+			float e1[3] = {b->x - a->x, b->y - a->y, b->z - a->z};
+			float e2[3] = {c->x - a->x, c->y - a->y, c->z - a->z};
+			float p[3] = {d[1] * e2[2] - d[2] * e2[1], d[2] * e2[0] - d[0] * e2[2], d[0] * e2[1] - d[1] * e2[0]};
+			float det = e1[0] * p[0] + e1[1] * p[1] + e1[2] * p[2];
+			if(fabsf(det) < 1e-12f)
+				continue;
+
+			float inv_det = 1.0f / det;
+			float s[3] = {o[0] - a->x, o[1] - a->y, o[2] - a->z};
+			float u = (s[0] * p[0] + s[1] * p[1] + s[2] * p[2]) * inv_det;
+			if(u < 0.0f || u > 1.0f)
+				continue;
+
+			float q[3] = {s[1] * e1[2] - s[2] * e1[1], s[2] * e1[0] - s[0] * e1[2], s[0] * e1[1] - s[1] * e1[0]};
+			float v = (d[0] * q[0] + d[1] * q[1] + d[2] * q[2]) * inv_det;
+			if(v < 0.0f || u + v > 1.0f)
+				continue;
+
+			float t = (e2[0] * q[0] + e2[1] * q[1] + e2[2] * q[2]) * inv_det;
+			if(fabsf(t) > best || (found && fabsf(t) == best && triangles[i] > hit->triangle))
+				continue;
+
+			best = fabsf(t);
+			found = true;
+			hit->triangle = triangles[i];
+			hit->t = t;
+			hit->u = u;
+			hit->v = v;
+		}
+	}
+
+	return found;
+}
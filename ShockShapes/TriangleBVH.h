@@ -0,0 +1,98 @@
+/** @file TriangleBVH.h
+ *
+ * @brief Bounding volume hierarchy for ray queries against a mesh
+ *
+ * Copyright 2013, Stewart Hall
+ *
+ * Licensed under The MIT License
+ * Redistributions of files must retain the above copyright notice.
+ *
+ * @author		Stewart Hall (www.stewartghall.com)
+ * @date		10/18/2026
+ * @copyright	Copyright 2013, Stewart Hall
+ * @license		MIT License (http://www.opensource.org/licenses/mit-license.php)
+ */
+
+#ifndef _TRIANGLEBVH_
+#define _TRIANGLEBVH_
+
+#include <vector>
+
+#include "CommonDefs.h"
+
+class Geometry;
+
+/**
+ * Largest number of triangles stored in a leaf
+ */
+#define BVH_LEAF_SIZE 4
+
+/**
+ * @brief Result of a ray query
+ */
+typedef struct {
+	int triangle;	/**< Triangle that was hit. */
+	float t;		/**< Signed distance along the ray direction to the hit. */
+	float u;		/**< Barycentric weight of the triangle's second corner. */
+	float v;		/**< Barycentric weight of the triangle's third corner. */
+} BVHHit;
+
+/**
+ * @brief Node of the hierarchy
+ * @details Leaves have a nonzero count and hold triangles first to
+ * first + count - 1 of the sorted triangle list. Inner nodes have a count of
+ * zero and children first and first + 1.
+ */
+typedef struct {
+	float bounds_min[3];
+	float bounds_max[3];
+	int first;
+	int count;
+} BVHNode;
+
+/**
+ * @brief Binary tree of boxes around the triangles of a mesh
+ * @details Built by splitting triangles at the median centroid along the
+ * longest axis. Queries only read the tree, so any number of threads can
+ * query it at once. The mesh must not change while the tree is used.
+ */
+class TriangleBVH {
+private:
+	Geometry *mesh;					/**< Mesh the tree was built from. */
+	std::vector<BVHNode> nodes;		/**< Nodes with the root first. */
+	std::vector<int> triangles;		/**< Triangle indices in leaf order. */
+
+	/**
+	 * Builds the subtree for a range of the triangle list
+	 * @param node Index of the node to fill
+	 * @param first First triangle of the range
+	 * @param count Number of triangles in the range
+	 * @param centroids Centroid of every mesh triangle
+	 */
+	void buildNode(int node, int first, int count, const std::vector<Vector3D> &centroids);
+
+public:
+	TriangleBVH();		/**< Constructs an empty tree. */
+
+	~TriangleBVH();		/**< Destructor. */
+
+	/**
+	 * Builds the tree over the triangles of a mesh
+	 * @param g The mesh
+	 */
+	void build(Geometry *g);
+
+	/**
+	 * Finds the hit closest to a point along a line through it, looking both
+	 * forwards and backwards
+	 * @param origin Point on the line
+	 * @param direction Direction of the line
+	 * @param max_distance Largest distance along the direction to search, in
+	 * units of the direction's length
+	 * @param hit Set to the closest hit if there is one
+	 * @return True if a triangle was hit
+	 */
+	bool findClosestAlong(Vector3D origin, Vector3D direction, float max_distance, BVHHit *hit);
+};
+
+#endif
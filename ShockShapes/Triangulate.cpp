@@ -0,0 +1,168 @@
+/** @file Triangulate.cpp
+ *
+ * @brief Splits polygons read from COLLADA files into triangles
+ *
+ * Copyright 2013, Stewart Hall
+ *
+ * Licensed under The MIT License
+ * Redistributions of files must retain the above copyright notice.
+ *
+ * @author		Stewart Hall (www.stewartghall.com)
+ * @date		10/18/2026
+ * @copyright	Copyright 2013, Stewart Hall
+ * @license		MIT License (http://www.opensource.org/licenses/mit-license.php)
+ */
+
+#include <math.h>
+
+#include "Triangulate.h"
+
+//Twice the signed area of a 2D triangle
+static float cross2D(const Vector2D &a, const Vector2D &b, const Vector2D &c)
+{
+	return (b.u - a.u) * (c.v - a.v) - (b.v - a.v) * (c.u - a.u);
+}
+
+//Check if a point is inside or on the edge of a counter clockwise triangle
+static bool insideTriangle(const Vector2D &p, const Vector2D &a, const Vector2D &b, const Vector2D &c)
+{
+	return cross2D(a, b, p) >= 0.0f && cross2D(b, c, p) >= 0.0f && cross2D(c, a, p) >= 0.0f;
+}
+
+//Constructor
+Triangulator::Triangulator()
+:projected(), remaining()
+{
+
+}
+
+//Triangulate a polygon
+int Triangulator::triangulate(const Vector3D *positions, int num_corners, int *triangles)
+{
+	if(num_corners < 3)
+		return 0;
+
+	if(num_corners == 3) {
+		triangles[0] = 0;
+		triangles[1] = 1;
+		triangles[2] = 2;
+		return 1;
+	}
+
+	//Newell's method gives the polygon normal even if it is concave
+	Vector3D normal;
+	normal.x = normal.y = normal.z = 0.0f;
+	for(int i = 0; i < num_corners; i++) {
+		const Vector3D &a = positions[i];
+		const Vector3D &b = positions[(i + 1) % num_corners];
+		normal.x += (a.y - b.y) * (a.z + b.z);
+		normal.y += (a.z - b.z) * (a.x + b.x);
+		normal.z += (a.x - b.x) * (a.y + b.y);
+	}
+
+	//Project onto the plane of the two axes the normal points away from
+	float ax = fabsf(normal.x), ay = fabsf(normal.y), az = fabsf(normal.z);
+	projected.resize(num_corners);
+	bool ccw;
+	if(az >= ax && az >= ay) {
+		for(int i = 0; i < num_corners; i++) {
+			projected[i].u = positions[i].x;
+			projected[i].v = positions[i].y;
+		}
+		ccw = normal.z >= 0.0f;
+	} else if(ay >= ax) {
+		for(int i = 0; i < num_corners; i++) {
+			projected[i].u = positions[i].z;
+			projected[i].v = positions[i].x;
+		}
+		ccw = normal.y >= 0.0f;
+	} else {
+		for(int i = 0; i < num_corners; i++) {
+			projected[i].u = positions[i].y;
+			projected[i].v = positions[i].z;
+		}
+		ccw = normal.x >= 0.0f;
+	}
+
+	//Convex polygons are split as a fan
+	bool convex = true;
+	for(int i = 0; i < num_corners && convex; i++) {
+		float turn = cross2D(projected[i], projected[(i + 1) % num_corners], projected[(i + 2) % num_corners]);
+		if(ccw ? turn < 0.0f : turn > 0.0f)
+			convex = false;
+	}
+
+	if(convex) {
+		for(int i = 0; i < num_corners - 2; i++) {
+			triangles[i * 3] = 0;
+			triangles[i * 3 + 1] = i + 1;
+			triangles[i * 3 + 2] = i + 2;
+		}
+
+		return num_corners - 2;
+	}
+
+	return clipEars(num_corners, ccw, triangles);
+}
+
+//Ear clipping
+int Triangulator::clipEars(int num_corners, bool ccw, int *triangles)
+{
+	//Walk the corners counter clockwise so ear tests have one orientation
+	remaining.resize(num_corners);
+	for(int i = 0; i < num_corners; i++)
+		remaining[i] = ccw ? i : num_corners - 1 - i;
+
+	int num_triangles = 0;
+	int count = num_corners;
+	int i = 0;
+	int attempts = 0;
+
+	while(count > 3) {
+		int prev = remaining[(i + count - 1) % count];
+		int cur = remaining[i];
+		int next = remaining[(i + 1) % count];
+
+		const Vector2D &a = projected[prev];
+		const Vector2D &b = projected[cur];
+		const Vector2D &c = projected[next];
+
+		//An ear is a convex corner with no other corner inside its triangle
+		bool ear = cross2D(a, b, c) > 0.0f;
+		for(int j = 0; j < count && ear; j++) {
+			int other = remaining[j];
+			if(other == prev || other == cur || other == next)
+				continue;
+
+			if(insideTriangle(projected[other], a, b, c))
+				ear = false;
+		}
+
+		//Degenerate input may have no ears left, so clip the corner anyway
+		if(!ear && ++attempts > count)
+			ear = true;
+
+		if(ear) {
+			//Emit in the polygon's own winding
+			triangles[num_triangles * 3] = ccw ? prev : next;
+			triangles[num_triangles * 3 + 1] = cur;
+			triangles[num_triangles * 3 + 2] = ccw ? next : prev;
+			num_triangles++;
+
+			remaining.erase(remaining.begin() + i);
+			count--;
+			if(i >= count)
+				i = 0;
+			attempts = 0;
+		} else {
+			i = (i + 1) % count;
+		}
+	}
+
+	triangles[num_triangles * 3] = ccw ? remaining[0] : remaining[2];
+	triangles[num_triangles * 3 + 1] = remaining[1];
+	triangles[num_triangles * 3 + 2] = ccw ? remaining[2] : remaining[0];
+	num_triangles++;
+
+	return num_triangles;
+}
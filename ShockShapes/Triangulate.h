@@ -0,0 +1,57 @@
+/** @file Triangulate.h
+ *
+ * @brief Splits polygons read from COLLADA files into triangles
+ *
+ * Copyright 2013, Stewart Hall
+ *
+ * Licensed under The MIT License
+ * Redistributions of files must retain the above copyright notice.
+ *
+ * @author		Stewart Hall (www.stewartghall.com)
+ * @date		10/18/2026
+ * @copyright	Copyright 2013, Stewart Hall
+ * @license		MIT License (http://www.opensource.org/licenses/mit-license.php)
+ */
+
+#ifndef _TRIANGULATE_
+#define _TRIANGULATE_
+
+#include <vector>
+
+#include "CommonDefs.h"
+
+/**
+ * @brief Triangulates simple polygons
+ * @details Convex polygons are split into a fan. Concave polygons are
+ * projected onto the plane they mostly lie in and split by ear clipping.
+ * Working buffers are kept between calls so a mesh of many polygons does
+ * not allocate per polygon.
+ */
+class Triangulator {
+private:
+	std::vector<Vector2D> projected;	/**< Corners projected onto the polygon's plane. */
+	std::vector<int> remaining;			/**< Corners not yet cut off by ear clipping. */
+
+	/**
+	 * Splits a polygon by ear clipping
+	 * @param num_corners Number of corners. projected must already hold them
+	 * @param ccw True if the projected corners wind counter clockwise
+	 * @param triangles Receives 3 corner numbers per triangle
+	 * @return Number of triangles written
+	 */
+	int clipEars(int num_corners, bool ccw, int *triangles);
+
+public:
+	Triangulator();		/**< Constructs a triangulator with empty buffers. */
+
+	/**
+	 * Triangulates a polygon
+	 * @param positions Position of each corner in order around the polygon
+	 * @param num_corners Number of corners
+	 * @param triangles Receives 3 corner numbers per triangle, wound the same way as the polygon. Must hold num_corners - 2 triangles
+	 * @return Number of triangles written
+	 */
+	int triangulate(const Vector3D *positions, int num_corners, int *triangles);
+};
+
+#endif
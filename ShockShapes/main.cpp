@@ -13,6 +13,8 @@
  * @license		MIT License (http://www.opensource.org/licenses/mit-license.php)
  */
 
+#include <string.h>
+
 #include "Scene.h"
 #include "Cube.h"
 #include "Group.h"
@@ -21,9 +23,144 @@
 #include "NormalFilter.h"
 #include "Instance.h"
 #include "TiledGroup.h"
+#include "ProceduralTexture.h"
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+#define BENCH_NUM_GEOMETRIES 10000
+#define BENCH_NUM_INSTANCES 100000
+
+//Wall clock time in seconds
+double wallTime(void)
+{
+#ifdef _OPENMP
+	return omp_get_wtime();
+#else
+	return (double)clock() / CLOCKS_PER_SEC;
+#endif
+}
+
+//Times loading a synthetic file with many instances of many geometries
+void benchmarkLoad(void)
+{
+	//Build a file where every instance has to look up its geometry by id
+	Scene *source_scene = new Scene("bench_source");
+	std::vector<Geometry*> bases;
+	for(int i = 0; i < BENCH_NUM_GEOMETRIES; i++) {
+		Cube *c = new Cube(1.0f);
+		c->setVisibility(false);
+		source_scene->addObject(c);
+		bases.push_back(c);
+	}
+
+	for(int i = 0; i < BENCH_NUM_INSTANCES; i++) {
+		Instance *inst = new Instance(bases[(i * 7919) % BENCH_NUM_GEOMETRIES]);
+		inst->getTransform()->translate((float)(i % 100), 0.0f, (float)(i / 100));
+		source_scene->addObject(inst);
+	}
+
+	source_scene->generate(0);
+	if(source_scene->save("bench.dae")) {
+		printf("Could not write benchmark file\n");
+		delete source_scene;
+		return;
+	}
+	delete source_scene;
+
+	//Time the load with serial and parallel geometry parsing
+	for(int parallel = 0; parallel < 2; parallel++) {
+		Scene *load_scene = new Scene();
+		load_scene->setParallelLoad(parallel != 0);
+
+		double start = wallTime();
+		int result = load_scene->load("bench.dae");
+		double end = wallTime();
+
+		printf("%s load of %d geometries and %d instances: %.3f s (status %d)\n", parallel ? "Parallel" : "Serial",
+			BENCH_NUM_GEOMETRIES, BENCH_NUM_INSTANCES, end - start, result);
+
+		delete load_scene;
+	}
+}
+
+//Largest difference between two vectors along any axis
+float maxDifference(Vector3D *a, Vector3D *b)
+{
+	float dx = fabsf(a->x - b->x);
+	float dy = fabsf(a->y - b->y);
+	float dz = fabsf(a->z - b->z);
+
+	return dx > dy ? (dx > dz ? dx : dz) : (dy > dz ? dy : dz);
+}
+
+//Saves a quantized mesh, loads it back and checks every corner against the error the save reported
+int checkQuantizedRoundTrip(void)
+{
+	Scene *source_scene = new Scene("roundtrip_source");
+	Cube *c = new Cube(3.0f, 1.0f, 2.0f);
+	c->addFilter(new Subdivide(2));
+	c->addFilter(new NormalFilter(NM_SOFTEN));
+	source_scene->addObject(c);
+	source_scene->generate(0);
+	source_scene->setQuantized(true);
+
+	Scene *load_scene = new Scene();
+	int result = source_scene->save("roundtrip.dae");
+	if(!result)
+		result = load_scene->load("roundtrip.dae");
+
+	Geometry *loaded = result ? NULL : load_scene->findObject(c->getUniqueId());
+	if(!loaded || loaded->getNumTriangles() != c->getNumTriangles()) {
+		printf("Quantized round trip could not load the mesh (status %d)\n", result);
+		delete source_scene;
+		delete load_scene;
+		return 1;
+	}
+
+	//Allow for rounding in the decode on top of the quantization itself
+	QuantizationError error = c->getQuantizationError();
+	float position_tolerance = error.position_error + 1e-5f;
+	float normal_tolerance = cosf((error.normal_error + 0.01f) * PI / 180.0f);
+	float uv_tolerance = error.uv_error + 1e-6f;
+
+	int failures = 0;
+	for(int t = 0; t < c->getNumTriangles(); t++) {
+		Triangle *original = c->getTriangle(t);
+		Triangle *decoded = loaded->getTriangle(t);
+		for(int k = 0; k < 3; k++) {
+			Vector3D *n0 = c->getNormal(original->normals[k]);
+			Vector3D *n1 = loaded->getNormal(decoded->normals[k]);
+			Vector2D *uv0 = c->getUV(original->uvs[k]);
+			Vector2D *uv1 = loaded->getUV(decoded->uvs[k]);
+			float length = sqrtf(n0->x * n0->x + n0->y * n0->y + n0->z * n0->z);
+			float cos_angle = length > 0.0f ? (n0->x * n1->x + n0->y * n1->y + n0->z * n1->z) / length : 1.0f;
 
-int main(void)
+			if(maxDifference(c->getVertex(original->vertices[k]), loaded->getVertex(decoded->vertices[k])) > position_tolerance ||
+				cos_angle < normal_tolerance ||
+				fabsf(uv0->u - uv1->u) > uv_tolerance || fabsf(uv0->v - uv1->v) > uv_tolerance)
+				failures++;
+		}
+	}
+
+	printf("Quantized round trip of %d triangles: %d corners outside the reported error\n", c->getNumTriangles(), failures);
+
+	delete source_scene;
+	delete load_scene;
+	return failures ? 1 : 0;
+}
+
+int main(int argc, char **argv)
 {
+	if(argc > 1 && !strcmp(argv[1], "-bench")) {
+		benchmarkLoad();
+		return 0;
+	}
+
+	if(argc > 1 && !strcmp(argv[1], "-roundtrip"))
+		return checkQuantizedRoundTrip();
+
 	Scene *scene = new Scene("test_file");
 
 	Cube *c = new Cube(4.0f);
@@ -42,6 +179,19 @@ int main(void)
 	norm_f->enableSoftenThreshold(0.5f);
 	c1->addFilter(norm_f);
 
+	//Brick texture roughened by noise
+	PatternNode *bricks = new PatternNode(TP_BRICKS, 8.0f);
+	NoiseNode *grain = new NoiseNode(7, 32.0f, 4);
+	BlendNode *brick_wall = new BlendNode(bricks, grain, BM_MULTIPLY, 0.6f);
+
+	ProceduralTexture *wall_texture = new ProceduralTexture("WallTexture", brick_wall, 512, 512);
+	Vector3D mortar_color, brick_color;
+	mortar_color.x = 0.35f; mortar_color.y = 0.33f; mortar_color.z = 0.3f;
+	brick_color.x = 0.65f; brick_color.y = 0.25f; brick_color.z = 0.15f;
+	wall_texture->setColors(mortar_color, brick_color);
+	scene->addTexture(wall_texture);
+	c1->setTexture(wall_texture);
+
 	//Set up tiled group
 	TiledGroup *wall = new TiledGroup("Wall");
 	wall->setBaseObject(c1, 5.15f, 2.15f);
@@ -49,7 +199,7 @@ int main(void)
 	scene->addObject(wall);
 	
 	scene->generate(0);
-	if(scene->save("test.dae")) {
+	if(scene->renderTextures() || scene->save("test.dae")) {
 		printf("Error occured\n");
 		getchar();
 	}